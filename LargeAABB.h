@@ -0,0 +1,627 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargePositionBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/*
+
+LargeAABB is an axis-aligned bounding box whose corners are LargePositions (cell + local offset).
+
+Tests never go through to_double3(). Like operator==, they work from integer cell deltas: every coordinate is
+expressed in the frame of one reference cell as
+
+  float(clamp(cell - reference_cell)) * CELL_SIZE + local
+
+where the cell delta is computed exactly and saturated to the int32_t range. Near the reference cell this is as
+precise as the local offsets themselves; far away it is approximate, but the sign (which side of a box a
+coordinate lies on) is always right. merge() copies corner components and therefore never rounds.
+
+LargeAABBBuffer stores boxes as SoA lanes, and the batch_* functions test one query box against thousands of
+boxes with SIMD. Batch results are bit-identical to the scalar LargeAABB methods: the squared distances are never
+fused into FMAs, on any path (see unfused() in LargePositionBatch.h).
+
+*/
+struct LargeAABB
+{
+    LargePosition min;
+    LargePosition max;
+
+    LargeAABB() = default;
+
+    LargeAABB(const LargePosition& min_, const LargePosition& max_)
+        : min(min_)
+        , max(max_)
+    {
+    }
+
+    // Box around center with the given half extents (each within 3 cells, like from_float3())
+    static LargeAABB from_center(const LargePosition& center, const float3& half_extent)
+    {
+        LargeAABB box;
+        box.min.from_float3(center.global, center.local - half_extent);
+        box.max.from_float3(center.global, center.local + half_extent);
+        return box;
+    }
+
+    // Offset of one corner coordinate from the center of the reference cell (see the comment above). The scale by
+    // CELL_SIZE is exact, so the result is the same whether or not the compiler fuses it with the add.
+    static float axis_offset(int32_t cell, float local, int32_t reference)
+    {
+        return float(cell_delta(cell, reference)) * LargePosition::CELL_SIZE + local;
+    }
+
+    // cell - reference, computed exactly and saturated to the int32_t range
+    static int32_t cell_delta(int32_t cell, int32_t reference)
+    {
+        int64_t d = int64_t(cell) - reference;
+        return int32_t(std::min<int64_t>(std::max<int64_t>(d, INT32_MIN), INT32_MAX));
+    }
+
+    bool overlaps(const LargeAABB& other) const
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float lo, hi, other_lo, other_hi;
+            axis_interval(axis, *this, &lo, &hi, other, &other_lo, &other_hi);
+            if (!(other_lo <= hi && lo <= other_hi))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool contains(const LargeAABB& other) const
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float lo, hi, other_lo, other_hi;
+            axis_interval(axis, *this, &lo, &hi, other, &other_lo, &other_hi);
+            if (!(lo <= other_lo && other_hi <= hi))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool contains(const LargePosition& pos) const { return contains(LargeAABB(pos, pos)); }
+
+    // Squared distance between the closest points of two boxes, 0 when they overlap
+    float distance_sq(const LargeAABB& other) const
+    {
+        float gap[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float lo, hi, other_lo, other_hi;
+            axis_interval(axis, *this, &lo, &hi, other, &other_lo, &other_hi);
+            gap[axis] = std::max(std::max(other_lo - hi, lo - other_hi), 0.0f);
+        }
+        using namespace large_coordinates_detail;
+        return (unfused(gap[0] * gap[0]) + unfused(gap[1] * gap[1])) + unfused(gap[2] * gap[2]);
+    }
+
+    float distance_sq(const LargePosition& pos) const { return distance_sq(LargeAABB(pos, pos)); }
+
+    // Smallest box containing both boxes
+    LargeAABB merged(const LargeAABB& other) const
+    {
+        LargeAABB result = *this;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float lo, hi, other_lo, other_hi;
+            axis_interval(axis, *this, &lo, &hi, other, &other_lo, &other_hi);
+            if (other_lo < lo)
+            {
+                copy_axis(result.min, other.min, axis);
+            }
+            if (other_hi > hi)
+            {
+                copy_axis(result.max, other.max, axis);
+            }
+        }
+        return result;
+    }
+
+    void merge(const LargeAABB& other) { *this = merged(other); }
+
+  private:
+    static int32_t component(const int3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+    static float component(const float3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+    static void copy_axis(LargePosition& dst, const LargePosition& src, int axis)
+    {
+        (axis == 0 ? dst.global.x : (axis == 1 ? dst.global.y : dst.global.z)) = component(src.global, axis);
+        (axis == 0 ? dst.local.x : (axis == 1 ? dst.local.y : dst.local.z)) = component(src.local, axis);
+    }
+
+    // Both intervals along one axis, in the frame of a.min's cell
+    static void axis_interval(int axis, const LargeAABB& a, float* lo, float* hi, const LargeAABB& b, float* b_lo, float* b_hi)
+    {
+        int32_t reference = component(a.min.global, axis);
+        *lo = axis_offset(component(a.min.global, axis), component(a.min.local, axis), reference);
+        *hi = axis_offset(component(a.max.global, axis), component(a.max.local, axis), reference);
+        *b_lo = axis_offset(component(b.min.global, axis), component(b.min.local, axis), reference);
+        *b_hi = axis_offset(component(b.max.global, axis), component(b.max.local, axis), reference);
+    }
+};
+
+// Read-only SoA view of many boxes
+struct AABBLanes
+{
+    PositionLanes min;
+    PositionLanes max;
+};
+
+/*
+
+LargeAABBBuffer stores boxes as two LargePositionBuffers (min and max corners), so every component is a
+contiguous lane for the batch tests.
+
+*/
+class LargeAABBBuffer
+{
+  public:
+    size_t size() const { return m_min.size(); }
+    bool empty() const { return m_min.empty(); }
+
+    void reserve(size_t count)
+    {
+        m_min.reserve(count);
+        m_max.reserve(count);
+    }
+
+    void clear()
+    {
+        m_min.clear();
+        m_max.clear();
+    }
+
+    void push_back(const LargeAABB& box)
+    {
+        m_min.push_back(box.min);
+        m_max.push_back(box.max);
+    }
+
+    LargeAABB get(size_t index) const { return LargeAABB(m_min.get(index), m_max.get(index)); }
+
+    void set(size_t index, const LargeAABB& box)
+    {
+        m_min.set(index, box.min);
+        m_max.set(index, box.max);
+    }
+
+    AABBLanes lanes() const { return AABBLanes{m_min.lanes(), m_max.lanes()}; }
+
+  private:
+    LargePositionBuffer m_min;
+    LargePositionBuffer m_max;
+};
+
+namespace large_coordinates_detail
+{
+
+enum class AABBTest
+{
+    Overlap,  // query overlaps box i
+    Contains, // query contains box i
+};
+
+// Query box prepared in the frame of its min cell
+struct AABBQuery
+{
+    int32_t reference[3];
+    float lo[3];
+    float hi[3];
+};
+
+inline AABBQuery make_aabb_query(const LargeAABB& query)
+{
+    AABBQuery q;
+    q.reference[0] = query.min.global.x;
+    q.reference[1] = query.min.global.y;
+    q.reference[2] = query.min.global.z;
+    const float min_local[3] = {query.min.local.x, query.min.local.y, query.min.local.z};
+    const float max_local[3] = {query.max.local.x, query.max.local.y, query.max.local.z};
+    const int32_t max_global[3] = {query.max.global.x, query.max.global.y, query.max.global.z};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        q.lo[axis] = LargeAABB::axis_offset(q.reference[axis], min_local[axis], q.reference[axis]);
+        q.hi[axis] = LargeAABB::axis_offset(max_global[axis], max_local[axis], q.reference[axis]);
+    }
+    return q;
+}
+
+inline void lane_axes(const PositionLanes& lanes, const int32_t* (&global)[3], const float* (&local)[3])
+{
+    global[0] = lanes.global_x;
+    global[1] = lanes.global_y;
+    global[2] = lanes.global_z;
+    local[0] = lanes.local_x;
+    local[1] = lanes.local_y;
+    local[2] = lanes.local_z;
+}
+
+template <AABBTest Test>
+inline size_t aabb_test_scalar(const AABBQuery& q, const AABBLanes& boxes, size_t first, size_t count, uint64_t* mask)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t hits = 0;
+    for (size_t i = first; i < count; i++)
+    {
+        bool hit = true;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float lo = LargeAABB::axis_offset(min_global[axis][i], min_local[axis][i], q.reference[axis]);
+            float hi = LargeAABB::axis_offset(max_global[axis][i], max_local[axis][i], q.reference[axis]);
+            hit = hit && (Test == AABBTest::Overlap ? (lo <= q.hi[axis] && q.lo[axis] <= hi) : (q.lo[axis] <= lo && hi <= q.hi[axis]));
+        }
+        if (hit)
+        {
+            mask[i / 64] |= uint64_t(1) << (i % 64);
+            hits++;
+        }
+    }
+    return hits;
+}
+
+inline void aabb_distance_sq_scalar(const AABBQuery& q, const AABBLanes& boxes, size_t first, size_t count, float* out)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    for (size_t i = first; i < count; i++)
+    {
+        float gap[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float lo = LargeAABB::axis_offset(min_global[axis][i], min_local[axis][i], q.reference[axis]);
+            float hi = LargeAABB::axis_offset(max_global[axis][i], max_local[axis][i], q.reference[axis]);
+            gap[axis] = std::max(std::max(lo - q.hi[axis], q.lo[axis] - hi), 0.0f);
+        }
+        out[i] = (unfused(gap[0] * gap[0]) + unfused(gap[1] * gap[1])) + unfused(gap[2] * gap[2]);
+    }
+}
+
+#if LARGE_COORDINATES_X86
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// cell - reference saturated to the int32_t range, as in LargeAABB::axis_offset(). The int32_t subtraction wraps
+// only when the true delta leaves the int32_t range, which happens exactly when the signs of cell and reference
+// differ and the result takes the sign of the reference; those lanes saturate towards the sign of cell.
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128i cell_delta_sse42(__m128i cell, __m128i reference)
+{
+    __m128i d = _mm_sub_epi32(cell, reference);
+    __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(cell, reference), _mm_xor_si128(cell, d)), 31);
+    __m128i saturated = _mm_xor_si128(_mm_srai_epi32(cell, 31), _mm_set1_epi32(INT32_MAX));
+    return _mm_blendv_epi8(d, saturated, overflow);
+}
+
+// Vector form of LargeAABB::axis_offset()
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128 axis_offset_sse42(const int32_t* global, const float* local, __m128i reference)
+{
+    __m128i d = cell_delta_sse42(_mm_loadu_si128(reinterpret_cast<const __m128i*>(global)), reference);
+    return _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(d), _mm_set1_ps(LargePosition::CELL_SIZE)), _mm_loadu_ps(local));
+}
+
+template <AABBTest Test>
+LARGE_COORDINATES_TARGET("sse4.2")
+inline size_t aabb_test_sse42(const AABBQuery& q, const AABBLanes& boxes, size_t count, uint64_t* mask)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t hits = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 hit = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m128i reference = _mm_set1_epi32(q.reference[axis]);
+            __m128 lo = axis_offset_sse42(min_global[axis] + i, min_local[axis] + i, reference);
+            __m128 hi = axis_offset_sse42(max_global[axis] + i, max_local[axis] + i, reference);
+            __m128 q_lo = _mm_set1_ps(q.lo[axis]);
+            __m128 q_hi = _mm_set1_ps(q.hi[axis]);
+            if (Test == AABBTest::Overlap)
+            {
+                hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(lo, q_hi), _mm_cmple_ps(q_lo, hi)));
+            }
+            else
+            {
+                hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(q_lo, lo), _mm_cmple_ps(hi, q_hi)));
+            }
+        }
+        uint32_t bits = uint32_t(_mm_movemask_ps(hit));
+        hits += store_changed_bits(mask, i, bits);
+    }
+    return hits + aabb_test_scalar<Test>(q, boxes, i, count, mask);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void aabb_distance_sq_sse42(const AABBQuery& q, const AABBLanes& boxes, size_t count, float* out)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 gap[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m128i reference = _mm_set1_epi32(q.reference[axis]);
+            __m128 lo = axis_offset_sse42(min_global[axis] + i, min_local[axis] + i, reference);
+            __m128 hi = axis_offset_sse42(max_global[axis] + i, max_local[axis] + i, reference);
+            __m128 g = _mm_max_ps(_mm_sub_ps(lo, _mm_set1_ps(q.hi[axis])), _mm_sub_ps(_mm_set1_ps(q.lo[axis]), hi));
+            gap[axis] = _mm_max_ps(g, _mm_setzero_ps());
+        }
+        __m128 xy = _mm_add_ps(unfused(_mm_mul_ps(gap[0], gap[0])), unfused(_mm_mul_ps(gap[1], gap[1])));
+        __m128 d = _mm_add_ps(xy, unfused(_mm_mul_ps(gap[2], gap[2])));
+        _mm_storeu_ps(out + i, d);
+    }
+    aabb_distance_sq_scalar(q, boxes, i, count, out);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256i cell_delta_avx2(__m256i cell, __m256i reference)
+{
+    __m256i d = _mm256_sub_epi32(cell, reference);
+    __m256i overflow = _mm256_srai_epi32(_mm256_and_si256(_mm256_xor_si256(cell, reference), _mm256_xor_si256(cell, d)), 31);
+    __m256i saturated = _mm256_xor_si256(_mm256_srai_epi32(cell, 31), _mm256_set1_epi32(INT32_MAX));
+    return _mm256_blendv_epi8(d, saturated, overflow);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256 axis_offset_avx2(const int32_t* global, const float* local, __m256i reference)
+{
+    __m256i d = cell_delta_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(global)), reference);
+    return _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(d), _mm256_set1_ps(LargePosition::CELL_SIZE)), _mm256_loadu_ps(local));
+}
+
+template <AABBTest Test>
+LARGE_COORDINATES_TARGET("avx2")
+inline size_t aabb_test_avx2(const AABBQuery& q, const AABBLanes& boxes, size_t count, uint64_t* mask)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t hits = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 hit = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m256i reference = _mm256_set1_epi32(q.reference[axis]);
+            __m256 lo = axis_offset_avx2(min_global[axis] + i, min_local[axis] + i, reference);
+            __m256 hi = axis_offset_avx2(max_global[axis] + i, max_local[axis] + i, reference);
+            __m256 q_lo = _mm256_set1_ps(q.lo[axis]);
+            __m256 q_hi = _mm256_set1_ps(q.hi[axis]);
+            if (Test == AABBTest::Overlap)
+            {
+                hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(lo, q_hi, _CMP_LE_OQ), _mm256_cmp_ps(q_lo, hi, _CMP_LE_OQ)));
+            }
+            else
+            {
+                hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(q_lo, lo, _CMP_LE_OQ), _mm256_cmp_ps(hi, q_hi, _CMP_LE_OQ)));
+            }
+        }
+        uint32_t bits = uint32_t(_mm256_movemask_ps(hit));
+        hits += store_changed_bits(mask, i, bits);
+    }
+    return hits + aabb_test_scalar<Test>(q, boxes, i, count, mask);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void aabb_distance_sq_avx2(const AABBQuery& q, const AABBLanes& boxes, size_t count, float* out)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 gap[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m256i reference = _mm256_set1_epi32(q.reference[axis]);
+            __m256 lo = axis_offset_avx2(min_global[axis] + i, min_local[axis] + i, reference);
+            __m256 hi = axis_offset_avx2(max_global[axis] + i, max_local[axis] + i, reference);
+            __m256 g = _mm256_max_ps(_mm256_sub_ps(lo, _mm256_set1_ps(q.hi[axis])), _mm256_sub_ps(_mm256_set1_ps(q.lo[axis]), hi));
+            gap[axis] = _mm256_max_ps(g, _mm256_setzero_ps());
+        }
+        __m256 xy = _mm256_add_ps(unfused(_mm256_mul_ps(gap[0], gap[0])), unfused(_mm256_mul_ps(gap[1], gap[1])));
+        __m256 d = _mm256_add_ps(xy, unfused(_mm256_mul_ps(gap[2], gap[2])));
+        _mm256_storeu_ps(out + i, d);
+    }
+    aabb_distance_sq_scalar(q, boxes, i, count, out);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512i cell_delta_avx512(__m512i cell, __m512i reference)
+{
+    __m512i d = _mm512_sub_epi32(cell, reference);
+    __mmask16 overflow = _mm512_cmplt_epi32_mask(_mm512_and_si512(_mm512_xor_si512(cell, reference), _mm512_xor_si512(cell, d)),
+                                                 _mm512_setzero_si512());
+    __m512i saturated = _mm512_xor_si512(_mm512_srai_epi32(cell, 31), _mm512_set1_epi32(INT32_MAX));
+    return _mm512_mask_blend_epi32(overflow, d, saturated);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512 axis_offset_avx512(const int32_t* global, const float* local, __m512i reference)
+{
+    __m512i d = cell_delta_avx512(_mm512_loadu_si512(global), reference);
+    return _mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(d), _mm512_set1_ps(LargePosition::CELL_SIZE)), _mm512_loadu_ps(local));
+}
+
+template <AABBTest Test>
+LARGE_COORDINATES_TARGET("avx512f")
+inline size_t aabb_test_avx512(const AABBQuery& q, const AABBLanes& boxes, size_t count, uint64_t* mask)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t hits = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __mmask16 hit = 0xffff;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m512i reference = _mm512_set1_epi32(q.reference[axis]);
+            __m512 lo = axis_offset_avx512(min_global[axis] + i, min_local[axis] + i, reference);
+            __m512 hi = axis_offset_avx512(max_global[axis] + i, max_local[axis] + i, reference);
+            __m512 q_lo = _mm512_set1_ps(q.lo[axis]);
+            __m512 q_hi = _mm512_set1_ps(q.hi[axis]);
+            if (Test == AABBTest::Overlap)
+            {
+                hit = _mm512_mask_cmp_ps_mask(hit, lo, q_hi, _CMP_LE_OQ);
+                hit = _mm512_mask_cmp_ps_mask(hit, q_lo, hi, _CMP_LE_OQ);
+            }
+            else
+            {
+                hit = _mm512_mask_cmp_ps_mask(hit, q_lo, lo, _CMP_LE_OQ);
+                hit = _mm512_mask_cmp_ps_mask(hit, hi, q_hi, _CMP_LE_OQ);
+            }
+        }
+        hits += store_changed_bits(mask, i, uint32_t(hit));
+    }
+    return hits + aabb_test_scalar<Test>(q, boxes, i, count, mask);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void aabb_distance_sq_avx512(const AABBQuery& q, const AABBLanes& boxes, size_t count, float* out)
+{
+    const int32_t* min_global[3];
+    const float* min_local[3];
+    const int32_t* max_global[3];
+    const float* max_local[3];
+    lane_axes(boxes.min, min_global, min_local);
+    lane_axes(boxes.max, max_global, max_local);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512 gap[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m512i reference = _mm512_set1_epi32(q.reference[axis]);
+            __m512 lo = axis_offset_avx512(min_global[axis] + i, min_local[axis] + i, reference);
+            __m512 hi = axis_offset_avx512(max_global[axis] + i, max_local[axis] + i, reference);
+            __m512 g = _mm512_max_ps(_mm512_sub_ps(lo, _mm512_set1_ps(q.hi[axis])), _mm512_sub_ps(_mm512_set1_ps(q.lo[axis]), hi));
+            gap[axis] = _mm512_max_ps(g, _mm512_setzero_ps());
+        }
+        __m512 xy = _mm512_add_ps(unfused(_mm512_mul_ps(gap[0], gap[0])), unfused(_mm512_mul_ps(gap[1], gap[1])));
+        __m512 d = _mm512_add_ps(xy, unfused(_mm512_mul_ps(gap[2], gap[2])));
+        _mm512_storeu_ps(out + i, d);
+    }
+    aabb_distance_sq_scalar(q, boxes, i, count, out);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // LARGE_COORDINATES_X86
+
+template <AABBTest Test>
+inline size_t batch_aabb_test(const LargeAABB& query, const AABBLanes& boxes, size_t count, uint64_t* mask)
+{
+    std::memset(mask, 0, ((count + 63) / 64) * sizeof(uint64_t));
+    const AABBQuery q = make_aabb_query(query);
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        return aabb_test_avx512<Test>(q, boxes, count, mask);
+    case SimdLevel::AVX2:
+        return aabb_test_avx2<Test>(q, boxes, count, mask);
+    case SimdLevel::SSE42:
+        return aabb_test_sse42<Test>(q, boxes, count, mask);
+#endif
+    default:
+        return aabb_test_scalar<Test>(q, boxes, 0, count, mask);
+    }
+}
+
+} // namespace large_coordinates_detail
+
+// Sets bit i of hit_mask ((count + 63) / 64 words) when `query` overlaps box i, returns the number of hits.
+// Use changed_mask_to_indices() to turn the mask into a list of indices.
+inline size_t batch_overlaps(const LargeAABB& query, const AABBLanes& boxes, size_t count, uint64_t* hit_mask)
+{
+    using namespace large_coordinates_detail;
+    return batch_aabb_test<AABBTest::Overlap>(query, boxes, count, hit_mask);
+}
+
+// Sets bit i of hit_mask when `query` fully contains box i, returns the number of hits
+inline size_t batch_contains(const LargeAABB& query, const AABBLanes& boxes, size_t count, uint64_t* hit_mask)
+{
+    using namespace large_coordinates_detail;
+    return batch_aabb_test<AABBTest::Contains>(query, boxes, count, hit_mask);
+}
+
+// out[i] = query.distance_sq(box i)
+inline void batch_distance_sq(const LargeAABB& query, const AABBLanes& boxes, size_t count, float* out)
+{
+    using namespace large_coordinates_detail;
+    const AABBQuery q = make_aabb_query(query);
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        aabb_distance_sq_avx512(q, boxes, count, out);
+        return;
+    case SimdLevel::AVX2:
+        aabb_distance_sq_avx2(q, boxes, count, out);
+        return;
+    case SimdLevel::SSE42:
+        aabb_distance_sq_sse42(q, boxes, count, out);
+        return;
+#endif
+    default:
+        aabb_distance_sq_scalar(q, boxes, 0, count, out);
+        return;
+    }
+}
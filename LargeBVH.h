@@ -0,0 +1,673 @@
+#pragma once
+
+#include "LargeAABB.h"
+#include "LargeCoordinates.h"
+#include "LargeRay.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+/*
+
+LargeBVH is a two-level bounding volume hierarchy for objects anchored to LargePositions.
+
+A single float BVH cannot span the +/-29.3 AU range, so the structure is split in two levels:
+
+  - The top level maps every occupied cell (LargePosition::global) to its own subtree. The root bounds of all
+    subtrees are kept as LargeAABBs in a LargeAABBBuffer and scanned with the SIMD batch_overlaps() test, which
+    handles any cell distance without converting to double.
+  - Each cell owns a dynamic float BVH over the objects' local coordinates. Leaves are inserted by a surface area
+    descent and removed by collapsing their parent (no rebuild), so nodes live as long as their object.
+
+Moving objects:
+
+  - update() with a position that kept its cell (the common case after from_float3()) only writes the leaf bounds
+    and marks the cell subtree dirty. refit() then recomputes the bounds of every dirty subtree bottom-up.
+  - update() with a position in a different cell removes the leaf from the old subtree and inserts it into the new
+    one. Empty subtrees are released.
+
+Queries expect refit() to have been called after the last update(). Query methods reuse internal scratch
+buffers, so a LargeBVH must not be queried from several threads at once.
+
+Object ids are dense indices (entity indices), like in LargeSpatialHash.
+
+*/
+class LargeBVH
+{
+  public:
+    inline static constexpr uint32_t INVALID = 0xffffffffu;
+
+    struct RayHit
+    {
+        uint32_t id;
+        float distance; // ray parameter of the entry point (world units when the direction is normalized)
+    };
+
+    size_t object_count() const { return m_object_count; }
+    size_t cell_count() const { return m_cells.size(); }
+
+    bool contains(uint32_t id) const { return id < m_objects.size() && m_objects[id].tree != INVALID; }
+
+    void clear()
+    {
+        m_trees.clear();
+        m_free_trees.clear();
+        m_cells.clear();
+        m_tree_bounds.clear();
+        m_objects.clear();
+        m_dirty_trees.clear();
+        m_object_count = 0;
+        m_reach = 0;
+    }
+
+    // Replaces the content with `count` objects; every cell subtree is built top-down by median splits,
+    // which gives better trees than inserting the objects one by one
+    void build(const uint32_t* ids, const LargePosition* positions, const float3* half_extents, size_t count)
+    {
+        clear();
+        std::vector<uint32_t> tree_of(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            tree_of[i] = acquire_tree(positions[i].global);
+            m_trees[tree_of[i]].object_count++;
+        }
+
+        std::vector<std::vector<uint32_t>> leaves(m_trees.size());
+        for (uint32_t t = 0; t < uint32_t(m_trees.size()); t++)
+        {
+            leaves[t].reserve(m_trees[t].object_count);
+            m_trees[t].nodes.reserve(size_t(m_trees[t].object_count) * 2);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            assert(!contains(ids[i]) && "Object is already in the BVH");
+            uint32_t leaf = create_leaf(tree_of[i], ids[i], positions[i].local, half_extents[i]);
+            leaves[tree_of[i]].push_back(leaf);
+        }
+        m_object_count = count;
+
+        for (uint32_t t = 0; t < uint32_t(m_trees.size()); t++)
+        {
+            m_trees[t].root = build_range(m_trees[t], leaves[t].data(), leaves[t].size(), INVALID);
+            update_tree_bounds(t);
+        }
+    }
+
+    void insert(uint32_t id, const LargePosition& pos, const float3& half_extent)
+    {
+        assert(!contains(id) && "Object is already in the BVH");
+        uint32_t tree = acquire_tree(pos.global);
+        m_trees[tree].object_count++;
+        insert_leaf(tree, create_leaf(tree, id, pos.local, half_extent));
+        m_object_count++;
+    }
+
+    bool remove(uint32_t id)
+    {
+        if (!contains(id))
+        {
+            return false;
+        }
+        erase(id);
+        return true;
+    }
+
+    // Moves an object. Returns true when it changed cell and was reinserted into another subtree.
+    bool update(uint32_t id, const LargePosition& pos)
+    {
+        assert(contains(id) && "Object is not in the BVH");
+        Object& object = m_objects[id];
+        CellTree& tree = m_trees[object.tree];
+        if (tree.cell == pos.global)
+        {
+            Node& leaf = tree.nodes[object.leaf];
+            leaf.min = pos.local - object.half_extent;
+            leaf.max = pos.local + object.half_extent;
+            mark_dirty(object.tree);
+            return false;
+        }
+
+        const float3 half_extent = object.half_extent;
+        erase(id);
+        insert(id, pos, half_extent);
+        return true;
+    }
+
+    // Recomputes the bounds of every subtree touched by an in-cell update(), returns the number of subtrees refitted
+    size_t refit()
+    {
+        size_t refitted = 0;
+        for (uint32_t t : m_dirty_trees)
+        {
+            CellTree& tree = m_trees[t];
+            tree.dirty = false;
+            if (tree.root == INVALID)
+            {
+                continue;
+            }
+            refit_subtree(tree, tree.root);
+            update_tree_bounds(t);
+            refitted++;
+        }
+        m_dirty_trees.clear();
+        return refitted;
+    }
+
+    // Appends the id of every object whose bounds overlap `box`, returns the number of ids appended
+    size_t overlap(const LargeAABB& box, std::vector<uint32_t>& out)
+    {
+        assert(m_dirty_trees.empty() && "Call refit() after update() before querying");
+        const size_t first = out.size();
+        const size_t candidates = candidate_trees(box);
+
+        for (size_t c = 0; c < candidates; c++)
+        {
+            const CellTree& tree = m_trees[m_candidates[c]];
+            const float3 lo = to_tree_frame(box.min, tree.cell);
+            const float3 hi = to_tree_frame(box.max, tree.cell);
+
+            m_stack.clear();
+            m_stack.push_back(tree.root);
+            while (!m_stack.empty())
+            {
+                const Node& node = tree.nodes[m_stack.back()];
+                m_stack.pop_back();
+                if (!(node.min.x <= hi.x && lo.x <= node.max.x && node.min.y <= hi.y && lo.y <= node.max.y && node.min.z <= hi.z &&
+                      lo.z <= node.max.z))
+                {
+                    continue;
+                }
+                if (node.child[0] == INVALID)
+                {
+                    out.push_back(node.object);
+                }
+                else
+                {
+                    m_stack.push_back(node.child[0]);
+                    m_stack.push_back(node.child[1]);
+                }
+            }
+        }
+        return out.size() - first;
+    }
+
+    // Closest object hit by the ray within max_distance. The ray is expressed in every subtree's cell frame,
+    // so precision is that of a float position at the distance between the ray origin and the subtree.
+    bool raycast(const LargePosition& origin, const float3& direction, float max_distance, RayHit& hit)
+    {
+        assert(m_dirty_trees.empty() && "Call refit() after update() before querying");
+        const float3 inv_dir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+        // The segment's bounding box selects the candidate subtrees with the SIMD top-level scan
+        const float3 end = origin.local + direction * max_distance;
+        LargeAABB segment_bounds;
+        segment_bounds.min.global = origin.global;
+        segment_bounds.max.global = origin.global;
+        segment_bounds.min.local = min3(origin.local, end);
+        segment_bounds.max.local = max3(origin.local, end);
+        const size_t candidates = candidate_trees(segment_bounds);
+
+        // Subtrees whose root is hit, nearest entry first, so far subtrees are skipped once a closer hit is known
+        m_ray_candidates.clear();
+        for (size_t c = 0; c < candidates; c++)
+        {
+            const CellTree& tree = m_trees[m_candidates[c]];
+            float t_enter;
+            if (ray_box(to_tree_frame(origin, tree.cell), inv_dir, tree.nodes[tree.root], max_distance, &t_enter))
+            {
+                m_ray_candidates.push_back(RayCandidate{t_enter, m_candidates[c]});
+            }
+        }
+        std::sort(m_ray_candidates.begin(), m_ray_candidates.end(),
+                  [](const RayCandidate& a, const RayCandidate& b) { return a.t_enter < b.t_enter; });
+
+        hit = RayHit{INVALID, max_distance};
+        for (const RayCandidate& candidate : m_ray_candidates)
+        {
+            if (candidate.t_enter > hit.distance)
+            {
+                break;
+            }
+            const CellTree& tree = m_trees[candidate.tree];
+            const float3 o = to_tree_frame(origin, tree.cell);
+
+            m_stack.clear();
+            m_stack.push_back(tree.root);
+            while (!m_stack.empty())
+            {
+                const Node& node = tree.nodes[m_stack.back()];
+                m_stack.pop_back();
+                float t_enter;
+                if (!ray_box(o, inv_dir, node, hit.distance, &t_enter))
+                {
+                    continue;
+                }
+                if (node.child[0] == INVALID)
+                {
+                    if (hit.id == INVALID || t_enter < hit.distance)
+                    {
+                        hit = RayHit{node.object, t_enter};
+                    }
+                    continue;
+                }
+
+                // Visit the nearer child first (pushed last)
+                float t0 = FLT_MAX, t1 = FLT_MAX;
+                bool hit0 = ray_box(o, inv_dir, tree.nodes[node.child[0]], hit.distance, &t0);
+                bool hit1 = ray_box(o, inv_dir, tree.nodes[node.child[1]], hit.distance, &t1);
+                uint32_t near_child = t0 <= t1 ? node.child[0] : node.child[1];
+                uint32_t far_child = t0 <= t1 ? node.child[1] : node.child[0];
+                if (t0 <= t1 ? hit1 : hit0)
+                {
+                    m_stack.push_back(far_child);
+                }
+                if (t0 <= t1 ? hit0 : hit1)
+                {
+                    m_stack.push_back(near_child);
+                }
+            }
+        }
+        return hit.id != INVALID;
+    }
+
+    bool raycast(const LargeRay& ray, float max_distance, RayHit& hit) { return raycast(ray.origin, ray.direction, max_distance, hit); }
+
+  private:
+    struct Node
+    {
+        float3 min;
+        float3 max;
+        uint32_t parent;
+        uint32_t child[2]; // child[0] == INVALID for leaves
+        uint32_t object;
+    };
+
+    struct CellTree
+    {
+        int3 cell;
+        uint32_t root = INVALID;
+        uint32_t object_count = 0;
+        bool dirty = false;
+        std::vector<Node> nodes;
+        std::vector<uint32_t> free_nodes;
+    };
+
+    struct Object
+    {
+        uint32_t tree = INVALID;
+        uint32_t leaf = INVALID;
+        float3 half_extent;
+    };
+
+    struct RayCandidate
+    {
+        float t_enter;
+        uint32_t tree;
+    };
+
+    // A hash probe costs about as much as scanning this many roots with the SIMD test
+    inline static constexpr double PROBE_COST = 16.0;
+
+    static float3 min3(const float3& a, const float3& b) { return float3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)); }
+    static float3 max3(const float3& a, const float3& b) { return float3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)); }
+
+    static float surface_area(const float3& min, const float3& max)
+    {
+        float3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    // Position relative to the center of `cell`, using the same saturated cell delta as LargeAABB
+    static float3 to_tree_frame(const LargePosition& pos, const int3& cell)
+    {
+        return float3(LargeAABB::axis_offset(pos.global.x, pos.local.x, cell.x), LargeAABB::axis_offset(pos.global.y, pos.local.y, cell.y),
+                      LargeAABB::axis_offset(pos.global.z, pos.local.z, cell.z));
+    }
+
+    static bool ray_box(const float3& origin, const float3& inv_dir, const Node& node, float t_max, float* t_enter)
+    {
+        return ray_intersect_box(origin, inv_dir, node.min, node.max, t_max, t_enter);
+    }
+
+    // Fills m_candidates with the subtrees that may overlap `box`, returns their number.
+    // Small boxes probe the cells they can reach through the hash map; large ones scan every root with the SIMD
+    // batch test. Probed subtrees are not tested against their root here, the traversal does that first.
+    size_t candidate_trees(const LargeAABB& box)
+    {
+        const size_t tree_count = m_trees.size();
+        m_candidates.resize(tree_count);
+
+        // Cells whose subtree can reach the box: the box's own cells, widened by the largest subtree reach
+        constexpr double cell_size = LargePosition::CELL_SIZE;
+        const int32_t min_global[3] = {box.min.global.x, box.min.global.y, box.min.global.z};
+        const int32_t max_global[3] = {box.max.global.x, box.max.global.y, box.max.global.z};
+        const float min_local[3] = {box.min.local.x, box.min.local.y, box.min.local.z};
+        const float max_local[3] = {box.max.local.x, box.max.local.y, box.max.local.z};
+        int64_t lo[3], hi[3];
+        double volume = 1.0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            double first = double(min_global[axis]) + std::floor(min_local[axis] / cell_size + 0.5) - double(m_reach);
+            double last = double(max_global[axis]) + std::floor(max_local[axis] / cell_size + 0.5) + double(m_reach);
+            lo[axis] = int64_t(std::max(first, double(INT32_MIN)));
+            hi[axis] = int64_t(std::min(last, double(INT32_MAX)));
+            volume *= double(std::max<int64_t>(hi[axis] - lo[axis] + 1, 0));
+        }
+
+        if (volume * PROBE_COST > double(tree_count))
+        {
+            m_mask.resize((tree_count + 63) / 64);
+            batch_overlaps(box, m_tree_bounds.lanes(), tree_count, m_mask.data());
+            return changed_mask_to_indices(m_mask.data(), tree_count, m_candidates.data());
+        }
+
+        size_t found = 0;
+        for (int64_t z = lo[2]; z <= hi[2]; z++)
+        {
+            for (int64_t y = lo[1]; y <= hi[1]; y++)
+            {
+                for (int64_t x = lo[0]; x <= hi[0]; x++)
+                {
+                    auto cell = m_cells.find(int3(int32_t(x), int32_t(y), int32_t(z)));
+                    if (cell != m_cells.end())
+                    {
+                        m_candidates[found++] = cell->second;
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+    uint32_t acquire_tree(const int3& cell)
+    {
+        auto found = m_cells.find(cell);
+        if (found != m_cells.end())
+        {
+            return found->second;
+        }
+
+        uint32_t tree;
+        if (!m_free_trees.empty())
+        {
+            tree = m_free_trees.back();
+            m_free_trees.pop_back();
+        }
+        else
+        {
+            tree = uint32_t(m_trees.size());
+            m_trees.emplace_back();
+            m_tree_bounds.push_back(LargeAABB());
+        }
+        m_trees[tree].cell = cell;
+        m_cells.emplace(cell, tree);
+        update_tree_bounds(tree);
+        return tree;
+    }
+
+    void release_tree(uint32_t tree_index)
+    {
+        CellTree& tree = m_trees[tree_index];
+        m_cells.erase(tree.cell);
+        tree.root = INVALID;
+        tree.nodes.clear();
+        tree.free_nodes.clear();
+        m_free_trees.push_back(tree_index);
+        update_tree_bounds(tree_index);
+    }
+
+    // Copies a subtree's root bounds to the top level; empty subtrees get inverted bounds that overlap nothing
+    void update_tree_bounds(uint32_t tree_index)
+    {
+        const CellTree& tree = m_trees[tree_index];
+        LargeAABB bounds;
+        bounds.min.global = tree.cell;
+        bounds.max.global = tree.cell;
+        if (tree.root == INVALID)
+        {
+            bounds.min.local = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+            bounds.max.local = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        }
+        else
+        {
+            const Node& root = tree.nodes[tree.root];
+            bounds.min.local = root.min;
+            bounds.max.local = root.max;
+            float extent = std::max(std::max(std::max(-root.min.x, root.max.x), std::max(-root.min.y, root.max.y)),
+                                    std::max(-root.min.z, root.max.z));
+            m_reach = std::max(m_reach, int64_t(std::min(double(extent) / LargePosition::CELL_SIZE + 1.0, double(INT32_MAX))));
+        }
+        m_tree_bounds.set(tree_index, bounds);
+    }
+
+    void mark_dirty(uint32_t tree_index)
+    {
+        if (!m_trees[tree_index].dirty)
+        {
+            m_trees[tree_index].dirty = true;
+            m_dirty_trees.push_back(tree_index);
+        }
+    }
+
+    uint32_t allocate_node(CellTree& tree)
+    {
+        if (!tree.free_nodes.empty())
+        {
+            uint32_t node = tree.free_nodes.back();
+            tree.free_nodes.pop_back();
+            return node;
+        }
+        tree.nodes.emplace_back();
+        return uint32_t(tree.nodes.size() - 1);
+    }
+
+    uint32_t create_leaf(uint32_t tree_index, uint32_t id, const float3& local, const float3& half_extent)
+    {
+        CellTree& tree = m_trees[tree_index];
+        uint32_t leaf = allocate_node(tree);
+        Node& node = tree.nodes[leaf];
+        node.min = local - half_extent;
+        node.max = local + half_extent;
+        node.parent = INVALID;
+        node.child[0] = node.child[1] = INVALID;
+        node.object = id;
+
+        if (id >= m_objects.size())
+        {
+            m_objects.resize(size_t(id) + 1);
+        }
+        m_objects[id] = Object{tree_index, leaf, half_extent};
+        return leaf;
+    }
+
+    // Top-down build: split at the median centroid along the longest axis of the centroid bounds
+    uint32_t build_range(CellTree& tree, uint32_t* leaves, size_t count, uint32_t parent)
+    {
+        if (count == 1)
+        {
+            tree.nodes[leaves[0]].parent = parent;
+            return leaves[0];
+        }
+
+        float3 lo(FLT_MAX, FLT_MAX, FLT_MAX), hi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (size_t i = 0; i < count; i++)
+        {
+            const Node& leaf = tree.nodes[leaves[i]];
+            float3 centroid = leaf.min + leaf.max;
+            lo = min3(lo, centroid);
+            hi = max3(hi, centroid);
+        }
+        float3 extent = hi - lo;
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        auto centroid_on_axis = [&tree, axis](uint32_t index)
+        {
+            const Node& n = tree.nodes[index];
+            return axis == 0 ? n.min.x + n.max.x : (axis == 1 ? n.min.y + n.max.y : n.min.z + n.max.z);
+        };
+        size_t mid = count / 2;
+        std::nth_element(leaves, leaves + mid, leaves + count,
+                         [&centroid_on_axis](uint32_t a, uint32_t b) { return centroid_on_axis(a) < centroid_on_axis(b); });
+
+        uint32_t node = allocate_node(tree);
+        uint32_t left = build_range(tree, leaves, mid, node);
+        uint32_t right = build_range(tree, leaves + mid, count - mid, node);
+        Node& n = tree.nodes[node];
+        n.parent = parent;
+        n.child[0] = left;
+        n.child[1] = right;
+        n.object = INVALID;
+        n.min = min3(tree.nodes[left].min, tree.nodes[right].min);
+        n.max = max3(tree.nodes[left].max, tree.nodes[right].max);
+        return node;
+    }
+
+    // Recomputes internal bounds from the current leaf bounds. Children follow their parent in pre-order,
+    // so walking the pre-order backwards visits every child before its parent.
+    void refit_subtree(CellTree& tree, uint32_t root)
+    {
+        m_order.clear();
+        m_stack.clear();
+        m_stack.push_back(root);
+        while (!m_stack.empty())
+        {
+            uint32_t index = m_stack.back();
+            m_stack.pop_back();
+            m_order.push_back(index);
+            if (tree.nodes[index].child[0] != INVALID)
+            {
+                m_stack.push_back(tree.nodes[index].child[0]);
+                m_stack.push_back(tree.nodes[index].child[1]);
+            }
+        }
+        for (size_t i = m_order.size(); i-- > 0;)
+        {
+            Node& n = tree.nodes[m_order[i]];
+            if (n.child[0] != INVALID)
+            {
+                n.min = min3(tree.nodes[n.child[0]].min, tree.nodes[n.child[1]].min);
+                n.max = max3(tree.nodes[n.child[0]].max, tree.nodes[n.child[1]].max);
+            }
+        }
+    }
+
+    void refit_ancestors(CellTree& tree, uint32_t index)
+    {
+        for (; index != INVALID; index = tree.nodes[index].parent)
+        {
+            Node& n = tree.nodes[index];
+            n.min = min3(tree.nodes[n.child[0]].min, tree.nodes[n.child[1]].min);
+            n.max = max3(tree.nodes[n.child[0]].max, tree.nodes[n.child[1]].max);
+        }
+    }
+
+    // Surface area heuristic descent: stop where pairing with the current node is cheaper than descending
+    void insert_leaf(uint32_t tree_index, uint32_t leaf)
+    {
+        CellTree& tree = m_trees[tree_index];
+        if (tree.root == INVALID)
+        {
+            tree.root = leaf;
+            tree.nodes[leaf].parent = INVALID;
+            update_tree_bounds(tree_index);
+            return;
+        }
+
+        const float3 leaf_min = tree.nodes[leaf].min;
+        const float3 leaf_max = tree.nodes[leaf].max;
+        uint32_t index = tree.root;
+        while (tree.nodes[index].child[0] != INVALID)
+        {
+            const Node& node = tree.nodes[index];
+            float area = surface_area(node.min, node.max);
+            float combined = surface_area(min3(node.min, leaf_min), max3(node.max, leaf_max));
+            float cost = 2.0f * combined;
+            float inheritance = 2.0f * (combined - area);
+
+            float child_cost[2];
+            for (int c = 0; c < 2; c++)
+            {
+                const Node& child = tree.nodes[node.child[c]];
+                float enlarged = surface_area(min3(child.min, leaf_min), max3(child.max, leaf_max));
+                child_cost[c] = inheritance + (child.child[0] == INVALID ? enlarged : enlarged - surface_area(child.min, child.max));
+            }
+            if (cost < child_cost[0] && cost < child_cost[1])
+            {
+                break;
+            }
+            index = child_cost[0] <= child_cost[1] ? node.child[0] : node.child[1];
+        }
+
+        const uint32_t sibling = index;
+        const uint32_t old_parent = tree.nodes[sibling].parent;
+        const uint32_t parent = allocate_node(tree);
+        Node& p = tree.nodes[parent];
+        p.parent = old_parent;
+        p.child[0] = sibling;
+        p.child[1] = leaf;
+        p.object = INVALID;
+        tree.nodes[sibling].parent = parent;
+        tree.nodes[leaf].parent = parent;
+        if (old_parent == INVALID)
+        {
+            tree.root = parent;
+        }
+        else
+        {
+            Node& op = tree.nodes[old_parent];
+            op.child[op.child[0] == sibling ? 0 : 1] = parent;
+        }
+        refit_ancestors(tree, parent);
+        update_tree_bounds(tree_index);
+    }
+
+    void erase(uint32_t id)
+    {
+        const Object object = m_objects[id];
+        CellTree& tree = m_trees[object.tree];
+        m_objects[id] = Object();
+        m_object_count--;
+
+        if (--tree.object_count == 0)
+        {
+            release_tree(object.tree);
+            return;
+        }
+
+        // The sibling takes the parent's place
+        const uint32_t parent = tree.nodes[object.leaf].parent;
+        const uint32_t sibling = tree.nodes[parent].child[tree.nodes[parent].child[0] == object.leaf ? 1 : 0];
+        const uint32_t grandparent = tree.nodes[parent].parent;
+        tree.nodes[sibling].parent = grandparent;
+        if (grandparent == INVALID)
+        {
+            tree.root = sibling;
+        }
+        else
+        {
+            Node& g = tree.nodes[grandparent];
+            g.child[g.child[0] == parent ? 0 : 1] = sibling;
+            refit_ancestors(tree, grandparent);
+        }
+        tree.free_nodes.push_back(object.leaf);
+        tree.free_nodes.push_back(parent);
+        update_tree_bounds(object.tree);
+    }
+
+    std::vector<CellTree> m_trees;
+    std::vector<uint32_t> m_free_trees;
+    std::unordered_map<int3, uint32_t> m_cells;
+    LargeAABBBuffer m_tree_bounds; // root bounds of m_trees[i], in the frame of its cell
+    std::vector<Object> m_objects;
+    std::vector<uint32_t> m_dirty_trees;
+    size_t m_object_count = 0;
+    int64_t m_reach = 0; // no subtree extends further than this many cells from its own cell (only grows)
+
+    // Query scratch
+    std::vector<uint64_t> m_mask;
+    std::vector<uint32_t> m_candidates;
+    std::vector<uint32_t> m_stack;
+    std::vector<uint32_t> m_order;
+    std::vector<RayCandidate> m_ray_candidates;
+};
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargeSpatialSort.h"
+#include "LargeThreadPool.h"
+#include <algorithm>
+#include <vector>
+
+/*
+
+LargeCellScheduler groups entities by cell (LargePosition::global) and splits a simulation step into independent
+jobs, one per island of nearby cells.
+
+Two occupied cells belong to the same island when they are at most `reach` cells apart on every axis (chained:
+an island is a connected component). With the default reach of 3, the distance below which operator== may still
+consider two cell anchors equal, entities of different islands are at least (reach + 1) * CELL_SIZE minus twice the
+hysteresis threshold apart, i.e. 2.5 cells (5120 units): any interaction shorter than that stays inside one island,
+and islands can be simulated in parallel without locks.
+
+build() buckets the entities with a radix sort on a LargeThreadPool and computes the islands. The layout depends only
+on the positions, never on timing:
+
+  - cells are sorted by (x, y, z); islands are numbered in the order of their first cell
+  - the cells of an island are contiguous and sorted, entities of a cell keep their input order
+
+run() calls the job of every island on a LargeThreadPool, largest islands first so that a big island does not
+start last. Jobs record the entities that left their cell during the step; the migrations are returned sorted by
+entity id, identical for any thread count.
+
+Entity ids are the indices of the positions passed to build() (dense entity indices, like in LargeSpatialHash).
+
+*/
+class LargeCellScheduler
+{
+  public:
+    inline static constexpr int32_t DEFAULT_REACH = 3;
+
+    struct Cell
+    {
+        int3 cell;
+        uint32_t first_entity; // index into entities()
+        uint32_t entity_count;
+    };
+
+    struct Island
+    {
+        uint32_t first_cell; // index into cells()
+        uint32_t cell_count;
+        uint32_t first_entity; // index into entities()
+        uint32_t entity_count;
+    };
+
+    struct Migration
+    {
+        uint32_t id;
+        int3 from;
+        int3 to;
+    };
+
+    explicit LargeCellScheduler(int32_t reach = DEFAULT_REACH)
+        : m_reach(reach)
+    {
+        assert(reach >= 0 && "Reach must not be negative");
+    }
+
+    int32_t reach() const { return m_reach; }
+
+    const std::vector<Cell>& cells() const { return m_cells; }
+    const std::vector<Island>& islands() const { return m_islands; }
+    const std::vector<uint32_t>& entities() const { return m_entities; }
+
+    void build(const LargePosition* positions, size_t count, LargeThreadPool& pool = LargeThreadPool::shared())
+    {
+        build_layout(count, [positions](size_t i) { return positions[i].global; }, pool);
+    }
+
+    void build(const PositionLanes& positions, size_t count, LargeThreadPool& pool = LargeThreadPool::shared())
+    {
+        build_layout(
+            count, [&positions](size_t i) { return int3(positions.global_x[i], positions.global_y[i], positions.global_z[i]); }, pool);
+    }
+
+    // Calls job(island, migrations) once for every island of the last build(), in parallel. The job appends a
+    // Migration for each of its entities that changed cell (the list is shared with other islands: append only).
+    // Returns all migrations of the step, sorted by entity id (in recording order for the same entity).
+    template <typename Job>
+    const std::vector<Migration>& run(const Job& job, LargeThreadPool& pool = LargeThreadPool::shared())
+    {
+        // One list per pool thread: an entity is only moved by the job of its island, so sorting the concatenated
+        // lists by id (stable) gives the same result whichever thread ran which island
+        m_thread_migrations.resize(pool.thread_count());
+        for (std::vector<Migration>& migrations : m_thread_migrations)
+        {
+            migrations.clear();
+        }
+
+        pool.parallel_for(m_dispatch.size(), 1,
+                          [&](size_t begin, size_t end)
+                          {
+                              std::vector<Migration>& migrations = m_thread_migrations[pool.thread_index()];
+                              for (size_t i = begin; i < end; i++)
+                              {
+                                  job(m_islands[m_dispatch[i]], migrations);
+                              }
+                          });
+
+        m_migrations.clear();
+        for (const std::vector<Migration>& migrations : m_thread_migrations)
+        {
+            m_migrations.insert(m_migrations.end(), migrations.begin(), migrations.end());
+        }
+        std::stable_sort(m_migrations.begin(), m_migrations.end(), [](const Migration& a, const Migration& b) { return a.id < b.id; });
+        return m_migrations;
+    }
+
+  private:
+    template <typename CellAt>
+    void build_layout(size_t count, const CellAt& cell_at, LargeThreadPool& pool)
+    {
+        assert(count <= UINT32_MAX && "Too many entities");
+
+        // Bucket with a stable radix sort on the cell (ids start in input order, which breaks ties). Offsets from the
+        // lowest occupied cell keep the sort order and leave the high bytes zero for clustered cells, so the radix
+        // sort skips those passes.
+        int64_t low[3] = {INT32_MAX, INT32_MAX, INT32_MAX};
+        for (size_t i = 0; i < count; i++)
+        {
+            const int3 cell = cell_at(i);
+            low[0] = std::min<int64_t>(low[0], cell.x);
+            low[1] = std::min<int64_t>(low[1], cell.y);
+            low[2] = std::min<int64_t>(low[2], cell.z);
+        }
+        m_sort_keys.resize(count);
+        m_sort_ids.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const int3 cell = cell_at(i);
+            const uint64_t x = uint64_t(cell.x - low[0]), y = uint64_t(cell.y - low[1]), z = uint64_t(cell.z - low[2]);
+            m_sort_keys[i] = SpatialKey96{(x << 32) | y, uint32_t(z)};
+            m_sort_ids[i] = uint32_t(i);
+        }
+        radix_sort(m_sort_keys.data(), m_sort_ids.data(), count, pool);
+
+        // Distinct cells in sorted order (ranks); m_rank_first[rank] is the first sorted entity of the cell
+        m_sorted_cells.clear();
+        m_rank_first.clear();
+        for (uint32_t i = 0; i < uint32_t(count); i++)
+        {
+            if (i == 0 || m_sort_keys[i] != m_sort_keys[i - 1])
+            {
+                const SpatialKey96& key = m_sort_keys[i];
+                m_sorted_cells.push_back(int3(int32_t(low[0] + int64_t(key.hi >> 32)), int32_t(low[1] + int64_t(key.hi & 0xffffffffu)),
+                                              int32_t(low[2] + int64_t(key.lo))));
+                m_rank_first.push_back(i);
+            }
+        }
+        const uint32_t cell_count = uint32_t(m_sorted_cells.size());
+        m_rank_first.push_back(uint32_t(count));
+
+        link_neighbors();
+
+        // Islands numbered by their first sorted cell; cells grouped by island, sorted within it
+        m_island_of.assign(cell_count, INVALID);
+        m_islands.clear();
+        for (uint32_t i = 0; i < cell_count; i++)
+        {
+            uint32_t root = find_root(i);
+            if (m_island_of[root] == INVALID)
+            {
+                m_island_of[root] = uint32_t(m_islands.size());
+                m_islands.push_back(Island{0, 0, 0, 0});
+            }
+            Island& island = m_islands[m_island_of[root]];
+            island.cell_count++;
+            island.entity_count += m_rank_first[i + 1] - m_rank_first[i];
+        }
+        uint32_t first_cell = 0, first_entity = 0;
+        for (Island& island : m_islands)
+        {
+            island.first_cell = first_cell;
+            island.first_entity = first_entity;
+            first_cell += island.cell_count;
+            first_entity += island.entity_count;
+        }
+
+        m_cells.resize(cell_count);
+        m_cursor.resize(m_islands.size());
+        for (size_t i = 0; i < m_islands.size(); i++)
+        {
+            m_cursor[i] = m_islands[i].first_cell;
+        }
+        for (uint32_t i = 0; i < cell_count; i++)
+        {
+            m_cells[m_cursor[m_island_of[find_root(i)]]++] = Cell{m_sorted_cells[i], i, m_rank_first[i + 1] - m_rank_first[i]};
+        }
+
+        // Cell.first_entity still holds the rank here
+        m_entities.resize(count);
+        first_entity = 0;
+        for (Cell& cell : m_cells)
+        {
+            const uint32_t* ids = m_sort_ids.data() + m_rank_first[cell.first_entity];
+            std::copy(ids, ids + cell.entity_count, m_entities.begin() + first_entity);
+            cell.first_entity = first_entity;
+            first_entity += cell.entity_count;
+        }
+
+        // Largest islands first; ties keep the island order
+        m_dispatch.resize(m_islands.size());
+        for (uint32_t i = 0; i < uint32_t(m_islands.size()); i++)
+        {
+            m_dispatch[i] = i;
+        }
+        std::stable_sort(m_dispatch.begin(), m_dispatch.end(),
+                         [this](uint32_t a, uint32_t b) { return m_islands[a].entity_count > m_islands[b].entity_count; });
+    }
+
+    // Union-find over sorted cell ranks. The root of a set is its smallest rank, so island numbering is stable.
+    void link_neighbors()
+    {
+        const uint32_t cell_count = uint32_t(m_sorted_cells.size());
+        m_parent.resize(cell_count);
+        for (uint32_t i = 0; i < cell_count; i++)
+        {
+            m_parent[i] = i;
+        }
+
+        // Every adjacent pair is found once from its lower cell. The candidates in column x + dx are the cells from
+        // (x + dx, y - reach, z - reach) to (x + dx, y + reach, z + reach): a contiguous span of the sorted cells
+        // whose start only moves forward as cells are visited in order, so one cursor per column finds it. Inside the
+        // span, cells outside the z window are skipped with binary searches, so dense rows cost O(log n) per row.
+        const int32_t r = m_reach;
+        m_column_cursors.assign(size_t(r) + 1, 0);
+        for (uint32_t i = 0; i < cell_count; i++)
+        {
+            const int3 cell = m_sorted_cells[i];
+            uint32_t root = find_root(i);
+            const int64_t z_min = int64_t(cell.z) - r, z_max = int64_t(cell.z) + r;
+            for (int32_t dx = 0; dx <= r; dx++)
+            {
+                const int64_t x = int64_t(cell.x) + dx;
+                uint32_t k = i + 1;
+                if (dx > 0)
+                {
+                    uint32_t& cursor = m_column_cursors[dx];
+                    while (cursor < cell_count && row_before(m_sorted_cells[cursor], x, int64_t(cell.y) - r, z_min))
+                    {
+                        cursor++;
+                    }
+                    k = cursor;
+                }
+                while (k < cell_count && m_sorted_cells[k].x == x && m_sorted_cells[k].y <= int64_t(cell.y) + r)
+                {
+                    const int3 other = m_sorted_cells[k];
+                    if (other.z < z_min)
+                    {
+                        k = seek(k, x, other.y, z_min);
+                    }
+                    else if (other.z <= z_max)
+                    {
+                        root = unite(root, k++);
+                    }
+                    else
+                    {
+                        k = seek(k, x, int64_t(other.y) + 1, INT64_MIN);
+                    }
+                }
+            }
+        }
+    }
+
+    // First sorted cell at or after `first` that is not before (x, y, z)
+    uint32_t seek(uint32_t first, int64_t x, int64_t y, int64_t z) const
+    {
+        auto found = std::lower_bound(m_sorted_cells.begin() + first, m_sorted_cells.end(), 0,
+                                      [x, y, z](const int3& cell, int) { return row_before(cell, x, y, z); });
+        return uint32_t(found - m_sorted_cells.begin());
+    }
+
+    // (cell.x, cell.y, cell.z) < (x, y, z) in the sort order of the cells
+    static bool row_before(const int3& cell, int64_t x, int64_t y, int64_t z)
+    {
+        if (cell.x != x)
+        {
+            return cell.x < x;
+        }
+        if (cell.y != y)
+        {
+            return cell.y < y;
+        }
+        return cell.z < z;
+    }
+
+    uint32_t find_root(uint32_t i)
+    {
+        while (m_parent[i] != i)
+        {
+            m_parent[i] = m_parent[m_parent[i]]; // path halving
+            i = m_parent[i];
+        }
+        return i;
+    }
+
+    // Merges the set of `other` into the set with root `root`, returns the root of the merged set
+    uint32_t unite(uint32_t root, uint32_t other)
+    {
+        if (m_parent[other] == root)
+        {
+            return root; // common in dense regions: linked by an earlier neighbor
+        }
+        other = find_root(other);
+        m_parent[std::max(root, other)] = std::min(root, other);
+        return std::min(root, other);
+    }
+
+    inline static constexpr uint32_t INVALID = 0xffffffffu;
+
+    int32_t m_reach;
+    std::vector<Cell> m_cells;
+    std::vector<Island> m_islands;
+    std::vector<uint32_t> m_entities;
+    std::vector<uint32_t> m_dispatch; // island indices in run() order
+    std::vector<std::vector<Migration>> m_thread_migrations;
+    std::vector<Migration> m_migrations;
+
+    // build() scratch, kept to avoid reallocating every step
+    std::vector<SpatialKey96> m_sort_keys;
+    std::vector<uint32_t> m_sort_ids;
+    std::vector<int3> m_sorted_cells;
+    std::vector<uint32_t> m_rank_first;
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_island_of;
+    std::vector<uint32_t> m_cursor;
+    std::vector<uint32_t> m_column_cursors;
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include <cstddef>
+
+/*
+
+Batch builder for the chunk-local matrix rendering strategy (see README, "Chunk-Local Matrix Rendering Strategy").
+
+For every chunk (cell) the builder produces
+
+  chunk_to_clip = projection * view * translation(chunk center - camera position)
+
+so objects are rendered from their native local coordinates. The translation is computed as
+float(chunk - camera.global) * CELL_SIZE - camera.local: the cell difference is an exact integer, the scale by the
+power-of-two CELL_SIZE is exact, and the only rounding happens in the final subtraction. No double math is needed.
+
+`view` maps camera-relative offsets (camera at the origin) to view space, i.e. it holds the camera rotation only.
+
+Matrices are column-major with column vectors (clip = M * float4(local, 1)), which is the layout of GLSL and of
+HLSL's default packing. Each float4x4 is 64 bytes and 16-byte aligned, so an output array can be copied directly
+into a constant buffer.
+
+All columns except the translation column equal projection * view, so each chunk only costs one 4-wide
+multiply-add chain and the stores. The SSE4.2 path builds one matrix per iteration, the AVX2 path two. No path fuses
+the chain into FMAs, so every instruction set rounds the same way.
+
+*/
+
+struct alignas(16) float4x4
+{
+    // m[column * 4 + row]
+    float m[16];
+
+    static float4x4 identity()
+    {
+        float4x4 r = {};
+        r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+        return r;
+    }
+
+    static float4x4 translation(const float3& t)
+    {
+        float4x4 r = identity();
+        r.m[12] = t.x;
+        r.m[13] = t.y;
+        r.m[14] = t.z;
+        return r;
+    }
+
+    float4x4 operator*(const float4x4& other) const
+    {
+        float4x4 r;
+        for (int column = 0; column < 4; column++)
+        {
+            for (int row = 0; row < 4; row++)
+            {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; k++)
+                {
+                    sum += m[k * 4 + row] * other.m[column * 4 + k];
+                }
+                r.m[column * 4 + row] = sum;
+            }
+        }
+        return r;
+    }
+};
+
+static_assert(sizeof(float4x4) == 64, "float4x4 must be tightly packed for constant buffer uploads");
+
+namespace large_coordinates_detail
+{
+
+// Offset from the camera position to the center of a chunk
+inline float3 chunk_offset(const LargePosition& camera, const int3& chunk)
+{
+    constexpr float cell_size = LargePosition::CELL_SIZE;
+    int3 d = chunk - camera.global;
+    return float3(float(d.x) * cell_size - camera.local.x, float(d.y) * cell_size - camera.local.y,
+                  float(d.z) * cell_size - camera.local.z);
+}
+
+inline void chunk_matrices_scalar(const float4x4& view_proj, const LargePosition& camera, const int3* chunks, float4x4* out,
+                                  size_t first, size_t count)
+{
+    const float* vp = view_proj.m;
+    for (size_t i = first; i < count; i++)
+    {
+        float3 t = chunk_offset(camera, chunks[i]);
+        float* m = out[i].m;
+        for (int j = 0; j < 12; j++)
+        {
+            m[j] = vp[j];
+        }
+        for (int row = 0; row < 4; row++)
+        {
+            // Same operation order and rounding as the vector paths
+            float x = unfused(vp[row] * t.x);
+            float y = unfused(vp[4 + row] * t.y);
+            float z = unfused(vp[8 + row] * t.z);
+            m[12 + row] = ((x + y) + z) + vp[12 + row];
+        }
+    }
+}
+
+#if LARGE_COORDINATES_X86
+
+// Loads an int3 without reading past its 12 bytes (w = 0)
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128i load_int3_sse42(const int3& v)
+{
+    return _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&v)), v.z, 2);
+}
+
+// Vector form of chunk_offset(), w = 0
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128 chunk_offset_sse42(__m128i chunk, __m128i camera_global, __m128 camera_local, __m128 cell_size)
+{
+    return _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(chunk, camera_global)), cell_size), camera_local);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void chunk_matrices_sse42(const float4x4& view_proj, const LargePosition& camera, const int3* chunks, float4x4* out, size_t count)
+{
+    const __m128 c0 = _mm_load_ps(view_proj.m);
+    const __m128 c1 = _mm_load_ps(view_proj.m + 4);
+    const __m128 c2 = _mm_load_ps(view_proj.m + 8);
+    const __m128 c3 = _mm_load_ps(view_proj.m + 12);
+    const __m128i camera_global = load_int3_sse42(camera.global);
+    const __m128 camera_local = _mm_setr_ps(camera.local.x, camera.local.y, camera.local.z, 0.0f);
+    const __m128 cell_size = _mm_set1_ps(LargePosition::CELL_SIZE);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        __m128 t = chunk_offset_sse42(load_int3_sse42(chunks[i]), camera_global, camera_local, cell_size);
+        __m128 x = unfused(_mm_mul_ps(c0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0))));
+        __m128 y = unfused(_mm_mul_ps(c1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+        __m128 z = unfused(_mm_mul_ps(c2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+        __m128 translation = _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), c3);
+
+        float* m = out[i].m;
+        _mm_store_ps(m, c0);
+        _mm_store_ps(m + 4, c1);
+        _mm_store_ps(m + 8, c2);
+        _mm_store_ps(m + 12, translation);
+    }
+}
+
+// Two chunks per iteration (one per 128-bit half); every matrix is written with two 32-byte stores
+LARGE_COORDINATES_TARGET("avx2")
+inline void chunk_matrices_avx2(const float4x4& view_proj, const LargePosition& camera, const int3* chunks, float4x4* out, size_t count)
+{
+    const __m256 c01 = _mm256_loadu_ps(view_proj.m);
+    const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_proj.m));
+    const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_proj.m + 4));
+    const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_proj.m + 8));
+    const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(view_proj.m + 12));
+    const __m128i camera_global128 = load_int3_sse42(camera.global);
+    const __m256i camera_global = _mm256_set_m128i(camera_global128, camera_global128);
+    const __m128 camera_local128 = _mm_setr_ps(camera.local.x, camera.local.y, camera.local.z, 0.0f);
+    const __m256 camera_local = _mm256_set_m128(camera_local128, camera_local128);
+    const __m256 cell_size = _mm256_set1_ps(LargePosition::CELL_SIZE);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m256i pair = _mm256_set_m128i(load_int3_sse42(chunks[i + 1]), load_int3_sse42(chunks[i]));
+        __m256 t = _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(pair, camera_global)), cell_size), camera_local);
+        __m256 x = unfused(_mm256_mul_ps(c0, _mm256_permute_ps(t, _MM_SHUFFLE(0, 0, 0, 0))));
+        __m256 y = unfused(_mm256_mul_ps(c1, _mm256_permute_ps(t, _MM_SHUFFLE(1, 1, 1, 1))));
+        __m256 z = unfused(_mm256_mul_ps(c2, _mm256_permute_ps(t, _MM_SHUFFLE(2, 2, 2, 2))));
+        __m256 translation = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), c3);
+
+        // Low half: column 2 and the first chunk's translation, high half: column 2 and the second chunk's translation
+        _mm256_storeu_ps(out[i].m, c01);
+        _mm256_storeu_ps(out[i].m + 8, _mm256_permute2f128_ps(c2, translation, 0x20));
+        _mm256_storeu_ps(out[i + 1].m, c01);
+        _mm256_storeu_ps(out[i + 1].m + 8, _mm256_permute2f128_ps(c2, translation, 0x30));
+    }
+    chunk_matrices_scalar(view_proj, camera, chunks, out, i, count);
+}
+
+#endif // LARGE_COORDINATES_X86
+
+} // namespace large_coordinates_detail
+
+// Single chunk version of build_chunk_matrices()
+inline float4x4 chunk_to_clip_matrix(const LargePosition& camera, const float4x4& view_proj, const int3& chunk)
+{
+    float4x4 result;
+    large_coordinates_detail::chunk_matrices_scalar(view_proj, camera, &chunk, &result, 0, 1);
+    return result;
+}
+
+// Writes out[i] = projection * view * translation(chunks[i] center - camera) for `count` chunks.
+// Results are bit-identical for every instruction set.
+inline void build_chunk_matrices(const LargePosition& camera, const float4x4& view, const float4x4& projection, const int3* chunks,
+                                 size_t count, float4x4* out)
+{
+    using namespace large_coordinates_detail;
+    const float4x4 view_proj = projection * view;
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+    case SimdLevel::AVX2:
+        chunk_matrices_avx2(view_proj, camera, chunks, out, count);
+        return;
+    case SimdLevel::SSE42:
+        chunk_matrices_sse42(view_proj, camera, chunks, out, count);
+        return;
+#endif
+    default:
+        chunk_matrices_scalar(view_proj, camera, chunks, out, 0, count);
+        return;
+    }
+}
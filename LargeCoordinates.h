@@ -3,7 +3,11 @@
 #include <cassert>
 #include <climits>
 #include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <stdint.h>
+#include <type_traits>
 
 struct int3
 {
@@ -28,6 +32,52 @@ struct int3
 
     bool operator==(const int3& other) const { return x == other.x && y == other.y && z == other.z; }
     bool operator!=(const int3& other) const { return !(*this == other); }
+
+    // Lexicographic (x, y, z) total order, for sorted containers
+    bool operator<(const int3& other) const
+    {
+        if (x != other.x)
+        {
+            return x < other.x;
+        }
+        return (y != other.y) ? y < other.y : z < other.z;
+    }
+};
+
+// 64-bit cell indices for worlds beyond the +/-29.3 AU range of int3
+struct longlong3
+{
+    int64_t x, y, z;
+
+    longlong3()
+        : x(0)
+        , y(0)
+        , z(0)
+    {
+    }
+    longlong3(int64_t x_, int64_t y_, int64_t z_)
+        : x(x_)
+        , y(y_)
+        , z(z_)
+    {
+    }
+
+    longlong3 operator+(const longlong3& other) const { return longlong3(x + other.x, y + other.y, z + other.z); }
+    longlong3 operator-(const longlong3& other) const { return longlong3(x - other.x, y - other.y, z - other.z); }
+    longlong3 operator*(int64_t scalar) const { return longlong3(x * scalar, y * scalar, z * scalar); }
+
+    bool operator==(const longlong3& other) const { return x == other.x && y == other.y && z == other.z; }
+    bool operator!=(const longlong3& other) const { return !(*this == other); }
+
+    // Lexicographic (x, y, z) total order, for sorted containers
+    bool operator<(const longlong3& other) const
+    {
+        if (x != other.x)
+        {
+            return x < other.x;
+        }
+        return (y != other.y) ? y < other.y : z < other.z;
+    }
 };
 
 struct float3
@@ -88,25 +138,116 @@ struct double3
     bool operator!=(const double3& other) const { return !(*this == other); }
 };
 
+// Maps a scalar type to the matching 3-component vector type
+template <typename T> struct LargeVector3;
+template <> struct LargeVector3<int32_t>
+{
+    using type = int3;
+};
+template <> struct LargeVector3<int64_t>
+{
+    using type = longlong3;
+};
+template <> struct LargeVector3<float>
+{
+    using type = float3;
+};
+template <> struct LargeVector3<double>
+{
+    using type = double3;
+};
+
+namespace large_coordinates_detail
+{
+
+// MurmurHash3 fmix64 finalizer: full avalanche, so every input bit affects the low bits used by power-of-two tables
+inline uint64_t fmix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// Bit pattern of a local offset with -0 folded into +0, so values that compare equal hash equal
+inline uint64_t float_bits(float value)
+{
+    value += 0.0f;
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline uint64_t float_bits(double value)
+{
+    value += 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Byte order of the host, for file and network formats that are defined as little-endian
+inline bool host_is_little_endian()
+{
+    const uint32_t one = 1;
+    uint8_t first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+} // namespace large_coordinates_detail
+
+// Hash of a cell index with full avalanche, so clustered and axis-aligned cells spread evenly over the table
+inline uint64_t hash_cell(const int3& cell)
+{
+    uint64_t h = uint64_t(uint32_t(cell.x)) * 0x9e3779b97f4a7c15ull;
+    h ^= uint64_t(uint32_t(cell.y)) * 0xc2b2ae3d27d4eb4full;
+    h ^= uint64_t(uint32_t(cell.z)) * 0x165667b19e3779f9ull;
+    return large_coordinates_detail::fmix64(h);
+}
+
+inline uint64_t hash_cell(const longlong3& cell)
+{
+    // Multiplying by an odd constant is a bijection on 64 bits, so the high halves of the indices are kept
+    uint64_t h = uint64_t(cell.x) * 0x9e3779b97f4a7c15ull;
+    h ^= uint64_t(cell.y) * 0xc2b2ae3d27d4eb4full;
+    h ^= uint64_t(cell.z) * 0x165667b19e3779f9ull;
+    return large_coordinates_detail::fmix64(h);
+}
+
 /*
 
-The LargePosition struct represents a high-precision position in a large,
+The LargePositionT struct represents a high-precision position in a large,
 cell-partitioned 3D world using a double-layer coordinate system.
 
 It combines:
-  global: an int3 representing the center coordinates of the spatial cell
-  local: a float3 representing the local offset within the current cell.
+  global: an integer vector representing the center coordinates of the spatial cell
+  local: a floating point vector representing the local offset within the current cell.
 
-Each cell is a cubic region of size CELL_SIZE (2048 units by default) centered on global * CELL_SIZE.
+Each cell is a cubic region of size CELL_SIZE centered on global * CELL_SIZE.
 The cell at global(0,0,0) covers world coordinates [-CELL_SIZE/2, CELL_SIZE/2) in each dimension.
 The absolute world position is: `world_position = global * CELL_SIZE + local`
 
-PRECISION CHARACTERISTICS:
+Template parameters:
+  CellSize:   cell edge length, must be a power of two so that scaling by it is an exact exponent shift
+  GlobalInt:  int32_t (int3 cells) or int64_t (longlong3 cells, for ranges beyond +/-29.3 AU)
+  LocalFloat: float (float3 offsets) or double (double3 offsets)
+
+All range and precision constants below are derived from these parameters at compile time.
+LargePosition (2048 unit cells, int32_t cells, float offsets) is the default configuration.
+
+PRECISION CHARACTERISTICS (LargePosition):
 - Maintains consistent precision across the entire supported range (+/-29.3 AU)
 - Typical precision: 0.000244 meters (FP32 ULP at CELL_SIZE)
 - Minimum precision: 0.000488 meters (worst case at maximum local offset)
 - Range limits: MIN_COORDINATE to MAX_COORDINATE (~+/-4.398e12 meters)
 
+Smaller cells trade range for precision (512 unit cells: 0.000061 meters typical precision, +/-7.3 AU range).
+With int64_t cells the range is no longer limited by the cell index, but by the double precision world coordinates
+accepted by from_double3() and returned by to_double3().
+
 Note: The system uses loose cell partitioning with hysteresis
 Local coordinates can extend beyond the natural cell boundary (+/-CELL_SIZE/2) up to +/-CELL_SIZE
 to reduce jitter and avoid frequent cell switching when an object hovers near a boundary.
@@ -115,41 +256,54 @@ The dual coordinate system prevents precision loss that would occur with naive
 large-coordinate approaches, maintaining sub-meter accuracy even at astronomical scales.
 
 */
-struct LargePosition
+template <uint32_t CellSize, typename GlobalInt, typename LocalFloat> struct LargePositionT
 {
-    // Usable range = -4,398,046,509,056 to 4,398,046,509,056 meters, which is -29.3au to 29.3au
+    static_assert(CellSize != 0 && (CellSize & (CellSize - 1)) == 0, "CellSize must be a power of two");
+    static_assert(std::is_same<GlobalInt, int32_t>::value || std::is_same<GlobalInt, int64_t>::value,
+                  "GlobalInt must be int32_t or int64_t");
+    static_assert(std::is_same<LocalFloat, float>::value || std::is_same<LocalFloat, double>::value, "LocalFloat must be float or double");
+
+    using global_type = typename LargeVector3<GlobalInt>::type;
+    using local_type = typename LargeVector3<LocalFloat>::type;
 
     // FP32 ULP at 2048.0 = 0.000244
-    inline static constexpr float CELL_SIZE = 2048.0f;
+    inline static constexpr LocalFloat CELL_SIZE = LocalFloat(CellSize);
 
     // System range limits (usable coordinate range)
-    inline static constexpr double MIN_COORDINATE = (double)(INT_MIN)*CELL_SIZE; // ~-4.398e12 meters (~-29.3 AU)
-    inline static constexpr double MAX_COORDINATE = (double)(INT_MAX)*CELL_SIZE; // ~+4.398e12 meters (~+29.3 AU)
+    // LargePosition: -4,398,046,509,056 to 4,398,046,509,056 meters, which is -29.3au to 29.3au
+    inline static constexpr double MIN_COORDINATE = (double)(std::numeric_limits<GlobalInt>::min()) * CELL_SIZE;
+    inline static constexpr double MAX_COORDINATE = (double)(std::numeric_limits<GlobalInt>::max()) * CELL_SIZE;
 
     // Precision characteristics (consistent across entire supported range)
-    inline static constexpr float MIN_PRECISION = 0.000488f;     // Worst-case precision at maximum local offset (FP32 ULP at 6144.0)
-    inline static constexpr float TYPICAL_PRECISION = 0.000244f; // Typical precision at CELL_SIZE (FP32 ULP at 2048.0)
+    // Typical precision is the ULP at CELL_SIZE, the worst case (ULP at 3 * CELL_SIZE) is twice that.
+    // Both are exact powers of two (LargePosition: 2^-12 and 2^-11).
+    inline static constexpr LocalFloat TYPICAL_PRECISION = CELL_SIZE * std::numeric_limits<LocalFloat>::epsilon();
+    inline static constexpr LocalFloat MIN_PRECISION = TYPICAL_PRECISION * LocalFloat(2);
+
+    // Hysteresis-based cell selection to reduce switching near boundaries
+    // Natural cell boundary is +/-CELL_SIZE/2, but allow extension to +/-CELL_SIZE*0.75
+    inline static constexpr LocalFloat THRESHOLD = CELL_SIZE * LocalFloat(0.75);
 
     // Useful astronomical constant for space simulation
     inline static constexpr double AU_DISTANCE = 149597870700.0; // 1 Astronomical Unit in meters
 
     // global coordinates (cell center)
-    int3 global;
+    global_type global;
 
     // local coordinates (offset from cell center)
-    float3 local;
+    local_type local;
 
     // Default constructor
-    LargePosition()
+    LargePositionT()
         : global(0, 0, 0)
-        , local(0.0f, 0.0f, 0.0f)
+        , local(0, 0, 0)
     {
     }
 
     // Constructor from global and local coordinates
-    LargePosition(const int3& global_, const float3& local_) { from_float3(global_, local_); }
+    LargePositionT(const global_type& global_, const local_type& local_) { from_float3(global_, local_); }
 
-    explicit LargePosition(const double3& val) { from_double3(val); }
+    explicit LargePositionT(const double3& val) { from_double3(val); }
 
     // Set position from world coordinates (double precision for large values)
     // Automatically assigns to the nearest cell center to minimize local offset
@@ -161,14 +315,14 @@ struct LargePosition
         assert(val.z >= MIN_COORDINATE && val.z <= MAX_COORDINATE && "Z coordinate exceeds supported range (~+/-29.3 AU)");
 
         // Find nearest cell center (rounds to nearest integer)
-        global.x = (int32_t)(std::round(val.x / CELL_SIZE));
-        global.y = (int32_t)(std::round(val.y / CELL_SIZE));
-        global.z = (int32_t)(std::round(val.z / CELL_SIZE));
+        global.x = nearest_cell(val.x);
+        global.y = nearest_cell(val.y);
+        global.z = nearest_cell(val.z);
 
         // Calculate local offset from the chosen cell center
-        local.x = (float)(val.x - global.x * double(CELL_SIZE));
-        local.y = (float)(val.y - global.y * double(CELL_SIZE));
-        local.z = (float)(val.z - global.z * double(CELL_SIZE));
+        local.x = (LocalFloat)(val.x - global.x * double(CELL_SIZE));
+        local.y = (LocalFloat)(val.y - global.y * double(CELL_SIZE));
+        local.z = (LocalFloat)(val.z - global.z * double(CELL_SIZE));
     }
 
     // Convert to world coordinates as double precision
@@ -180,28 +334,25 @@ struct LargePosition
 
     // Convert this position to local coordinates relative to the specified origin cell center
     // Returns the offset from origin's cell center to this position
-    float3 to_float3(const int3& origin) const
+    local_type to_float3(const global_type& origin) const
     {
-        int3 d = global - origin;
-        float3 local_pos = local + float3(d.x * CELL_SIZE, d.y * CELL_SIZE, d.z * CELL_SIZE);
+        global_type d = global - origin;
+        local_type local_pos = local + local_type(LocalFloat(d.x) * CELL_SIZE, LocalFloat(d.y) * CELL_SIZE, LocalFloat(d.z) * CELL_SIZE);
 
         // Assert that local position doesn't exceed reasonable bounds for relative positioning
         // This catches logic errors where positions are too far from reference frame
         // With center-based cells and hysteresis, reasonable bound is ~3 cell sizes
 
         // FP32 ULP at 6144.0 = 0.000488
-        assert(std::abs(local_pos.x) <= CELL_SIZE * 3.0f &&
-               "The distance to the provided origin is too large to be represented as a float3.");
-        assert(std::abs(local_pos.y) <= CELL_SIZE * 3.0f &&
-               "The distance to the provided origin is too large to be represented as a float3.");
-        assert(std::abs(local_pos.z) <= CELL_SIZE * 3.0f &&
-               "The distance to the provided origin is too large to be represented as a float3.");
+        assert(std::abs(local_pos.x) <= CELL_SIZE * 3 && "The distance to the provided origin is too large to be represented as a float3.");
+        assert(std::abs(local_pos.y) <= CELL_SIZE * 3 && "The distance to the provided origin is too large to be represented as a float3.");
+        assert(std::abs(local_pos.z) <= CELL_SIZE * 3 && "The distance to the provided origin is too large to be represented as a float3.");
         return local_pos;
     }
 
     // Set this position from local coordinates relative to the specified origin cell center
     // local_pos is the offset from origin's cell center to the desired world position
-    void from_float3(const int3& origin, const float3& local_)
+    void from_float3(const global_type& origin, const local_type& local_)
     {
         // FP32 ULP at 6144.0 = 0.000488
         // Large movement detection: For movements > CELL_SIZE*3, use double precision approach:
@@ -209,13 +360,9 @@ struct LargePosition
         // 2. Add movement: double3 new_world = world + movement
         // 3. Create new position: LargePosition new_pos(new_world)
         // This avoids precision loss that occurs when using from_float3() with large local offsets.
-        assert(std::abs(local_.x) <= CELL_SIZE * 3.0f && "Large movement detected! Use double precision approach.");
-        assert(std::abs(local_.y) <= CELL_SIZE * 3.0f && "Large movement detected! Use double precision approach.");
-        assert(std::abs(local_.z) <= CELL_SIZE * 3.0f && "Large movement detected! Use double precision approach.");
-
-        // Hysteresis-based cell selection to reduce switching near boundaries
-        // Natural cell boundary is +/-CELL_SIZE/2, but allow extension to +/-CELL_SIZE*0.75
-        constexpr float THRESHOLD = CELL_SIZE * 0.75f;
+        assert(std::abs(local_.x) <= CELL_SIZE * 3 && "Large movement detected! Use double precision approach.");
+        assert(std::abs(local_.y) <= CELL_SIZE * 3 && "Large movement detected! Use double precision approach.");
+        assert(std::abs(local_.z) <= CELL_SIZE * 3 && "Large movement detected! Use double precision approach.");
 
         if (std::abs(local_.x) <= THRESHOLD && std::abs(local_.y) <= THRESHOLD && std::abs(local_.z) <= THRESHOLD)
         {
@@ -234,32 +381,129 @@ struct LargePosition
 
     // Equality operators - compare actual world positions, not internal representation
     // With center-based cells and hysteresis, same world position can have different (global, local) pairs
-    bool operator==(const LargePosition& other) const
+    bool operator==(const LargePositionT& other) const
     {
         // Early exit: if cell centers are too far apart, they can't represent the same position
         // With hysteresis threshold of CELL_SIZE from center, positions can differ by ~3 cells max
-
-        // We need to use `int64_t` here because in the worst case we can end up computing `INT_MAX - INT_MIN`,
-        // which overflows the signed integer range.
-        int64_t global_dx = int64_t(global.x) - int64_t(other.global.x);
-        int64_t global_dy = int64_t(global.y) - int64_t(other.global.y);
-        int64_t global_dz = int64_t(global.z) - int64_t(other.global.z);
-
-        if (std::abs(global_dx) > 3 || std::abs(global_dy) > 3 || std::abs(global_dz) > 3)
+        if (cells_far_apart(global.x, other.global.x) || cells_far_apart(global.y, other.global.y) ||
+            cells_far_apart(global.z, other.global.z))
         {
             return false;
         }
 
         // Convert both positions to this object's reference frame and compare
         // Using this->global avoids triggering to_float3() bounds assertion
-        const float3& this_local = local;
-        float3 other_local = other.to_float3(global);
+        const local_type& this_local = local;
+        local_type other_local = other.to_float3(global);
 
         // Use small tolerance for floating point comparison
-        constexpr float tolerance = 1e-6f;
+        constexpr LocalFloat tolerance = LocalFloat(1e-6);
         return std::abs(this_local.x - other_local.x) < tolerance && std::abs(this_local.y - other_local.y) < tolerance &&
                std::abs(this_local.z - other_local.z) < tolerance;
     }
 
-    bool operator!=(const LargePosition& other) const { return !(*this == other); }
+    bool operator!=(const LargePositionT& other) const { return !(*this == other); }
+
+    // The same world position in its nearest cell, with local in [-CELL_SIZE/2, CELL_SIZE/2) on every axis.
+    // Unlike from_double3(to_double3()) this is exact: moving local by a multiple of CELL_SIZE loses no bits, so
+    // every (global, local) pair describing one world position has the same canonical form.
+    LargePositionT canonical() const
+    {
+        LargePositionT result;
+        canonical_axis(global.x, local.x, result.global.x, result.local.x);
+        canonical_axis(global.y, local.y, result.global.y, result.local.y);
+        canonical_axis(global.z, local.z, result.global.z, result.local.z);
+        return result;
+    }
+
+    // Total order of the canonical forms: by cell (x, y, z), then by local offset.
+    // Positions are equivalent under it exactly when they describe the same world position, and equivalent
+    // positions always compare equal with operator== (the converse doesn't hold: operator== has a tolerance).
+    bool operator<(const LargePositionT& other) const
+    {
+        const LargePositionT a = canonical();
+        const LargePositionT b = other.canonical();
+        if (a.global != b.global)
+        {
+            return a.global < b.global;
+        }
+        if (a.local.x != b.local.x)
+        {
+            return a.local.x < b.local.x;
+        }
+        return (a.local.y != b.local.y) ? a.local.y < b.local.y : a.local.z < b.local.z;
+    }
+
+    // Hash of the canonical form, consistent with operator<. Positions that are equal under operator== only thanks
+    // to its tolerance (a different world position within 1e-6, or rounding of the frame change) may hash
+    // differently; no hash can follow a tolerance, since it is not transitive.
+    size_t hash() const
+    {
+        using namespace large_coordinates_detail;
+        const LargePositionT c = canonical();
+        uint64_t h = float_bits(c.local.x) * 0x9e3779b97f4a7c15ull;
+        h ^= float_bits(c.local.y) * 0xc2b2ae3d27d4eb4full;
+        h ^= float_bits(c.local.z) * 0x165667b19e3779f9ull;
+        return size_t(fmix64(h ^ hash_cell(c.global)));
+    }
+
+  private:
+    // For int64_t cells double(max()) rounds up to 2^63, so MAX_COORDINATE / CELL_SIZE is not representable and
+    // converting it would be undefined; it is clamped to the last cell instead (the local offset absorbs the rest)
+    static GlobalInt nearest_cell(double coordinate)
+    {
+        double cell = std::round(coordinate / CELL_SIZE);
+        if (cell >= double(std::numeric_limits<GlobalInt>::max()))
+        {
+            return std::numeric_limits<GlobalInt>::max();
+        }
+        return GlobalInt(cell);
+    }
+
+    static void canonical_axis(GlobalInt cell, LocalFloat offset, GlobalInt& out_cell, LocalFloat& out_offset)
+    {
+        // Nearest cell center, ties go up. offset / CELL_SIZE and the comparison are exact.
+        double steps = std::floor(double(offset) / double(CELL_SIZE));
+        if (double(offset) >= (steps + 0.5) * double(CELL_SIZE))
+        {
+            steps += 1.0;
+        }
+        GlobalInt k = GlobalInt(steps);
+        assert((k <= 0 || cell <= std::numeric_limits<GlobalInt>::max() - k) && "Canonical cell exceeds supported range");
+        assert((k >= 0 || cell >= std::numeric_limits<GlobalInt>::min() - k) && "Canonical cell exceeds supported range");
+        out_cell = cell + k;
+        out_offset = offset - LocalFloat(k) * CELL_SIZE;
+    }
+
+    static bool cells_far_apart(GlobalInt a, GlobalInt b)
+    {
+        // The difference is computed in unsigned 64-bit arithmetic because in the worst case we can end up computing
+        // `MAX - MIN`, which overflows the signed integer range (even for int64_t cells)
+        uint64_t distance = (a > b) ? uint64_t(a) - uint64_t(b) : uint64_t(b) - uint64_t(a);
+        return distance > 3;
+    }
 };
+
+// Default configuration: 2048 unit cells, int32_t cell indices, float local offsets
+using LargePosition = LargePositionT<2048, int32_t, float>;
+
+// Hashing support, so cells and positions can be keys of std::unordered_map / std::unordered_set
+namespace std
+{
+
+template <> struct hash<int3>
+{
+    size_t operator()(const int3& cell) const { return size_t(hash_cell(cell)); }
+};
+
+template <> struct hash<longlong3>
+{
+    size_t operator()(const longlong3& cell) const { return size_t(hash_cell(cell)); }
+};
+
+template <uint32_t CellSize, typename GlobalInt, typename LocalFloat> struct hash<LargePositionT<CellSize, GlobalInt, LocalFloat>>
+{
+    size_t operator()(const LargePositionT<CellSize, GlobalInt, LocalFloat>& pos) const { return pos.hash(); }
+};
+
+} // namespace std
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+/*
+
+LargeFixedPosition is a deterministic variant of LargePosition for lockstep simulation, where every peer must
+compute bit-identical positions regardless of compiler, optimization level or instruction set.
+
+The cell layout is the same as LargePosition (2048 unit cells centered on global * CELL_SIZE, hysteresis up to
++/-0.75 CELL_SIZE), but `local` is a 32-bit fixed-point offset: one cell is CELL_UNITS = 2^24 units, so a unit is
+2^-13 meters (half of LargePosition::TYPICAL_PRECISION, uniform over the whole cell).
+
+Cell crossing (from_fixed), relative offsets (to_fixed), equality and the canonical form only use integer
+arithmetic, so simulation code that moves positions by fixed-point deltas is exactly reproducible.
+Floating point only appears at the boundaries:
+  to_float3() / to_position(): for rendering, correctly rounded int -> float conversions and power-of-two scales
+  to_units() / from_position() / from_double3(): for input, rounded half away from zero on the unit grid with
+  exact double arithmetic, so the same input value gives the same units everywhere
+
+Build configurations must keep the default IEEE round-to-nearest mode and must not enable -ffast-math style
+value-changing optimizations for the boundary conversions.
+
+*/
+struct LargeFixedPosition
+{
+    inline static constexpr int32_t FRACTION_BITS = 24;
+    inline static constexpr int32_t CELL_UNITS = int32_t(1) << FRACTION_BITS;
+    inline static constexpr int32_t HALF_CELL_UNITS = CELL_UNITS / 2;
+
+    // Same hysteresis and relative offset limits as LargePosition, in units
+    inline static constexpr int32_t THRESHOLD_UNITS = CELL_UNITS / 4 * 3;
+    inline static constexpr int32_t MAX_OFFSET_UNITS = CELL_UNITS * 3;
+
+    inline static constexpr float CELL_SIZE = LargePosition::CELL_SIZE;
+    inline static constexpr float UNIT_SIZE = CELL_SIZE / float(CELL_UNITS);
+    inline static constexpr double UNITS_PER_METER = double(CELL_UNITS) / double(CELL_SIZE);
+
+    // global coordinates (cell center)
+    int3 global;
+
+    // local coordinates (offset from cell center, in units)
+    int3 local;
+
+    LargeFixedPosition()
+        : global(0, 0, 0)
+        , local(0, 0, 0)
+    {
+    }
+
+    // Constructor from a cell and an offset in units relative to its center
+    LargeFixedPosition(const int3& global_, const int3& local_) { from_fixed(global_, local_); }
+
+    explicit LargeFixedPosition(const double3& val) { from_double3(val); }
+
+    // Meters to units on the fixed-point grid, rounding half away from zero.
+    // double(meters) * UNITS_PER_METER is exact (power of two scale), and so is std::round.
+    static int32_t to_units(float meters)
+    {
+        double units = std::round(double(meters) * UNITS_PER_METER);
+        assert(std::abs(units) <= double(MAX_OFFSET_UNITS) && "Offset is too large to be represented in units");
+        return int32_t(units);
+    }
+
+    static int3 to_units(const float3& meters) { return int3(to_units(meters.x), to_units(meters.y), to_units(meters.z)); }
+
+    // Set position from world coordinates, in the nearest cell like LargePosition::from_double3()
+    void from_double3(const double3& val)
+    {
+        from_double_axis(val.x, global.x, local.x);
+        from_double_axis(val.y, global.y, local.y);
+        from_double_axis(val.z, global.z, local.z);
+    }
+
+    // Convert to world coordinates as double precision (exact up to 2^53 units, about +/-1.1e12 meters)
+    double3 to_double3() const
+    {
+        return double3(double(world_units(global.x, local.x)) / UNITS_PER_METER, double(world_units(global.y, local.y)) / UNITS_PER_METER,
+                       double(world_units(global.z, local.z)) / UNITS_PER_METER);
+    }
+
+    // Set from a floating point position, snapping its local offset to the unit grid. The cell is kept.
+    void from_position(const LargePosition& pos) { from_fixed(pos.global, to_units(pos.local)); }
+
+    // The same position as a LargePosition. Exact: offsets within the hysteresis range fit a float mantissa.
+    LargePosition to_position() const
+    {
+        LargePosition pos;
+        pos.global = global;
+        pos.local = float3(float(local.x) * UNIT_SIZE, float(local.y) * UNIT_SIZE, float(local.z) * UNIT_SIZE);
+        return pos;
+    }
+
+    // Offset in units from the center of the `origin` cell to this position, exact.
+    // Like LargePosition::to_float3(), the origin must be within about 3 cells.
+    int3 to_fixed(const int3& origin) const
+    {
+        return int3(relative_axis(global.x, local.x, origin.x), relative_axis(global.y, local.y, origin.y),
+                    relative_axis(global.z, local.z, origin.z));
+    }
+
+    // Set this position from an offset in units relative to the center of the `origin` cell.
+    // Integer version of LargePosition::from_float3(): offsets within THRESHOLD_UNITS keep the origin cell,
+    // otherwise every axis moves to its nearest cell (ties go up).
+    void from_fixed(const int3& origin, const int3& offset)
+    {
+        assert(std::abs(int64_t(offset.x)) <= MAX_OFFSET_UNITS && "Large movement detected! Use double precision approach.");
+        assert(std::abs(int64_t(offset.y)) <= MAX_OFFSET_UNITS && "Large movement detected! Use double precision approach.");
+        assert(std::abs(int64_t(offset.z)) <= MAX_OFFSET_UNITS && "Large movement detected! Use double precision approach.");
+
+        if (std::abs(offset.x) <= THRESHOLD_UNITS && std::abs(offset.y) <= THRESHOLD_UNITS && std::abs(offset.z) <= THRESHOLD_UNITS)
+        {
+            global = origin;
+            local = offset;
+            return;
+        }
+
+        nearest_cell_axis(origin.x, offset.x, global.x, local.x);
+        nearest_cell_axis(origin.y, offset.y, global.y, local.y);
+        nearest_cell_axis(origin.z, offset.z, global.z, local.z);
+    }
+
+    // Moves this position by `delta` units, the typical integration step of a lockstep simulation
+    void move(const int3& delta) { from_fixed(global, local + delta); }
+
+    // Offset from the center of the `origin` cell for rendering (see to_fixed)
+    float3 to_float3(const int3& origin) const
+    {
+        int3 offset = to_fixed(origin);
+        return float3(float(offset.x) * UNIT_SIZE, float(offset.y) * UNIT_SIZE, float(offset.z) * UNIT_SIZE);
+    }
+
+    // The same world position in its nearest cell, with local in [-HALF_CELL_UNITS, HALF_CELL_UNITS) on every axis
+    LargeFixedPosition canonical() const
+    {
+        LargeFixedPosition result;
+        nearest_cell_axis(global.x, local.x, result.global.x, result.local.x);
+        nearest_cell_axis(global.y, local.y, result.global.y, result.local.y);
+        nearest_cell_axis(global.z, local.z, result.global.z, result.local.z);
+        return result;
+    }
+
+    // Exact comparison of world positions: unlike LargePosition there is no tolerance, so this is an equivalence
+    bool operator==(const LargeFixedPosition& other) const
+    {
+        return world_units(global.x, local.x) == world_units(other.global.x, other.local.x) &&
+               world_units(global.y, local.y) == world_units(other.global.y, other.local.y) &&
+               world_units(global.z, local.z) == world_units(other.global.z, other.local.z);
+    }
+
+    bool operator!=(const LargeFixedPosition& other) const { return !(*this == other); }
+
+    // Hash of the canonical form, consistent with operator== and identical on every platform
+    uint64_t hash() const
+    {
+        const LargeFixedPosition c = canonical();
+        uint64_t h = uint64_t(uint32_t(c.local.x)) * 0x9e3779b97f4a7c15ull;
+        h ^= uint64_t(uint32_t(c.local.y)) * 0xc2b2ae3d27d4eb4full;
+        h ^= uint64_t(uint32_t(c.local.z)) * 0x165667b19e3779f9ull;
+        return large_coordinates_detail::fmix64(h ^ hash_cell(c.global));
+    }
+
+  private:
+    static int64_t world_units(int32_t cell, int32_t offset) { return int64_t(cell) * CELL_UNITS + offset; }
+
+    static int32_t relative_axis(int32_t cell, int32_t offset, int32_t origin)
+    {
+        int64_t relative = (int64_t(cell) - origin) * CELL_UNITS + offset;
+        assert(relative >= -MAX_OFFSET_UNITS && relative <= MAX_OFFSET_UNITS &&
+               "The distance to the provided origin is too large to be represented as a fixed offset.");
+        return int32_t(relative);
+    }
+
+    static void nearest_cell_axis(int32_t cell, int32_t offset, int32_t& out_cell, int32_t& out_offset)
+    {
+        // Arithmetic shift is a floor division by CELL_UNITS, so ties (offset == +/-HALF_CELL_UNITS) go up
+        int32_t k = int32_t((int64_t(offset) + HALF_CELL_UNITS) >> FRACTION_BITS);
+        assert(int64_t(cell) + k >= std::numeric_limits<int32_t>::min() && int64_t(cell) + k <= std::numeric_limits<int32_t>::max() &&
+               "Cell exceeds supported range");
+        out_cell = cell + k;
+        out_offset = offset - k * CELL_UNITS;
+    }
+
+    static void from_double_axis(double value, int32_t& cell, int32_t& offset)
+    {
+        assert(value >= LargePosition::MIN_COORDINATE && value <= LargePosition::MAX_COORDINATE &&
+               "Coordinate exceeds supported range (~+/-29.3 AU)");
+
+        // Units are rounded first, so the cell and offset are derived from one integer and always agree
+        int64_t units = int64_t(std::round(value * UNITS_PER_METER));
+        int64_t k = (units + HALF_CELL_UNITS) >> FRACTION_BITS;
+        cell = int32_t(k);
+        offset = int32_t(units - k * CELL_UNITS);
+    }
+};
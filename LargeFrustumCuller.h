@@ -0,0 +1,485 @@
+#pragma once
+
+#include "LargeAABB.h"
+#include "LargeChunkMatrices.h"
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargeSpatialSort.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/*
+
+Cell-level frustum culling for the chunk-local matrix rendering strategy.
+
+Everything is evaluated in camera-relative float space: the center of a cell is
+float(cell - camera.global) * CELL_SIZE - camera.local, the same integer delta that to_float3() uses, so there is
+no double math per cell and no precision problem at planetary view distances. The delta saturates to the int32_t
+range like LargeAABB's, so candidates more than 2^31 cells away stay on the correct side of the camera.
+
+Each cell is tested as a box around its center. The default half extent is THRESHOLD (0.75 * CELL_SIZE) because
+hysteresis lets positions anchored to a cell reach that far; add the radius of the largest object with
+set_cell_extent() if objects should never pop at the frustum border.
+
+Planes are given in camera-relative space (camera at the origin) as dot(normal, p) + distance >= 0 for points
+inside. They do not need to be normalized. extract_frustum_planes() builds them from a view-projection matrix.
+
+Visible cells are returned sorted front-to-back (by distance from the camera to the cell center), ready for
+build_chunk_matrices(). The plane tests run on 4/8/16 cells at a time (SSE4.2/AVX2/AVX-512). Plane distances and
+sort keys are never fused into FMAs, so every instruction set (and the scalar tail of each) gives the same answers.
+
+*/
+
+struct FrustumPlane
+{
+    float3 normal;
+    float distance;
+};
+
+// Extracts the six clip planes (left, right, bottom, top, near, far) of a column-major view-projection matrix.
+// zero_to_one_depth selects the D3D/Vulkan depth range (0 <= z <= w), otherwise the OpenGL range (-w <= z <= w).
+// With reversed-Z infinite projections one of the depth planes is degenerate (zero normal, positive distance)
+// and accepts everything.
+inline void extract_frustum_planes(const float4x4& view_proj, FrustumPlane out[6], bool zero_to_one_depth = true)
+{
+    auto row = [&](int r, float sign, int base)
+    {
+        const float* m = view_proj.m;
+        // Plane = row3 + sign * row(r), or row(r) alone when base == 0
+        float w = base ? 1.0f : 0.0f;
+        return FrustumPlane{float3(w * m[3] + sign * m[r], w * m[7] + sign * m[4 + r], w * m[11] + sign * m[8 + r]),
+                            w * m[15] + sign * m[12 + r]};
+    };
+    out[0] = row(0, 1.0f, 1);
+    out[1] = row(0, -1.0f, 1);
+    out[2] = row(1, 1.0f, 1);
+    out[3] = row(1, -1.0f, 1);
+    out[4] = zero_to_one_depth ? row(2, 1.0f, 0) : row(2, 1.0f, 1);
+    out[5] = row(2, -1.0f, 1);
+}
+
+namespace large_coordinates_detail
+{
+
+// Planes prepared for the box test: a box (center c, half extent h) is outside a plane when
+// dot(n, c) + distance + h * (|nx| + |ny| + |nz|) < 0
+struct CullPlanes
+{
+    float nx[6];
+    float ny[6];
+    float nz[6];
+    float offset[6];
+    uint32_t count;
+    int3 camera_global;
+    float3 camera_local;
+};
+
+// The cell delta saturates like LargeAABB::axis_offset(), so far candidates cannot overflow it
+inline float3 cell_center(const CullPlanes& planes, const int3& cell)
+{
+    constexpr float cell_size = LargePosition::CELL_SIZE;
+    const int3& camera = planes.camera_global;
+    return float3(float(LargeAABB::cell_delta(cell.x, camera.x)) * cell_size - planes.camera_local.x,
+                  float(LargeAABB::cell_delta(cell.y, camera.y)) * cell_size - planes.camera_local.y,
+                  float(LargeAABB::cell_delta(cell.z, camera.z)) * cell_size - planes.camera_local.z);
+}
+
+inline float center_distance_sq(const float3& c) { return (unfused(c.x * c.x) + unfused(c.y * c.y)) + unfused(c.z * c.z); }
+
+inline size_t cull_cells_scalar(const CullPlanes& planes, const int3* cells, size_t first, size_t count, int3* out_cells,
+                                float* out_distance_sq)
+{
+    size_t written = 0;
+    for (size_t i = first; i < count; i++)
+    {
+        float3 c = cell_center(planes, cells[i]);
+        bool visible = true;
+        for (uint32_t p = 0; p < planes.count; p++)
+        {
+            // Same operation order and rounding as the vector paths
+            float nx = unfused(planes.nx[p] * c.x);
+            float ny = unfused(planes.ny[p] * c.y);
+            float nz = unfused(planes.nz[p] * c.z);
+            float dist = ((nx + ny) + nz) + planes.offset[p];
+            visible = visible && dist >= 0.0f;
+        }
+        if (visible)
+        {
+            out_cells[written] = cells[i];
+            out_distance_sq[written] = center_distance_sq(c);
+            written++;
+        }
+    }
+    return written;
+}
+
+inline size_t emit_visible_cells(uint32_t mask, const int3* cells, const float* distance_sq, int3* out_cells, float* out_distance_sq)
+{
+    size_t written = 0;
+    for (; mask != 0; mask &= mask - 1)
+    {
+        uint32_t lane = 0;
+        while (((mask >> lane) & 1) == 0)
+        {
+            lane++;
+        }
+        out_cells[written] = cells[lane];
+        out_distance_sq[written] = distance_sq[lane];
+        written++;
+    }
+    return written;
+}
+
+#if LARGE_COORDINATES_X86
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline size_t cull_cells_sse42(const CullPlanes& planes, const int3* cells, size_t count, int3* out_cells, float* out_distance_sq)
+{
+    const __m128 cell_size = _mm_set1_ps(LargePosition::CELL_SIZE);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const int3* c = cells + i;
+        __m128i gx = _mm_setr_epi32(c[0].x, c[1].x, c[2].x, c[3].x);
+        __m128i gy = _mm_setr_epi32(c[0].y, c[1].y, c[2].y, c[3].y);
+        __m128i gz = _mm_setr_epi32(c[0].z, c[1].z, c[2].z, c[3].z);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(cell_delta_sse42(gx, _mm_set1_epi32(planes.camera_global.x))), cell_size),
+                              _mm_set1_ps(planes.camera_local.x));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(cell_delta_sse42(gy, _mm_set1_epi32(planes.camera_global.y))), cell_size),
+                              _mm_set1_ps(planes.camera_local.y));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(cell_delta_sse42(gz, _mm_set1_epi32(planes.camera_global.z))), cell_size),
+                              _mm_set1_ps(planes.camera_local.z));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (uint32_t p = 0; p < planes.count; p++)
+        {
+            __m128 nx = unfused(_mm_mul_ps(_mm_set1_ps(planes.nx[p]), x));
+            __m128 ny = unfused(_mm_mul_ps(_mm_set1_ps(planes.ny[p]), y));
+            __m128 nz = unfused(_mm_mul_ps(_mm_set1_ps(planes.nz[p]), z));
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(nx, ny), nz), _mm_set1_ps(planes.offset[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, _mm_setzero_ps()));
+        }
+
+        uint32_t mask = uint32_t(_mm_movemask_ps(inside));
+        if (mask != 0)
+        {
+            alignas(16) float distance_sq[4];
+            __m128 xy = _mm_add_ps(unfused(_mm_mul_ps(x, x)), unfused(_mm_mul_ps(y, y)));
+            _mm_store_ps(distance_sq, _mm_add_ps(xy, unfused(_mm_mul_ps(z, z))));
+            written += emit_visible_cells(mask, c, distance_sq, out_cells + written, out_distance_sq + written);
+        }
+    }
+    return written + cull_cells_scalar(planes, cells, i, count, out_cells + written, out_distance_sq + written);
+}
+
+static_assert(sizeof(int3) == 3 * sizeof(int32_t), "The gathers below assume tightly packed int3 components");
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256 cell_axis_avx2(const int32_t* base, __m256i index, int32_t camera_global, float camera_local)
+{
+    __m256i g = _mm256_i32gather_epi32(base, index, 4);
+    __m256 d = _mm256_cvtepi32_ps(cell_delta_avx2(g, _mm256_set1_epi32(camera_global)));
+    return _mm256_sub_ps(_mm256_mul_ps(d, _mm256_set1_ps(LargePosition::CELL_SIZE)), _mm256_set1_ps(camera_local));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline size_t cull_cells_avx2(const CullPlanes& planes, const int3* cells, size_t count, int3* out_cells, float* out_distance_sq)
+{
+    // int3 is three packed int32_t, so the components of 8 cells are 3 elements apart
+    const __m256i index = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const int32_t* base = &cells[i].x;
+        __m256 x = cell_axis_avx2(base, index, planes.camera_global.x, planes.camera_local.x);
+        __m256 y = cell_axis_avx2(base + 1, index, planes.camera_global.y, planes.camera_local.y);
+        __m256 z = cell_axis_avx2(base + 2, index, planes.camera_global.z, planes.camera_local.z);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t p = 0; p < planes.count; p++)
+        {
+            __m256 nx = unfused(_mm256_mul_ps(_mm256_set1_ps(planes.nx[p]), x));
+            __m256 ny = unfused(_mm256_mul_ps(_mm256_set1_ps(planes.ny[p]), y));
+            __m256 nz = unfused(_mm256_mul_ps(_mm256_set1_ps(planes.nz[p]), z));
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(nx, ny), nz), _mm256_set1_ps(planes.offset[p]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        uint32_t mask = uint32_t(_mm256_movemask_ps(inside));
+        if (mask != 0)
+        {
+            alignas(32) float distance_sq[8];
+            __m256 xy = _mm256_add_ps(unfused(_mm256_mul_ps(x, x)), unfused(_mm256_mul_ps(y, y)));
+            _mm256_store_ps(distance_sq, _mm256_add_ps(xy, unfused(_mm256_mul_ps(z, z))));
+            written += emit_visible_cells(mask, cells + i, distance_sq, out_cells + written, out_distance_sq + written);
+        }
+    }
+    return written + cull_cells_scalar(planes, cells, i, count, out_cells + written, out_distance_sq + written);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512 cell_axis_avx512(const int32_t* base, __m512i index, int32_t camera_global, float camera_local)
+{
+    __m512i g = _mm512_i32gather_epi32(index, base, 4);
+    __m512 d = _mm512_cvtepi32_ps(cell_delta_avx512(g, _mm512_set1_epi32(camera_global)));
+    return _mm512_sub_ps(_mm512_mul_ps(d, _mm512_set1_ps(LargePosition::CELL_SIZE)), _mm512_set1_ps(camera_local));
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline size_t cull_cells_avx512(const CullPlanes& planes, const int3* cells, size_t count, int3* out_cells, float* out_distance_sq)
+{
+    const __m512i index = _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const int32_t* base = &cells[i].x;
+        __m512 x = cell_axis_avx512(base, index, planes.camera_global.x, planes.camera_local.x);
+        __m512 y = cell_axis_avx512(base + 1, index, planes.camera_global.y, planes.camera_local.y);
+        __m512 z = cell_axis_avx512(base + 2, index, planes.camera_global.z, planes.camera_local.z);
+
+        __mmask16 inside = 0xffff;
+        for (uint32_t p = 0; p < planes.count; p++)
+        {
+            __m512 nx = unfused(_mm512_mul_ps(_mm512_set1_ps(planes.nx[p]), x));
+            __m512 ny = unfused(_mm512_mul_ps(_mm512_set1_ps(planes.ny[p]), y));
+            __m512 nz = unfused(_mm512_mul_ps(_mm512_set1_ps(planes.nz[p]), z));
+            __m512 dist = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(nx, ny), nz), _mm512_set1_ps(planes.offset[p]));
+            inside = _mm512_mask_cmp_ps_mask(inside, dist, _mm512_setzero_ps(), _CMP_GE_OQ);
+        }
+
+        if (inside != 0)
+        {
+            alignas(64) float distance_sq[16];
+            __m512 xy = _mm512_add_ps(unfused(_mm512_mul_ps(x, x)), unfused(_mm512_mul_ps(y, y)));
+            _mm512_store_ps(distance_sq, _mm512_add_ps(xy, unfused(_mm512_mul_ps(z, z))));
+            written += emit_visible_cells(inside, cells + i, distance_sq, out_cells + written, out_distance_sq + written);
+        }
+    }
+    return written + cull_cells_scalar(planes, cells, i, count, out_cells + written, out_distance_sq + written);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // LARGE_COORDINATES_X86
+
+inline size_t cull_cells(const CullPlanes& planes, const int3* cells, size_t count, int3* out_cells, float* out_distance_sq)
+{
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        return cull_cells_avx512(planes, cells, count, out_cells, out_distance_sq);
+    case SimdLevel::AVX2:
+        return cull_cells_avx2(planes, cells, count, out_cells, out_distance_sq);
+    case SimdLevel::SSE42:
+        return cull_cells_sse42(planes, cells, count, out_cells, out_distance_sq);
+#endif
+    default:
+        return cull_cells_scalar(planes, cells, 0, count, out_cells, out_distance_sq);
+    }
+}
+
+} // namespace large_coordinates_detail
+
+class LargeFrustumCuller
+{
+  public:
+    // Blocks of up to LEAF_SIZE^3 cells are handed to the SIMD plane test instead of being subdivided further
+    inline static constexpr int32_t LEAF_SIZE = 4;
+
+    LargeFrustumCuller() { set_cell_extent(LargePosition::THRESHOLD); }
+
+    // Half extent of the box tested for every cell (and added to every block during the walk)
+    void set_cell_extent(float half_extent)
+    {
+        m_cell_extent = half_extent;
+        update_offsets();
+    }
+
+    void set_frustum(const LargePosition& camera, const FrustumPlane* planes, size_t plane_count)
+    {
+        assert(plane_count <= 6 && "At most 6 frustum planes are supported");
+        m_planes.count = uint32_t(plane_count);
+        m_planes.camera_global = camera.global;
+        m_planes.camera_local = camera.local;
+        for (size_t p = 0; p < plane_count; p++)
+        {
+            m_source[p] = planes[p];
+            m_planes.nx[p] = planes[p].normal.x;
+            m_planes.ny[p] = planes[p].normal.y;
+            m_planes.nz[p] = planes[p].normal.z;
+        }
+        update_offsets();
+    }
+
+    void set_frustum(const LargePosition& camera, const float4x4& view_proj, bool zero_to_one_depth = true)
+    {
+        FrustumPlane planes[6];
+        extract_frustum_planes(view_proj, planes, zero_to_one_depth);
+        set_frustum(camera, planes, 6);
+    }
+
+    // Tests a list of candidate cells; `visible` receives the cells inside the frustum, sorted front-to-back
+    size_t cull(const int3* candidates, size_t count, std::vector<int3>& visible)
+    {
+        m_visible.resize(count);
+        m_distance_sq.resize(count);
+        size_t found = large_coordinates_detail::cull_cells(m_planes, candidates, count, m_visible.data(), m_distance_sq.data());
+        sort_front_to_back(found, visible);
+        return visible.size();
+    }
+
+    // Finds every cell within radius_cells of the camera cell (a cube) that intersects the frustum.
+    // Blocks of cells are tested as a whole first, so cells of blocks entirely outside are never visited.
+    size_t cull_range(int32_t radius_cells, std::vector<int3>& visible)
+    {
+        assert(radius_cells >= 0 && "Radius must not be negative");
+        m_candidates.clear();
+
+        // Clamp the cube to the int32_t cell range
+        int64_t lo[3], hi[3];
+        const int32_t camera[3] = {m_planes.camera_global.x, m_planes.camera_global.y, m_planes.camera_global.z};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            lo[axis] = std::max<int64_t>(int64_t(camera[axis]) - radius_cells, INT32_MIN) - camera[axis];
+            hi[axis] = std::min<int64_t>(int64_t(camera[axis]) + radius_cells, INT32_MAX) - camera[axis];
+        }
+        walk(lo, hi);
+
+        m_visible.resize(m_candidates.size());
+        m_distance_sq.resize(m_candidates.size());
+        size_t found = large_coordinates_detail::cull_cells(m_planes, m_candidates.data(), m_candidates.size(), m_visible.data(),
+                                                            m_distance_sq.data());
+        sort_front_to_back(found, visible);
+        return visible.size();
+    }
+
+  private:
+    void update_offsets()
+    {
+        for (uint32_t p = 0; p < m_planes.count; p++)
+        {
+            float extent = std::abs(m_source[p].normal.x) + std::abs(m_source[p].normal.y) + std::abs(m_source[p].normal.z);
+            m_planes.offset[p] = m_source[p].distance + m_cell_extent * extent;
+        }
+    }
+
+    // Block of cells [lo, hi] (offsets from the camera cell, inclusive) against every plane
+    // Returns -1 when fully outside, 1 when fully inside and 0 when it crosses a plane.
+    // Both answers keep a relative safety margin, so the block test never disagrees with the per-cell test.
+    int classify_block(const int64_t lo[3], const int64_t hi[3]) const
+    {
+        constexpr float cell_size = LargePosition::CELL_SIZE;
+        float center[3], half[3];
+        const float camera_local[3] = {m_planes.camera_local.x, m_planes.camera_local.y, m_planes.camera_local.z};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            center[axis] = float(lo[axis] + hi[axis]) * (cell_size * 0.5f) - camera_local[axis];
+            half[axis] = float(hi[axis] - lo[axis]) * (cell_size * 0.5f) + m_cell_extent;
+        }
+
+        int result = 1;
+        for (uint32_t p = 0; p < m_planes.count; p++)
+        {
+            float dist = m_planes.nx[p] * center[0] + m_planes.ny[p] * center[1] + m_planes.nz[p] * center[2] + m_source[p].distance;
+            float reach = std::abs(m_planes.nx[p]) * half[0] + std::abs(m_planes.ny[p]) * half[1] + std::abs(m_planes.nz[p]) * half[2];
+            float margin = (std::abs(dist) + reach + std::abs(m_source[p].distance)) * 1e-5f;
+            if (dist + reach < -margin)
+            {
+                return -1;
+            }
+            if (dist - reach < margin)
+            {
+                result = 0;
+            }
+        }
+        return result;
+    }
+
+    void walk(const int64_t lo[3], const int64_t hi[3])
+    {
+        if (lo[0] > hi[0] || lo[1] > hi[1] || lo[2] > hi[2])
+        {
+            return;
+        }
+
+        int state = classify_block(lo, hi);
+        if (state < 0)
+        {
+            return;
+        }
+
+        int split = 0;
+        for (int axis = 1; axis < 3; axis++)
+        {
+            split = (hi[axis] - lo[axis] > hi[split] - lo[split]) ? axis : split;
+        }
+
+        if (state > 0 || hi[split] - lo[split] < LEAF_SIZE)
+        {
+            // Every cell that survives the block test still goes through the (cheap, vectorized) per-cell test,
+            // so the result is exactly the per-cell answer over the whole cube
+            const int3& camera = m_planes.camera_global;
+            for (int64_t z = lo[2]; z <= hi[2]; z++)
+            {
+                for (int64_t y = lo[1]; y <= hi[1]; y++)
+                {
+                    for (int64_t x = lo[0]; x <= hi[0]; x++)
+                    {
+                        m_candidates.push_back(int3(int32_t(camera.x + x), int32_t(camera.y + y), int32_t(camera.z + z)));
+                    }
+                }
+            }
+            return;
+        }
+
+        int64_t mid = lo[split] + (hi[split] - lo[split]) / 2;
+        int64_t first_hi[3] = {hi[0], hi[1], hi[2]};
+        int64_t second_lo[3] = {lo[0], lo[1], lo[2]};
+        first_hi[split] = mid;
+        second_lo[split] = mid + 1;
+        walk(lo, first_hi);
+        walk(second_lo, hi);
+    }
+
+    void sort_front_to_back(size_t count, std::vector<int3>& visible)
+    {
+        // Non-negative floats order like their bit patterns, so the radix sort can sort distances directly
+        m_keys.resize(count);
+        m_order.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &m_distance_sq[i], sizeof(bits));
+            m_keys[i] = bits;
+            m_order[i] = uint32_t(i);
+        }
+        radix_sort(m_keys.data(), m_order.data(), count, 1);
+
+        visible.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            visible[i] = m_visible[m_order[i]];
+        }
+    }
+
+    large_coordinates_detail::CullPlanes m_planes = {};
+    FrustumPlane m_source[6] = {};
+    float m_cell_extent = 0.0f;
+    std::vector<int3> m_candidates;
+    std::vector<int3> m_visible;
+    std::vector<float> m_distance_sq;
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_order;
+};
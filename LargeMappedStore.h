@@ -0,0 +1,472 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargePositionBuffer.h"
+#include "LargeSnapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+
+LargeMappedStore opens a position snapshot (see LargeSnapshot.h) by memory mapping it, so opening a table of any size
+is O(1): pages are only read from disk when they are first touched. Every chunk of the snapshot is exposed as a
+read-only span of PositionLanes that the batch conversions (batch_to_float3, ...) use in place.
+
+Updates never modify the snapshot file:
+  The mapping is private (copy-on-write), so set() patches the mapped lanes in place and only touched pages are copied.
+  Every set() and push_back() is appended to a log next to the snapshot (<path>.log), which open() replays.
+  The log is only opened for writing by the first update, so read-only snapshots (read-only directories or media)
+  open normally; updates then fail and leave the store unchanged.
+  Appended elements live in a LargePositionBuffer, exposed as one more span after the mapped chunks.
+
+compact() writes the current contents as a new snapshot and removes the log, so that open() stays fast. Replaying an
+old log on the compacted snapshot is harmless, so a crash between the two steps loses nothing.
+
+A log record is 32 bytes, little-endian: index, global, local and a checksum. Replay stops at the first incomplete or
+corrupt record (a crash while appending loses at most that record), and the log is truncated there before the next
+record is appended.
+
+Elements are not validated on open, that would touch every page. Use LargeSnapshotReader to validate a snapshot.
+
+*/
+
+namespace large_coordinates_detail
+{
+
+// Private (copy-on-write) mapping of a whole file
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { unmap(); }
+
+    bool map(const char* path)
+    {
+        unmap();
+#if defined(_WIN32)
+        HANDLE file =
+            CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER size;
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        }
+        CloseHandle(file);
+        if (!mapping)
+        {
+            return false;
+        }
+        // The view keeps the mapping (and the file) open
+        void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!data)
+        {
+            return false;
+        }
+        m_size = size_t(size.QuadPart);
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat info;
+        void* data = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            data = ::mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        // The mapping keeps the file open
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+        m_size = size_t(info.st_size);
+#endif
+        m_data = static_cast<char*>(data);
+        return true;
+    }
+
+    void unmap()
+    {
+        if (m_data)
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#else
+            ::munmap(m_data, m_size);
+#endif
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+  private:
+    char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace large_coordinates_detail
+
+class LargeMappedStore
+{
+  public:
+    // Elements [first, first + count) of the store, in lanes that stay valid until the store is closed or compacted
+    // (or, for the appended elements, until the next push_back)
+    struct Span
+    {
+        size_t first;
+        size_t count;
+        PositionLanes lanes;
+    };
+
+    LargeMappedStore() = default;
+    LargeMappedStore(const LargeMappedStore&) = delete;
+    LargeMappedStore& operator=(const LargeMappedStore&) = delete;
+    ~LargeMappedStore() { close(); }
+
+    // Maps the snapshot at `path` and replays its log. Only the header and the log are read.
+    SnapshotStatus open(const std::string& path)
+    {
+        using namespace large_coordinates_detail;
+        close();
+        if (!m_file.map(path.c_str()))
+        {
+            return SnapshotStatus::IoError;
+        }
+        if (m_file.size() < sizeof(LargeSnapshotHeader))
+        {
+            return fail(SnapshotStatus::Truncated);
+        }
+
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        const bool swap = !host_is_little_endian();
+        if (swap)
+        {
+            byte_swap_header(m_header);
+        }
+        SnapshotStatus status = validate_snapshot_header(m_header);
+        if (status == SnapshotStatus::Ok && m_file.size() < m_header.file_size())
+        {
+            status = SnapshotStatus::Truncated;
+        }
+        if (status != SnapshotStatus::Ok)
+        {
+            return fail(status);
+        }
+
+        if (swap)
+        {
+            // Big-endian hosts convert the lanes once, in the private copy of the pages
+            for (uint64_t chunk = 0; chunk < m_header.chunk_total(); chunk++)
+            {
+                const uint64_t chunk_bytes = LargeSnapshotHeader::lane_bytes(m_header.chunk_count(chunk)) * 6;
+                byte_swap_lane(m_file.data() + m_header.chunk_offset(chunk), size_t(chunk_bytes / sizeof(uint32_t)));
+            }
+        }
+
+        m_path = path;
+        return replay_log();
+    }
+
+    void close()
+    {
+        if (m_log)
+        {
+            std::fclose(m_log);
+        }
+        m_log = nullptr;
+        m_log_bytes = 0;
+        m_file.unmap();
+        m_header = {};
+        m_appended.clear();
+        m_path.clear();
+    }
+
+    bool is_open() const { return m_file.data() != nullptr; }
+
+    // Number of elements, mapped and appended
+    size_t size() const { return size_t(m_header.count) + m_appended.size(); }
+
+    const LargeSnapshotHeader& header() const { return m_header; }
+
+    // One span per snapshot chunk, plus one for the appended elements
+    size_t span_count() const { return size_t(m_header.chunk_total()) + (m_appended.empty() ? 0 : 1); }
+
+    Span span(size_t index) const
+    {
+        assert(index < span_count() && "LargeMappedStore span index out of range");
+        if (index == m_header.chunk_total())
+        {
+            return Span{size_t(m_header.count), m_appended.size(), m_appended.lanes()};
+        }
+        const size_t count = size_t(m_header.chunk_count(index));
+        return Span{index * m_header.chunk_elements, count, chunk_lanes(index, count)};
+    }
+
+    LargePosition get(size_t index) const
+    {
+        assert(index < size() && "LargeMappedStore index out of range");
+        if (index >= m_header.count)
+        {
+            return m_appended.get(index - size_t(m_header.count));
+        }
+        const Span chunk = span(index / m_header.chunk_elements);
+        const size_t i = index - chunk.first;
+        LargePosition pos;
+        pos.global = int3(chunk.lanes.global_x[i], chunk.lanes.global_y[i], chunk.lanes.global_z[i]);
+        pos.local = float3(chunk.lanes.local_x[i], chunk.lanes.local_y[i], chunk.lanes.local_z[i]);
+        return pos;
+    }
+
+    // set() and push_back() return false, leaving the store unchanged, when the update cannot be appended to the log
+    bool set(size_t index, const LargePosition& pos)
+    {
+        assert(index < size() && "LargeMappedStore index out of range");
+        assert(index <= UINT32_MAX && "LargeMappedStore log records hold 32-bit indices");
+        if (!append_log(uint32_t(index), pos))
+        {
+            return false;
+        }
+        apply(uint32_t(index), pos);
+        return true;
+    }
+
+    bool push_back(const LargePosition& pos)
+    {
+        assert(size() < UINT32_MAX && "LargeMappedStore is limited to 2^32 - 1 elements");
+        const uint32_t index = uint32_t(size());
+        if (!append_log(index, pos))
+        {
+            return false;
+        }
+        apply(index, pos);
+        return true;
+    }
+
+    // Hands the buffered log records to the operating system
+    bool flush() { return !m_log || std::fflush(m_log) == 0; }
+
+    // Bulk to_float3 over all spans, writes size() offsets relative to `origin` (see batch_to_float3)
+    void to_float3(const int3& origin, const Float3Lanes& out) const
+    {
+        for (size_t i = 0; i < span_count(); i++)
+        {
+            const Span s = span(i);
+            batch_to_float3(origin, s.lanes, Float3Lanes{out.x + s.first, out.y + s.first, out.z + s.first}, s.count);
+        }
+    }
+
+    // Rewrites the snapshot with the current contents (same chunk size) and removes the log, then reopens it
+    SnapshotStatus compact()
+    {
+        assert(is_open() && "LargeMappedStore is not open");
+        LargePositionBuffer contents(size());
+        for (size_t i = 0; i < span_count(); i++)
+        {
+            const Span s = span(i);
+            const size_t bytes = s.count * sizeof(float);
+            std::memcpy(contents.global_x() + s.first, s.lanes.global_x, bytes);
+            std::memcpy(contents.global_y() + s.first, s.lanes.global_y, bytes);
+            std::memcpy(contents.global_z() + s.first, s.lanes.global_z, bytes);
+            std::memcpy(contents.local_x() + s.first, s.lanes.local_x, bytes);
+            std::memcpy(contents.local_y() + s.first, s.lanes.local_y, bytes);
+            std::memcpy(contents.local_z() + s.first, s.lanes.local_z, bytes);
+        }
+
+        const std::string path = m_path;
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!write_snapshot(out, contents, m_header.chunk_elements) || !out.flush())
+            {
+                return SnapshotStatus::IoError;
+            }
+        }
+
+        // The snapshot must be unmapped before it can be replaced on Windows
+        close();
+        std::error_code error;
+        std::filesystem::rename(temp, path, error);
+        if (error)
+        {
+            return SnapshotStatus::IoError;
+        }
+        std::filesystem::remove(log_path(path), error);
+        return open(path);
+    }
+
+  private:
+    inline static constexpr size_t RECORD_WORDS = 8;
+
+    static std::string log_path(const std::string& path) { return path + ".log"; }
+
+    PositionLanes chunk_lanes(size_t chunk, size_t count) const
+    {
+        const char* base = m_file.data() + m_header.chunk_offset(chunk);
+        const size_t stride = size_t(LargeSnapshotHeader::lane_bytes(count));
+        return PositionLanes{reinterpret_cast<const int32_t*>(base),
+                             reinterpret_cast<const int32_t*>(base + stride),
+                             reinterpret_cast<const int32_t*>(base + stride * 2),
+                             reinterpret_cast<const float*>(base + stride * 3),
+                             reinterpret_cast<const float*>(base + stride * 4),
+                             reinterpret_cast<const float*>(base + stride * 5)};
+    }
+
+    // Stores `pos` at `index` (at most size()) without logging it
+    void apply(uint32_t index, const LargePosition& pos)
+    {
+        if (index >= m_header.count)
+        {
+            const size_t appended = index - size_t(m_header.count);
+            if (appended == m_appended.size())
+            {
+                m_appended.push_back(pos);
+            }
+            else
+            {
+                m_appended.set(appended, pos);
+            }
+            return;
+        }
+
+        // The lanes of the private mapping are writable, only the span view is const
+        const Span chunk = span(index / m_header.chunk_elements);
+        const size_t i = index - chunk.first;
+        const_cast<int32_t*>(chunk.lanes.global_x)[i] = pos.global.x;
+        const_cast<int32_t*>(chunk.lanes.global_y)[i] = pos.global.y;
+        const_cast<int32_t*>(chunk.lanes.global_z)[i] = pos.global.z;
+        const_cast<float*>(chunk.lanes.local_x)[i] = pos.local.x;
+        const_cast<float*>(chunk.lanes.local_y)[i] = pos.local.y;
+        const_cast<float*>(chunk.lanes.local_z)[i] = pos.local.z;
+    }
+
+    static uint32_t record_checksum(const uint32_t* words)
+    {
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+        for (size_t i = 0; i < RECORD_WORDS - 1; i++)
+        {
+            h = large_coordinates_detail::fmix64(h ^ words[i]);
+        }
+        return uint32_t(h);
+    }
+
+    bool append_log(uint32_t index, const LargePosition& pos)
+    {
+        using namespace large_coordinates_detail;
+        uint32_t words[RECORD_WORDS] = {index, uint32_t(pos.global.x), uint32_t(pos.global.y), uint32_t(pos.global.z)};
+        const float local[3] = {pos.local.x, pos.local.y, pos.local.z};
+        std::memcpy(&words[4], local, sizeof(local));
+        words[7] = record_checksum(words);
+        if (!host_is_little_endian())
+        {
+            byte_swap_lane(words, RECORD_WORDS);
+        }
+        if (!m_log && !open_log())
+        {
+            return false;
+        }
+        if (std::fwrite(words, sizeof(words), 1, m_log) != 1)
+        {
+            // Reopening truncates a partially written record, so that later records still replay
+            std::fclose(m_log);
+            m_log = nullptr;
+            return false;
+        }
+        m_log_bytes += sizeof(words);
+        return true;
+    }
+
+    // Opens the log for appending, first dropping a torn or corrupt tail that replay_log() stopped at
+    bool open_log()
+    {
+        const std::string path = log_path(m_path);
+        std::error_code error;
+        const uint64_t size = std::filesystem::file_size(path, error); // fails when there is no log yet
+        if (!error && size != m_log_bytes)
+        {
+            std::filesystem::resize_file(path, m_log_bytes, error);
+            if (error)
+            {
+                return false;
+            }
+        }
+        m_log = std::fopen(path.c_str(), "ab");
+        return m_log != nullptr;
+    }
+
+    // Applies the valid records of the log; the log is not opened for writing until the first update
+    SnapshotStatus replay_log()
+    {
+        using namespace large_coordinates_detail;
+        const std::string path = log_path(m_path);
+        if (std::FILE* log = std::fopen(path.c_str(), "rb"))
+        {
+            uint32_t words[RECORD_WORDS];
+            while (std::fread(words, sizeof(words), 1, log) == 1)
+            {
+                if (!host_is_little_endian())
+                {
+                    byte_swap_lane(words, RECORD_WORDS);
+                }
+                if (words[7] != record_checksum(words) || words[0] > size())
+                {
+                    break;
+                }
+                LargePosition pos;
+                pos.global = int3(int32_t(words[1]), int32_t(words[2]), int32_t(words[3]));
+                float local[3];
+                std::memcpy(local, &words[4], sizeof(local));
+                pos.local = float3(local[0], local[1], local[2]);
+                apply(words[0], pos);
+                m_log_bytes += sizeof(words);
+            }
+            std::fclose(log);
+        }
+        return SnapshotStatus::Ok;
+    }
+
+    SnapshotStatus fail(SnapshotStatus status)
+    {
+        close();
+        return status;
+    }
+
+    large_coordinates_detail::MappedFile m_file;
+    LargeSnapshotHeader m_header = {};
+    LargePositionBuffer m_appended;
+    std::string m_path;
+    std::FILE* m_log = nullptr;
+    uint64_t m_log_bytes = 0; // valid records in the log, new records are appended after them
+};
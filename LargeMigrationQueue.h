@@ -0,0 +1,280 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargeThreadPool.h"
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+/*
+
+LargeMigrationQueue collects cell migrations (entity id, old cell, new cell) produced by from_float3(), so spatial
+structures can be updated in one batched pass per tick instead of comparing `global` around every call.
+
+It is a lock-free multi-producer / single-consumer queue: any number of threads push() concurrently, one thread at a
+time drains, possibly while producers are still running. Storage is a linked list of blocks of BLOCK_EVENTS slots:
+
+  - push() reserves slots with a single fetch_add on the tail (one per call, however many events it pushes), writes
+    them and publishes each slot with a release store. It never waits for other producers.
+  - drain() hands out events in slot order and stops at the first slot not published yet.
+  - Blocks are allocated by the producer that first needs them; drained blocks are freed by the consumer once no
+    producer can still be walking through them (no push() in flight).
+
+Events pushed by one thread are drained in push order. Events of different threads interleave in reservation order;
+sort by id when a deterministic order is needed.
+
+The tracked versions of from_float3 below push one event for each element that changes cell.
+
+*/
+class LargeMigrationQueue
+{
+  public:
+    inline static constexpr size_t BLOCK_EVENTS = 1024;
+
+    struct Event
+    {
+        uint32_t id;
+        int3 from;
+        int3 to;
+    };
+
+    LargeMigrationQueue()
+    {
+        Block* block = new Block(0);
+        m_head_block = block;
+        m_tail_block.store(block, std::memory_order_relaxed);
+    }
+
+    ~LargeMigrationQueue()
+    {
+        free_blocks(m_retired);
+        for (Block* block = m_head_block; block != nullptr;)
+        {
+            Block* next = block->next.load(std::memory_order_relaxed);
+            delete block;
+            block = next;
+        }
+    }
+
+    LargeMigrationQueue(const LargeMigrationQueue&) = delete;
+    LargeMigrationQueue& operator=(const LargeMigrationQueue&) = delete;
+
+    // Events pushed and not drained yet, called by the consumer (a snapshot while producers are running)
+    size_t size() const { return size_t(m_tail.load(std::memory_order_acquire) - m_head); }
+
+    void push(const Event& event) { push(&event, 1); }
+
+    // Thread-safe; the events occupy consecutive slots
+    void push(const Event* events, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        m_producers.fetch_add(1);
+
+        // The hint is read before reserving: it only ever points at a block holding an already reserved slot,
+        // so it can't be past the block of our first slot
+        Block* block = m_tail_block.load();
+        uint64_t slot = m_tail.fetch_add(count);
+        for (size_t i = 0; i < count; i++, slot++)
+        {
+            while (slot >= block->first + BLOCK_EVENTS)
+            {
+                block = next_block(block);
+            }
+            size_t index = size_t(slot - block->first);
+            block->events[index] = events[i];
+            block->ready[index].store(1, std::memory_order_release);
+        }
+        advance_hint(block);
+
+        m_producers.fetch_sub(1);
+    }
+
+    // Single consumer. Calls fn(event) for every published event in slot order, returns the number of events
+    template <typename Fn>
+    size_t drain(const Fn& fn)
+    {
+        size_t drained = 0;
+        for (;;)
+        {
+            Block* block = m_head_block;
+            size_t index = size_t(m_head - block->first);
+            if (index == BLOCK_EVENTS)
+            {
+                Block* next = block->next.load(std::memory_order_acquire);
+                if (next == nullptr)
+                {
+                    break;
+                }
+                m_retired.push_back(block);
+                m_head_block = next;
+                continue;
+            }
+            if (block->ready[index].load(std::memory_order_acquire) == 0)
+            {
+                break;
+            }
+            fn(block->events[index]);
+            m_head++;
+            drained++;
+        }
+        release_retired();
+        return drained;
+    }
+
+    // Appends the published events to `out`, returns the number appended
+    size_t drain(std::vector<Event>& out)
+    {
+        return drain([&out](const Event& event) { out.push_back(event); });
+    }
+
+  private:
+    struct Block
+    {
+        explicit Block(uint64_t first_)
+            : first(first_)
+        {
+            for (std::atomic<uint8_t>& flag : ready)
+            {
+                flag.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        const uint64_t first; // slot of events[0]
+        std::atomic<Block*> next{nullptr};
+        std::atomic<uint8_t> ready[BLOCK_EVENTS];
+        Event events[BLOCK_EVENTS];
+    };
+
+    // Follows (or creates) the block after `block`; concurrent producers agree on a single successor
+    static Block* next_block(Block* block)
+    {
+        Block* next = block->next.load(std::memory_order_acquire);
+        if (next != nullptr)
+        {
+            return next;
+        }
+        Block* created = new Block(block->first + BLOCK_EVENTS);
+        if (block->next.compare_exchange_strong(next, created, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return created;
+        }
+        delete created;
+        return next;
+    }
+
+    void advance_hint(Block* block)
+    {
+        Block* hint = m_tail_block.load();
+        while (hint->first < block->first && !m_tail_block.compare_exchange_weak(hint, block))
+        {
+        }
+    }
+
+    // A retired block is unreachable for new producers once the hint has moved past it; with no push() in flight,
+    // no old producer is walking through it either
+    void release_retired()
+    {
+        if (m_retired.empty() || m_tail_block.load()->first <= m_retired.back()->first || m_producers.load() != 0)
+        {
+            return;
+        }
+        free_blocks(m_retired);
+    }
+
+    static void free_blocks(std::vector<Block*>& blocks)
+    {
+        for (Block* block : blocks)
+        {
+            delete block;
+        }
+        blocks.clear();
+    }
+
+    std::atomic<uint64_t> m_tail{0};
+    std::atomic<Block*> m_tail_block;
+    std::atomic<uint32_t> m_producers{0};
+
+    // Consumer side
+    alignas(64) uint64_t m_head = 0;
+    Block* m_head_block;
+    std::vector<Block*> m_retired;
+};
+
+// LargePosition::from_float3() that pushes a migration event for entity `id` when the cell changes.
+// Returns true if the cell changed.
+inline bool from_float3_tracked(LargePosition& pos, const int3& origin, const float3& local_pos, uint32_t id, LargeMigrationQueue& sink)
+{
+    const int3 from = pos.global;
+    pos.from_float3(origin, local_pos);
+    if (pos.global == from)
+    {
+        return false;
+    }
+    sink.push(LargeMigrationQueue::Event{id, from, pos.global});
+    return true;
+}
+
+namespace large_coordinates_detail
+{
+
+// Elements per kernel call of the tracked batch update; the old cells of a chunk are saved on the stack
+inline constexpr size_t TRACKED_CHUNK = 256;
+
+} // namespace large_coordinates_detail
+
+// batch_from_float3() that pushes a migration event for each element that changes cell, with id first_id + i.
+// Events of one call are pushed with a single reservation, in element order. Returns the number of elements that
+// changed cell.
+inline size_t batch_from_float3(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count, uint32_t first_id,
+                                LargeMigrationQueue& sink)
+{
+    using namespace large_coordinates_detail;
+    std::vector<LargeMigrationQueue::Event> events;
+    int32_t old_x[TRACKED_CHUNK], old_y[TRACKED_CHUNK], old_z[TRACKED_CHUNK];
+    uint64_t mask[TRACKED_CHUNK / 64];
+    uint32_t changed[TRACKED_CHUNK];
+    for (size_t first = 0; first < count; first += TRACKED_CHUNK)
+    {
+        const size_t n = std::min(TRACKED_CHUNK, count - first);
+        std::memcpy(old_x, dst.global_x + first, n * sizeof(int32_t));
+        std::memcpy(old_y, dst.global_y + first, n * sizeof(int32_t));
+        std::memcpy(old_z, dst.global_z + first, n * sizeof(int32_t));
+
+        const MutablePositionLanes chunk = offset_lanes(dst, first);
+        if (batch_from_float3(chunk, offset_lanes(local_pos, first), n, mask) == 0)
+        {
+            continue;
+        }
+        const size_t changed_count = changed_mask_to_indices(mask, n, changed);
+        for (size_t c = 0; c < changed_count; c++)
+        {
+            const uint32_t i = changed[c];
+            events.push_back(LargeMigrationQueue::Event{uint32_t(first_id + first + i), int3(old_x[i], old_y[i], old_z[i]),
+                                                        int3(chunk.global_x[i], chunk.global_y[i], chunk.global_z[i])});
+        }
+    }
+    sink.push(events.data(), events.size());
+    return events.size();
+}
+
+// Parallel version of the above: every chunk pushes its own events, so events are ordered within a chunk only
+inline size_t parallel_batch_from_float3(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count,
+                                         uint32_t first_id, LargeMigrationQueue& sink, LargeThreadPool& pool = LargeThreadPool::shared())
+{
+    using namespace large_coordinates_detail;
+    std::atomic<size_t> changed{0};
+    pool.parallel_for(
+        count, parallel_grain(6 * 4 + 3 * 4),
+        [&](size_t begin, size_t end)
+        {
+            size_t n =
+                batch_from_float3(offset_lanes(dst, begin), offset_lanes(local_pos, begin), end - begin, uint32_t(first_id + begin), sink);
+            changed.fetch_add(n, std::memory_order_relaxed);
+        },
+        PARALLEL_CHUNK_ALIGN);
+    return changed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,519 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/*
+
+Compact network encoding of LargePosition batches, for replication.
+
+Positions are quantized on a grid of `step` = CELL_SIZE / 2^local_bits (local_bits up to 23, where the step is
+TYPICAL_PRECISION), so every axis becomes one integer Q = cell * 2^local_bits + fraction. Rounding errs by at most
+half a step. Quantizing also moves hysteresis-extended locals to their nearest cell, both peers see the same canonical
+position. A batch is written with one of two encodings per position:
+
+  full:  the cell relative to the receiver's reference cell (usually 0 or +/-1, 1 or 3 bits per axis with an order-0
+         exponential-Golomb code) and the fraction in local_bits bits
+  delta: Q minus the last state the receiver acknowledged (the baseline), with an exponential-Golomb code whose order is
+         chosen per batch to minimize the total length estimated from a histogram of the delta bit widths, so that
+         small movements take a few bits per axis and a few teleports don't inflate every code
+
+Without baselines (a keyframe) every position uses the full encoding. With baselines the encoder picks the shorter
+encoding per position and spends one bit to flag it. The quantized values of every batch are returned to the caller,
+which keeps them until the receiver acknowledges the batch and then uses them as baselines; the receiver keeps the
+values it decoded in the same way.
+
+LargeBitWriter and LargeBitReader pack bits LSB first into little-endian bytes through a 64-bit accumulator. The reader
+never reads past its buffer and reports truncated or corrupt input through ok().
+
+*/
+
+namespace large_coordinates_detail
+{
+
+// Number of bits needed to represent `value` (0 for 0)
+inline uint32_t bit_width64(uint64_t value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return uint32_t(index) + 1;
+#elif defined(__GNUC__) || defined(__clang__)
+    return 64 - uint32_t(__builtin_clzll(value));
+#else
+    uint32_t width = 0;
+    while (value)
+    {
+        width++;
+        value >>= 1;
+    }
+    return width;
+#endif
+}
+
+// Index of the lowest set bit of a non-zero `value`
+inline uint32_t count_trailing_zeros64(uint64_t value)
+{
+    assert(value != 0);
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return uint32_t(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return uint32_t(__builtin_ctzll(value));
+#else
+    uint32_t count = 0;
+    while ((value & 1) == 0)
+    {
+        count++;
+        value >>= 1;
+    }
+    return count;
+#endif
+}
+
+inline uint64_t zigzag_encode(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+
+inline int64_t zigzag_decode(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+// Length of the order-k exponential-Golomb code of `value`
+inline uint32_t exp_golomb_bits(uint64_t value, uint32_t k)
+{
+    const uint32_t n = bit_width64(value + (uint64_t(1) << k)) - 1;
+    return 2 * n - k + 1;
+}
+
+} // namespace large_coordinates_detail
+
+class LargeBitWriter
+{
+  public:
+    // Appends the low `bits` bits of `value` (up to 64)
+    void write(uint64_t value, uint32_t bits)
+    {
+        if (bits > 32)
+        {
+            write_word(uint32_t(value), 32);
+            value >>= 32;
+            bits -= 32;
+        }
+        write_word(uint32_t(value), bits);
+    }
+
+    void write_bit(bool bit) { write_word(bit ? 1u : 0u, 1); }
+
+    // Order-k exponential-Golomb code: (n - k) zero bits and a one, then the n low bits of value + 2^k, where
+    // n = floor(log2(value + 2^k)). `value` must be below 2^61.
+    void write_exp_golomb(uint64_t value, uint32_t k)
+    {
+        assert(value < (uint64_t(1) << 61) && k < 32 && "Exponential-Golomb value out of range");
+        const uint64_t v = value + (uint64_t(1) << k);
+        const uint32_t n = large_coordinates_detail::bit_width64(v) - 1;
+        uint32_t zeros = n - k;
+        while (zeros > 32)
+        {
+            write_word(0, 32);
+            zeros -= 32;
+        }
+        write_word(0, zeros);
+        write_word(1, 1);
+        write(v, n);
+    }
+
+    size_t bit_count() const { return m_bytes.size() * 8 + m_count; }
+
+    // Flushes the pending bits (zero padded to a byte) and returns the encoded bytes
+    const std::vector<uint8_t>& finish()
+    {
+        while (m_count > 0)
+        {
+            m_bytes.push_back(uint8_t(m_accumulator));
+            m_accumulator >>= 8;
+            m_count = (m_count > 8) ? m_count - 8 : 0;
+        }
+        m_accumulator = 0;
+        return m_bytes;
+    }
+
+    void clear()
+    {
+        m_bytes.clear();
+        m_accumulator = 0;
+        m_count = 0;
+    }
+
+  private:
+    void write_word(uint32_t value, uint32_t bits)
+    {
+        assert(bits <= 32);
+        const uint64_t mask = (bits == 32) ? 0xffffffffull : (uint64_t(1) << bits) - 1;
+        m_accumulator |= (uint64_t(value) & mask) << m_count;
+        m_count += bits;
+        if (m_count >= 32)
+        {
+            const uint32_t word = uint32_t(m_accumulator);
+            const uint8_t bytes[4] = {uint8_t(word), uint8_t(word >> 8), uint8_t(word >> 16), uint8_t(word >> 24)};
+            m_bytes.insert(m_bytes.end(), bytes, bytes + 4);
+            m_accumulator >>= 32;
+            m_count -= 32;
+        }
+    }
+
+    std::vector<uint8_t> m_bytes;
+    uint64_t m_accumulator = 0;
+    uint32_t m_count = 0; // pending bits in m_accumulator, always below 32 between calls
+};
+
+class LargeBitReader
+{
+  public:
+    LargeBitReader(const uint8_t* data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+    explicit LargeBitReader(const std::vector<uint8_t>& bytes)
+        : LargeBitReader(bytes.data(), bytes.size())
+    {
+    }
+
+    // Reads `bits` bits (up to 64). Past the end of the data, zero bits are returned and ok() turns false.
+    uint64_t read(uint32_t bits)
+    {
+        if (bits > 32)
+        {
+            const uint64_t low = read_word(32);
+            return low | (read_word(bits - 32) << 32);
+        }
+        return read_word(bits);
+    }
+
+    bool read_bit() { return read_word(1) != 0; }
+
+    // Reads a code written by LargeBitWriter::write_exp_golomb()
+    uint64_t read_exp_golomb(uint32_t k)
+    {
+        uint32_t zeros = 0;
+        for (;;)
+        {
+            refill();
+            if (m_accumulator != 0)
+            {
+                const uint32_t run = large_coordinates_detail::count_trailing_zeros64(m_accumulator);
+                zeros += run;
+                consume(run + 1);
+                break;
+            }
+            // No set bit in the buffered bits: either a long prefix or the end of the data
+            zeros += m_count;
+            consume(m_count);
+            if (m_position >= m_size)
+            {
+                m_overrun = true;
+                return 0;
+            }
+        }
+        if (zeros + k > 61)
+        {
+            // Longer than any value write_exp_golomb() accepts
+            m_overrun = true;
+            return 0;
+        }
+        const uint32_t n = zeros + k;
+        return ((uint64_t(1) << n) | read(n)) - (uint64_t(1) << k);
+    }
+
+    // False when more bits were read than the data holds, or a code was malformed
+    bool ok() const { return !m_overrun; }
+
+  private:
+    uint64_t read_word(uint32_t bits)
+    {
+        assert(bits <= 32);
+        if (m_count < bits)
+        {
+            refill();
+            if (m_count < bits)
+            {
+                m_overrun = true;
+                m_accumulator = 0;
+                m_count = bits;
+            }
+        }
+        const uint64_t value = m_accumulator & ((uint64_t(1) << bits) - 1);
+        consume(bits);
+        return value;
+    }
+
+    void consume(uint32_t bits)
+    {
+        m_accumulator = (bits == 64) ? 0 : m_accumulator >> bits;
+        m_count -= bits;
+    }
+
+    // Tops the accumulator up to at least 57 bits while data remains
+    void refill()
+    {
+        if (m_position + 8 <= m_size && large_coordinates_detail::host_is_little_endian())
+        {
+            // Only whole bytes are added, so the bits above m_count stay zero
+            const uint32_t bytes = (64 - m_count) >> 3;
+            uint64_t word;
+            std::memcpy(&word, m_data + m_position, sizeof(word));
+            word &= (bytes == 8) ? ~uint64_t(0) : (uint64_t(1) << (bytes * 8)) - 1;
+            m_accumulator |= (bytes == 0) ? 0 : word << m_count;
+            m_position += bytes;
+            m_count += bytes * 8;
+            return;
+        }
+        while (m_count <= 56 && m_position < m_size)
+        {
+            m_accumulator |= uint64_t(m_data[m_position++]) << m_count;
+            m_count += 8;
+        }
+    }
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_position = 0;
+    uint64_t m_accumulator = 0;
+    uint32_t m_count = 0; // valid bits in m_accumulator
+    bool m_overrun = false;
+};
+
+class LargePositionCodec
+{
+  public:
+    inline static constexpr uint32_t MAX_LOCAL_BITS = 23;
+
+    explicit LargePositionCodec(uint32_t local_bits = 16)
+        : m_local_bits(local_bits)
+        , m_step(LargePosition::CELL_SIZE / float(uint32_t(1) << local_bits))
+    {
+        assert(local_bits >= 1 && local_bits <= MAX_LOCAL_BITS && "local_bits must be within [1, MAX_LOCAL_BITS]");
+    }
+
+    // The coarsest encoding whose rounding error (half a step) is at most `precision`, limited to MAX_LOCAL_BITS
+    static LargePositionCodec with_precision(float precision)
+    {
+        uint32_t bits = 1;
+        while (bits < MAX_LOCAL_BITS && LargePosition::CELL_SIZE / float(uint32_t(1) << bits) * 0.5f > precision)
+        {
+            bits++;
+        }
+        return LargePositionCodec(bits);
+    }
+
+    uint32_t local_bits() const { return m_local_bits; }
+    float step() const { return m_step; }
+
+    // Quantized world coordinates (cell * 2^local_bits + fraction) of `pos`
+    longlong3 quantize(const LargePosition& pos) const
+    {
+        return longlong3(quantize_axis(pos.global.x, pos.local.x), quantize_axis(pos.global.y, pos.local.y),
+                         quantize_axis(pos.global.z, pos.local.z));
+    }
+
+    // The canonical position on the quantization grid
+    LargePosition dequantize(const longlong3& q) const
+    {
+        LargePosition pos;
+        dequantize_axis(q.x, pos.global.x, pos.local.x);
+        dequantize_axis(q.y, pos.global.y, pos.local.y);
+        dequantize_axis(q.z, pos.global.z, pos.local.z);
+        return pos;
+    }
+
+    // Appends `count` positions to `out`. `baselines` are the values last acknowledged by the receiver, one per
+    // position, or nullptr for a keyframe. The quantized values are written to `sent` (count elements).
+    void encode(const int3& reference, const PositionLanes& positions, size_t count, const longlong3* baselines, LargeBitWriter& out,
+                longlong3* sent) const
+    {
+        using namespace large_coordinates_detail;
+        for (size_t i = 0; i < count; i++)
+        {
+            sent[i] = longlong3(quantize_axis(positions.global_x[i], positions.local_x[i]),
+                                quantize_axis(positions.global_y[i], positions.local_y[i]),
+                                quantize_axis(positions.global_z[i], positions.local_z[i]));
+        }
+
+        out.write_bit(baselines != nullptr);
+        if (!baselines)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                write_full(reference, sent[i], out);
+            }
+            return;
+        }
+
+        const uint32_t k = delta_order(sent, baselines, count);
+        out.write(k, 5);
+        for (size_t i = 0; i < count; i++)
+        {
+            const longlong3 d = sent[i] - baselines[i];
+            const uint64_t dx = zigzag_encode(d.x), dy = zigzag_encode(d.y), dz = zigzag_encode(d.z);
+            const uint32_t delta_bits = exp_golomb_bits(dx, k) + exp_golomb_bits(dy, k) + exp_golomb_bits(dz, k);
+            const uint32_t full_bits = exp_golomb_bits(zigzag_encode(cell_of(sent[i].x) - reference.x), 0) +
+                                       exp_golomb_bits(zigzag_encode(cell_of(sent[i].y) - reference.y), 0) +
+                                       exp_golomb_bits(zigzag_encode(cell_of(sent[i].z) - reference.z), 0) + 3 * m_local_bits;
+            const bool delta = delta_bits <= full_bits;
+            out.write_bit(delta);
+            if (delta)
+            {
+                out.write_exp_golomb(dx, k);
+                out.write_exp_golomb(dy, k);
+                out.write_exp_golomb(dz, k);
+            }
+            else
+            {
+                write_full(reference, sent[i], out);
+            }
+        }
+    }
+
+    // Decodes `count` positions written by encode() with the same reference, baselines and local_bits into `out`, and
+    // the quantized values into `received`. Returns false on truncated or corrupt input (`out` is then unspecified).
+    bool decode(LargeBitReader& in, const int3& reference, const longlong3* baselines, size_t count, const MutablePositionLanes& out,
+                longlong3* received) const
+    {
+        using namespace large_coordinates_detail;
+        if (in.read_bit() != (baselines != nullptr))
+        {
+            return false;
+        }
+        const uint32_t k = baselines ? uint32_t(in.read(5)) : 0;
+        for (size_t i = 0; i < count && in.ok(); i++)
+        {
+            longlong3 q;
+            if (baselines && in.read_bit())
+            {
+                q.x = baselines[i].x + zigzag_decode(in.read_exp_golomb(k));
+                q.y = baselines[i].y + zigzag_decode(in.read_exp_golomb(k));
+                q.z = baselines[i].z + zigzag_decode(in.read_exp_golomb(k));
+            }
+            else if (!read_full(reference, in, q))
+            {
+                return false;
+            }
+            if (!cell_in_range(q.x) || !cell_in_range(q.y) || !cell_in_range(q.z))
+            {
+                return false;
+            }
+
+            received[i] = q;
+            dequantize_axis(q.x, out.global_x[i], out.local_x[i]);
+            dequantize_axis(q.y, out.global_y[i], out.local_y[i]);
+            dequantize_axis(q.z, out.global_z[i], out.local_z[i]);
+        }
+        return in.ok();
+    }
+
+  private:
+    int64_t quantize_axis(int32_t cell, float local) const
+    {
+        // Offsets from the cell corner in steps: the scale is a power of two and +0.5 exact, so this is a
+        // deterministic round half up
+        const double steps = std::floor((double(local) + double(LargePosition::CELL_SIZE) * 0.5) / double(m_step) + 0.5);
+        return int64_t(cell) * (int64_t(1) << m_local_bits) + int64_t(steps);
+    }
+
+    void dequantize_axis(int64_t q, int32_t& cell, float& local) const
+    {
+        cell = int32_t(cell_of(q));
+        // Exact: the fraction has at most 23 significant bits and the result is a multiple of the step
+        local = float(q & ((int64_t(1) << m_local_bits) - 1)) * m_step - LargePosition::CELL_SIZE * 0.5f;
+    }
+
+    int64_t cell_of(int64_t q) const { return q >> m_local_bits; }
+
+    static bool cell_fits(int64_t cell)
+    {
+        return cell >= std::numeric_limits<int32_t>::min() && cell <= std::numeric_limits<int32_t>::max();
+    }
+
+    bool cell_in_range(int64_t q) const { return cell_fits(cell_of(q)); }
+
+    void write_full(const int3& reference, const longlong3& q, LargeBitWriter& out) const
+    {
+        using namespace large_coordinates_detail;
+        const uint64_t fraction_mask = (uint64_t(1) << m_local_bits) - 1;
+        out.write_exp_golomb(zigzag_encode(cell_of(q.x) - reference.x), 0);
+        out.write_exp_golomb(zigzag_encode(cell_of(q.y) - reference.y), 0);
+        out.write_exp_golomb(zigzag_encode(cell_of(q.z) - reference.z), 0);
+        out.write(uint64_t(q.x) & fraction_mask, m_local_bits);
+        out.write(uint64_t(q.y) & fraction_mask, m_local_bits);
+        out.write(uint64_t(q.z) & fraction_mask, m_local_bits);
+    }
+
+    // Fails on cells outside the int32_t range: corrupt deltas decode to up to +/-2^61, which must not be scaled
+    bool read_full(const int3& reference, LargeBitReader& in, longlong3& q) const
+    {
+        using namespace large_coordinates_detail;
+        const int64_t cx = reference.x + zigzag_decode(in.read_exp_golomb(0));
+        const int64_t cy = reference.y + zigzag_decode(in.read_exp_golomb(0));
+        const int64_t cz = reference.z + zigzag_decode(in.read_exp_golomb(0));
+        if (!cell_fits(cx) || !cell_fits(cy) || !cell_fits(cz))
+        {
+            return false;
+        }
+        const int64_t scale = int64_t(1) << m_local_bits;
+        const int64_t fx = int64_t(in.read(m_local_bits));
+        const int64_t fy = int64_t(in.read(m_local_bits));
+        const int64_t fz = int64_t(in.read(m_local_bits));
+        q = longlong3(cx * scale + fx, cy * scale + fy, cz * scale + fz);
+        return true;
+    }
+
+    // Exponential-Golomb order with the shortest total length for the deltas of a batch, estimated from a histogram
+    // of their bit widths, so a few teleports don't inflate the codes of every small movement
+    static uint32_t delta_order(const longlong3* values, const longlong3* baselines, size_t count)
+    {
+        using namespace large_coordinates_detail;
+        size_t histogram[65] = {};
+        for (size_t i = 0; i < count; i++)
+        {
+            const longlong3 d = values[i] - baselines[i];
+            histogram[bit_width64(zigzag_encode(d.x))]++;
+            histogram[bit_width64(zigzag_encode(d.y))]++;
+            histogram[bit_width64(zigzag_encode(d.z))]++;
+        }
+
+        // A value of width w needs n = max(w - 1, k) bits after the prefix (exact up to one bit), 2n - k + 1 in total
+        uint32_t best_k = 0;
+        uint64_t best_bits = ~uint64_t(0);
+        for (uint32_t k = 0; k < 32; k++)
+        {
+            uint64_t bits = 0;
+            for (uint32_t w = 0; w <= 64; w++)
+            {
+                const uint32_t n = std::max(w > 0 ? w - 1 : 0, k);
+                bits += uint64_t(histogram[w]) * (2 * n - k + 1);
+            }
+            if (bits < best_bits)
+            {
+                best_bits = bits;
+                best_k = k;
+            }
+        }
+        return best_k;
+    }
+
+    uint32_t m_local_bits;
+    float m_step;
+};
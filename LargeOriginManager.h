@@ -0,0 +1,140 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargePositionBuffer.h"
+#include <vector>
+
+/*
+
+LargeOriginManager keeps the camera-relative float3 of every object for the shared-origin rendering path.
+
+Instead of calling to_float3(camera.global) for every object every frame, the manager caches the results and
+recomputes them only when needed:
+
+  - an object moved (set_position): only that object is refreshed by the next update()
+  - the origin moved to another cell (set_origin): every object is refreshed in one vectorized pass (batch_to_float3)
+  - the camera moved within its cell: nothing is recomputed
+
+An origin shift is applied as an integer cell delta inside the vector pass (local + (global - origin) * CELL_SIZE)
+rather than by adding delta * CELL_SIZE to the cached floats: the latter would round twice and lose precision
+near the camera every time the origin moves. Cached values are always bit-identical to to_float3(origin).
+
+Like to_float3(), every object must stay within 3 cells of the origin.
+
+*/
+class LargeOriginManager
+{
+  public:
+    explicit LargeOriginManager(const int3& origin = int3(0, 0, 0))
+        : m_origin(origin)
+        , m_cached_origin(origin)
+    {
+    }
+
+    size_t size() const { return m_positions.size(); }
+    const int3& origin() const { return m_origin; }
+
+    // Objects waiting to be refreshed by the next update()
+    size_t dirty_count() const { return m_dirty.size(); }
+
+    uint32_t add(const LargePosition& pos)
+    {
+        uint32_t index = uint32_t(m_positions.size());
+        m_positions.push_back(pos);
+        m_relative_x.push_back(0.0f);
+        m_relative_y.push_back(0.0f);
+        m_relative_z.push_back(0.0f);
+        m_dirty_flags.push_back(0);
+        mark_dirty(index);
+        return index;
+    }
+
+    void clear()
+    {
+        m_positions.clear();
+        m_relative_x.clear();
+        m_relative_y.clear();
+        m_relative_z.clear();
+        m_dirty_flags.clear();
+        m_dirty.clear();
+    }
+
+    LargePosition position(uint32_t index) const { return m_positions.get(index); }
+
+    void set_position(uint32_t index, const LargePosition& pos)
+    {
+        m_positions.set(index, pos);
+        mark_dirty(index);
+    }
+
+    void set_positions(const uint32_t* indices, const LargePosition* positions, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            set_position(indices[i], positions[i]);
+        }
+    }
+
+    // Takes effect on the next update(); moving within the current cell costs nothing
+    void set_origin(const int3& origin) { m_origin = origin; }
+
+    // Brings the cached values up to date, returns the number of objects that were recomputed
+    size_t update()
+    {
+        const size_t count = m_positions.size();
+
+        // Past this point one streaming vector pass beats refreshing scattered objects one by one
+        const bool full_pass = m_cached_origin != m_origin || m_dirty.size() * 4 > count;
+        if (full_pass)
+        {
+            batch_to_float3(m_origin, m_positions.lanes(), Float3Lanes{m_relative_x.data(), m_relative_y.data(), m_relative_z.data()},
+                            count);
+            m_cached_origin = m_origin;
+        }
+        else
+        {
+            for (uint32_t index : m_dirty)
+            {
+                float3 relative = m_positions.get(index).to_float3(m_origin);
+                m_relative_x[index] = relative.x;
+                m_relative_y[index] = relative.y;
+                m_relative_z[index] = relative.z;
+            }
+        }
+
+        size_t recomputed = full_pass ? count : m_dirty.size();
+        for (uint32_t index : m_dirty)
+        {
+            m_dirty_flags[index] = 0;
+        }
+        m_dirty.clear();
+        return recomputed;
+    }
+
+    // Camera-relative position as of the last update()
+    float3 relative(uint32_t index) const { return float3(m_relative_x[index], m_relative_y[index], m_relative_z[index]); }
+
+    ConstFloat3Lanes relative_lanes() const { return ConstFloat3Lanes{m_relative_x.data(), m_relative_y.data(), m_relative_z.data()}; }
+
+    const LargePositionBuffer& positions() const { return m_positions; }
+
+  private:
+    void mark_dirty(uint32_t index)
+    {
+        if (!m_dirty_flags[index])
+        {
+            m_dirty_flags[index] = 1;
+            m_dirty.push_back(index);
+        }
+    }
+
+    LargePositionBuffer m_positions;
+    std::vector<float> m_relative_x;
+    std::vector<float> m_relative_y;
+    std::vector<float> m_relative_z;
+    std::vector<uint8_t> m_dirty_flags;
+    std::vector<uint32_t> m_dirty;
+    int3 m_origin;
+    int3 m_cached_origin;
+};
@@ -0,0 +1,467 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include <cassert>
+#include <cmath>
+
+/*
+
+LargePackedPosition stores a LargePosition in 16 bytes instead of 24, for entity tables and storage that are
+bandwidth bound. Four packed positions fill a cache line exactly.
+
+Every axis is a 42-bit fixed-point coordinate in steps of LOCAL_STEP (2^-11, half the typical precision):
+
+  bits 22..41  cell index relative to an origin cell (signed, 20 bits: +/-2^19 cells, about +/-1.07e9 meters)
+  bits  0..21  (local + CELL_SIZE/2) / LOCAL_STEP, so the unpacked local is always in [-CELL_SIZE/2, CELL_SIZE/2)
+
+The bits 10..41 of x, y and z live in words[0..2] and the low 10 bits of all three axes share words[3], so the cell
+of an axis is a single arithmetic shift of its word. Packing rounds the local offset to the nearest step, which keeps
+the round trip within TYPICAL_PRECISION. Unpacking is exact, and pack(unpack(p)) == p.
+
+Cells are stored relative to an origin cell (like to_float3), so worlds larger than the 20-bit cell range can be
+packed region by region. Hysteresis-extended locals are folded into the neighboring cell while packing.
+
+batch_pack() and batch_unpack() convert between packed arrays and SoA lanes with SIMD, four positions per SSE
+vector, eight per AVX2 vector and sixteen per AVX-512 vector, bit-identical to the scalar methods.
+
+*/
+struct LargePackedPosition
+{
+    inline static constexpr int32_t LOCAL_BITS = 22;
+    inline static constexpr int32_t CELL_BITS = 20;
+    inline static constexpr int32_t MIN_CELL = -(int32_t(1) << (CELL_BITS - 1));
+    inline static constexpr int32_t MAX_CELL = (int32_t(1) << (CELL_BITS - 1)) - 1;
+    inline static constexpr float LOCAL_STEP = LargePosition::CELL_SIZE / float(int32_t(1) << LOCAL_BITS);
+    inline static constexpr float STEPS_PER_UNIT = float(int32_t(1) << LOCAL_BITS) / LargePosition::CELL_SIZE;
+
+    // Rounding to the nearest step errs by at most half a step
+    static_assert(LOCAL_STEP * 0.5f == LargePosition::TYPICAL_PRECISION, "The packed round trip must stay within TYPICAL_PRECISION");
+
+    uint32_t words[4];
+
+    // Packs `pos` with its cell relative to `origin`; the relative cell must be within [MIN_CELL, MAX_CELL]
+    static LargePackedPosition pack(const LargePosition& pos, const int3& origin = int3())
+    {
+        LargePackedPosition packed;
+        uint32_t low = 0;
+        pack_axis(pos.global.x, pos.local.x, origin.x, packed.words[0], low, 0);
+        pack_axis(pos.global.y, pos.local.y, origin.y, packed.words[1], low, 10);
+        pack_axis(pos.global.z, pos.local.z, origin.z, packed.words[2], low, 20);
+        packed.words[3] = low;
+        return packed;
+    }
+
+    // The canonical position stored in this value, with cells relative to `origin`
+    LargePosition unpack(const int3& origin = int3()) const
+    {
+        LargePosition pos;
+        unpack_axis(words[0], words[3], origin.x, pos.global.x, pos.local.x);
+        unpack_axis(words[1], words[3] >> 10, origin.y, pos.global.y, pos.local.y);
+        unpack_axis(words[2], words[3] >> 20, origin.z, pos.global.z, pos.local.z);
+        return pos;
+    }
+
+    bool operator==(const LargePackedPosition& other) const
+    {
+        return words[0] == other.words[0] && words[1] == other.words[1] && words[2] == other.words[2] && words[3] == other.words[3];
+    }
+    bool operator!=(const LargePackedPosition& other) const { return !(*this == other); }
+
+  private:
+    static void pack_axis(int32_t global, float local, int32_t origin, uint32_t& high, uint32_t& low, int shift)
+    {
+        // local * STEPS_PER_UNIT is exact (power of two scale); lrint rounds to nearest even like the SIMD conversion
+        int32_t steps = int32_t(std::lrint(local * STEPS_PER_UNIT)) + (int32_t(1) << (LOCAL_BITS - 1));
+        int32_t cell = global - origin + (steps >> LOCAL_BITS);
+        assert(cell >= MIN_CELL && cell <= MAX_CELL && "Cell is out of the packed range, pack relative to a closer origin");
+        uint32_t fraction = uint32_t(steps) & ((uint32_t(1) << LOCAL_BITS) - 1);
+        high = (uint32_t(cell) << (32 - CELL_BITS)) | (fraction >> 10);
+        low |= (fraction & 0x3ff) << shift;
+    }
+
+    static void unpack_axis(uint32_t high, uint32_t low, int32_t origin, int32_t& global, float& local)
+    {
+        global = (int32_t(high) >> (32 - CELL_BITS)) + origin;
+        uint32_t fraction = ((high & 0xfff) << 10) | (low & 0x3ff);
+        local = float(int32_t(fraction)) * LOCAL_STEP - LargePosition::CELL_SIZE * 0.5f;
+    }
+};
+
+static_assert(sizeof(LargePackedPosition) == 16, "LargePackedPosition must stay 16 bytes");
+
+namespace large_coordinates_detail
+{
+
+inline void pack_scalar(const int3& origin, const PositionLanes& src, LargePackedPosition* dst, size_t first, size_t count)
+{
+    for (size_t i = first; i < count; i++)
+    {
+        LargePosition pos;
+        pos.global = int3(src.global_x[i], src.global_y[i], src.global_z[i]);
+        pos.local = float3(src.local_x[i], src.local_y[i], src.local_z[i]);
+        dst[i] = LargePackedPosition::pack(pos, origin);
+    }
+}
+
+inline void unpack_scalar(const int3& origin, const LargePackedPosition* src, const MutablePositionLanes& dst, size_t first, size_t count)
+{
+    for (size_t i = first; i < count; i++)
+    {
+        LargePosition pos = src[i].unpack(origin);
+        dst.global_x[i] = pos.global.x;
+        dst.global_y[i] = pos.global.y;
+        dst.global_z[i] = pos.global.z;
+        dst.local_x[i] = pos.local.x;
+        dst.local_y[i] = pos.local.y;
+        dst.local_z[i] = pos.local.z;
+    }
+}
+
+#if LARGE_COORDINATES_X86
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// The vector kernels transpose 4x4 blocks of 32-bit words (within each 128-bit lane) between the packed layout
+// [x, y, z, low] and x / y / z / low vectors, then apply the scalar bit operations lane by lane.
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void transpose4_sse42(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    __m128i t0 = _mm_unpacklo_epi32(a, b);
+    __m128i t1 = _mm_unpacklo_epi32(c, d);
+    __m128i t2 = _mm_unpackhi_epi32(a, b);
+    __m128i t3 = _mm_unpackhi_epi32(c, d);
+    a = _mm_unpacklo_epi64(t0, t1);
+    b = _mm_unpackhi_epi64(t0, t1);
+    c = _mm_unpacklo_epi64(t2, t3);
+    d = _mm_unpackhi_epi64(t2, t3);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128i pack_axis_sse42(const int32_t* global, const float* local, __m128i origin, int shift, __m128i& low)
+{
+    __m128i steps = _mm_add_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(local), _mm_set1_ps(LargePackedPosition::STEPS_PER_UNIT))),
+                                  _mm_set1_epi32(int32_t(1) << (LargePackedPosition::LOCAL_BITS - 1)));
+    __m128i cell = _mm_add_epi32(_mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(global)), origin),
+                                 _mm_srai_epi32(steps, LargePackedPosition::LOCAL_BITS));
+#ifndef NDEBUG
+    __m128i out_of_range = _mm_or_si128(_mm_cmplt_epi32(cell, _mm_set1_epi32(LargePackedPosition::MIN_CELL)),
+                                        _mm_cmpgt_epi32(cell, _mm_set1_epi32(LargePackedPosition::MAX_CELL)));
+    assert(_mm_movemask_epi8(out_of_range) == 0 && "Cell is out of the packed range, pack relative to a closer origin");
+#endif
+    __m128i fraction = _mm_and_si128(steps, _mm_set1_epi32((int32_t(1) << LargePackedPosition::LOCAL_BITS) - 1));
+    low = _mm_or_si128(low, _mm_sll_epi32(_mm_and_si128(fraction, _mm_set1_epi32(0x3ff)), _mm_cvtsi32_si128(shift)));
+    return _mm_or_si128(_mm_slli_epi32(cell, 32 - LargePackedPosition::CELL_BITS), _mm_srli_epi32(fraction, 10));
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void unpack_axis_sse42(__m128i high, __m128i low, __m128i origin, int32_t* global, float* local)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(global), _mm_add_epi32(_mm_srai_epi32(high, 32 - LargePackedPosition::CELL_BITS), origin));
+    __m128i fraction_high = _mm_slli_epi32(_mm_and_si128(high, _mm_set1_epi32(0xfff)), 10);
+    __m128i fraction = _mm_or_si128(fraction_high, _mm_and_si128(low, _mm_set1_epi32(0x3ff)));
+    _mm_storeu_ps(local, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(fraction), _mm_set1_ps(LargePackedPosition::LOCAL_STEP)),
+                                    _mm_set1_ps(LargePosition::CELL_SIZE * 0.5f)));
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void pack_sse42(const int3& origin, const PositionLanes& src, LargePackedPosition* dst, size_t count)
+{
+    const __m128i ox = _mm_set1_epi32(origin.x);
+    const __m128i oy = _mm_set1_epi32(origin.y);
+    const __m128i oz = _mm_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i low = _mm_setzero_si128();
+        __m128i x = pack_axis_sse42(src.global_x + i, src.local_x + i, ox, 0, low);
+        __m128i y = pack_axis_sse42(src.global_y + i, src.local_y + i, oy, 10, low);
+        __m128i z = pack_axis_sse42(src.global_z + i, src.local_z + i, oz, 20, low);
+        transpose4_sse42(x, y, z, low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 1), y);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 2), z);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 3), low);
+    }
+    pack_scalar(origin, src, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void unpack_sse42(const int3& origin, const LargePackedPosition* src, const MutablePositionLanes& dst, size_t count)
+{
+    const __m128i ox = _mm_set1_epi32(origin.x);
+    const __m128i oy = _mm_set1_epi32(origin.y);
+    const __m128i oz = _mm_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 1));
+        __m128i z = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 2));
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 3));
+        transpose4_sse42(x, y, z, low);
+        unpack_axis_sse42(x, low, ox, dst.global_x + i, dst.local_x + i);
+        unpack_axis_sse42(y, _mm_srli_epi32(low, 10), oy, dst.global_y + i, dst.local_y + i);
+        unpack_axis_sse42(z, _mm_srli_epi32(low, 20), oz, dst.global_z + i, dst.local_z + i);
+    }
+    unpack_scalar(origin, src, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void transpose4_avx2(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(a, b);
+    __m256i t1 = _mm256_unpacklo_epi32(c, d);
+    __m256i t2 = _mm256_unpackhi_epi32(a, b);
+    __m256i t3 = _mm256_unpackhi_epi32(c, d);
+    a = _mm256_unpacklo_epi64(t0, t1);
+    b = _mm256_unpackhi_epi64(t0, t1);
+    c = _mm256_unpacklo_epi64(t2, t3);
+    d = _mm256_unpackhi_epi64(t2, t3);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256i pack_axis_avx2(const int32_t* global, const float* local, __m256i origin, int shift, __m256i& low)
+{
+    __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(local), _mm256_set1_ps(LargePackedPosition::STEPS_PER_UNIT));
+    __m256i steps = _mm256_add_epi32(_mm256_cvtps_epi32(scaled), _mm256_set1_epi32(int32_t(1) << (LargePackedPosition::LOCAL_BITS - 1)));
+    __m256i cell = _mm256_add_epi32(_mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(global)), origin),
+                                    _mm256_srai_epi32(steps, LargePackedPosition::LOCAL_BITS));
+#ifndef NDEBUG
+    __m256i out_of_range = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(LargePackedPosition::MIN_CELL), cell),
+                                           _mm256_cmpgt_epi32(cell, _mm256_set1_epi32(LargePackedPosition::MAX_CELL)));
+    assert(_mm256_movemask_epi8(out_of_range) == 0 && "Cell is out of the packed range, pack relative to a closer origin");
+#endif
+    __m256i fraction = _mm256_and_si256(steps, _mm256_set1_epi32((int32_t(1) << LargePackedPosition::LOCAL_BITS) - 1));
+    low = _mm256_or_si256(low, _mm256_sll_epi32(_mm256_and_si256(fraction, _mm256_set1_epi32(0x3ff)), _mm_cvtsi32_si128(shift)));
+    return _mm256_or_si256(_mm256_slli_epi32(cell, 32 - LargePackedPosition::CELL_BITS), _mm256_srli_epi32(fraction, 10));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void unpack_axis_avx2(__m256i high, __m256i low, __m256i origin, int32_t* global, float* local)
+{
+    __m256i cell = _mm256_srai_epi32(high, 32 - LargePackedPosition::CELL_BITS);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(global), _mm256_add_epi32(cell, origin));
+    __m256i fraction_high = _mm256_slli_epi32(_mm256_and_si256(high, _mm256_set1_epi32(0xfff)), 10);
+    __m256i fraction = _mm256_or_si256(fraction_high, _mm256_and_si256(low, _mm256_set1_epi32(0x3ff)));
+    _mm256_storeu_ps(local, _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(fraction), _mm256_set1_ps(LargePackedPosition::LOCAL_STEP)),
+                                          _mm256_set1_ps(LargePosition::CELL_SIZE * 0.5f)));
+}
+
+// 128-bit lane 0 holds positions i..i+3 and lane 1 positions i+4..i+7, so the in-lane transpose keeps element order
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256i load_packed_pair_avx2(const LargePackedPosition* lo, const LargePackedPosition* hi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo))),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)), 1);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void store_packed_pair_avx2(LargePackedPosition* lo, LargePackedPosition* hi, __m256i v)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lo), _mm256_castsi256_si128(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(hi), _mm256_extracti128_si256(v, 1));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void pack_avx2(const int3& origin, const PositionLanes& src, LargePackedPosition* dst, size_t count)
+{
+    const __m256i ox = _mm256_set1_epi32(origin.x);
+    const __m256i oy = _mm256_set1_epi32(origin.y);
+    const __m256i oz = _mm256_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i low = _mm256_setzero_si256();
+        __m256i x = pack_axis_avx2(src.global_x + i, src.local_x + i, ox, 0, low);
+        __m256i y = pack_axis_avx2(src.global_y + i, src.local_y + i, oy, 10, low);
+        __m256i z = pack_axis_avx2(src.global_z + i, src.local_z + i, oz, 20, low);
+        transpose4_avx2(x, y, z, low);
+        store_packed_pair_avx2(dst + i, dst + i + 4, x);
+        store_packed_pair_avx2(dst + i + 1, dst + i + 5, y);
+        store_packed_pair_avx2(dst + i + 2, dst + i + 6, z);
+        store_packed_pair_avx2(dst + i + 3, dst + i + 7, low);
+    }
+    pack_scalar(origin, src, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void unpack_avx2(const int3& origin, const LargePackedPosition* src, const MutablePositionLanes& dst, size_t count)
+{
+    const __m256i ox = _mm256_set1_epi32(origin.x);
+    const __m256i oy = _mm256_set1_epi32(origin.y);
+    const __m256i oz = _mm256_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i x = load_packed_pair_avx2(src + i, src + i + 4);
+        __m256i y = load_packed_pair_avx2(src + i + 1, src + i + 5);
+        __m256i z = load_packed_pair_avx2(src + i + 2, src + i + 6);
+        __m256i low = load_packed_pair_avx2(src + i + 3, src + i + 7);
+        transpose4_avx2(x, y, z, low);
+        unpack_axis_avx2(x, low, ox, dst.global_x + i, dst.local_x + i);
+        unpack_axis_avx2(y, _mm256_srli_epi32(low, 10), oy, dst.global_y + i, dst.local_y + i);
+        unpack_axis_avx2(z, _mm256_srli_epi32(low, 20), oz, dst.global_z + i, dst.local_z + i);
+    }
+    unpack_scalar(origin, src, dst, i, count);
+}
+
+// AVX-512 loads four whole positions per register. After the in-lane transpose, element 4 * j + k of a vector
+// belongs to position 4 * k + j; the same permutation (a 4x4 transpose) restores element order in both directions.
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512i transpose_order_avx512() { return _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15); }
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void transpose4_avx512(__m512i& a, __m512i& b, __m512i& c, __m512i& d)
+{
+    __m512i t0 = _mm512_unpacklo_epi32(a, b);
+    __m512i t1 = _mm512_unpacklo_epi32(c, d);
+    __m512i t2 = _mm512_unpackhi_epi32(a, b);
+    __m512i t3 = _mm512_unpackhi_epi32(c, d);
+    a = _mm512_unpacklo_epi64(t0, t1);
+    b = _mm512_unpackhi_epi64(t0, t1);
+    c = _mm512_unpacklo_epi64(t2, t3);
+    d = _mm512_unpackhi_epi64(t2, t3);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512i pack_axis_avx512(const int32_t* global, const float* local, __m512i origin, uint32_t shift, __m512i& low)
+{
+    __m512 scaled = _mm512_mul_ps(_mm512_loadu_ps(local), _mm512_set1_ps(LargePackedPosition::STEPS_PER_UNIT));
+    __m512i steps = _mm512_add_epi32(_mm512_cvtps_epi32(scaled), _mm512_set1_epi32(int32_t(1) << (LargePackedPosition::LOCAL_BITS - 1)));
+    __m512i cell =
+        _mm512_add_epi32(_mm512_sub_epi32(_mm512_loadu_si512(global), origin), _mm512_srai_epi32(steps, LargePackedPosition::LOCAL_BITS));
+#ifndef NDEBUG
+    __mmask16 out_of_range = _mm512_cmplt_epi32_mask(cell, _mm512_set1_epi32(LargePackedPosition::MIN_CELL)) |
+                             _mm512_cmpgt_epi32_mask(cell, _mm512_set1_epi32(LargePackedPosition::MAX_CELL));
+    assert(out_of_range == 0 && "Cell is out of the packed range, pack relative to a closer origin");
+#endif
+    __m512i fraction = _mm512_and_si512(steps, _mm512_set1_epi32((int32_t(1) << LargePackedPosition::LOCAL_BITS) - 1));
+    low = _mm512_or_si512(low, _mm512_sll_epi32(_mm512_and_si512(fraction, _mm512_set1_epi32(0x3ff)), _mm_cvtsi32_si128(int(shift))));
+    return _mm512_or_si512(_mm512_slli_epi32(cell, 32 - LargePackedPosition::CELL_BITS), _mm512_srli_epi32(fraction, 10));
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void unpack_axis_avx512(__m512i high, __m512i low, __m512i origin, int32_t* global, float* local)
+{
+    __m512i cell = _mm512_srai_epi32(high, 32 - LargePackedPosition::CELL_BITS);
+    _mm512_storeu_si512(global, _mm512_add_epi32(cell, origin));
+    __m512i fraction_high = _mm512_slli_epi32(_mm512_and_si512(high, _mm512_set1_epi32(0xfff)), 10);
+    __m512i fraction = _mm512_or_si512(fraction_high, _mm512_and_si512(low, _mm512_set1_epi32(0x3ff)));
+    _mm512_storeu_ps(local, _mm512_sub_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(fraction), _mm512_set1_ps(LargePackedPosition::LOCAL_STEP)),
+                                          _mm512_set1_ps(LargePosition::CELL_SIZE * 0.5f)));
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void pack_avx512(const int3& origin, const PositionLanes& src, LargePackedPosition* dst, size_t count)
+{
+    const __m512i order = transpose_order_avx512();
+    const __m512i ox = _mm512_set1_epi32(origin.x);
+    const __m512i oy = _mm512_set1_epi32(origin.y);
+    const __m512i oz = _mm512_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i low = _mm512_setzero_si512();
+        __m512i x = _mm512_permutexvar_epi32(order, pack_axis_avx512(src.global_x + i, src.local_x + i, ox, 0, low));
+        __m512i y = _mm512_permutexvar_epi32(order, pack_axis_avx512(src.global_y + i, src.local_y + i, oy, 10, low));
+        __m512i z = _mm512_permutexvar_epi32(order, pack_axis_avx512(src.global_z + i, src.local_z + i, oz, 20, low));
+        low = _mm512_permutexvar_epi32(order, low);
+        transpose4_avx512(x, y, z, low);
+        _mm512_storeu_si512(dst + i, x);
+        _mm512_storeu_si512(dst + i + 4, y);
+        _mm512_storeu_si512(dst + i + 8, z);
+        _mm512_storeu_si512(dst + i + 12, low);
+    }
+    pack_scalar(origin, src, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void unpack_avx512(const int3& origin, const LargePackedPosition* src, const MutablePositionLanes& dst, size_t count)
+{
+    const __m512i order = transpose_order_avx512();
+    const __m512i ox = _mm512_set1_epi32(origin.x);
+    const __m512i oy = _mm512_set1_epi32(origin.y);
+    const __m512i oz = _mm512_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i x = _mm512_loadu_si512(src + i);
+        __m512i y = _mm512_loadu_si512(src + i + 4);
+        __m512i z = _mm512_loadu_si512(src + i + 8);
+        __m512i low = _mm512_loadu_si512(src + i + 12);
+        transpose4_avx512(x, y, z, low);
+        x = _mm512_permutexvar_epi32(order, x);
+        y = _mm512_permutexvar_epi32(order, y);
+        z = _mm512_permutexvar_epi32(order, z);
+        low = _mm512_permutexvar_epi32(order, low);
+        unpack_axis_avx512(x, low, ox, dst.global_x + i, dst.local_x + i);
+        unpack_axis_avx512(y, _mm512_srli_epi32(low, 10), oy, dst.global_y + i, dst.local_y + i);
+        unpack_axis_avx512(z, _mm512_srli_epi32(low, 20), oz, dst.global_z + i, dst.local_z + i);
+    }
+    unpack_scalar(origin, src, dst, i, count);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // LARGE_COORDINATES_X86
+
+} // namespace large_coordinates_detail
+
+// dst[i] = LargePackedPosition::pack(src[i], origin), bit-identical to the scalar method
+inline void batch_pack(const int3& origin, const PositionLanes& src, LargePackedPosition* dst, size_t count)
+{
+    using namespace large_coordinates_detail;
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        pack_avx512(origin, src, dst, count);
+        return;
+    case SimdLevel::AVX2:
+        pack_avx2(origin, src, dst, count);
+        return;
+    case SimdLevel::SSE42:
+        pack_sse42(origin, src, dst, count);
+        return;
+#endif
+    default:
+        pack_scalar(origin, src, dst, 0, count);
+        return;
+    }
+}
+
+// dst[i] = src[i].unpack(origin), bit-identical to the scalar method
+inline void batch_unpack(const int3& origin, const LargePackedPosition* src, const MutablePositionLanes& dst, size_t count)
+{
+    using namespace large_coordinates_detail;
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        unpack_avx512(origin, src, dst, count);
+        return;
+    case SimdLevel::AVX2:
+        unpack_avx2(origin, src, dst, count);
+        return;
+    case SimdLevel::SSE42:
+        unpack_sse42(origin, src, dst, count);
+        return;
+#endif
+    default:
+        unpack_scalar(origin, src, dst, 0, count);
+        return;
+    }
+}
@@ -0,0 +1,1054 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#if !defined(LARGE_COORDINATES_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define LARGE_COORDINATES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC exposes every intrinsic without per-function target flags
+#define LARGE_COORDINATES_TARGET(isa)
+#else
+#define LARGE_COORDINATES_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define LARGE_COORDINATES_X86 0
+#endif
+
+/*
+
+Batch (SIMD) versions of the LargePosition conversions.
+
+The kernels operate on structure-of-arrays lanes (see LargePositionBuffer) and produce results that are
+bit-identical to the scalar LargePosition methods. The instruction set is selected at runtime:
+
+  AVX-512 (16 lanes) -> AVX2 (8 lanes) -> SSE4.2 (4 lanes) -> scalar
+
+Define LARGE_COORDINATES_NO_SIMD to compile the scalar path only. Non-x86 targets always use the scalar path.
+
+*/
+
+enum class SimdLevel : int
+{
+    Scalar = 0,
+    SSE42 = 1,
+    AVX2 = 2,
+    AVX512 = 3,
+};
+
+// Read-only view of LargePosition components stored as separate lanes
+struct PositionLanes
+{
+    const int32_t* global_x;
+    const int32_t* global_y;
+    const int32_t* global_z;
+    const float* local_x;
+    const float* local_y;
+    const float* local_z;
+};
+
+// Output view of float3 values stored as separate lanes
+struct Float3Lanes
+{
+    float* x;
+    float* y;
+    float* z;
+};
+
+// Writable view of LargePosition components stored as separate lanes
+struct MutablePositionLanes
+{
+    int32_t* global_x;
+    int32_t* global_y;
+    int32_t* global_z;
+    float* local_x;
+    float* local_y;
+    float* local_z;
+};
+
+// Input view of float3 values stored as separate lanes
+struct ConstFloat3Lanes
+{
+    const float* x;
+    const float* y;
+    const float* z;
+};
+
+namespace large_coordinates_detail
+{
+
+inline SimdLevel detect_simd_level()
+{
+#if LARGE_COORDINATES_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    int max_leaf = regs[0];
+
+    __cpuid(regs, 1);
+    bool sse42 = (regs[2] & (1 << 20)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!sse42)
+    {
+        return SimdLevel::Scalar;
+    }
+    if (!osxsave || !avx || max_leaf < 7)
+    {
+        return SimdLevel::SSE42;
+    }
+
+    // The OS must save YMM (bits 1-2) and ZMM/opmask (bits 5-7) state on context switches
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(regs, 7, 0);
+    bool avx2 = (regs[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    bool avx512 = (regs[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+#else
+    __builtin_cpu_init();
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+    if (!sse42)
+    {
+        return SimdLevel::Scalar;
+    }
+#endif
+    if (avx512 && avx2)
+    {
+        return SimdLevel::AVX512;
+    }
+    return avx2 ? SimdLevel::AVX2 : SimdLevel::SSE42;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+inline std::atomic<int>& active_simd_level()
+{
+    static std::atomic<int> level((int)detect_simd_level());
+    return level;
+}
+
+// GCC contracts a * b + c into an FMA whenever FMA instructions are available (-mfma, -march=native, avx512f
+// kernels), across statements and through the SSE/AVX intrinsics, and it fuses different products in the scalar and
+// the vector form of the same formula. Kernels that promise bit-identical results pass every product that feeds an
+// add through unfused(): the empty asm hides the value from the optimizer, so the product is rounded on its own. It
+// costs no instructions. MSVC only contracts under /fp:contract or /fp:fast.
+inline float unfused(float v)
+{
+#if LARGE_COORDINATES_X86 && defined(__GNUC__) && defined(__SSE__)
+    __asm__("" : "+x"(v));
+#endif
+    return v;
+}
+
+#if LARGE_COORDINATES_X86
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128 unfused(__m128 v)
+{
+#if defined(__GNUC__)
+    __asm__("" : "+x"(v));
+#endif
+    return v;
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256 unfused(__m256 v)
+{
+#if defined(__GNUC__)
+    __asm__("" : "+x"(v));
+#endif
+    return v;
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512 unfused(__m512 v)
+{
+#if defined(__GNUC__)
+    __asm__("" : "+v"(v));
+#endif
+    return v;
+}
+
+#endif // LARGE_COORDINATES_X86
+
+inline void to_float3_scalar(const int3& origin, const PositionLanes& src, const Float3Lanes& dst, size_t first, size_t count)
+{
+    constexpr float cell_size = LargePosition::CELL_SIZE;
+    for (size_t i = first; i < count; i++)
+    {
+        float x = src.local_x[i] + (src.global_x[i] - origin.x) * cell_size;
+        float y = src.local_y[i] + (src.global_y[i] - origin.y) * cell_size;
+        float z = src.local_z[i] + (src.global_z[i] - origin.z) * cell_size;
+
+        assert(std::abs(x) <= cell_size * 3.0f && "The distance to the provided origin is too large to be represented as a float3.");
+        assert(std::abs(y) <= cell_size * 3.0f && "The distance to the provided origin is too large to be represented as a float3.");
+        assert(std::abs(z) <= cell_size * 3.0f && "The distance to the provided origin is too large to be represented as a float3.");
+
+        dst.x[i] = x;
+        dst.y[i] = y;
+        dst.z[i] = z;
+    }
+}
+
+inline void set_changed_bit(uint64_t* changed_mask, size_t index)
+{
+    if (changed_mask)
+    {
+        changed_mask[index / 64] |= uint64_t(1) << (index % 64);
+    }
+}
+
+// Vector widths are powers of two <= 64 and vectors start at multiples of the width, so they never straddle a mask word
+inline size_t store_changed_bits(uint64_t* changed_mask, size_t first, uint32_t bits)
+{
+    if (changed_mask)
+    {
+        changed_mask[first / 64] |= uint64_t(bits) << (first % 64);
+    }
+
+    size_t changed = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        changed++;
+    }
+    return changed;
+}
+
+inline size_t from_float3_scalar(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t first, size_t count,
+                                 uint64_t* changed_mask)
+{
+    size_t changed = 0;
+    for (size_t i = first; i < count; i++)
+    {
+        int3 origin(dst.global_x[i], dst.global_y[i], dst.global_z[i]);
+
+        LargePosition pos;
+        pos.from_float3(origin, float3(local_pos.x[i], local_pos.y[i], local_pos.z[i]));
+
+        dst.global_x[i] = pos.global.x;
+        dst.global_y[i] = pos.global.y;
+        dst.global_z[i] = pos.global.z;
+        dst.local_x[i] = pos.local.x;
+        dst.local_y[i] = pos.local.y;
+        dst.local_z[i] = pos.local.z;
+
+        if (pos.global != origin)
+        {
+            set_changed_bit(changed_mask, i);
+            changed++;
+        }
+    }
+    return changed;
+}
+
+inline void from_double3_scalar(const double3* values, const MutablePositionLanes& dst, size_t first, size_t count)
+{
+    for (size_t i = first; i < count; i++)
+    {
+        LargePosition pos(values[i]);
+        dst.global_x[i] = pos.global.x;
+        dst.global_y[i] = pos.global.y;
+        dst.global_z[i] = pos.global.z;
+        dst.local_x[i] = pos.local.x;
+        dst.local_y[i] = pos.local.y;
+        dst.local_z[i] = pos.local.z;
+    }
+}
+
+inline size_t canonicalize_scalar(const MutablePositionLanes& dst, size_t first, size_t count, uint64_t* changed_mask)
+{
+    constexpr float high = LargePosition::CELL_SIZE * 0.5f;
+    constexpr float low = -high;
+    size_t changed = 0;
+    for (size_t i = first; i < count; i++)
+    {
+        // Canonical positions are the common case
+        if (dst.local_x[i] >= low && dst.local_x[i] < high && dst.local_y[i] >= low && dst.local_y[i] < high && dst.local_z[i] >= low &&
+            dst.local_z[i] < high)
+        {
+            continue;
+        }
+
+        // Fields are assigned directly: the constructor would apply from_float3() hysteresis
+        LargePosition pos;
+        pos.global = int3(dst.global_x[i], dst.global_y[i], dst.global_z[i]);
+        pos.local = float3(dst.local_x[i], dst.local_y[i], dst.local_z[i]);
+        const LargePosition canonical = pos.canonical();
+        if (canonical.global == pos.global)
+        {
+            continue;
+        }
+
+        dst.global_x[i] = canonical.global.x;
+        dst.global_y[i] = canonical.global.y;
+        dst.global_z[i] = canonical.global.z;
+        dst.local_x[i] = canonical.local.x;
+        dst.local_y[i] = canonical.local.y;
+        dst.local_z[i] = canonical.local.z;
+        set_changed_bit(changed_mask, i);
+        changed++;
+    }
+    return changed;
+}
+
+#if LARGE_COORDINATES_X86
+
+// GCC reports false positives for the _mm512_undefined_*() placeholders used inside its AVX-512 intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// int -> float conversion followed by a power-of-two scale is exact, so (local + d * CELL_SIZE) rounds exactly once,
+// like the scalar code, regardless of FMA contraction
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128 to_float3_lane_sse42(const int32_t* global, const float* local, __m128i origin, __m128 cell_size)
+{
+    __m128i d = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(global)), origin);
+    __m128 r = _mm_add_ps(_mm_loadu_ps(local), _mm_mul_ps(_mm_cvtepi32_ps(d), cell_size));
+#ifndef NDEBUG
+    // NLE (not less-or-equal) is also true for NaN, matching the scalar assert
+    __m128 abs_r = _mm_andnot_ps(_mm_set1_ps(-0.0f), r);
+    assert(_mm_movemask_ps(_mm_cmpnle_ps(abs_r, _mm_set1_ps(LargePosition::CELL_SIZE * 3.0f))) == 0 &&
+           "The distance to the provided origin is too large to be represented as a float3.");
+#endif
+    return r;
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void to_float3_sse42(const int3& origin, const PositionLanes& src, const Float3Lanes& dst, size_t count)
+{
+    const __m128 cell_size = _mm_set1_ps(LargePosition::CELL_SIZE);
+    const __m128i ox = _mm_set1_epi32(origin.x);
+    const __m128i oy = _mm_set1_epi32(origin.y);
+    const __m128i oz = _mm_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(dst.x + i, to_float3_lane_sse42(src.global_x + i, src.local_x + i, ox, cell_size));
+        _mm_storeu_ps(dst.y + i, to_float3_lane_sse42(src.global_y + i, src.local_y + i, oy, cell_size));
+        _mm_storeu_ps(dst.z + i, to_float3_lane_sse42(src.global_z + i, src.local_z + i, oz, cell_size));
+    }
+    to_float3_scalar(origin, src, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256 to_float3_lane_avx2(const int32_t* global, const float* local, __m256i origin, __m256 cell_size)
+{
+    __m256i d = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(global)), origin);
+    __m256 r = _mm256_add_ps(_mm256_loadu_ps(local), _mm256_mul_ps(_mm256_cvtepi32_ps(d), cell_size));
+#ifndef NDEBUG
+    __m256 abs_r = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), r);
+    assert(_mm256_movemask_ps(_mm256_cmp_ps(abs_r, _mm256_set1_ps(LargePosition::CELL_SIZE * 3.0f), _CMP_NLE_UQ)) == 0 &&
+           "The distance to the provided origin is too large to be represented as a float3.");
+#endif
+    return r;
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void to_float3_avx2(const int3& origin, const PositionLanes& src, const Float3Lanes& dst, size_t count)
+{
+    const __m256 cell_size = _mm256_set1_ps(LargePosition::CELL_SIZE);
+    const __m256i ox = _mm256_set1_epi32(origin.x);
+    const __m256i oy = _mm256_set1_epi32(origin.y);
+    const __m256i oz = _mm256_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(dst.x + i, to_float3_lane_avx2(src.global_x + i, src.local_x + i, ox, cell_size));
+        _mm256_storeu_ps(dst.y + i, to_float3_lane_avx2(src.global_y + i, src.local_y + i, oy, cell_size));
+        _mm256_storeu_ps(dst.z + i, to_float3_lane_avx2(src.global_z + i, src.local_z + i, oz, cell_size));
+    }
+    to_float3_scalar(origin, src, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512 to_float3_lane_avx512(const int32_t* global, const float* local, __m512i origin, __m512 cell_size)
+{
+    __m512i d = _mm512_sub_epi32(_mm512_loadu_si512(global), origin);
+    __m512 r = _mm512_add_ps(_mm512_loadu_ps(local), _mm512_mul_ps(_mm512_cvtepi32_ps(d), cell_size));
+#ifndef NDEBUG
+    __m512 abs_r = _mm512_abs_ps(r);
+    assert(_mm512_cmp_ps_mask(abs_r, _mm512_set1_ps(LargePosition::CELL_SIZE * 3.0f), _CMP_NLE_UQ) == 0 &&
+           "The distance to the provided origin is too large to be represented as a float3.");
+#endif
+    return r;
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void to_float3_avx512(const int3& origin, const PositionLanes& src, const Float3Lanes& dst, size_t count)
+{
+    const __m512 cell_size = _mm512_set1_ps(LargePosition::CELL_SIZE);
+    const __m512i ox = _mm512_set1_epi32(origin.x);
+    const __m512i oy = _mm512_set1_epi32(origin.y);
+    const __m512i oz = _mm512_set1_epi32(origin.z);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm512_storeu_ps(dst.x + i, to_float3_lane_avx512(src.global_x + i, src.local_x + i, ox, cell_size));
+        _mm512_storeu_ps(dst.y + i, to_float3_lane_avx512(src.global_y + i, src.local_y + i, oy, cell_size));
+        _mm512_storeu_ps(dst.z + i, to_float3_lane_avx512(src.global_z + i, src.local_z + i, oz, cell_size));
+    }
+    to_float3_scalar(origin, src, dst, i, count);
+}
+
+// Re-celling reproduces LargePosition::from_double3() lane by lane:
+//   world  = origin * CELL_SIZE + local          (double, same operations as the scalar code)
+//   global = round(world / CELL_SIZE)            (ties away from zero, like std::round)
+//   local  = (float)(world - global * CELL_SIZE)
+// Dividing by a power of two equals multiplying by its exact reciprocal. std::round is rebuilt from truncation:
+// the fractional part q - trunc(q) is exact, and |fraction| >= 0.5 steps one unit away from zero.
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline __m128d round_away_sse42(__m128d q)
+{
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    __m128d t = _mm_round_pd(q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128d away = _mm_cmpge_pd(_mm_andnot_pd(sign_mask, _mm_sub_pd(q, t)), _mm_set1_pd(0.5));
+    __m128d step = _mm_or_pd(_mm_and_pd(q, sign_mask), _mm_set1_pd(1.0));
+    return _mm_add_pd(t, _mm_and_pd(away, step));
+}
+
+// Vector form of LargePosition::from_double3() for two world coordinates (results in the low two lanes)
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void from_double3_lane_sse42(__m128d world, __m128i& out_global, __m128& out_local)
+{
+    __m128d global = round_away_sse42(_mm_mul_pd(world, _mm_set1_pd(1.0 / double(LargePosition::CELL_SIZE))));
+    out_global = _mm_cvttpd_epi32(global);
+    out_local = _mm_cvtpd_ps(_mm_sub_pd(world, _mm_mul_pd(global, _mm_set1_pd(double(LargePosition::CELL_SIZE)))));
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void recell_half_sse42(__m128d origin, __m128d local, __m128i& out_global, __m128& out_local)
+{
+    __m128d world = _mm_add_pd(_mm_mul_pd(origin, _mm_set1_pd(double(LargePosition::CELL_SIZE))), local);
+    from_double3_lane_sse42(world, out_global, out_local);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void recell_sse42(__m128i origin, __m128 local, __m128 crossed, __m128i& global, __m128& out_local)
+{
+    __m128i g_lo, g_hi;
+    __m128 l_lo, l_hi;
+    recell_half_sse42(_mm_cvtepi32_pd(origin), _mm_cvtps_pd(local), g_lo, l_lo);
+    recell_half_sse42(_mm_cvtepi32_pd(_mm_unpackhi_epi64(origin, origin)), _mm_cvtps_pd(_mm_movehl_ps(local, local)), g_hi, l_hi);
+
+    global = _mm_blendv_epi8(origin, _mm_unpacklo_epi64(g_lo, g_hi), _mm_castps_si128(crossed));
+    out_local = _mm_blendv_ps(local, _mm_movelh_ps(l_lo, l_hi), crossed);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline size_t from_float3_sse42(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count, uint64_t* changed_mask)
+{
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 threshold = _mm_set1_ps(LargePosition::CELL_SIZE * 0.75f);
+
+    size_t changed = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 lx = _mm_loadu_ps(local_pos.x + i);
+        __m128 ly = _mm_loadu_ps(local_pos.y + i);
+        __m128 lz = _mm_loadu_ps(local_pos.z + i);
+        __m128 ax = _mm_andnot_ps(sign_mask, lx);
+        __m128 ay = _mm_andnot_ps(sign_mask, ly);
+        __m128 az = _mm_andnot_ps(sign_mask, lz);
+#ifndef NDEBUG
+        const __m128 limit = _mm_set1_ps(LargePosition::CELL_SIZE * 3.0f);
+        assert(_mm_movemask_ps(_mm_or_ps(_mm_or_ps(_mm_cmpnle_ps(ax, limit), _mm_cmpnle_ps(ay, limit)), _mm_cmpnle_ps(az, limit))) == 0 &&
+               "Large movement detected! Use double precision approach.");
+#endif
+        __m128 crossed = _mm_or_ps(_mm_or_ps(_mm_cmpnle_ps(ax, threshold), _mm_cmpnle_ps(ay, threshold)), _mm_cmpnle_ps(az, threshold));
+        uint32_t bits = (uint32_t)_mm_movemask_ps(crossed);
+
+        // Crossings are rare, so the double precision path is skipped for whole vectors that stay in their cells
+        if (bits != 0)
+        {
+            __m128i gx, gy, gz;
+            recell_sse42(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst.global_x + i)), lx, crossed, gx, lx);
+            recell_sse42(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst.global_y + i)), ly, crossed, gy, ly);
+            recell_sse42(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst.global_z + i)), lz, crossed, gz, lz);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.global_x + i), gx);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.global_y + i), gy);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.global_z + i), gz);
+            changed += store_changed_bits(changed_mask, i, bits);
+        }
+
+        _mm_storeu_ps(dst.local_x + i, lx);
+        _mm_storeu_ps(dst.local_y + i, ly);
+        _mm_storeu_ps(dst.local_z + i, lz);
+    }
+    return changed + from_float3_scalar(dst, local_pos, i, count, changed_mask);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256d round_away_avx2(__m256d q)
+{
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    __m256d t = _mm256_round_pd(q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256d away = _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, _mm256_sub_pd(q, t)), _mm256_set1_pd(0.5), _CMP_GE_OQ);
+    __m256d step = _mm256_or_pd(_mm256_and_pd(q, sign_mask), _mm256_set1_pd(1.0));
+    return _mm256_add_pd(t, _mm256_and_pd(away, step));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void from_double3_lane_avx2(__m256d world, __m128i& out_global, __m128& out_local)
+{
+    __m256d global = round_away_avx2(_mm256_mul_pd(world, _mm256_set1_pd(1.0 / double(LargePosition::CELL_SIZE))));
+    out_global = _mm256_cvttpd_epi32(global);
+    out_local = _mm256_cvtpd_ps(_mm256_sub_pd(world, _mm256_mul_pd(global, _mm256_set1_pd(double(LargePosition::CELL_SIZE)))));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void recell_half_avx2(__m256d origin, __m256d local, __m128i& out_global, __m128& out_local)
+{
+    __m256d world = _mm256_add_pd(_mm256_mul_pd(origin, _mm256_set1_pd(double(LargePosition::CELL_SIZE))), local);
+    from_double3_lane_avx2(world, out_global, out_local);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void recell_avx2(__m256i origin, __m256 local, __m256 crossed, __m256i& global, __m256& out_local)
+{
+    __m128i g_lo, g_hi;
+    __m128 l_lo, l_hi;
+    recell_half_avx2(_mm256_cvtepi32_pd(_mm256_castsi256_si128(origin)), _mm256_cvtps_pd(_mm256_castps256_ps128(local)), g_lo, l_lo);
+    recell_half_avx2(_mm256_cvtepi32_pd(_mm256_extracti128_si256(origin, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(local, 1)), g_hi,
+                     l_hi);
+
+    global = _mm256_blendv_epi8(origin, _mm256_set_m128i(g_hi, g_lo), _mm256_castps_si256(crossed));
+    out_local = _mm256_blendv_ps(local, _mm256_set_m128(l_hi, l_lo), crossed);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline size_t from_float3_avx2(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count, uint64_t* changed_mask)
+{
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 threshold = _mm256_set1_ps(LargePosition::CELL_SIZE * 0.75f);
+
+    size_t changed = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 lx = _mm256_loadu_ps(local_pos.x + i);
+        __m256 ly = _mm256_loadu_ps(local_pos.y + i);
+        __m256 lz = _mm256_loadu_ps(local_pos.z + i);
+        __m256 ax = _mm256_andnot_ps(sign_mask, lx);
+        __m256 ay = _mm256_andnot_ps(sign_mask, ly);
+        __m256 az = _mm256_andnot_ps(sign_mask, lz);
+#ifndef NDEBUG
+        const __m256 limit = _mm256_set1_ps(LargePosition::CELL_SIZE * 3.0f);
+        __m256 too_far = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(ax, limit, _CMP_NLE_UQ), _mm256_cmp_ps(ay, limit, _CMP_NLE_UQ)),
+                                      _mm256_cmp_ps(az, limit, _CMP_NLE_UQ));
+        assert(_mm256_movemask_ps(too_far) == 0 && "Large movement detected! Use double precision approach.");
+#endif
+        __m256 crossed = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(ax, threshold, _CMP_NLE_UQ), _mm256_cmp_ps(ay, threshold, _CMP_NLE_UQ)),
+                                      _mm256_cmp_ps(az, threshold, _CMP_NLE_UQ));
+        uint32_t bits = (uint32_t)_mm256_movemask_ps(crossed);
+
+        if (bits != 0)
+        {
+            __m256i gx, gy, gz;
+            recell_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst.global_x + i)), lx, crossed, gx, lx);
+            recell_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst.global_y + i)), ly, crossed, gy, ly);
+            recell_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst.global_z + i)), lz, crossed, gz, lz);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.global_x + i), gx);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.global_y + i), gy);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.global_z + i), gz);
+            changed += store_changed_bits(changed_mask, i, bits);
+        }
+
+        _mm256_storeu_ps(dst.local_x + i, lx);
+        _mm256_storeu_ps(dst.local_y + i, ly);
+        _mm256_storeu_ps(dst.local_z + i, lz);
+    }
+    return changed + from_float3_scalar(dst, local_pos, i, count, changed_mask);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __m512d round_away_avx512(__m512d q)
+{
+    __m512d t = _mm512_roundscale_pd(q, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __mmask8 away = _mm512_cmp_pd_mask(_mm512_abs_pd(_mm512_sub_pd(q, t)), _mm512_set1_pd(0.5), _CMP_GE_OQ);
+    __m512d step = _mm512_castsi512_pd(
+        _mm512_or_epi64(_mm512_and_epi64(_mm512_castpd_si512(q), _mm512_set1_epi64(INT64_MIN)), _mm512_castpd_si512(_mm512_set1_pd(1.0))));
+    return _mm512_mask_add_pd(t, away, t, step);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void from_double3_lane_avx512(__m512d world, __m256i& out_global, __m256& out_local)
+{
+    __m512d global = round_away_avx512(_mm512_mul_pd(world, _mm512_set1_pd(1.0 / double(LargePosition::CELL_SIZE))));
+    out_global = _mm512_cvttpd_epi32(global);
+    out_local = _mm512_cvtpd_ps(_mm512_sub_pd(world, _mm512_mul_pd(global, _mm512_set1_pd(double(LargePosition::CELL_SIZE)))));
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void recell_half_avx512(__m512d origin, __m512d local, __m256i& out_global, __m256& out_local)
+{
+    __m512d world = _mm512_add_pd(_mm512_mul_pd(origin, _mm512_set1_pd(double(LargePosition::CELL_SIZE))), local);
+    from_double3_lane_avx512(world, out_global, out_local);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void recell_avx512(__m512i origin, __m512 local, __mmask16 crossed, __m512i& global, __m512& out_local)
+{
+    __m256i g_lo, g_hi;
+    __m256 l_lo, l_hi;
+    __m256 local_hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(local), 1));
+    recell_half_avx512(_mm512_cvtepi32_pd(_mm512_castsi512_si256(origin)), _mm512_cvtps_pd(_mm512_castps512_ps256(local)), g_lo, l_lo);
+    recell_half_avx512(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(origin, 1)), _mm512_cvtps_pd(local_hi), g_hi, l_hi);
+
+    __m512i recelled_global = _mm512_inserti64x4(_mm512_castsi256_si512(g_lo), g_hi, 1);
+    __m512 recelled_local =
+        _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(l_lo)), _mm256_castps_pd(l_hi), 1));
+
+    global = _mm512_mask_mov_epi32(origin, crossed, recelled_global);
+    out_local = _mm512_mask_mov_ps(local, crossed, recelled_local);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline size_t from_float3_avx512(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count, uint64_t* changed_mask)
+{
+    const __m512 threshold = _mm512_set1_ps(LargePosition::CELL_SIZE * 0.75f);
+
+    size_t changed = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512 lx = _mm512_loadu_ps(local_pos.x + i);
+        __m512 ly = _mm512_loadu_ps(local_pos.y + i);
+        __m512 lz = _mm512_loadu_ps(local_pos.z + i);
+        __m512 ax = _mm512_abs_ps(lx);
+        __m512 ay = _mm512_abs_ps(ly);
+        __m512 az = _mm512_abs_ps(lz);
+#ifndef NDEBUG
+        const __m512 limit = _mm512_set1_ps(LargePosition::CELL_SIZE * 3.0f);
+        __mmask16 too_far = _mm512_cmp_ps_mask(ax, limit, _CMP_NLE_UQ) | _mm512_cmp_ps_mask(ay, limit, _CMP_NLE_UQ) |
+                            _mm512_cmp_ps_mask(az, limit, _CMP_NLE_UQ);
+        assert(too_far == 0 && "Large movement detected! Use double precision approach.");
+#endif
+        __mmask16 crossed = _mm512_cmp_ps_mask(ax, threshold, _CMP_NLE_UQ) | _mm512_cmp_ps_mask(ay, threshold, _CMP_NLE_UQ) |
+                            _mm512_cmp_ps_mask(az, threshold, _CMP_NLE_UQ);
+
+        if (crossed != 0)
+        {
+            __m512i gx, gy, gz;
+            recell_avx512(_mm512_loadu_si512(dst.global_x + i), lx, crossed, gx, lx);
+            recell_avx512(_mm512_loadu_si512(dst.global_y + i), ly, crossed, gy, ly);
+            recell_avx512(_mm512_loadu_si512(dst.global_z + i), lz, crossed, gz, lz);
+            _mm512_storeu_si512(dst.global_x + i, gx);
+            _mm512_storeu_si512(dst.global_y + i, gy);
+            _mm512_storeu_si512(dst.global_z + i, gz);
+            changed += store_changed_bits(changed_mask, i, (uint32_t)crossed);
+        }
+
+        _mm512_storeu_ps(dst.local_x + i, lx);
+        _mm512_storeu_ps(dst.local_y + i, ly);
+        _mm512_storeu_ps(dst.local_z + i, lz);
+    }
+    return changed + from_float3_scalar(dst, local_pos, i, count, changed_mask);
+}
+
+
+// double3 is 24 bytes, so each axis of the input is a stride-3 lane of doubles
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void from_double3_axis_sse42(const double* axis, int32_t* global, float* local)
+{
+    __m128d world = _mm_loadh_pd(_mm_load_sd(axis), axis + 3);
+#ifndef NDEBUG
+    __m128d in_range = _mm_and_pd(_mm_cmpge_pd(world, _mm_set1_pd(LargePosition::MIN_COORDINATE)),
+                                  _mm_cmple_pd(world, _mm_set1_pd(LargePosition::MAX_COORDINATE)));
+    assert(_mm_movemask_pd(in_range) == 0x3 && "Coordinate exceeds supported range (~+/-29.3 AU)");
+#endif
+    __m128i g;
+    __m128 l;
+    from_double3_lane_sse42(world, g, l);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(global), g);
+    _mm_storel_pi(reinterpret_cast<__m64*>(local), l);
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void from_double3_sse42(const double3* values, const MutablePositionLanes& dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        from_double3_axis_sse42(&values[i].x, dst.global_x + i, dst.local_x + i);
+        from_double3_axis_sse42(&values[i].y, dst.global_y + i, dst.local_y + i);
+        from_double3_axis_sse42(&values[i].z, dst.global_z + i, dst.local_z + i);
+    }
+    from_double3_scalar(values, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void from_double3_axis_avx2(const double* axis, int32_t* global, float* local)
+{
+    // Paired scalar loads beat the AVX2 gather instruction on most cores
+    __m256d world = _mm256_set_m128d(_mm_loadh_pd(_mm_load_sd(axis + 6), axis + 9), _mm_loadh_pd(_mm_load_sd(axis), axis + 3));
+#ifndef NDEBUG
+    __m256d in_range = _mm256_and_pd(_mm256_cmp_pd(world, _mm256_set1_pd(LargePosition::MIN_COORDINATE), _CMP_GE_OQ),
+                                     _mm256_cmp_pd(world, _mm256_set1_pd(LargePosition::MAX_COORDINATE), _CMP_LE_OQ));
+    assert(_mm256_movemask_pd(in_range) == 0xf && "Coordinate exceeds supported range (~+/-29.3 AU)");
+#endif
+    __m128i g;
+    __m128 l;
+    from_double3_lane_avx2(world, g, l);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(global), g);
+    _mm_storeu_ps(local, l);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void from_double3_avx2(const double3* values, const MutablePositionLanes& dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        from_double3_axis_avx2(&values[i].x, dst.global_x + i, dst.local_x + i);
+        from_double3_axis_avx2(&values[i].y, dst.global_y + i, dst.local_y + i);
+        from_double3_axis_avx2(&values[i].z, dst.global_z + i, dst.local_z + i);
+    }
+    from_double3_scalar(values, dst, i, count);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void from_double3_axis_avx512(const double* axis, int32_t* global, float* local)
+{
+    // Same paired scalar loads as AVX2: about 10% faster than _mm512_i32gather_pd on cache-resident input, equal when memory bound
+    __m256d low = _mm256_set_m128d(_mm_loadh_pd(_mm_load_sd(axis + 6), axis + 9), _mm_loadh_pd(_mm_load_sd(axis), axis + 3));
+    __m256d high = _mm256_set_m128d(_mm_loadh_pd(_mm_load_sd(axis + 18), axis + 21), _mm_loadh_pd(_mm_load_sd(axis + 12), axis + 15));
+    __m512d world = _mm512_insertf64x4(_mm512_castpd256_pd512(low), high, 1);
+#ifndef NDEBUG
+    __mmask8 in_range = _mm512_cmp_pd_mask(world, _mm512_set1_pd(LargePosition::MIN_COORDINATE), _CMP_GE_OQ) &
+                        _mm512_cmp_pd_mask(world, _mm512_set1_pd(LargePosition::MAX_COORDINATE), _CMP_LE_OQ);
+    assert(in_range == 0xff && "Coordinate exceeds supported range (~+/-29.3 AU)");
+#endif
+    __m256i g;
+    __m256 l;
+    from_double3_lane_avx512(world, g, l);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(global), g);
+    _mm256_storeu_ps(local, l);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void from_double3_avx512(const double3* values, const MutablePositionLanes& dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        from_double3_axis_avx512(&values[i].x, dst.global_x + i, dst.local_x + i);
+        from_double3_axis_avx512(&values[i].y, dst.global_y + i, dst.local_y + i);
+        from_double3_axis_avx512(&values[i].z, dst.global_z + i, dst.local_z + i);
+    }
+    from_double3_scalar(values, dst, i, count);
+}
+
+// Canonicalization reproduces LargePosition::canonical() with float operations only:
+//   steps = floor(local / CELL_SIZE), plus one if local >= (steps + 0.5) * CELL_SIZE
+//   global += steps, local -= steps * CELL_SIZE
+// The scale, the threshold and the subtraction are all exact, so there is nothing to round.
+// Vectors whose locals are all within [-CELL_SIZE/2, CELL_SIZE/2) are only read, never written back.
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline void canonical_axis_sse42(int32_t* global, float* local)
+{
+    const __m128 cell_size = _mm_set1_ps(LargePosition::CELL_SIZE);
+    __m128 l = _mm_loadu_ps(local);
+    __m128 steps = _mm_floor_ps(_mm_mul_ps(l, _mm_set1_ps(1.0f / LargePosition::CELL_SIZE)));
+    __m128 up = _mm_cmpge_ps(l, _mm_mul_ps(_mm_add_ps(steps, _mm_set1_ps(0.5f)), cell_size));
+    steps = _mm_add_ps(steps, _mm_and_ps(up, _mm_set1_ps(1.0f)));
+
+    __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(global));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(global), _mm_add_epi32(g, _mm_cvtps_epi32(steps)));
+    _mm_storeu_ps(local, _mm_sub_ps(l, _mm_mul_ps(steps, cell_size)));
+}
+
+LARGE_COORDINATES_TARGET("sse4.2")
+inline size_t canonicalize_sse42(const MutablePositionLanes& dst, size_t count, uint64_t* changed_mask)
+{
+    const __m128 high = _mm_set1_ps(LargePosition::CELL_SIZE * 0.5f);
+    const __m128 low = _mm_set1_ps(LargePosition::CELL_SIZE * -0.5f);
+
+    size_t changed = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 lx = _mm_loadu_ps(dst.local_x + i);
+        __m128 ly = _mm_loadu_ps(dst.local_y + i);
+        __m128 lz = _mm_loadu_ps(dst.local_z + i);
+        __m128 out_x = _mm_or_ps(_mm_cmpge_ps(lx, high), _mm_cmplt_ps(lx, low));
+        __m128 out_y = _mm_or_ps(_mm_cmpge_ps(ly, high), _mm_cmplt_ps(ly, low));
+        __m128 out_z = _mm_or_ps(_mm_cmpge_ps(lz, high), _mm_cmplt_ps(lz, low));
+        uint32_t bits = (uint32_t)_mm_movemask_ps(_mm_or_ps(_mm_or_ps(out_x, out_y), out_z));
+        if (bits != 0)
+        {
+            canonical_axis_sse42(dst.global_x + i, dst.local_x + i);
+            canonical_axis_sse42(dst.global_y + i, dst.local_y + i);
+            canonical_axis_sse42(dst.global_z + i, dst.local_z + i);
+            changed += store_changed_bits(changed_mask, i, bits);
+        }
+    }
+    return changed + canonicalize_scalar(dst, i, count, changed_mask);
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline void canonical_axis_avx2(int32_t* global, float* local)
+{
+    const __m256 cell_size = _mm256_set1_ps(LargePosition::CELL_SIZE);
+    __m256 l = _mm256_loadu_ps(local);
+    __m256 steps = _mm256_floor_ps(_mm256_mul_ps(l, _mm256_set1_ps(1.0f / LargePosition::CELL_SIZE)));
+    __m256 up = _mm256_cmp_ps(l, _mm256_mul_ps(_mm256_add_ps(steps, _mm256_set1_ps(0.5f)), cell_size), _CMP_GE_OQ);
+    steps = _mm256_add_ps(steps, _mm256_and_ps(up, _mm256_set1_ps(1.0f)));
+
+    __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(global));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(global), _mm256_add_epi32(g, _mm256_cvtps_epi32(steps)));
+    _mm256_storeu_ps(local, _mm256_sub_ps(l, _mm256_mul_ps(steps, cell_size)));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline __m256 outside_cell_avx2(__m256 local)
+{
+    return _mm256_or_ps(_mm256_cmp_ps(local, _mm256_set1_ps(LargePosition::CELL_SIZE * 0.5f), _CMP_GE_OQ),
+                        _mm256_cmp_ps(local, _mm256_set1_ps(LargePosition::CELL_SIZE * -0.5f), _CMP_LT_OQ));
+}
+
+LARGE_COORDINATES_TARGET("avx2")
+inline size_t canonicalize_avx2(const MutablePositionLanes& dst, size_t count, uint64_t* changed_mask)
+{
+    size_t changed = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 out_x = outside_cell_avx2(_mm256_loadu_ps(dst.local_x + i));
+        __m256 out_y = outside_cell_avx2(_mm256_loadu_ps(dst.local_y + i));
+        __m256 out_z = outside_cell_avx2(_mm256_loadu_ps(dst.local_z + i));
+        uint32_t bits = (uint32_t)_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(out_x, out_y), out_z));
+        if (bits != 0)
+        {
+            canonical_axis_avx2(dst.global_x + i, dst.local_x + i);
+            canonical_axis_avx2(dst.global_y + i, dst.local_y + i);
+            canonical_axis_avx2(dst.global_z + i, dst.local_z + i);
+            changed += store_changed_bits(changed_mask, i, bits);
+        }
+    }
+    return changed + canonicalize_scalar(dst, i, count, changed_mask);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline void canonical_axis_avx512(int32_t* global, float* local)
+{
+    const __m512 cell_size = _mm512_set1_ps(LargePosition::CELL_SIZE);
+    __m512 l = _mm512_loadu_ps(local);
+    __m512 scaled = _mm512_mul_ps(l, _mm512_set1_ps(1.0f / LargePosition::CELL_SIZE));
+    __m512 steps = _mm512_roundscale_ps(scaled, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    __mmask16 up = _mm512_cmp_ps_mask(l, _mm512_mul_ps(_mm512_add_ps(steps, _mm512_set1_ps(0.5f)), cell_size), _CMP_GE_OQ);
+    steps = _mm512_mask_add_ps(steps, up, steps, _mm512_set1_ps(1.0f));
+
+    _mm512_storeu_si512(global, _mm512_add_epi32(_mm512_loadu_si512(global), _mm512_cvtps_epi32(steps)));
+    _mm512_storeu_ps(local, _mm512_sub_ps(l, _mm512_mul_ps(steps, cell_size)));
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline __mmask16 outside_cell_avx512(__m512 local)
+{
+    return _mm512_cmp_ps_mask(local, _mm512_set1_ps(LargePosition::CELL_SIZE * 0.5f), _CMP_GE_OQ) |
+           _mm512_cmp_ps_mask(local, _mm512_set1_ps(LargePosition::CELL_SIZE * -0.5f), _CMP_LT_OQ);
+}
+
+LARGE_COORDINATES_TARGET("avx512f")
+inline size_t canonicalize_avx512(const MutablePositionLanes& dst, size_t count, uint64_t* changed_mask)
+{
+    size_t changed = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __mmask16 out = outside_cell_avx512(_mm512_loadu_ps(dst.local_x + i)) | outside_cell_avx512(_mm512_loadu_ps(dst.local_y + i)) |
+                        outside_cell_avx512(_mm512_loadu_ps(dst.local_z + i));
+        if (out != 0)
+        {
+            canonical_axis_avx512(dst.global_x + i, dst.local_x + i);
+            canonical_axis_avx512(dst.global_y + i, dst.local_y + i);
+            canonical_axis_avx512(dst.global_z + i, dst.local_z + i);
+            changed += store_changed_bits(changed_mask, i, (uint32_t)out);
+        }
+    }
+    return changed + canonicalize_scalar(dst, i, count, changed_mask);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // LARGE_COORDINATES_X86
+
+} // namespace large_coordinates_detail
+
+// Best instruction set supported by the CPU and the OS
+inline SimdLevel simd_supported_level()
+{
+    static const SimdLevel level = large_coordinates_detail::detect_simd_level();
+    return level;
+}
+
+// Instruction set currently used by the batch functions
+inline SimdLevel simd_active_level() { return (SimdLevel)large_coordinates_detail::active_simd_level().load(std::memory_order_relaxed); }
+
+// Restrict the batch functions to a given instruction set (clamped to what the CPU supports)
+// Intended for testing and benchmarking; returns the level that is actually used
+inline SimdLevel simd_set_level(SimdLevel level)
+{
+    if ((int)level > (int)simd_supported_level())
+    {
+        level = simd_supported_level();
+    }
+    large_coordinates_detail::active_simd_level().store((int)level, std::memory_order_relaxed);
+    return level;
+}
+
+// Batch equivalent of LargePosition::to_float3()
+// Writes `count` offsets relative to the `origin` cell center, dst[i] is bit-identical to the scalar result
+inline void batch_to_float3(const int3& origin, const PositionLanes& src, const Float3Lanes& dst, size_t count)
+{
+    using namespace large_coordinates_detail;
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        to_float3_avx512(origin, src, dst, count);
+        return;
+    case SimdLevel::AVX2:
+        to_float3_avx2(origin, src, dst, count);
+        return;
+    case SimdLevel::SSE42:
+        to_float3_sse42(origin, src, dst, count);
+        return;
+#endif
+    default:
+        to_float3_scalar(origin, src, dst, 0, count);
+        return;
+    }
+}
+
+// Batch equivalent of LargePosition::from_double3()
+// Writes `count` positions into dst, bit-identical to constructing each LargePosition from values[i].
+// The division by the power-of-two CELL_SIZE becomes a multiplication by its exact reciprocal and std::round
+// becomes a vector truncation plus a ties-away-from-zero correction.
+inline void batch_from_double3(const double3* values, const MutablePositionLanes& dst, size_t count)
+{
+    using namespace large_coordinates_detail;
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        from_double3_avx512(values, dst, count);
+        return;
+    case SimdLevel::AVX2:
+        from_double3_avx2(values, dst, count);
+        return;
+    case SimdLevel::SSE42:
+        from_double3_sse42(values, dst, count);
+        return;
+#endif
+    default:
+        from_double3_scalar(values, dst, 0, count);
+        return;
+    }
+}
+
+// Batch equivalent of LargePosition::to_double3()
+// Writes `count` world positions, bit-identical to the scalar method. Every step is exact or a single rounding in
+// double precision, so a plain loop is used on every instruction set (compilers vectorize it).
+inline void batch_to_double3(const PositionLanes& src, double3* dst, size_t count)
+{
+    constexpr double cell_size = double(LargePosition::CELL_SIZE);
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = double3(src.global_x[i] * cell_size + src.local_x[i], src.global_y[i] * cell_size + src.local_y[i],
+                         src.global_z[i] * cell_size + src.local_z[i]);
+    }
+}
+
+// Batch equivalent of LargePosition::from_float3(), applied in place
+// Element i is set from the offset local_pos[i] relative to its own current cell (dst.global[i]), with the same
+// hysteresis and bit-identical results as the scalar method. local_pos may alias the dst local lanes.
+// If changed_mask is not null it must hold (count + 63) / 64 words; bit i is set when element i changed cell.
+// Returns the number of elements that changed cell.
+inline size_t batch_from_float3(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count, uint64_t* changed_mask)
+{
+    using namespace large_coordinates_detail;
+    if (changed_mask)
+    {
+        std::memset(changed_mask, 0, ((count + 63) / 64) * sizeof(uint64_t));
+    }
+
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        return from_float3_avx512(dst, local_pos, count, changed_mask);
+    case SimdLevel::AVX2:
+        return from_float3_avx2(dst, local_pos, count, changed_mask);
+    case SimdLevel::SSE42:
+        return from_float3_sse42(dst, local_pos, count, changed_mask);
+#endif
+    default:
+        return from_float3_scalar(dst, local_pos, 0, count, changed_mask);
+    }
+}
+
+// Batch equivalent of LargePosition::canonical(), applied in place
+// Moves every element to its nearest cell (local in [-CELL_SIZE/2, CELL_SIZE/2)) with the same world position,
+// undoing the extended locals left by from_float3() hysteresis. Bit-identical to the scalar method; only
+// float and integer operations are used. changed_mask works as in batch_from_float3.
+// Returns the number of elements that changed cell.
+inline size_t batch_canonicalize(const MutablePositionLanes& dst, size_t count, uint64_t* changed_mask)
+{
+    using namespace large_coordinates_detail;
+    if (changed_mask)
+    {
+        std::memset(changed_mask, 0, ((count + 63) / 64) * sizeof(uint64_t));
+    }
+
+    switch (simd_active_level())
+    {
+#if LARGE_COORDINATES_X86
+    case SimdLevel::AVX512:
+        return canonicalize_avx512(dst, count, changed_mask);
+    case SimdLevel::AVX2:
+        return canonicalize_avx2(dst, count, changed_mask);
+    case SimdLevel::SSE42:
+        return canonicalize_sse42(dst, count, changed_mask);
+#endif
+    default:
+        return canonicalize_scalar(dst, 0, count, changed_mask);
+    }
+}
+
+// Expands a changed_mask produced by batch_from_float3 (or batch_canonicalize) into a list of element indices, returns the number written
+inline size_t changed_mask_to_indices(const uint64_t* changed_mask, size_t count, uint32_t* out_indices)
+{
+    size_t written = 0;
+    for (size_t word = 0; word < (count + 63) / 64; word++)
+    {
+        for (uint64_t bits = changed_mask[word]; bits != 0; bits &= bits - 1)
+        {
+            uint32_t bit = 0;
+            while (((bits >> bit) & 1) == 0)
+            {
+                bit++;
+            }
+            out_indices[written++] = uint32_t(word * 64 + bit);
+        }
+    }
+    return written;
+}
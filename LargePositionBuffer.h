@@ -0,0 +1,330 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+/*
+
+LargePositionBuffer stores many LargePosition values as a structure of arrays (SoA).
+
+Every component lives in its own contiguous lane:
+  global_x, global_y, global_z: int32_t cell indices
+  local_x,  local_y,  local_z:  float offsets from the cell center
+
+Passes that only need `local` (or only `global`) stream 4 bytes per component instead of
+striding through 24-byte LargePosition structs.
+
+All lanes share a single allocation. Each lane starts on a 64-byte boundary and the capacity is
+always a multiple of LANE_PADDING elements, so SIMD kernels may safely read whole vectors up to capacity().
+
+Element i of the buffer follows exactly the same rules as a LargePosition, including hysteresis,
+and the bulk conversions produce bit-identical results to the scalar LargePosition methods.
+
+*/
+class LargePositionBuffer
+{
+  public:
+    inline static constexpr size_t ALIGNMENT = 64;
+    inline static constexpr size_t LANE_PADDING = ALIGNMENT / sizeof(float);
+
+    LargePositionBuffer() = default;
+
+    explicit LargePositionBuffer(size_t count) { resize(count); }
+
+    LargePositionBuffer(const LargePositionBuffer& other)
+    {
+        reserve(other.m_size);
+        m_size = other.m_size;
+        copy_lanes(other, 0, m_size);
+    }
+
+    LargePositionBuffer(LargePositionBuffer&& other) noexcept { swap(other); }
+
+    LargePositionBuffer& operator=(const LargePositionBuffer& other)
+    {
+        if (this != &other)
+        {
+            LargePositionBuffer tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    LargePositionBuffer& operator=(LargePositionBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            LargePositionBuffer tmp(std::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~LargePositionBuffer() { release(); }
+
+    void swap(LargePositionBuffer& other) noexcept
+    {
+        std::swap(m_memory, other.m_memory);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+        for (int i = 0; i < 3; i++)
+        {
+            std::swap(m_global[i], other.m_global[i]);
+            std::swap(m_local[i], other.m_local[i]);
+        }
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    void clear() { m_size = 0; }
+
+    void reserve(size_t count)
+    {
+        if (count <= m_capacity)
+        {
+            return;
+        }
+
+        size_t new_capacity = round_up_capacity(count);
+        void* new_memory = allocate(new_capacity);
+
+        LargePositionBuffer old;
+        old.m_memory = m_memory;
+        old.m_size = m_size;
+        old.m_capacity = m_capacity;
+        for (int i = 0; i < 3; i++)
+        {
+            old.m_global[i] = m_global[i];
+            old.m_local[i] = m_local[i];
+        }
+
+        bind_lanes(new_memory, new_capacity);
+        copy_lanes(old, 0, m_size);
+    }
+
+    // New elements are default constructed LargePosition values (cell 0, zero local offset)
+    void resize(size_t count)
+    {
+        if (count > m_capacity)
+        {
+            reserve(grow_capacity(count));
+        }
+
+        if (count > m_size)
+        {
+            size_t added = count - m_size;
+            for (int i = 0; i < 3; i++)
+            {
+                std::memset(m_global[i] + m_size, 0, added * sizeof(int32_t));
+                std::memset(m_local[i] + m_size, 0, added * sizeof(float));
+            }
+        }
+        m_size = count;
+    }
+
+    void push_back(const LargePosition& pos)
+    {
+        if (m_size == m_capacity)
+        {
+            reserve(grow_capacity(m_size + 1));
+        }
+        store(m_size, pos);
+        m_size++;
+    }
+
+    LargePosition get(size_t index) const
+    {
+        assert(index < m_size && "LargePositionBuffer index out of range");
+        // Bypass the LargePosition(global, local) constructor: stored values are already valid and must not be re-celled
+        LargePosition pos;
+        pos.global = int3(m_global[0][index], m_global[1][index], m_global[2][index]);
+        pos.local = float3(m_local[0][index], m_local[1][index], m_local[2][index]);
+        return pos;
+    }
+
+    void set(size_t index, const LargePosition& pos)
+    {
+        assert(index < m_size && "LargePositionBuffer index out of range");
+        store(index, pos);
+    }
+
+    // Raw lane access (valid for [0, size()), readable up to capacity())
+    int32_t* global_x() { return m_global[0]; }
+    int32_t* global_y() { return m_global[1]; }
+    int32_t* global_z() { return m_global[2]; }
+    float* local_x() { return m_local[0]; }
+    float* local_y() { return m_local[1]; }
+    float* local_z() { return m_local[2]; }
+
+    const int32_t* global_x() const { return m_global[0]; }
+    const int32_t* global_y() const { return m_global[1]; }
+    const int32_t* global_z() const { return m_global[2]; }
+    const float* local_x() const { return m_local[0]; }
+    const float* local_y() const { return m_local[1]; }
+    const float* local_z() const { return m_local[2]; }
+
+    PositionLanes lanes() const { return PositionLanes{m_global[0], m_global[1], m_global[2], m_local[0], m_local[1], m_local[2]}; }
+    MutablePositionLanes mutable_lanes()
+    {
+        return MutablePositionLanes{m_global[0], m_global[1], m_global[2], m_local[0], m_local[1], m_local[2]};
+    }
+
+    // Bulk equivalent of LargePosition::from_double3() (see batch_from_double3)
+    // Resizes the buffer to `count` and assigns every element from world coordinates
+    void from_double3(const double3* values, size_t count)
+    {
+        resize(count);
+        batch_from_double3(values, mutable_lanes(), count);
+    }
+
+    // Bulk equivalent of LargePosition::to_double3(), writes size() elements to `out`
+    void to_double3(double3* out) const { batch_to_double3(lanes(), out, m_size); }
+
+    // Bulk equivalent of LargePosition::to_float3(), writes size() offsets relative to `origin` to `out`
+    void to_float3(const int3& origin, float3* out) const
+    {
+        constexpr float cell_size = LargePosition::CELL_SIZE;
+        for (size_t i = 0; i < m_size; i++)
+        {
+            float3 local_pos(m_local[0][i] + (m_global[0][i] - origin.x) * cell_size,
+                             m_local[1][i] + (m_global[1][i] - origin.y) * cell_size,
+                             m_local[2][i] + (m_global[2][i] - origin.z) * cell_size);
+
+            assert(std::abs(local_pos.x) <= cell_size * 3.0f &&
+                   "The distance to the provided origin is too large to be represented as a float3.");
+            assert(std::abs(local_pos.y) <= cell_size * 3.0f &&
+                   "The distance to the provided origin is too large to be represented as a float3.");
+            assert(std::abs(local_pos.z) <= cell_size * 3.0f &&
+                   "The distance to the provided origin is too large to be represented as a float3.");
+            out[i] = local_pos;
+        }
+    }
+
+    // SIMD version of the above that writes size() offsets into separate x/y/z lanes (see batch_to_float3)
+    void to_float3(const int3& origin, const Float3Lanes& out) const { batch_to_float3(origin, lanes(), out, m_size); }
+
+    // Bulk equivalent of LargePosition::from_float3()
+    // Resizes the buffer to `count` and assigns every element from an offset relative to `origin`
+    void from_float3(const int3& origin, const float3* local_pos, size_t count)
+    {
+        resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            LargePosition pos;
+            pos.from_float3(origin, local_pos[i]);
+            store(i, pos);
+        }
+    }
+
+    // SIMD in-place update: element i is set from local_pos[i] relative to its own current cell (see batch_from_float3)
+    // Typical use is integration, where local_pos holds local + velocity * dt (it may alias the local lanes)
+    // Returns the number of elements that changed cell, optionally flagged in changed_mask ((size() + 63) / 64 words)
+    size_t from_float3(const ConstFloat3Lanes& local_pos, uint64_t* changed_mask = nullptr)
+    {
+        return batch_from_float3(mutable_lanes(), local_pos, m_size, changed_mask);
+    }
+
+    // Bulk equivalent of LargePosition::canonical(), applied in place (see batch_canonicalize)
+    // Returns the number of elements that changed cell, optionally flagged in changed_mask ((size() + 63) / 64 words)
+    size_t canonicalize(uint64_t* changed_mask = nullptr) { return batch_canonicalize(mutable_lanes(), m_size, changed_mask); }
+
+    // Incremental version for a background budget: canonicalizes up to `budget` elements starting at `cursor` and
+    // advances it, wrapping to 0 past the last element, so repeated calls keep sweeping the buffer.
+    // Bit i of changed_mask ((budget + 63) / 64 words) flags element (cursor on entry) + i.
+    // Returns the number of elements that changed cell.
+    size_t canonicalize(size_t& cursor, size_t budget, uint64_t* changed_mask = nullptr)
+    {
+        if (cursor >= m_size)
+        {
+            cursor = 0;
+        }
+        const size_t first = cursor;
+        const size_t count = (budget < m_size - first) ? budget : m_size - first;
+        const MutablePositionLanes range{m_global[0] + first, m_global[1] + first, m_global[2] + first,
+                                         m_local[0] + first,  m_local[1] + first,  m_local[2] + first};
+        cursor = (first + count == m_size) ? 0 : first + count;
+        return batch_canonicalize(range, count, changed_mask);
+    }
+
+  private:
+    static size_t round_up_capacity(size_t count) { return (count + LANE_PADDING - 1) & ~(LANE_PADDING - 1); }
+
+    size_t grow_capacity(size_t required) const
+    {
+        size_t doubled = m_capacity * 2;
+        return doubled > required ? doubled : required;
+    }
+
+    static size_t lane_bytes(size_t capacity) { return capacity * sizeof(float); }
+
+    static void* allocate(size_t capacity)
+    {
+        static_assert(sizeof(int32_t) == sizeof(float), "All lanes are expected to have the same element size");
+        return ::operator new(lane_bytes(capacity) * 6, std::align_val_t(ALIGNMENT));
+    }
+
+    void release()
+    {
+        if (m_memory)
+        {
+            ::operator delete(m_memory, std::align_val_t(ALIGNMENT));
+        }
+        m_memory = nullptr;
+        m_size = 0;
+        m_capacity = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            m_global[i] = nullptr;
+            m_local[i] = nullptr;
+        }
+    }
+
+    void bind_lanes(void* memory, size_t capacity)
+    {
+        // Capacity is a multiple of LANE_PADDING, so every lane stays 64-byte aligned
+        char* base = static_cast<char*>(memory);
+        size_t stride = lane_bytes(capacity);
+        for (int i = 0; i < 3; i++)
+        {
+            m_global[i] = reinterpret_cast<int32_t*>(base + stride * i);
+            m_local[i] = reinterpret_cast<float*>(base + stride * (3 + i));
+        }
+        m_memory = memory;
+        m_capacity = capacity;
+    }
+
+    void copy_lanes(const LargePositionBuffer& src, size_t first, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            std::memcpy(m_global[i] + first, src.m_global[i] + first, count * sizeof(int32_t));
+            std::memcpy(m_local[i] + first, src.m_local[i] + first, count * sizeof(float));
+        }
+    }
+
+    void store(size_t index, const LargePosition& pos)
+    {
+        m_global[0][index] = pos.global.x;
+        m_global[1][index] = pos.global.y;
+        m_global[2][index] = pos.global.z;
+        m_local[0][index] = pos.local.x;
+        m_local[1][index] = pos.local.y;
+        m_local[2][index] = pos.local.z;
+    }
+
+    void* m_memory = nullptr;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    int32_t* m_global[3] = {nullptr, nullptr, nullptr};
+    float* m_local[3] = {nullptr, nullptr, nullptr};
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "LargeAABB.h"
+#include "LargeCoordinates.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Slab test of a ray against a box, both in the same float frame. t_enter is clamped to 0 when the origin is
+// inside the box. Returns false when the ray misses the box or enters it after t_max.
+inline bool ray_intersect_box(const float3& origin, const float3& inv_direction, const float3& box_min, const float3& box_max,
+                              float t_max, float* t_enter)
+{
+    float tx0 = (box_min.x - origin.x) * inv_direction.x, tx1 = (box_max.x - origin.x) * inv_direction.x;
+    float ty0 = (box_min.y - origin.y) * inv_direction.y, ty1 = (box_max.y - origin.y) * inv_direction.y;
+    float tz0 = (box_min.z - origin.z) * inv_direction.z, tz1 = (box_max.z - origin.z) * inv_direction.z;
+    float t_near = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+    float t_far = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), t_max));
+    *t_enter = t_near;
+    return t_near <= t_far;
+}
+
+/*
+
+LargeRay is a ray starting at a LargePosition with a float direction (normalized, so ray parameters are meters).
+
+LargeRayTraversal walks the cells the ray passes through, in order, with the Amanatides-Woo grid traversal
+("A Fast Voxel Traversal Algorithm for Ray Tracing", 1987). Cell k of an axis spans [k - 0.5, k + 0.5) * CELL_SIZE,
+i.e. the natural cells of LargePosition (see README, "Cell Partitioning with Hysteresis"):
+
+  - Cells are stepped with integer increments, so the walk never drifts off the grid, however long the ray.
+  - The ray parameter of the n-th boundary along an axis is computed directly as
+    (first_boundary + n * CELL_SIZE) / |direction|, instead of accumulating t_delta, so rounding errors do not add up.
+
+Each visited cell also carries the ray origin expressed in that cell's frame, so objects stored with cell-local
+coordinates can be intersected with plain float math (see ray_intersect_box()). Like every float offset, its
+precision is that of a float at the distance between the ray origin and the cell.
+
+Typical use, stopping at the first hit:
+
+  LargeRayTraversal traversal(ray, 50000.0f);
+  RayCell cell;
+  while (traversal.next(cell))
+  {
+      if (intersect_objects_of(cell)) break;
+  }
+
+*/
+struct LargeRay
+{
+    LargePosition origin;
+    float3 direction;
+
+    LargeRay() = default;
+
+    LargeRay(const LargePosition& origin_, const float3& direction_)
+        : origin(origin_)
+        , direction(direction_)
+    {
+    }
+
+    float3 inv_direction() const { return float3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z); }
+};
+
+struct RayCell
+{
+    int3 cell;
+    float t_enter;
+    float t_exit;
+    float3 origin; // ray origin relative to the center of `cell`
+
+    // Point of the ray at parameter t, anchored to this cell
+    LargePosition point_at(const LargeRay& ray, float t) const
+    {
+        LargePosition pos;
+        pos.global = cell;
+        pos.local = origin + ray.direction * t;
+        return pos;
+    }
+};
+
+class LargeRayTraversal
+{
+  public:
+    LargeRayTraversal(const LargeRay& ray, float max_distance)
+        : m_ray(ray)
+        , m_max_distance(max_distance)
+    {
+        constexpr float cell_size = LargePosition::CELL_SIZE;
+        const int32_t global[3] = {ray.origin.global.x, ray.origin.global.y, ray.origin.global.z};
+        const float local[3] = {ray.origin.local.x, ray.origin.local.y, ray.origin.local.z};
+        const float direction[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            // The origin's local offset may reach past its own cell (hysteresis); start in the cell it lies in
+            float shift = std::floor(local[axis] / cell_size + 0.5f);
+            m_cell[axis] = int64_t(global[axis]) + int64_t(shift);
+            float l = local[axis] - shift * cell_size;
+
+            m_steps[axis] = 0;
+            if (direction[axis] > 0.0f)
+            {
+                m_step[axis] = 1;
+                m_first_boundary[axis] = cell_size * 0.5f - l;
+                m_inv_speed[axis] = 1.0f / direction[axis];
+            }
+            else if (direction[axis] < 0.0f)
+            {
+                m_step[axis] = -1;
+                m_first_boundary[axis] = l + cell_size * 0.5f;
+                m_inv_speed[axis] = -1.0f / direction[axis];
+            }
+            else
+            {
+                m_step[axis] = 0;
+                m_first_boundary[axis] = 0.0f;
+                m_inv_speed[axis] = 0.0f;
+            }
+            m_t_next[axis] = boundary_t(axis);
+        }
+        m_done = !in_range();
+    }
+
+    // Writes the next cell along the ray, returns false once the ray has passed max_distance
+    // or left the int32_t cell range
+    bool next(RayCell& out)
+    {
+        if (m_done)
+        {
+            return false;
+        }
+
+        int axis = m_t_next[0] <= m_t_next[1] ? (m_t_next[0] <= m_t_next[2] ? 0 : 2) : (m_t_next[1] <= m_t_next[2] ? 1 : 2);
+        const float t_exit = std::min(m_t_next[axis], m_max_distance);
+
+        out.cell = int3(int32_t(m_cell[0]), int32_t(m_cell[1]), int32_t(m_cell[2]));
+        out.t_enter = m_t_enter;
+        out.t_exit = t_exit;
+        out.origin = float3(LargeAABB::axis_offset(m_ray.origin.global.x, m_ray.origin.local.x, out.cell.x),
+                            LargeAABB::axis_offset(m_ray.origin.global.y, m_ray.origin.local.y, out.cell.y),
+                            LargeAABB::axis_offset(m_ray.origin.global.z, m_ray.origin.local.z, out.cell.z));
+
+        if (m_t_next[axis] >= m_max_distance)
+        {
+            m_done = true;
+            return true;
+        }
+
+        m_t_enter = m_t_next[axis];
+        m_cell[axis] += m_step[axis];
+        m_steps[axis]++;
+        m_t_next[axis] = boundary_t(axis);
+        m_done = !in_range();
+        return true;
+    }
+
+  private:
+    float boundary_t(int axis) const
+    {
+        if (m_step[axis] == 0)
+        {
+            return FLT_MAX;
+        }
+        return (m_first_boundary[axis] + float(m_steps[axis]) * LargePosition::CELL_SIZE) * m_inv_speed[axis];
+    }
+
+    bool in_range() const
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (m_cell[axis] < INT32_MIN || m_cell[axis] > INT32_MAX)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    LargeRay m_ray;
+    float m_max_distance;
+    float m_t_enter = 0.0f;
+    int64_t m_cell[3];
+    int32_t m_step[3];
+    int64_t m_steps[3];        // boundaries crossed along each axis
+    float m_first_boundary[3]; // distance along the axis from the origin to the first boundary
+    float m_inv_speed[3];      // 1 / |direction|
+    float m_t_next[3];
+    bool m_done = false;
+};
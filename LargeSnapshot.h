@@ -0,0 +1,387 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBuffer.h"
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/*
+
+Binary snapshot format for arrays of LargePosition, written from and read into LargePositionBuffer lanes.
+
+All values are little-endian. The file starts with a 64-byte LargeSnapshotHeader (format version, cell size, element
+count, chunk size and the cell bounds of all elements), followed by the elements in chunks of chunk_elements
+(the last one may be shorter). A chunk stores the six lanes one after the other:
+
+  global_x[n] global_y[n] global_z[n]   int32_t
+  local_x[n]  local_y[n]  local_z[n]    float
+
+Every lane is zero padded to a multiple of 64 bytes, so each lane starts on a 64-byte file offset and is written and
+read with a single bulk copy (a byte swap is only needed on big-endian hosts). This is also what allows mapping a
+snapshot and using its lanes in place.
+
+LargeSnapshotReader streams a snapshot one chunk at a time and validates every element while it is still in cache:
+its cell must lie within the header bounds, and its local offset must be finite, within the hysteresis threshold and
+keep the world position within [MIN_COORDINATE, MAX_COORDINATE]. This is checked on the integer cells and float
+offsets directly, no double world positions are computed.
+
+The header itself is untrusted too: chunk sizes and counts are capped, and on seekable streams the reader compares the
+size implied by the header with the stream length before allocating anything, so a forged 64-byte header fails with
+BadHeader or Truncated instead of a huge allocation.
+
+*/
+struct LargeSnapshotHeader
+{
+    inline static constexpr uint32_t MAGIC = 0x5343574c; // "LWCS" in file order
+    inline static constexpr uint16_t VERSION = 1;
+    inline static constexpr uint32_t LANE_ALIGNMENT = 64;
+    inline static constexpr uint32_t DEFAULT_CHUNK_ELEMENTS = 1 << 16;
+    // Limits accepted by the reader: a chunk is allocated before its data is read (at most 24 MB), and file_size()
+    // must not overflow
+    inline static constexpr uint32_t MAX_CHUNK_ELEMENTS = 1 << 20;
+    inline static constexpr uint64_t MAX_COUNT = uint64_t(1) << 48;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    float cell_size;
+    uint32_t chunk_elements; // multiple of 16 up to MAX_CHUNK_ELEMENTS, so only the last chunk has padded lanes
+    uint64_t count;
+    int3 min_cell; // bounds of the cells of all elements (min > max when count is 0)
+    int3 max_cell;
+    uint32_t reserved[4];
+
+    // Number of elements in chunk `index`
+    uint64_t chunk_count(uint64_t index) const
+    {
+        uint64_t first = index * chunk_elements;
+        return (count - first < chunk_elements) ? count - first : chunk_elements;
+    }
+
+    uint64_t chunk_total() const { return (chunk_elements == 0) ? 0 : (count + chunk_elements - 1) / chunk_elements; }
+
+    // Size of one lane of `n` elements in the file, including its padding
+    static uint64_t lane_bytes(uint64_t n) { return (n * sizeof(float) + LANE_ALIGNMENT - 1) & ~uint64_t(LANE_ALIGNMENT - 1); }
+
+    // File offset of chunk `index`, all chunks before it are full
+    uint64_t chunk_offset(uint64_t index) const { return sizeof(LargeSnapshotHeader) + index * 6 * lane_bytes(chunk_elements); }
+
+    // Size of the whole snapshot in bytes
+    uint64_t file_size() const
+    {
+        const uint64_t chunks = chunk_total();
+        return (chunks == 0) ? sizeof(LargeSnapshotHeader) : chunk_offset(chunks - 1) + 6 * lane_bytes(chunk_count(chunks - 1));
+    }
+};
+
+static_assert(sizeof(LargeSnapshotHeader) == 64, "LargeSnapshotHeader must stay 64 bytes");
+
+enum class SnapshotStatus
+{
+    Ok,
+    BadMagic,           // not a snapshot
+    UnsupportedVersion, // written by a newer version of the format
+    BadHeader,          // inconsistent header fields
+    CellSizeMismatch,   // written with another LargePositionT configuration
+    Truncated,          // the stream ended (or failed) before the last element
+    OutOfRange,         // an element fails validation, see LargeSnapshotReader
+    IoError,            // a file can't be opened, mapped or written (LargeMappedStore)
+};
+
+namespace large_coordinates_detail
+{
+
+inline uint32_t byte_swap32(uint32_t value)
+{
+    return (value >> 24) | ((value >> 8) & 0x0000ff00u) | ((value << 8) & 0x00ff0000u) | (value << 24);
+}
+
+inline void byte_swap_lane(void* data, size_t count)
+{
+    uint32_t* words = static_cast<uint32_t*>(data);
+    for (size_t i = 0; i < count; i++)
+    {
+        words[i] = byte_swap32(words[i]);
+    }
+}
+
+inline void byte_swap_header(LargeSnapshotHeader& header)
+{
+    uint32_t* words = reinterpret_cast<uint32_t*>(&header);
+    // magic, (version | header_size), cell_size, chunk_elements, count (two words swapped below), bounds, reserved
+    for (size_t i = 0; i < sizeof(header) / sizeof(uint32_t); i++)
+    {
+        words[i] = byte_swap32(words[i]);
+    }
+    std::swap(header.version, header.header_size);
+    std::swap(words[4], words[5]);
+}
+
+// True when every element in [first, first + count) is a valid LargePosition within the given cell bounds.
+// Branch-free over the elements so the compiler can vectorize it.
+inline bool validate_lanes(const PositionLanes& lanes, size_t first, size_t count, const int3& min_cell, const int3& max_cell)
+{
+    constexpr float threshold = LargePosition::THRESHOLD;
+    const int32_t* global[3] = {lanes.global_x, lanes.global_y, lanes.global_z};
+    const float* local[3] = {lanes.local_x, lanes.local_y, lanes.local_z};
+    const int32_t min_bound[3] = {min_cell.x, min_cell.y, min_cell.z};
+    const int32_t max_bound[3] = {max_cell.x, max_cell.y, max_cell.z};
+
+    bool valid = true;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (size_t i = first; i < first + count; i++)
+        {
+            const int32_t g = global[axis][i];
+            const float l = local[axis][i];
+            // NaN fails the threshold comparison. The extreme cells only reach MIN_COORDINATE / MAX_COORDINATE at their
+            // center, so their offset must point inwards.
+            valid &= (g >= min_bound[axis]) & (g <= max_bound[axis]) & (std::abs(l) <= threshold);
+            valid &= ((g != INT32_MIN) | (l >= 0.0f)) & ((g != INT32_MAX) | (l <= 0.0f));
+        }
+    }
+    return valid;
+}
+
+} // namespace large_coordinates_detail
+
+// Checks the header fields of a snapshot (in host byte order) that was written for LargePosition
+inline SnapshotStatus validate_snapshot_header(const LargeSnapshotHeader& header)
+{
+    if (header.magic != LargeSnapshotHeader::MAGIC)
+    {
+        return SnapshotStatus::BadMagic;
+    }
+    if (header.version > LargeSnapshotHeader::VERSION)
+    {
+        return SnapshotStatus::UnsupportedVersion;
+    }
+    const bool bounds_valid = header.min_cell.x <= header.max_cell.x && header.min_cell.y <= header.max_cell.y &&
+                              header.min_cell.z <= header.max_cell.z;
+    const bool chunk_valid =
+        header.chunk_elements != 0 && header.chunk_elements % 16 == 0 && header.chunk_elements <= LargeSnapshotHeader::MAX_CHUNK_ELEMENTS;
+    if (header.version == 0 || header.header_size != sizeof(LargeSnapshotHeader) || !chunk_valid ||
+        header.count > LargeSnapshotHeader::MAX_COUNT || (header.count > 0 && !bounds_valid))
+    {
+        return SnapshotStatus::BadHeader;
+    }
+    if (header.cell_size != LargePosition::CELL_SIZE)
+    {
+        return SnapshotStatus::CellSizeMismatch;
+    }
+    return SnapshotStatus::Ok;
+}
+
+// Writes `positions` as a snapshot to `out`, in chunks of `chunk_elements` (a multiple of 16, up to MAX_CHUNK_ELEMENTS).
+// Returns false when the stream fails.
+inline bool write_snapshot(std::ostream& out, const LargePositionBuffer& positions,
+                           uint32_t chunk_elements = LargeSnapshotHeader::DEFAULT_CHUNK_ELEMENTS)
+{
+    using namespace large_coordinates_detail;
+    assert(chunk_elements != 0 && chunk_elements % 16 == 0 && "Snapshot chunks must hold a multiple of 16 elements");
+    assert(chunk_elements <= LargeSnapshotHeader::MAX_CHUNK_ELEMENTS && "Snapshot chunks are too large for the reader");
+
+    LargeSnapshotHeader header = {};
+    header.magic = LargeSnapshotHeader::MAGIC;
+    header.version = LargeSnapshotHeader::VERSION;
+    header.header_size = sizeof(LargeSnapshotHeader);
+    header.cell_size = LargePosition::CELL_SIZE;
+    header.chunk_elements = chunk_elements;
+    header.count = positions.size();
+    header.min_cell = int3(INT32_MAX, INT32_MAX, INT32_MAX);
+    header.max_cell = int3(INT32_MIN, INT32_MIN, INT32_MIN);
+    const int32_t* global[3] = {positions.global_x(), positions.global_y(), positions.global_z()};
+    int32_t* min_bound[3] = {&header.min_cell.x, &header.min_cell.y, &header.min_cell.z};
+    int32_t* max_bound[3] = {&header.max_cell.x, &header.max_cell.y, &header.max_cell.z};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        int32_t lo = INT32_MAX, hi = INT32_MIN;
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            lo = (global[axis][i] < lo) ? global[axis][i] : lo;
+            hi = (global[axis][i] > hi) ? global[axis][i] : hi;
+        }
+        *min_bound[axis] = lo;
+        *max_bound[axis] = hi;
+    }
+
+    const bool swap = !host_is_little_endian();
+    LargeSnapshotHeader file_header = header;
+    if (swap)
+    {
+        byte_swap_header(file_header);
+    }
+    out.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+
+    const void* lanes[6] = {positions.global_x(), positions.global_y(), positions.global_z(),
+                            positions.local_x(),  positions.local_y(),  positions.local_z()};
+    const char padding[LargeSnapshotHeader::LANE_ALIGNMENT] = {};
+    std::vector<uint32_t> scratch(swap ? chunk_elements : 0);
+    for (uint64_t first = 0, chunk = 0; first < header.count; first += chunk_elements, chunk++)
+    {
+        const uint64_t n = header.chunk_count(chunk);
+        const uint64_t bytes = n * sizeof(float);
+        for (const void* lane : lanes)
+        {
+            const char* data = static_cast<const char*>(lane) + first * sizeof(float);
+            if (swap)
+            {
+                std::memcpy(scratch.data(), data, bytes);
+                byte_swap_lane(scratch.data(), n);
+                data = reinterpret_cast<const char*>(scratch.data());
+            }
+            out.write(data, std::streamsize(bytes));
+            out.write(padding, std::streamsize(LargeSnapshotHeader::lane_bytes(n) - bytes));
+        }
+    }
+    return bool(out);
+}
+
+// Streaming snapshot reader: reads and validates the header on construction, then appends one chunk at a time to a
+// LargePositionBuffer, so large snapshots can be processed (or loaded with progress) without a second copy.
+class LargeSnapshotReader
+{
+  public:
+    explicit LargeSnapshotReader(std::istream& in)
+        : m_in(in)
+    {
+        m_status = read_header();
+    }
+
+    // Ok when the header is valid, otherwise the reason. read_chunk() fails with the same status.
+    SnapshotStatus status() const { return m_status; }
+
+    const LargeSnapshotHeader& header() const { return m_header; }
+
+    // Number of elements not read yet
+    uint64_t remaining() const { return m_header.count - m_read; }
+
+    // Appends the next chunk to `out`. On failure `out` keeps its previous size and the reader stops.
+    SnapshotStatus read_chunk(LargePositionBuffer& out)
+    {
+        using namespace large_coordinates_detail;
+        if (m_status != SnapshotStatus::Ok || remaining() == 0)
+        {
+            return m_status;
+        }
+
+        const uint64_t n = m_header.chunk_count(m_chunk);
+        const uint64_t bytes = n * sizeof(float);
+        const size_t first = out.size();
+        out.resize(first + size_t(n));
+
+        void* lanes[6] = {out.global_x() + first, out.global_y() + first, out.global_z() + first,
+                          out.local_x() + first,  out.local_y() + first,  out.local_z() + first};
+        for (void* lane : lanes)
+        {
+            m_in.read(static_cast<char*>(lane), std::streamsize(bytes));
+            m_in.ignore(std::streamsize(LargeSnapshotHeader::lane_bytes(n) - bytes));
+            if (!m_in)
+            {
+                return fail(out, first, SnapshotStatus::Truncated);
+            }
+            if (m_swap)
+            {
+                byte_swap_lane(lane, size_t(n));
+            }
+        }
+
+        if (!validate_lanes(out.lanes(), first, size_t(n), m_header.min_cell, m_header.max_cell))
+        {
+            return fail(out, first, SnapshotStatus::OutOfRange);
+        }
+
+        m_read += n;
+        m_chunk++;
+        return SnapshotStatus::Ok;
+    }
+
+    // Appends all remaining elements to `out`. The buffer is reserved up front only when the stream length was
+    // checked against the header, so a forged count cannot trigger a huge allocation.
+    SnapshotStatus read_all(LargePositionBuffer& out)
+    {
+        if (m_status == SnapshotStatus::Ok && m_length_checked)
+        {
+            out.reserve(out.size() + size_t(remaining()));
+        }
+        while (m_status == SnapshotStatus::Ok && remaining() > 0)
+        {
+            read_chunk(out);
+        }
+        return m_status;
+    }
+
+  private:
+    SnapshotStatus read_header()
+    {
+        using namespace large_coordinates_detail;
+        m_in.read(reinterpret_cast<char*>(&m_header), sizeof(m_header));
+        if (!m_in)
+        {
+            m_header = {};
+            return SnapshotStatus::Truncated;
+        }
+
+        m_swap = !host_is_little_endian();
+        if (m_swap)
+        {
+            byte_swap_header(m_header);
+        }
+
+        SnapshotStatus status = validate_snapshot_header(m_header);
+        if (status == SnapshotStatus::Ok)
+        {
+            status = check_length();
+        }
+        if (status != SnapshotStatus::Ok)
+        {
+            m_header.count = 0;
+        }
+        return status;
+    }
+
+    // On seekable streams, a snapshot longer than the rest of the stream fails right away
+    SnapshotStatus check_length()
+    {
+        const std::streampos start = m_in.tellg();
+        if (start == std::streampos(-1))
+        {
+            m_in.clear();
+            return SnapshotStatus::Ok;
+        }
+        m_in.seekg(0, std::ios::end);
+        const std::streampos end = m_in.tellg();
+        m_in.seekg(start);
+        if (end == std::streampos(-1) || !m_in)
+        {
+            m_in.clear();
+            m_in.seekg(start);
+            return SnapshotStatus::Ok;
+        }
+        if (uint64_t(end - start) < m_header.file_size() - sizeof(LargeSnapshotHeader))
+        {
+            return SnapshotStatus::Truncated;
+        }
+        m_length_checked = true;
+        return SnapshotStatus::Ok;
+    }
+
+    SnapshotStatus fail(LargePositionBuffer& out, size_t size, SnapshotStatus status)
+    {
+        out.resize(size);
+        m_status = status;
+        return status;
+    }
+
+    std::istream& m_in;
+    LargeSnapshotHeader m_header = {};
+    SnapshotStatus m_status = SnapshotStatus::Ok;
+    bool m_swap = false;
+    bool m_length_checked = false; // the stream holds the whole snapshot
+    uint64_t m_read = 0;
+    uint64_t m_chunk = 0;
+};
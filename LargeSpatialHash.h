@@ -0,0 +1,386 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include <vector>
+
+/*
+
+LargeSpatialHash buckets objects by the cell (LargePosition::global) they are anchored to.
+
+Cells are stored in an open-addressing hash table (linear probing, 16-byte slots, backward-shift deletion),
+so lookups touch one or two cache lines and never chase list nodes. Each non-empty cell owns a bucket
+with the ids and local offsets of its objects stored as parallel arrays.
+
+Object ids are expected to be dense indices (entity indices): the grid keeps an id -> (bucket, slot) table,
+which makes remove() and update() O(1) without knowing the previous cell.
+
+The grid keeps its own copy of each object's local offset. Call update() when an object moves.
+
+*/
+class LargeSpatialHash
+{
+  public:
+    inline static constexpr uint32_t INVALID = 0xffffffffu;
+
+    struct Hit
+    {
+        uint32_t id;
+        float3 local; // offset from the query position's cell center
+    };
+
+    struct Bucket
+    {
+        int3 cell;
+        std::vector<uint32_t> ids;
+        std::vector<float3> locals;
+    };
+
+    size_t object_count() const { return m_object_count; }
+    size_t cell_count() const { return m_cell_count; }
+
+    void clear()
+    {
+        for (Slot& slot : m_slots)
+        {
+            slot.bucket = INVALID;
+        }
+        m_free_buckets.clear();
+        for (uint32_t i = 0; i < uint32_t(m_buckets.size()); i++)
+        {
+            m_buckets[i].ids.clear();
+            m_buckets[i].locals.clear();
+            m_free_buckets.push_back(i);
+        }
+        m_locations.clear();
+        m_object_count = 0;
+        m_cell_count = 0;
+    }
+
+    void reserve_cells(size_t count)
+    {
+        size_t required = table_capacity_for(count);
+        if (required > m_slots.size())
+        {
+            rehash(required);
+        }
+    }
+
+    bool contains(uint32_t id) const { return id < m_locations.size() && m_locations[id].bucket != INVALID; }
+
+    // Returns the bucket of a cell, or nullptr if the cell is empty
+    const Bucket* find_cell(const int3& cell) const
+    {
+        uint32_t bucket = find_bucket(cell);
+        return bucket == INVALID ? nullptr : &m_buckets[bucket];
+    }
+
+    void insert(uint32_t id, const LargePosition& pos)
+    {
+        assert(!contains(id) && "Object is already in the spatial hash");
+        append(acquire_bucket(pos.global), id, pos.local);
+    }
+
+    // Bulk insert; runs of objects in the same cell (e.g. sorted input) are appended without re-hashing
+    void insert(const uint32_t* ids, const LargePosition* positions, size_t count)
+    {
+        reserve_ids(ids, count);
+        uint32_t bucket = INVALID;
+        for (size_t i = 0; i < count; i++)
+        {
+            assert(!contains(ids[i]) && "Object is already in the spatial hash");
+            if (bucket == INVALID || m_buckets[bucket].cell != positions[i].global)
+            {
+                bucket = acquire_bucket(positions[i].global);
+            }
+            append(bucket, ids[i], positions[i].local);
+        }
+    }
+
+    void insert(const uint32_t* ids, const PositionLanes& positions, size_t count)
+    {
+        reserve_ids(ids, count);
+        uint32_t bucket = INVALID;
+        for (size_t i = 0; i < count; i++)
+        {
+            assert(!contains(ids[i]) && "Object is already in the spatial hash");
+            int3 cell(positions.global_x[i], positions.global_y[i], positions.global_z[i]);
+            if (bucket == INVALID || m_buckets[bucket].cell != cell)
+            {
+                bucket = acquire_bucket(cell);
+            }
+            append(bucket, ids[i], float3(positions.local_x[i], positions.local_y[i], positions.local_z[i]));
+        }
+    }
+
+    bool remove(uint32_t id)
+    {
+        if (!contains(id))
+        {
+            return false;
+        }
+        erase(id);
+        return true;
+    }
+
+    // Bulk remove, returns the number of objects that were present
+    size_t remove(const uint32_t* ids, size_t count)
+    {
+        size_t removed = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            removed += remove(ids[i]) ? 1 : 0;
+        }
+        return removed;
+    }
+
+    // Moves an object to a new position; objects that stay in their cell only refresh the stored local offset
+    void update(uint32_t id, const LargePosition& pos)
+    {
+        assert(contains(id) && "Object is not in the spatial hash");
+        Location loc = m_locations[id];
+        Bucket& bucket = m_buckets[loc.bucket];
+        if (bucket.cell == pos.global)
+        {
+            bucket.locals[loc.slot] = pos.local;
+            return;
+        }
+        erase(id);
+        append(acquire_bucket(pos.global), id, pos.local);
+    }
+
+    // Appends every object in the cube of cells within `radius_cells` of center.global to `out`.
+    // Offsets are expressed relative to center.global, exactly like LargePosition::to_float3(center.global).
+    // Returns the number of hits appended.
+    size_t gather(const LargePosition& center, int32_t radius_cells, std::vector<Hit>& out) const
+    {
+        assert(radius_cells >= 0 && "Radius must not be negative");
+        size_t first = out.size();
+        if (m_cell_count == 0)
+        {
+            return 0;
+        }
+
+        constexpr float cell_size = LargePosition::CELL_SIZE;
+        for (int32_t dz = -radius_cells; dz <= radius_cells; dz++)
+        {
+            for (int32_t dy = -radius_cells; dy <= radius_cells; dy++)
+            {
+                for (int32_t dx = -radius_cells; dx <= radius_cells; dx++)
+                {
+                    int64_t cx = int64_t(center.global.x) + dx;
+                    int64_t cy = int64_t(center.global.y) + dy;
+                    int64_t cz = int64_t(center.global.z) + dz;
+                    if (!cell_in_range(cx) || !cell_in_range(cy) || !cell_in_range(cz))
+                    {
+                        continue;
+                    }
+
+                    uint32_t bucket_index = find_bucket(int3(int32_t(cx), int32_t(cy), int32_t(cz)));
+                    if (bucket_index == INVALID)
+                    {
+                        continue;
+                    }
+
+                    const Bucket& bucket = m_buckets[bucket_index];
+                    float3 offset(dx * cell_size, dy * cell_size, dz * cell_size);
+                    for (size_t i = 0; i < bucket.ids.size(); i++)
+                    {
+                        out.push_back(Hit{bucket.ids[i], bucket.locals[i] + offset});
+                    }
+                }
+            }
+        }
+        return out.size() - first;
+    }
+
+  private:
+    struct Slot
+    {
+        int3 cell;
+        uint32_t bucket;
+    };
+
+    struct Location
+    {
+        uint32_t bucket;
+        uint32_t slot;
+    };
+
+    inline static constexpr size_t MIN_TABLE_CAPACITY = 64;
+
+    static bool cell_in_range(int64_t c) { return c >= INT32_MIN && c <= INT32_MAX; }
+
+    // Keeps the load factor at or below 50%, where linear probing stays short
+    static size_t table_capacity_for(size_t cells)
+    {
+        size_t capacity = MIN_TABLE_CAPACITY;
+        while (capacity < cells * 2)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    uint32_t find_bucket(const int3& cell) const
+    {
+        if (m_slots.empty())
+        {
+            return INVALID;
+        }
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = size_t(hash_cell(cell)) & mask;; i = (i + 1) & mask)
+        {
+            const Slot& slot = m_slots[i];
+            if (slot.bucket == INVALID)
+            {
+                return INVALID;
+            }
+            if (slot.cell == cell)
+            {
+                return slot.bucket;
+            }
+        }
+    }
+
+    void insert_slot(const int3& cell, uint32_t bucket)
+    {
+        size_t mask = m_slots.size() - 1;
+        size_t i = size_t(hash_cell(cell)) & mask;
+        while (m_slots[i].bucket != INVALID)
+        {
+            i = (i + 1) & mask;
+        }
+        m_slots[i].cell = cell;
+        m_slots[i].bucket = bucket;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.assign(capacity, Slot{int3(), INVALID});
+        for (const Slot& slot : old)
+        {
+            if (slot.bucket != INVALID)
+            {
+                insert_slot(slot.cell, slot.bucket);
+            }
+        }
+    }
+
+    uint32_t acquire_bucket(const int3& cell)
+    {
+        uint32_t existing = find_bucket(cell);
+        if (existing != INVALID)
+        {
+            return existing;
+        }
+
+        if (table_capacity_for(m_cell_count + 1) > m_slots.size())
+        {
+            rehash(table_capacity_for(m_cell_count + 1));
+        }
+
+        uint32_t bucket;
+        if (!m_free_buckets.empty())
+        {
+            bucket = m_free_buckets.back();
+            m_free_buckets.pop_back();
+        }
+        else
+        {
+            bucket = uint32_t(m_buckets.size());
+            m_buckets.emplace_back();
+        }
+        m_buckets[bucket].cell = cell;
+        insert_slot(cell, bucket);
+        m_cell_count++;
+        return bucket;
+    }
+
+    void release_bucket(uint32_t bucket_index)
+    {
+        const int3 cell = m_buckets[bucket_index].cell;
+        size_t mask = m_slots.size() - 1;
+        size_t i = size_t(hash_cell(cell)) & mask;
+        while (m_slots[i].bucket != bucket_index)
+        {
+            i = (i + 1) & mask;
+        }
+
+        // Backward-shift deletion keeps probe sequences intact without tombstones
+        for (size_t j = (i + 1) & mask; m_slots[j].bucket != INVALID; j = (j + 1) & mask)
+        {
+            size_t home = size_t(hash_cell(m_slots[j].cell)) & mask;
+            bool home_in_gap = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (!home_in_gap)
+            {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i].bucket = INVALID;
+
+        m_free_buckets.push_back(bucket_index);
+        m_cell_count--;
+    }
+
+    void reserve_ids(const uint32_t* ids, size_t count)
+    {
+        uint32_t max_id = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            max_id = ids[i] > max_id ? ids[i] : max_id;
+        }
+        if (count > 0 && max_id >= m_locations.size())
+        {
+            m_locations.resize(size_t(max_id) + 1, Location{INVALID, INVALID});
+        }
+    }
+
+    void append(uint32_t bucket_index, uint32_t id, const float3& local)
+    {
+        if (id >= m_locations.size())
+        {
+            m_locations.resize(size_t(id) + 1, Location{INVALID, INVALID});
+        }
+
+        Bucket& bucket = m_buckets[bucket_index];
+        m_locations[id] = Location{bucket_index, uint32_t(bucket.ids.size())};
+        bucket.ids.push_back(id);
+        bucket.locals.push_back(local);
+        m_object_count++;
+    }
+
+    void erase(uint32_t id)
+    {
+        Location loc = m_locations[id];
+        Bucket& bucket = m_buckets[loc.bucket];
+
+        // Swap-remove keeps the bucket arrays dense
+        uint32_t last = uint32_t(bucket.ids.size() - 1);
+        if (loc.slot != last)
+        {
+            bucket.ids[loc.slot] = bucket.ids[last];
+            bucket.locals[loc.slot] = bucket.locals[last];
+            m_locations[bucket.ids[loc.slot]].slot = loc.slot;
+        }
+        bucket.ids.pop_back();
+        bucket.locals.pop_back();
+        m_locations[id] = Location{INVALID, INVALID};
+        m_object_count--;
+
+        if (bucket.ids.empty())
+        {
+            release_bucket(loc.bucket);
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    std::vector<Bucket> m_buckets;
+    std::vector<uint32_t> m_free_buckets;
+    std::vector<Location> m_locations;
+    size_t m_object_count = 0;
+    size_t m_cell_count = 0;
+};
@@ -0,0 +1,536 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBatch.h"
+#include "LargePositionBuffer.h"
+#include "LargeThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+/*
+
+Space-filling curve keys and radix sorting for LargePosition.
+
+int3 has no meaningful order: sorting cells lexicographically keeps neighbors along x together but scatters
+neighbors along y and z far apart. Morton (Z-order) and Hilbert keys interleave the bits of all three axes,
+so objects that are close in space end up close in memory once they are sorted by key.
+
+Every axis is quantized relative to an `origin` cell:
+
+  axis = (global - origin) * 2^SubcellBits + floor((local / CELL_SIZE + 0.5) * 2^SubcellBits) + 2^(AxisBits - 1)
+
+which is the signed position in units of 1/2^SubcellBits cells, biased to be unsigned and clamped to AxisBits bits.
+Positions outside the range of the key are clamped onto its border: the sort is still valid, only less coherent there.
+
+  64-bit keys: 21 bits per axis. With the default 5 sub-cell bits they cover +/-32768 cells (~67 000 km) around the
+               origin at 64 m resolution.
+  96-bit keys: 32 bits per axis. With the default 0 sub-cell bits they cover the full int32_t cell range.
+
+Bit interleaving uses BMI2 pdep when the CPU supports it and the active SIMD level (see simd_set_level) is AVX2
+or above, and portable bit twiddling otherwise. Both produce identical keys.
+
+*/
+
+enum class SpatialCurve : int
+{
+    Morton = 0,
+    Hilbert = 1,
+};
+
+// 96-bit key (32 bits per axis), ordered as the 96-bit integer hi * 2^32 + lo
+struct SpatialKey96
+{
+    uint64_t hi;
+    uint32_t lo;
+
+    bool operator==(const SpatialKey96& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const SpatialKey96& other) const { return !(*this == other); }
+    bool operator<(const SpatialKey96& other) const { return hi != other.hi ? hi < other.hi : lo < other.lo; }
+};
+
+namespace large_coordinates_detail
+{
+
+inline bool detect_bmi2()
+{
+#if LARGE_COORDINATES_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 8)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#endif
+#else
+    return false;
+#endif
+}
+
+// Tied to the AVX2 level so that simd_set_level(SimdLevel::SSE42) also exercises the portable path
+inline bool use_pdep()
+{
+    static const bool bmi2 = detect_bmi2();
+    return bmi2 && simd_active_level() >= SimdLevel::AVX2;
+}
+
+// Moves bit i of the low 21 bits of v to bit 3 * i
+inline uint64_t spread_bits3(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x001f00000000ffffull;
+    v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+inline uint64_t interleave3_portable(uint32_t x, uint32_t y, uint32_t z)
+{
+    return spread_bits3(x) | (spread_bits3(y) << 1) | (spread_bits3(z) << 2);
+}
+
+#if LARGE_COORDINATES_X86 && (defined(__x86_64__) || defined(_M_X64))
+LARGE_COORDINATES_TARGET("bmi2")
+inline uint64_t interleave3_bmi2(uint32_t x, uint32_t y, uint32_t z)
+{
+    return _pdep_u64(x, 0x1249249249249249ull) | _pdep_u64(y, 0x2492492492492492ull) | _pdep_u64(z, 0x4924924924924924ull);
+}
+#define LARGE_COORDINATES_PDEP 1
+#else
+#define LARGE_COORDINATES_PDEP 0
+#endif
+
+// Interleaves the low 21 bits of each axis: x lands on bits 0, 3, 6, ..., z on bits 2, 5, 8, ...
+inline uint64_t interleave3(uint32_t x, uint32_t y, uint32_t z, bool pdep)
+{
+#if LARGE_COORDINATES_PDEP
+    if (pdep)
+    {
+        return interleave3_bmi2(x & 0x1fffff, y & 0x1fffff, z & 0x1fffff);
+    }
+#else
+    (void)pdep;
+#endif
+    return interleave3_portable(x, y, z);
+}
+
+// Interleaves all 32 bits of each axis: the low 21 bits of every axis form bits 0-62, the high 11 bits form bits 63-95
+inline SpatialKey96 interleave3_96(uint32_t x, uint32_t y, uint32_t z, bool pdep)
+{
+    uint64_t low = interleave3(x, y, z, pdep);
+    uint64_t high = interleave3(x >> 21, y >> 21, z >> 21, pdep);
+    return SpatialKey96{(low >> 32) | (high << 31), uint32_t(low)};
+}
+
+// Converts axes to the "transposed" Hilbert index (J. Skilling, "Programming the Hilbert curve", 2004).
+// Interleaving the result with axis[0] as the most significant bit of each triple gives the Hilbert index.
+inline void hilbert_transpose(uint32_t axis[3], uint32_t bits)
+{
+    const uint32_t top = 1u << (bits - 1);
+
+    // Inverse undo. Branch-free: the bit tests are data dependent and would mispredict about half of the time.
+    for (uint32_t q = top; q > 1; q >>= 1)
+    {
+        uint32_t p = q - 1;
+        for (int i = 0; i < 3; i++)
+        {
+            // Bit set: invert the low bits of axis[0]. Bit clear: exchange the low bits of axis[0] and axis[i].
+            uint32_t set = 0u - uint32_t((axis[i] & q) != 0);
+            uint32_t t = (axis[0] ^ axis[i]) & p & ~set;
+            axis[0] ^= (p & set) | t;
+            axis[i] ^= t;
+        }
+    }
+
+    // Gray encode
+    axis[1] ^= axis[0];
+    axis[2] ^= axis[1];
+    uint32_t t = 0;
+    for (uint32_t q = top; q > 1; q >>= 1)
+    {
+        t ^= (q - 1) & (0u - uint32_t((axis[2] & q) != 0));
+    }
+    axis[0] ^= t;
+    axis[1] ^= t;
+    axis[2] ^= t;
+}
+
+template <uint32_t AxisBits, uint32_t SubcellBits>
+inline uint32_t quantize_axis(int32_t global, int32_t origin, float local)
+{
+    static_assert(AxisBits <= 32 && SubcellBits < AxisBits, "Sub-cell bits must leave room for the cell index");
+    constexpr double subcells = double(1ull << SubcellBits);
+    constexpr int64_t bias = int64_t(1) << (AxisBits - 1);
+    constexpr int64_t max_value = (int64_t(1) << AxisBits) - 1;
+
+    // Exact in double: CELL_SIZE and the sub-cell count are powers of two and local has 24 significant bits
+    int64_t subcell = int64_t(std::floor(double(local) * (subcells / LargePosition::CELL_SIZE) + subcells * 0.5));
+    int64_t value = (int64_t(global) - origin) * int64_t(1ull << SubcellBits) + subcell + bias;
+    return uint32_t(std::min(std::max(value, int64_t(0)), max_value));
+}
+
+template <uint32_t AxisBits, uint32_t SubcellBits>
+inline void quantize_position(const int3& global, const float3& local, const int3& origin, uint32_t axis[3])
+{
+    axis[0] = quantize_axis<AxisBits, SubcellBits>(global.x, origin.x, local.x);
+    axis[1] = quantize_axis<AxisBits, SubcellBits>(global.y, origin.y, local.y);
+    axis[2] = quantize_axis<AxisBits, SubcellBits>(global.z, origin.z, local.z);
+}
+
+template <uint32_t SubcellBits>
+inline uint64_t spatial_key64(SpatialCurve curve, const int3& global, const float3& local, const int3& origin, bool pdep)
+{
+    uint32_t axis[3];
+    quantize_position<21, SubcellBits>(global, local, origin, axis);
+    if (curve == SpatialCurve::Hilbert)
+    {
+        hilbert_transpose(axis, 21);
+        return interleave3(axis[2], axis[1], axis[0], pdep);
+    }
+    return interleave3(axis[0], axis[1], axis[2], pdep);
+}
+
+template <uint32_t SubcellBits>
+inline SpatialKey96 spatial_key96(SpatialCurve curve, const int3& global, const float3& local, const int3& origin, bool pdep)
+{
+    uint32_t axis[3];
+    quantize_position<32, SubcellBits>(global, local, origin, axis);
+    if (curve == SpatialCurve::Hilbert)
+    {
+        hilbert_transpose(axis, 32);
+        return interleave3_96(axis[2], axis[1], axis[0], pdep);
+    }
+    return interleave3_96(axis[0], axis[1], axis[2], pdep);
+}
+
+inline uint32_t radix_digit(uint64_t key, uint32_t pass) { return uint32_t(key >> (pass * 8)) & 0xff; }
+
+inline uint32_t radix_digit(const SpatialKey96& key, uint32_t pass)
+{
+    return pass < 4 ? (key.lo >> (pass * 8)) & 0xff : uint32_t(key.hi >> ((pass - 4) * 8)) & 0xff;
+}
+
+// Runs fn(0) .. fn(chunk_count - 1): on the pool if there is one, otherwise on fresh threads with fn(0) on the
+// calling thread
+template <typename Fn>
+inline void run_chunks(uint32_t chunk_count, LargeThreadPool* pool, const Fn& fn)
+{
+    if (pool)
+    {
+        pool->parallel_for(chunk_count, 1,
+                           [&](size_t begin, size_t end)
+                           {
+                               for (size_t t = begin; t < end; t++)
+                               {
+                                   fn(uint32_t(t));
+                               }
+                           });
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(chunk_count - 1);
+    for (uint32_t t = 1; t < chunk_count; t++)
+    {
+        threads.emplace_back([&fn, t]() { fn(t); });
+    }
+    fn(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Below this many elements per chunk, starting threads costs more than it saves
+inline constexpr size_t RADIX_SORT_MIN_CHUNK = size_t(1) << 15;
+
+// Waking the workers of a pool is much cheaper than starting threads, so pool chunks can be smaller
+inline constexpr size_t RADIX_SORT_POOL_MIN_CHUNK = size_t(1) << 13;
+
+// Stable LSD radix sort with 8-bit digits. Every pass builds per-chunk histograms of contiguous chunks, so each
+// chunk is scattered into disjoint, precomputed ranges of the output. Passes where all keys share the
+// same digit (common for the high bytes of clustered keys) are skipped.
+template <typename Key, uint32_t Passes>
+inline void radix_sort_pairs(Key* keys, uint32_t* values, size_t count, uint32_t thread_count, LargeThreadPool* pool)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    size_t min_chunk = RADIX_SORT_MIN_CHUNK;
+    if (pool)
+    {
+        thread_count = pool->thread_count();
+        min_chunk = RADIX_SORT_POOL_MIN_CHUNK;
+    }
+    else if (thread_count == 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const uint32_t chunk_count = uint32_t(std::min<size_t>(thread_count, std::max<size_t>(1, count / min_chunk)));
+    const size_t chunk = (count + chunk_count - 1) / chunk_count;
+    if (chunk_count == 1)
+    {
+        pool = nullptr; // sorted on the calling thread
+    }
+
+    // One read of the keys finds the passes that would not move anything
+    std::vector<size_t> totals(size_t(chunk_count) * Passes * 256, 0);
+    run_chunks(chunk_count, pool,
+               [&](uint32_t t)
+               {
+                   size_t* histogram = &totals[size_t(t) * Passes * 256];
+                   for (size_t i = t * chunk; i < std::min(count, (t + 1) * chunk); i++)
+                   {
+                       for (uint32_t pass = 0; pass < Passes; pass++)
+                       {
+                           histogram[pass * 256 + radix_digit(keys[i], pass)]++;
+                       }
+                   }
+               });
+    bool skip[Passes];
+    for (uint32_t pass = 0; pass < Passes; pass++)
+    {
+        size_t first_digit_count = 0;
+        for (uint32_t t = 0; t < chunk_count; t++)
+        {
+            first_digit_count += totals[(size_t(t) * Passes + pass) * 256 + radix_digit(keys[0], pass)];
+        }
+        skip[pass] = first_digit_count == count;
+    }
+
+    std::vector<Key> key_scratch(count);
+    std::vector<uint32_t> value_scratch(count);
+    Key* src_keys = keys;
+    uint32_t* src_values = values;
+    Key* dst_keys = key_scratch.data();
+    uint32_t* dst_values = value_scratch.data();
+    std::vector<size_t> offsets(size_t(chunk_count) * 256);
+
+    for (uint32_t pass = 0; pass < Passes; pass++)
+    {
+        if (skip[pass])
+        {
+            continue;
+        }
+
+        run_chunks(chunk_count, pool,
+                   [&](uint32_t t)
+                   {
+                       size_t* histogram = &offsets[size_t(t) * 256];
+                       std::fill(histogram, histogram + 256, size_t(0));
+                       for (size_t i = t * chunk; i < std::min(count, (t + 1) * chunk); i++)
+                       {
+                           histogram[radix_digit(src_keys[i], pass)]++;
+                       }
+                   });
+
+        // Digit-major prefix sum: chunk t writes its elements of digit d after those of chunks 0 .. t-1 (stability)
+        size_t running = 0;
+        for (uint32_t digit = 0; digit < 256; digit++)
+        {
+            for (uint32_t t = 0; t < chunk_count; t++)
+            {
+                size_t digit_count = offsets[size_t(t) * 256 + digit];
+                offsets[size_t(t) * 256 + digit] = running;
+                running += digit_count;
+            }
+        }
+
+        run_chunks(chunk_count, pool,
+                   [&](uint32_t t)
+                   {
+                       size_t* offset = &offsets[size_t(t) * 256];
+                       for (size_t i = t * chunk; i < std::min(count, (t + 1) * chunk); i++)
+                       {
+                           size_t target = offset[radix_digit(src_keys[i], pass)]++;
+                           dst_keys[target] = src_keys[i];
+                           dst_values[target] = src_values[i];
+                       }
+                   });
+
+        std::swap(src_keys, dst_keys);
+        std::swap(src_values, dst_values);
+    }
+
+    if (src_keys != keys)
+    {
+        std::copy(src_keys, src_keys + count, keys);
+        std::copy(src_values, src_values + count, values);
+    }
+}
+
+template <typename T>
+inline void permute_lane(T* lane, const uint32_t* order, size_t count, std::vector<T>& scratch)
+{
+    scratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        scratch[i] = lane[order[i]];
+    }
+    std::copy(scratch.begin(), scratch.end(), lane);
+}
+
+} // namespace large_coordinates_detail
+
+// Sub-cell bits used by spatial_sort (64-bit keys)
+inline constexpr uint32_t SPATIAL_SORT_SUBCELL_BITS = 5;
+
+// 64-bit Morton (Z-order) key of pos, quantized relative to the origin cell
+template <uint32_t SubcellBits = SPATIAL_SORT_SUBCELL_BITS>
+inline uint64_t morton_key64(const LargePosition& pos, const int3& origin = int3(0, 0, 0))
+{
+    using namespace large_coordinates_detail;
+    return spatial_key64<SubcellBits>(SpatialCurve::Morton, pos.global, pos.local, origin, use_pdep());
+}
+
+// 64-bit Hilbert key of pos, quantized relative to the origin cell
+// Consecutive keys are always face neighbors, which gives better locality than Morton at a higher encoding cost.
+template <uint32_t SubcellBits = SPATIAL_SORT_SUBCELL_BITS>
+inline uint64_t hilbert_key64(const LargePosition& pos, const int3& origin = int3(0, 0, 0))
+{
+    using namespace large_coordinates_detail;
+    return spatial_key64<SubcellBits>(SpatialCurve::Hilbert, pos.global, pos.local, origin, use_pdep());
+}
+
+// 96-bit Morton key; with SubcellBits = 0 and the default origin it orders the whole cell range
+template <uint32_t SubcellBits = 0>
+inline SpatialKey96 morton_key96(const LargePosition& pos, const int3& origin = int3(0, 0, 0))
+{
+    using namespace large_coordinates_detail;
+    return spatial_key96<SubcellBits>(SpatialCurve::Morton, pos.global, pos.local, origin, use_pdep());
+}
+
+// 96-bit Hilbert key; with SubcellBits = 0 and the default origin it orders the whole cell range
+template <uint32_t SubcellBits = 0>
+inline SpatialKey96 hilbert_key96(const LargePosition& pos, const int3& origin = int3(0, 0, 0))
+{
+    using namespace large_coordinates_detail;
+    return spatial_key96<SubcellBits>(SpatialCurve::Hilbert, pos.global, pos.local, origin, use_pdep());
+}
+
+// Batch key generation over SoA lanes, keys[i] equals morton_key64 / hilbert_key64 of element i
+template <uint32_t SubcellBits = SPATIAL_SORT_SUBCELL_BITS>
+inline void spatial_keys64(SpatialCurve curve, const int3& origin, const PositionLanes& src, uint64_t* keys, size_t count)
+{
+    using namespace large_coordinates_detail;
+    const bool pdep = use_pdep();
+    for (size_t i = 0; i < count; i++)
+    {
+        int3 global(src.global_x[i], src.global_y[i], src.global_z[i]);
+        float3 local(src.local_x[i], src.local_y[i], src.local_z[i]);
+        keys[i] = spatial_key64<SubcellBits>(curve, global, local, origin, pdep);
+    }
+}
+
+template <uint32_t SubcellBits = 0>
+inline void spatial_keys96(SpatialCurve curve, const int3& origin, const PositionLanes& src, SpatialKey96* keys, size_t count)
+{
+    using namespace large_coordinates_detail;
+    const bool pdep = use_pdep();
+    for (size_t i = 0; i < count; i++)
+    {
+        int3 global(src.global_x[i], src.global_y[i], src.global_z[i]);
+        float3 local(src.local_x[i], src.local_y[i], src.local_z[i]);
+        keys[i] = spatial_key96<SubcellBits>(curve, global, local, origin, pdep);
+    }
+}
+
+// Stable radix sort of keys, applying the same permutation to values (typically element indices).
+// thread_count = 0 uses every hardware thread; small arrays are always sorted on the calling thread.
+inline void radix_sort(uint64_t* keys, uint32_t* values, size_t count, uint32_t thread_count = 0)
+{
+    large_coordinates_detail::radix_sort_pairs<uint64_t, 8>(keys, values, count, thread_count, nullptr);
+}
+
+inline void radix_sort(SpatialKey96* keys, uint32_t* values, size_t count, uint32_t thread_count = 0)
+{
+    large_coordinates_detail::radix_sort_pairs<SpatialKey96, 12>(keys, values, count, thread_count, nullptr);
+}
+
+// Same sorts on the threads of a pool, which avoids starting threads on every pass of repeated or mid-size sorts
+inline void radix_sort(uint64_t* keys, uint32_t* values, size_t count, LargeThreadPool& pool)
+{
+    large_coordinates_detail::radix_sort_pairs<uint64_t, 8>(keys, values, count, 0, &pool);
+}
+
+inline void radix_sort(SpatialKey96* keys, uint32_t* values, size_t count, LargeThreadPool& pool)
+{
+    large_coordinates_detail::radix_sort_pairs<SpatialKey96, 12>(keys, values, count, 0, &pool);
+}
+
+namespace large_coordinates_detail
+{
+
+inline void spatial_sort_order(SpatialCurve curve, const int3& origin, const PositionLanes& src, size_t count, uint32_t* order,
+                               uint32_t thread_count, LargeThreadPool* pool)
+{
+    assert(count <= UINT32_MAX && "Too many positions for 32-bit indices");
+    std::vector<uint64_t> keys(count);
+    spatial_keys64(curve, origin, src, keys.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        order[i] = uint32_t(i);
+    }
+    radix_sort_pairs<uint64_t, 8>(keys.data(), order, count, thread_count, pool);
+}
+
+inline void spatial_sort(LargePositionBuffer& buffer, const int3& origin, SpatialCurve curve, uint32_t* order, uint32_t thread_count,
+                         LargeThreadPool* pool)
+{
+    const size_t count = buffer.size();
+    std::vector<uint32_t> own_order;
+    if (!order)
+    {
+        own_order.resize(count);
+        order = own_order.data();
+    }
+    spatial_sort_order(curve, origin, buffer.lanes(), count, order, thread_count, pool);
+
+    // Lane by lane, so every pass reads one lane and writes one lane
+    std::vector<int32_t> global_scratch;
+    std::vector<float> local_scratch;
+    permute_lane(buffer.global_x(), order, count, global_scratch);
+    permute_lane(buffer.global_y(), order, count, global_scratch);
+    permute_lane(buffer.global_z(), order, count, global_scratch);
+    permute_lane(buffer.local_x(), order, count, local_scratch);
+    permute_lane(buffer.local_y(), order, count, local_scratch);
+    permute_lane(buffer.local_z(), order, count, local_scratch);
+}
+
+} // namespace large_coordinates_detail
+
+// Writes the permutation that orders the positions along a curve around `origin`: order[i] is the index of the
+// element that goes to position i. Equal keys keep their original relative order.
+inline void spatial_sort_order(SpatialCurve curve, const int3& origin, const PositionLanes& src, size_t count, uint32_t* order,
+                               uint32_t thread_count = 0)
+{
+    large_coordinates_detail::spatial_sort_order(curve, origin, src, count, order, thread_count, nullptr);
+}
+
+inline void spatial_sort_order(SpatialCurve curve, const int3& origin, const PositionLanes& src, size_t count, uint32_t* order,
+                               LargeThreadPool& pool)
+{
+    large_coordinates_detail::spatial_sort_order(curve, origin, src, count, order, 0, &pool);
+}
+
+// Reorders the buffer along a curve around `origin`. If `order` is not null it receives the permutation
+// (buffer.size() entries, see spatial_sort_order) so that arrays of per-object data can be reordered the same way.
+inline void spatial_sort(LargePositionBuffer& buffer, const int3& origin, SpatialCurve curve = SpatialCurve::Morton,
+                         uint32_t* order = nullptr, uint32_t thread_count = 0)
+{
+    large_coordinates_detail::spatial_sort(buffer, origin, curve, order, thread_count, nullptr);
+}
+
+inline void spatial_sort(LargePositionBuffer& buffer, const int3& origin, SpatialCurve curve, uint32_t* order, LargeThreadPool& pool)
+{
+    large_coordinates_detail::spatial_sort(buffer, origin, curve, order, 0, &pool);
+}
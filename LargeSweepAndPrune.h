@@ -0,0 +1,317 @@
+#pragma once
+
+#include "LargeAABB.h"
+#include "LargeCoordinates.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+/*
+
+LargeSweepAndPrune is a sort-and-sweep broadphase over LargeAABBs that spans cell boundaries.
+
+A per-cell sweep misses pairs across cells: hysteresis lets an object's local offset reach up to 0.75 cells past its
+cell center, so two touching objects can be anchored to different cells. Instead, space is divided into regions of
+REGION_CELLS^3 cells, and every region sorts its boxes in one stable float frame: the center of a fixed cell near the
+middle of the region, with the same float(cell delta) * CELL_SIZE + local math as to_float3(). Frames never move,
+so the sorted order stays valid from one frame to the next.
+
+Each box is entered in every region its natural cells touch (computed from min/max including any local offset
+beyond +/-CELL_SIZE/2). Boxes straddling regions are therefore tested in several regions; a pair is reported only
+by the lowest region both boxes belong to, which is decided with integer region indices and never depends on float
+rounding.
+
+find_pairs() refreshes the frame bounds of every entry, restores the order along x with an insertion sort (nearly
+linear when objects moved a little since the last frame) and sweeps along x, testing y and z for the boxes whose
+x intervals overlap.
+
+Object ids are dense indices (entity indices), like in LargeSpatialHash.
+
+*/
+class LargeSweepAndPrune
+{
+  public:
+    // Region edge length in cells; frame offsets stay within a few cells, where float precision is ~1 mm
+    inline static constexpr int32_t REGION_CELLS = 4;
+
+    struct Pair
+    {
+        uint32_t a; // a < b
+        uint32_t b;
+    };
+
+    size_t object_count() const { return m_object_count; }
+    size_t region_count() const { return m_region_slots.size(); }
+
+    bool contains(uint32_t id) const { return id < m_objects.size() && m_objects[id].alive; }
+
+    void clear()
+    {
+        m_objects.clear();
+        m_regions.clear();
+        m_region_slots.clear();
+        m_free_regions.clear();
+        m_object_count = 0;
+    }
+
+    void insert(uint32_t id, const LargeAABB& box)
+    {
+        assert(!contains(id) && "Object is already in the broadphase");
+        if (id >= m_objects.size())
+        {
+            m_objects.resize(size_t(id) + 1);
+        }
+        Object& object = m_objects[id];
+        object.box = box;
+        object.alive = true;
+        object.epoch++;
+        region_range(box, object.region_min, object.region_max);
+        enter_regions(id, object);
+        m_object_count++;
+    }
+
+    void update(uint32_t id, const LargeAABB& box)
+    {
+        assert(contains(id) && "Object is not in the broadphase");
+        Object& object = m_objects[id];
+        object.box = box;
+
+        // A new region range invalidates all current entries (dropped during the next find_pairs()) and re-enters
+        // the object everywhere, so no region ever holds two live entries of one object
+        int3 region_min, region_max;
+        region_range(box, region_min, region_max);
+        if (region_min != object.region_min || region_max != object.region_max)
+        {
+            object.region_min = region_min;
+            object.region_max = region_max;
+            object.epoch++;
+            enter_regions(id, object);
+        }
+    }
+
+    bool remove(uint32_t id)
+    {
+        if (!contains(id))
+        {
+            return false;
+        }
+        m_objects[id].alive = false;
+        m_object_count--;
+        return true;
+    }
+
+    // Appends every overlapping pair once, returns the number of pairs appended
+    size_t find_pairs(std::vector<Pair>& out)
+    {
+        const size_t first = out.size();
+        for (size_t r = 0; r < m_regions.size(); r++)
+        {
+            Region& region = m_regions[r];
+            if (region.entries.empty())
+            {
+                continue;
+            }
+            refresh(region);
+            if (region.entries.empty())
+            {
+                release_region(uint32_t(r));
+                continue;
+            }
+            sort(region);
+            sweep(region, out);
+        }
+        return out.size() - first;
+    }
+
+  private:
+    struct Object
+    {
+        LargeAABB box;
+        int3 region_min;
+        int3 region_max;
+        uint32_t epoch = 0; // entries made with an older epoch are stale
+        bool alive = false;
+    };
+
+    // Box bounds in the region frame
+    struct Entry
+    {
+        float min_x, max_x;
+        float min_y, max_y;
+        float min_z, max_z;
+        uint32_t id;
+        uint32_t epoch;
+    };
+
+    struct Region
+    {
+        int3 index;
+        int3 frame_cell;
+        std::vector<Entry> entries;
+        size_t sorted = 0; // entries [0, sorted) were in order after the last find_pairs(), the rest are new
+    };
+
+    static int32_t floor_div(int64_t value, int32_t divisor)
+    {
+        int64_t q = value / divisor;
+        return int32_t(q * divisor > value ? q - 1 : q);
+    }
+
+    // Natural cell of one coordinate, which differs from `global` when |local| > CELL_SIZE / 2
+    static int64_t natural_cell(int32_t global, float local)
+    {
+        return int64_t(global) + int64_t(std::floor(local / LargePosition::CELL_SIZE + 0.5f));
+    }
+
+    static void region_range(const LargeAABB& box, int3& region_min, int3& region_max)
+    {
+        region_min = int3(floor_div(natural_cell(box.min.global.x, box.min.local.x), REGION_CELLS),
+                          floor_div(natural_cell(box.min.global.y, box.min.local.y), REGION_CELLS),
+                          floor_div(natural_cell(box.min.global.z, box.min.local.z), REGION_CELLS));
+        region_max = int3(floor_div(natural_cell(box.max.global.x, box.max.local.x), REGION_CELLS),
+                          floor_div(natural_cell(box.max.global.y, box.max.local.y), REGION_CELLS),
+                          floor_div(natural_cell(box.max.global.z, box.max.local.z), REGION_CELLS));
+    }
+
+    void enter_regions(uint32_t id, const Object& object)
+    {
+        for (int32_t z = object.region_min.z; z <= object.region_max.z; z++)
+        {
+            for (int32_t y = object.region_min.y; y <= object.region_max.y; y++)
+            {
+                for (int32_t x = object.region_min.x; x <= object.region_max.x; x++)
+                {
+                    Entry entry = {};
+                    entry.id = id;
+                    entry.epoch = object.epoch;
+                    m_regions[acquire_region(int3(x, y, z))].entries.push_back(entry);
+                }
+            }
+        }
+    }
+
+    uint32_t acquire_region(const int3& index)
+    {
+        auto found = m_region_slots.find(index);
+        if (found != m_region_slots.end())
+        {
+            return found->second;
+        }
+
+        uint32_t slot;
+        if (!m_free_regions.empty())
+        {
+            slot = m_free_regions.back();
+            m_free_regions.pop_back();
+        }
+        else
+        {
+            slot = uint32_t(m_regions.size());
+            m_regions.emplace_back();
+        }
+
+        // Frame at the center of cell REGION_CELLS / 2 of the region (int64 keeps the edge regions from overflowing)
+        Region& region = m_regions[slot];
+        region.index = index;
+        auto frame = [](int32_t r) { return int32_t(std::min<int64_t>(int64_t(r) * REGION_CELLS + REGION_CELLS / 2, INT32_MAX)); };
+        region.frame_cell = int3(frame(index.x), frame(index.y), frame(index.z));
+        m_region_slots.emplace(index, slot);
+        return slot;
+    }
+
+    void release_region(uint32_t slot)
+    {
+        m_region_slots.erase(m_regions[slot].index);
+        m_free_regions.push_back(slot);
+    }
+
+    // Drops entries of removed objects and stale entries, recomputes the frame bounds of the rest
+    void refresh(Region& region)
+    {
+        const int3 c = region.frame_cell;
+        size_t kept = 0;
+        size_t kept_sorted = 0;
+        for (size_t i = 0; i < region.entries.size(); i++)
+        {
+            Entry entry = region.entries[i];
+            const Object& object = m_objects[entry.id];
+            if (!object.alive || entry.epoch != object.epoch)
+            {
+                continue;
+            }
+            const LargeAABB& box = object.box;
+            entry.min_x = LargeAABB::axis_offset(box.min.global.x, box.min.local.x, c.x);
+            entry.max_x = LargeAABB::axis_offset(box.max.global.x, box.max.local.x, c.x);
+            entry.min_y = LargeAABB::axis_offset(box.min.global.y, box.min.local.y, c.y);
+            entry.max_y = LargeAABB::axis_offset(box.max.global.y, box.max.local.y, c.y);
+            entry.min_z = LargeAABB::axis_offset(box.min.global.z, box.min.local.z, c.z);
+            entry.max_z = LargeAABB::axis_offset(box.max.global.z, box.max.local.z, c.z);
+            region.entries[kept++] = entry;
+            kept_sorted += i < region.sorted ? 1 : 0;
+        }
+        region.entries.resize(kept);
+        region.sorted = kept_sorted;
+    }
+
+    // Entries keep their order between frames, so an insertion sort of the old entries is close to linear for
+    // coherent motion. New entries are sorted separately and merged in, which keeps bulk insertion O(n log n).
+    static void sort(Region& region)
+    {
+        std::vector<Entry>& entries = region.entries;
+        auto by_min_x = [](const Entry& a, const Entry& b) { return a.min_x < b.min_x; };
+        for (size_t i = 1; i < region.sorted; i++)
+        {
+            if (!(entries[i].min_x < entries[i - 1].min_x))
+            {
+                continue;
+            }
+            Entry moving = entries[i];
+            size_t j = i;
+            for (; j > 0 && moving.min_x < entries[j - 1].min_x; j--)
+            {
+                entries[j] = entries[j - 1];
+            }
+            entries[j] = moving;
+        }
+        if (region.sorted < entries.size())
+        {
+            std::sort(entries.begin() + region.sorted, entries.end(), by_min_x);
+            std::inplace_merge(entries.begin(), entries.begin() + region.sorted, entries.end(), by_min_x);
+        }
+        region.sorted = entries.size();
+    }
+
+    void sweep(const Region& region, std::vector<Pair>& out) const
+    {
+        const Entry* entries = region.entries.data();
+        const size_t count = region.entries.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            const Entry a = entries[i];
+            for (size_t j = i + 1; j < count && entries[j].min_x <= a.max_x; j++)
+            {
+                // Non-short-circuit: the y/z test is almost always false, one branch predicts better than four
+                const Entry& b = entries[j];
+                bool overlap = (b.min_y <= a.max_y) & (a.min_y <= b.max_y) & (b.min_z <= a.max_z) & (a.min_z <= b.max_z);
+                if (overlap && owns_pair(region.index, m_objects[a.id], m_objects[b.id]))
+                {
+                    out.push_back(a.id < b.id ? Pair{a.id, b.id} : Pair{b.id, a.id});
+                }
+            }
+        }
+    }
+
+    // The lowest region shared by both objects reports the pair
+    static bool owns_pair(const int3& region, const Object& a, const Object& b)
+    {
+        return region.x == std::max(a.region_min.x, b.region_min.x) && region.y == std::max(a.region_min.y, b.region_min.y) &&
+               region.z == std::max(a.region_min.z, b.region_min.z);
+    }
+
+    std::vector<Object> m_objects;
+    std::vector<Region> m_regions;
+    std::unordered_map<int3, uint32_t> m_region_slots;
+    std::vector<uint32_t> m_free_regions;
+    size_t m_object_count = 0;
+};
@@ -0,0 +1,358 @@
+#pragma once
+
+#include "LargePositionBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+
+LargeThreadPool is a small work-stealing scheduler for data-parallel loops, with parallel versions of the batch
+conversions built on top of it.
+
+parallel_for() splits a range lazily: the thread running a range pushes its upper half onto its own queue and
+keeps the lower half, until the range is no larger than the grain. Owners pop the most recently pushed (smallest,
+cache-warm) range from the back of their queue; idle threads steal the oldest (largest) range from the front of
+another queue, so a steal takes about half of the victim's remaining work and steals stay rare. The calling thread
+works too, so a pool of N threads runs N - 1 workers. Idle workers sleep on a condition variable.
+
+Ranges are split at multiples of `align`, which the batch wrappers set to 64 elements: the changed_mask words of
+batch_from_float3() are then never shared between threads, and lanes keep the alignment of the buffer.
+
+parallel_for() may be called from inside a task of the same pool (the caller keeps stealing until its range is
+done). Calls from several outside threads are serialized. The loop body must not throw.
+
+*/
+class LargeThreadPool
+{
+  public:
+    // thread_count counts the calling thread; 0 uses std::thread::hardware_concurrency()
+    explicit LargeThreadPool(uint32_t thread_count = 0)
+    {
+        if (thread_count == 0)
+        {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        m_queues.resize(thread_count);
+        for (std::unique_ptr<WorkQueue>& queue : m_queues)
+        {
+            queue.reset(new WorkQueue());
+        }
+        m_workers.reserve(thread_count - 1);
+        for (uint32_t i = 0; i + 1 < thread_count; i++)
+        {
+            m_workers.emplace_back([this, i] { worker_main(i); });
+        }
+    }
+
+    ~LargeThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    LargeThreadPool(const LargeThreadPool&) = delete;
+    LargeThreadPool& operator=(const LargeThreadPool&) = delete;
+
+    uint32_t thread_count() const { return uint32_t(m_queues.size()); }
+
+    // Index of the calling thread in [0, thread_count()) while it runs a parallel_for() range of this pool.
+    // No two threads have the same index at the same time, so it can select per-thread scratch data.
+    uint32_t thread_index() const
+    {
+        assert(current_context().pool == this && "Not called from a parallel_for() of this pool");
+        return current_context().index;
+    }
+
+    // Process-wide pool with one thread per hardware thread, created on first use
+    static LargeThreadPool& shared()
+    {
+        static LargeThreadPool pool;
+        return pool;
+    }
+
+    // Calls fn(begin, end) over disjoint ranges covering [0, count) and returns once all of them are done.
+    // Ranges hold at most `grain` elements (rounded up to a multiple of `align`) and start at multiples of `align`;
+    // a pool with a single thread calls fn(0, count) directly.
+    template <typename Fn>
+    void parallel_for(size_t count, size_t grain, const Fn& fn, size_t align = 1)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        assert(align > 0 && "Alignment must be positive");
+        grain = (std::max<size_t>(grain, 1) + align - 1) / align * align;
+
+        // Outside threads share the last queue, one at a time; nested calls run on the queue of the current thread
+        ThreadContext& context = current_context();
+        const ThreadContext saved = context;
+        std::unique_lock<std::mutex> external_lock;
+        if (context.pool != this)
+        {
+            external_lock = std::unique_lock<std::mutex>(m_external_mutex);
+            context = ThreadContext{this, thread_count() - 1};
+        }
+        const uint32_t index = context.index;
+
+        if (m_workers.empty() || count <= grain)
+        {
+            fn(size_t(0), count);
+            context = saved;
+            return;
+        }
+
+        Job job;
+        job.fn = &fn;
+        job.run = [](const void* f, size_t begin, size_t end) { (*static_cast<const Fn*>(f))(begin, end); };
+        job.grain = grain;
+        job.align = align;
+        job.remaining.store(count, std::memory_order_relaxed);
+
+        execute(index, Task{&job, 0, count});
+        while (job.remaining.load(std::memory_order_acquire) != 0)
+        {
+            Task task;
+            if (find_task(index, task))
+            {
+                execute(index, task);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        context = saved;
+    }
+
+  private:
+    struct Job
+    {
+        const void* fn;
+        void (*run)(const void* fn, size_t begin, size_t end);
+        size_t grain;
+        size_t align;
+        std::atomic<size_t> remaining; // elements not processed yet
+    };
+
+    struct Task
+    {
+        Job* job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct alignas(64) WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct ThreadContext
+    {
+        const LargeThreadPool* pool = nullptr;
+        uint32_t index = 0;
+    };
+
+    static ThreadContext& current_context()
+    {
+        static thread_local ThreadContext context;
+        return context;
+    }
+
+    void worker_main(uint32_t index)
+    {
+        current_context() = ThreadContext{this, index};
+        for (;;)
+        {
+            Task task;
+            if (find_task(index, task))
+            {
+                execute(index, task);
+                continue;
+            }
+
+            // m_queued is re-checked under the lock that push() takes before notifying, so no wakeup is lost
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleepers++;
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load() != 0; });
+            m_sleepers--;
+            if (m_stop)
+            {
+                return;
+            }
+        }
+    }
+
+    void execute(uint32_t index, Task task)
+    {
+        Job& job = *task.job;
+        while (task.end - task.begin > job.grain)
+        {
+            // Rounding the lower half up keeps both halves non-empty, since the range is longer than one align
+            size_t mid = task.begin + ((task.end - task.begin) / 2 + job.align - 1) / job.align * job.align;
+            push(index, Task{&job, mid, task.end});
+            task.end = mid;
+        }
+        job.run(job.fn, task.begin, task.end);
+        job.remaining.fetch_sub(task.end - task.begin, std::memory_order_release);
+    }
+
+    void push(uint32_t index, const Task& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(task);
+        }
+        m_queued.fetch_add(1);
+        if (m_sleepers.load() != 0)
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_wake.notify_one();
+        }
+    }
+
+    // Own queue first (newest task), then the other queues (oldest task)
+    bool find_task(uint32_t index, Task& out)
+    {
+        if (m_queued.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+        const uint32_t count = thread_count();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t victim = (index + i) % count;
+            WorkQueue& queue = *m_queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+            if (victim == index)
+            {
+                out = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                out = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+            m_queued.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues; // one per worker, the last one for the calling thread
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_queued{0}; // tasks in all queues
+    std::atomic<uint32_t> m_sleepers{0};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    std::mutex m_external_mutex;
+    bool m_stop = false;
+};
+
+namespace large_coordinates_detail
+{
+
+// Working set of one parallel batch chunk (inputs plus outputs). A chunk stays within the L2 cache of the core that
+// runs it, and is large enough that scheduling costs well under 1% of the conversion itself.
+inline constexpr size_t PARALLEL_CHUNK_BYTES = size_t(256) << 10;
+
+// Chunks start at multiples of 64 elements: whole changed_mask words, and lane alignment is preserved
+inline constexpr size_t PARALLEL_CHUNK_ALIGN = 64;
+
+inline size_t parallel_grain(size_t bytes_per_element)
+{
+    return std::max(PARALLEL_CHUNK_ALIGN, PARALLEL_CHUNK_BYTES / bytes_per_element / PARALLEL_CHUNK_ALIGN * PARALLEL_CHUNK_ALIGN);
+}
+
+inline PositionLanes offset_lanes(const PositionLanes& lanes, size_t first)
+{
+    return PositionLanes{lanes.global_x + first, lanes.global_y + first, lanes.global_z + first,
+                         lanes.local_x + first,  lanes.local_y + first,  lanes.local_z + first};
+}
+
+inline MutablePositionLanes offset_lanes(const MutablePositionLanes& lanes, size_t first)
+{
+    return MutablePositionLanes{lanes.global_x + first, lanes.global_y + first, lanes.global_z + first,
+                                lanes.local_x + first,  lanes.local_y + first,  lanes.local_z + first};
+}
+
+inline Float3Lanes offset_lanes(const Float3Lanes& lanes, size_t first)
+{
+    return Float3Lanes{lanes.x + first, lanes.y + first, lanes.z + first};
+}
+
+inline ConstFloat3Lanes offset_lanes(const ConstFloat3Lanes& lanes, size_t first)
+{
+    return ConstFloat3Lanes{lanes.x + first, lanes.y + first, lanes.z + first};
+}
+
+} // namespace large_coordinates_detail
+
+// Parallel versions of the batch conversions, with identical results. Each chunk runs the batch function of the
+// active SIMD level on its own slice of the lanes.
+
+inline void parallel_batch_to_float3(const int3& origin, const PositionLanes& src, const Float3Lanes& dst, size_t count,
+                                     LargeThreadPool& pool = LargeThreadPool::shared())
+{
+    using namespace large_coordinates_detail;
+    pool.parallel_for(
+        count, parallel_grain(6 * 4 + 3 * 4),
+        [&](size_t begin, size_t end) { batch_to_float3(origin, offset_lanes(src, begin), offset_lanes(dst, begin), end - begin); },
+        PARALLEL_CHUNK_ALIGN);
+}
+
+inline void parallel_batch_to_double3(const PositionLanes& src, double3* dst, size_t count,
+                                      LargeThreadPool& pool = LargeThreadPool::shared())
+{
+    using namespace large_coordinates_detail;
+    pool.parallel_for(
+        count, parallel_grain(6 * 4 + 3 * 8),
+        [&](size_t begin, size_t end) { batch_to_double3(offset_lanes(src, begin), dst + begin, end - begin); }, PARALLEL_CHUNK_ALIGN);
+}
+
+inline void parallel_batch_from_double3(const double3* values, const MutablePositionLanes& dst, size_t count,
+                                        LargeThreadPool& pool = LargeThreadPool::shared())
+{
+    using namespace large_coordinates_detail;
+    pool.parallel_for(
+        count, parallel_grain(3 * 8 + 6 * 4),
+        [&](size_t begin, size_t end) { batch_from_double3(values + begin, offset_lanes(dst, begin), end - begin); }, PARALLEL_CHUNK_ALIGN);
+}
+
+// changed_mask follows batch_from_float3(): (count + 63) / 64 words or null.
+// Returns the number of elements that changed cell.
+inline size_t parallel_batch_from_float3(const MutablePositionLanes& dst, const ConstFloat3Lanes& local_pos, size_t count,
+                                         uint64_t* changed_mask, LargeThreadPool& pool = LargeThreadPool::shared())
+{
+    using namespace large_coordinates_detail;
+    std::atomic<size_t> changed{0};
+    pool.parallel_for(
+        count, parallel_grain(6 * 4 + 3 * 4),
+        [&](size_t begin, size_t end)
+        {
+            uint64_t* mask = changed_mask ? changed_mask + begin / 64 : nullptr;
+            size_t n = batch_from_float3(offset_lanes(dst, begin), offset_lanes(local_pos, begin), end - begin, mask);
+            changed.fetch_add(n, std::memory_order_relaxed);
+        },
+        PARALLEL_CHUNK_ALIGN);
+    return changed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_large_coordinates.dir/bench_large_coordinates.cpp.o"
+  "CMakeFiles/bench_large_coordinates.dir/bench_large_coordinates.cpp.o.d"
+  "bench_large_coordinates"
+  "bench_large_coordinates.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_large_coordinates.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
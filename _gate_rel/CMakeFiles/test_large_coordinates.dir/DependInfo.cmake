@@ -0,0 +1,41 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test_large_aabb.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_aabb.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_aabb.cpp.o.d"
+  "/root/repo/test_large_bvh.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_bvh.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_bvh.cpp.o.d"
+  "/root/repo/test_large_cell_scheduler.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_cell_scheduler.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_cell_scheduler.cpp.o.d"
+  "/root/repo/test_large_chunk_matrices.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_chunk_matrices.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_chunk_matrices.cpp.o.d"
+  "/root/repo/test_large_coordinates.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_coordinates.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_coordinates.cpp.o.d"
+  "/root/repo/test_large_fixed_position.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_fixed_position.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_fixed_position.cpp.o.d"
+  "/root/repo/test_large_frustum_culler.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_frustum_culler.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_frustum_culler.cpp.o.d"
+  "/root/repo/test_large_mapped_store.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_mapped_store.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_mapped_store.cpp.o.d"
+  "/root/repo/test_large_migration_queue.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_migration_queue.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_migration_queue.cpp.o.d"
+  "/root/repo/test_large_network_codec.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_network_codec.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_network_codec.cpp.o.d"
+  "/root/repo/test_large_origin_manager.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_origin_manager.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_origin_manager.cpp.o.d"
+  "/root/repo/test_large_packed_position.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_packed_position.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_packed_position.cpp.o.d"
+  "/root/repo/test_large_position_batch.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_position_batch.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_position_batch.cpp.o.d"
+  "/root/repo/test_large_position_buffer.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_position_buffer.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_position_buffer.cpp.o.d"
+  "/root/repo/test_large_position_template.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_position_template.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_position_template.cpp.o.d"
+  "/root/repo/test_large_ray.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_ray.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_ray.cpp.o.d"
+  "/root/repo/test_large_snapshot.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_snapshot.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_snapshot.cpp.o.d"
+  "/root/repo/test_large_spatial_hash.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_spatial_hash.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_spatial_hash.cpp.o.d"
+  "/root/repo/test_large_spatial_sort.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_spatial_sort.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_spatial_sort.cpp.o.d"
+  "/root/repo/test_large_sweep_and_prune.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_sweep_and_prune.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_sweep_and_prune.cpp.o.d"
+  "/root/repo/test_large_thread_pool.cpp" "CMakeFiles/test_large_coordinates.dir/test_large_thread_pool.cpp.o" "gcc" "CMakeFiles/test_large_coordinates.dir/test_large_thread_pool.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_gate_rel/_deps/googletest-build/googletest/CMakeFiles/gtest_main.dir/DependInfo.cmake"
+  "/root/repo/_gate_rel/_deps/googletest-build/googletest/CMakeFiles/gtest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,51 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_large_coordinates.dir/test_large_aabb.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_aabb.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_bvh.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_bvh.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_cell_scheduler.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_cell_scheduler.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_chunk_matrices.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_chunk_matrices.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_coordinates.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_coordinates.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_fixed_position.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_fixed_position.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_frustum_culler.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_frustum_culler.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_mapped_store.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_mapped_store.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_migration_queue.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_migration_queue.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_network_codec.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_network_codec.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_origin_manager.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_origin_manager.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_packed_position.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_packed_position.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_position_batch.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_position_batch.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_position_buffer.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_position_buffer.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_position_template.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_position_template.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_ray.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_ray.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_snapshot.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_snapshot.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_spatial_hash.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_spatial_hash.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_spatial_sort.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_spatial_sort.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_sweep_and_prune.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_sweep_and_prune.cpp.o.d"
+  "CMakeFiles/test_large_coordinates.dir/test_large_thread_pool.cpp.o"
+  "CMakeFiles/test_large_coordinates.dir/test_large_thread_pool.cpp.o.d"
+  "test_large_coordinates"
+  "test_large_coordinates.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_large_coordinates.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
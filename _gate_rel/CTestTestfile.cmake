@@ -0,0 +1,9 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo
+# Build directory: /root/repo/_gate_rel
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(LargeCoordinatesTest "/root/repo/_gate_rel/test_large_coordinates")
+set_tests_properties(LargeCoordinatesTest PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/CMakeLists.txt;72;add_test;/root/repo/CMakeLists.txt;0;")
+subdirs("_deps/googletest-build")
@@ -0,0 +1,1524 @@
+#include "LargeAABB.h"
+#include "LargeBVH.h"
+#include "LargeCellScheduler.h"
+#include "LargeChunkMatrices.h"
+#include "LargeFixedPosition.h"
+#include "LargeFrustumCuller.h"
+#include "LargeMappedStore.h"
+#include "LargeMigrationQueue.h"
+#include "LargeNetworkCodec.h"
+#include "LargeOriginManager.h"
+#include "LargePackedPosition.h"
+#include "LargePositionBuffer.h"
+#include "LargeRay.h"
+#include "LargeSnapshot.h"
+#include "LargeSpatialHash.h"
+#include "LargeSpatialSort.h"
+#include "LargeSweepAndPrune.h"
+#include "LargeThreadPool.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+
+// Working set sizes: one that fits in L2 and one that streams from memory
+static constexpr int64_t SMALL_COUNT = 1 << 14;
+static constexpr int64_t LARGE_COUNT = 1 << 20;
+
+enum Distribution : int64_t
+{
+    // Objects gathered within a few kilometers of the world origin (typical for a level or a planet surface)
+    Clustered = 0,
+    // Objects spread uniformly over the whole supported range (+/-29.3 AU)
+    Uniform = 1,
+    // Objects sitting within a meter of a natural cell boundary (+/-CELL_SIZE/2)
+    Boundary = 2,
+};
+
+static const char* DistributionName(int64_t distribution)
+{
+    switch (distribution)
+    {
+    case Clustered:
+        return "clustered";
+    case Uniform:
+        return "uniform";
+    default:
+        return "boundary";
+    }
+}
+
+static std::vector<double3> MakeWorldPositions(size_t count, int64_t distribution = Uniform)
+{
+    constexpr double cell = double(LargePosition::CELL_SIZE);
+    std::mt19937 rng(1);
+    std::normal_distribution<double> clustered(0.0, 5000.0);
+    std::uniform_real_distribution<double> uniform(-29.0 * LargePosition::AU_DISTANCE, 29.0 * LargePosition::AU_DISTANCE);
+    std::uniform_int_distribution<int32_t> boundary_cell(-1000000, 1000000);
+    std::uniform_real_distribution<double> boundary_offset(-1.0, 1.0);
+
+    auto coordinate = [&]() -> double
+    {
+        switch (distribution)
+        {
+        case Clustered:
+            return clustered(rng);
+        case Uniform:
+            return uniform(rng);
+        default:
+            return (boundary_cell(rng) + 0.5) * cell + boundary_offset(rng);
+        }
+    };
+
+    std::vector<double3> values(count);
+    for (auto& v : values)
+    {
+        v.x = coordinate();
+        v.y = coordinate();
+        v.z = coordinate();
+    }
+    return values;
+}
+
+static std::vector<LargePosition> MakePositions(size_t count, int64_t distribution)
+{
+    std::vector<double3> values = MakeWorldPositions(count, distribution);
+    std::vector<LargePosition> positions;
+    positions.reserve(count);
+    for (const double3& v : values)
+    {
+        positions.push_back(LargePosition(v));
+    }
+    return positions;
+}
+
+// Reference cells one step away from each position, so to_float3() stays within its +/-3 cell limit
+static std::vector<int3> MakeNearbyOrigins(const std::vector<LargePosition>& positions)
+{
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int32_t> step(-1, 1);
+    std::vector<int3> origins(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        origins[i] = positions[i].global + int3(step(rng), step(rng), step(rng));
+    }
+    return origins;
+}
+
+static void SetupDistribution(benchmark::State& state)
+{
+    state.SetLabel(DistributionName(state.range(1)));
+}
+
+static void FinishItems(benchmark::State& state) { state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0)); }
+
+static void DistributionArgs(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({"count", "dist"})->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {Clustered, Uniform, Boundary}});
+}
+
+static bool SelectSimdLevel(benchmark::State& state, int64_t requested)
+{
+    if ((int64_t)simd_set_level((SimdLevel)requested) != requested)
+    {
+        state.SkipWithError("Instruction set is not supported by this CPU");
+        return false;
+    }
+    return true;
+}
+
+static void SimdArgs(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({"count", "simd"})
+        ->ArgsProduct({{SMALL_COUNT, LARGE_COUNT},
+                       {(int)SimdLevel::Scalar, (int)SimdLevel::SSE42, (int)SimdLevel::AVX2, (int)SimdLevel::AVX512}});
+}
+
+// === from_double3 ===
+
+static void BM_FromDouble3_Scalar(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), state.range(1));
+    std::vector<LargePosition> positions(values.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            positions[i].from_double3(values[i]);
+        }
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_FromDouble3_Scalar)->Apply(DistributionArgs);
+
+static void BM_FromDouble3_Batch(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)));
+    LargePositionBuffer buffer(values.size());
+
+    for (auto _ : state)
+    {
+        buffer.from_double3(values.data(), values.size());
+        benchmark::DoNotOptimize(buffer.local_x());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_FromDouble3_Batch)->Apply(SimdArgs);
+
+// === to_double3 ===
+
+static void BM_ToDouble3(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+    std::vector<double3> out(positions.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            out[i] = positions[i].to_double3();
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_ToDouble3)->Apply(DistributionArgs);
+
+// === to_float3 ===
+
+static void BM_ToFloat3(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+    std::vector<int3> origins = MakeNearbyOrigins(positions);
+    std::vector<float3> out(positions.size());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            out[i] = positions[i].to_float3(origins[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_ToFloat3)->Apply(DistributionArgs);
+
+// Shared-origin rendering: every position converted to one camera cell
+static void BM_ToFloat3_Batch(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    int3 camera(10, -20, 30);
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int32_t> step(-1, 1);
+    std::uniform_real_distribution<float> local(-1024.0f, 1024.0f);
+
+    LargePositionBuffer buffer(size_t(state.range(0)));
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        LargePosition pos;
+        pos.global = camera + int3(step(rng), step(rng), step(rng));
+        pos.local = float3(local(rng), local(rng), local(rng));
+        buffer.set(i, pos);
+    }
+    std::vector<float> x(buffer.size()), y(buffer.size()), z(buffer.size());
+
+    for (auto _ : state)
+    {
+        buffer.to_float3(camera, Float3Lanes{x.data(), y.data(), z.data()});
+        benchmark::DoNotOptimize(x.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_ToFloat3_Batch)->Apply(SimdArgs);
+
+// === from_float3 ===
+
+// Offsets that stay within the 0.75 * CELL_SIZE hysteresis threshold (cell is kept)
+static void BM_FromFloat3_KeepCell(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> offset(-LargePosition::CELL_SIZE * 0.7f, LargePosition::CELL_SIZE * 0.7f);
+    std::vector<float3> locals(positions.size());
+    for (auto& l : locals)
+    {
+        l = float3(offset(rng), offset(rng), offset(rng));
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            positions[i].from_float3(positions[i].global, locals[i]);
+        }
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_FromFloat3_KeepCell)->Apply(DistributionArgs);
+
+// Offsets beyond the threshold, so every call falls back to from_double3() and re-cells
+static void BM_FromFloat3_Recell(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+    std::vector<int3> origins(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        origins[i] = positions[i].global;
+    }
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> offset(LargePosition::CELL_SIZE * 0.8f, LargePosition::CELL_SIZE * 2.5f);
+    std::bernoulli_distribution negative(0.5);
+    std::vector<float3> locals(positions.size());
+    for (auto& l : locals)
+    {
+        l = float3(negative(rng) ? -offset(rng) : offset(rng), offset(rng) * 0.1f, -offset(rng) * 0.1f);
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            positions[i].from_float3(origins[i], locals[i]);
+        }
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_FromFloat3_Recell)->Apply(DistributionArgs);
+
+// In-place SoA update where one position in 64 crosses the threshold each step
+static void BM_FromFloat3_Batch(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+    LargePositionBuffer initial;
+    initial.from_double3(values.data(), values.size());
+
+    std::vector<float> x(initial.size()), y(initial.size()), z(initial.size());
+    for (size_t i = 0; i < initial.size(); i++)
+    {
+        float push = (i % 64 == 0) ? LargePosition::CELL_SIZE : 1.0f;
+        x[i] = initial.local_x()[i] + push;
+        y[i] = initial.local_y()[i];
+        z[i] = initial.local_z()[i];
+    }
+    std::vector<uint64_t> changed_mask((initial.size() + 63) / 64);
+    LargePositionBuffer buffer;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        buffer = initial;
+        state.ResumeTiming();
+
+        size_t changed = buffer.from_float3(ConstFloat3Lanes{x.data(), y.data(), z.data()}, changed_mask.data());
+        benchmark::DoNotOptimize(changed);
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_FromFloat3_Batch)->Apply(SimdArgs);
+
+// === canonicalize ===
+
+// Full pass after integration left one position in eight with a hysteresis-extended local offset
+static void BM_Canonicalize_Batch(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+    LargePositionBuffer initial;
+    initial.from_double3(values.data(), values.size());
+    for (size_t i = 0; i < initial.size(); i += 8)
+    {
+        LargePosition pos = initial.get(i);
+        pos.from_float3(pos.global, pos.local + float3(LargePosition::CELL_SIZE * 0.5f, 0.0f, 0.0f));
+        initial.set(i, pos);
+    }
+    LargePositionBuffer buffer;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        buffer = initial;
+        state.ResumeTiming();
+
+        size_t changed = buffer.canonicalize();
+        benchmark::DoNotOptimize(changed);
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_Canonicalize_Batch)->Apply(SimdArgs);
+
+// Background sweep of an already canonical buffer, 4096 elements per call: the cost paid every frame
+static void BM_Canonicalize_Budget(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+    LargePositionBuffer buffer;
+    buffer.from_double3(values.data(), values.size());
+    constexpr size_t budget = 4096;
+    size_t cursor = 0;
+
+    for (auto _ : state)
+    {
+        size_t changed = buffer.canonicalize(cursor, budget);
+        benchmark::DoNotOptimize(changed);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(budget));
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_Canonicalize_Budget)->Apply(SimdArgs);
+
+// === operator== ===
+
+// Pairs whose cells are more than 3 apart: rejected by the integer early exit
+static void BM_Equality_EarlyExit(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> a = MakePositions(size_t(state.range(0)), state.range(1));
+    std::vector<LargePosition> b = a;
+    for (auto& pos : b)
+    {
+        pos.global.x += (pos.global.x > 0) ? -4 : 4;
+    }
+
+    for (auto _ : state)
+    {
+        size_t equal = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            equal += (a[i] == b[i]) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(equal);
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_Equality_EarlyExit)->Apply(DistributionArgs);
+
+// Same world positions stored with a neighboring cell: compared through to_float3()
+static void BM_Equality_FullCompare(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> a = MakePositions(size_t(state.range(0)), state.range(1));
+    std::vector<LargePosition> b = a;
+    for (size_t i = 0; i < b.size(); i++)
+    {
+        if (i % 2 == 0)
+        {
+            // Representation with hysteresis-extended local offset
+            int32_t dir = (b[i].global.x > 0) ? -1 : 1;
+            b[i].local.x -= float(dir) * LargePosition::CELL_SIZE;
+            b[i].global.x += dir;
+        }
+    }
+
+    for (auto _ : state)
+    {
+        size_t equal = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            equal += (a[i] == b[i]) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(equal);
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_Equality_FullCompare)->Apply(DistributionArgs);
+
+// === LargeSpatialHash ===
+
+// Neighbor queries over clustered objects (about 8 objects per occupied cell)
+static void BM_SpatialHash_Gather(benchmark::State& state)
+{
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), Clustered);
+    std::vector<uint32_t> ids(positions.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        ids[i] = uint32_t(i);
+    }
+
+    LargeSpatialHash grid;
+    grid.insert(ids.data(), positions.data(), positions.size());
+
+    std::vector<LargeSpatialHash::Hit> hits;
+    size_t query = 0;
+    for (auto _ : state)
+    {
+        hits.clear();
+        grid.gather(positions[query], int32_t(state.range(1)), hits);
+        benchmark::DoNotOptimize(hits.data());
+        query = (query + 7919) % positions.size();
+    }
+    state.counters["cells"] = double(grid.cell_count());
+}
+BENCHMARK(BM_SpatialHash_Gather)->ArgNames({"count", "radius"})->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {1, 2}});
+
+static void BM_SpatialHash_Insert(benchmark::State& state)
+{
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), Clustered);
+    std::vector<uint32_t> ids(positions.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        ids[i] = uint32_t(i);
+    }
+
+    for (auto _ : state)
+    {
+        LargeSpatialHash grid;
+        grid.insert(ids.data(), positions.data(), positions.size());
+        benchmark::DoNotOptimize(grid.cell_count());
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_SpatialHash_Insert)->Arg(SMALL_COUNT)->Arg(LARGE_COUNT);
+
+// === Spatial sort keys ===
+
+// Key generation per instruction set: AVX2 and above interleave with BMI2 pdep
+static void BM_SpatialKeys64(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    LargePositionBuffer buffer(size_t(state.range(0)));
+    std::vector<LargePosition> positions = MakePositions(buffer.size(), Clustered);
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        buffer.set(i, positions[i]);
+    }
+    std::vector<uint64_t> keys(buffer.size());
+    SpatialCurve curve = (SpatialCurve)state.range(2);
+    state.SetLabel(curve == SpatialCurve::Morton ? "morton" : "hilbert");
+
+    for (auto _ : state)
+    {
+        spatial_keys64(curve, int3(0, 0, 0), buffer.lanes(), keys.data(), keys.size());
+        benchmark::DoNotOptimize(keys.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_SpatialKeys64)
+    ->ArgNames({"count", "simd", "curve"})
+    ->ArgsProduct({{LARGE_COUNT}, {(int)SimdLevel::SSE42, (int)SimdLevel::AVX2}, {(int)SpatialCurve::Morton, (int)SpatialCurve::Hilbert}});
+
+static void BM_RadixSort64(benchmark::State& state)
+{
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), Uniform);
+    std::vector<uint64_t> keys(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        keys[i] = morton_key64(positions[i]);
+    }
+    std::vector<uint64_t> sorted_keys(keys.size());
+    std::vector<uint32_t> values(keys.size());
+    const uint32_t threads = uint32_t(state.range(1));
+    const bool use_pool = state.range(2) != 0;
+    state.SetLabel(use_pool ? "pool" : "threads");
+    LargeThreadPool pool(threads);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        sorted_keys = keys;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            values[i] = uint32_t(i);
+        }
+        state.ResumeTiming();
+        if (use_pool)
+        {
+            radix_sort(sorted_keys.data(), values.data(), sorted_keys.size(), pool);
+        }
+        else
+        {
+            radix_sort(sorted_keys.data(), values.data(), sorted_keys.size(), threads);
+        }
+        benchmark::DoNotOptimize(values.data());
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_RadixSort64)
+    ->ArgNames({"count", "threads", "pool"})
+    ->ArgsProduct({{SMALL_COUNT * 4, LARGE_COUNT}, {1, 2, 4, 8}, {0, 1}})
+    ->UseRealTime();
+
+// === LargeOriginManager ===
+
+enum OriginScenario : int64_t
+{
+    // Camera moves inside its cell, nothing else changes
+    StaticScene = 0,
+    // 1% of the objects move every frame
+    FewMoving = 1,
+    // Camera crosses into another cell every frame
+    OriginShift = 2,
+};
+
+static void BM_OriginManager_Update(benchmark::State& state)
+{
+    const int3 camera(10, -20, 30);
+    std::mt19937 rng(4);
+    std::uniform_int_distribution<int32_t> step(-1, 1);
+    std::uniform_real_distribution<float> local(-1024.0f, 1024.0f);
+
+    LargeOriginManager manager(camera);
+    for (int64_t i = 0; i < state.range(0); i++)
+    {
+        LargePosition pos;
+        pos.global = camera + int3(step(rng), step(rng), step(rng));
+        pos.local = float3(local(rng), local(rng), local(rng));
+        manager.add(pos);
+    }
+    manager.update();
+
+    const OriginScenario scenario = (OriginScenario)state.range(1);
+    state.SetLabel(scenario == StaticScene ? "static" : scenario == FewMoving ? "1% moving" : "origin shift");
+    const uint32_t moving = uint32_t(manager.size() / 100);
+    uint32_t frame = 0;
+    for (auto _ : state)
+    {
+        if (scenario == FewMoving)
+        {
+            for (uint32_t i = 0; i < moving; i++)
+            {
+                uint32_t index = (i * 97 + frame) % uint32_t(manager.size());
+                manager.set_position(index, manager.position(index));
+            }
+        }
+        else if (scenario == OriginShift)
+        {
+            manager.set_origin(camera + int3(frame & 1, 0, 0));
+        }
+        benchmark::DoNotOptimize(manager.update());
+        frame++;
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_OriginManager_Update)
+    ->ArgNames({"count", "scenario"})
+    ->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {StaticScene, FewMoving, OriginShift}});
+
+// === Chunk matrices ===
+
+static void BM_BuildChunkMatrices(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    LargePosition camera(double3(1.0e9, 2.0e6, -3.0e8));
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int32_t> step(-20, 20);
+    std::vector<int3> chunks(size_t(state.range(0)));
+    for (int3& chunk : chunks)
+    {
+        chunk = camera.global + int3(step(rng), step(rng), step(rng));
+    }
+    std::vector<float4x4> matrices(chunks.size());
+    float4x4 view = float4x4::identity();
+    float4x4 projection = float4x4::identity();
+
+    for (auto _ : state)
+    {
+        build_chunk_matrices(camera, view, projection, chunks.data(), chunks.size(), matrices.data());
+        benchmark::DoNotOptimize(matrices.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_BuildChunkMatrices)
+    ->ArgNames({"count", "simd"})
+    ->ArgsProduct({{256, 4096}, {(int)SimdLevel::Scalar, (int)SimdLevel::SSE42, (int)SimdLevel::AVX2}});
+
+// === Frustum culling ===
+
+// Visible cells within `radius` cells of the camera (90 degree horizontal FOV, infinite far plane)
+static void BM_FrustumCull_Range(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    float4x4 projection = {};
+    projection.m[0] = 1.0f;
+    projection.m[5] = 1.7f;
+    projection.m[11] = -1.0f;
+    projection.m[14] = 0.1f;
+    LargeFrustumCuller culler;
+    culler.set_frustum(LargePosition(double3(1.0e11, 3.0e6, -4.0e10)), projection);
+
+    std::vector<int3> visible;
+    for (auto _ : state)
+    {
+        culler.cull_range(int32_t(state.range(0)), visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+    state.counters["visible"] = double(visible.size());
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(visible.size()));
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_FrustumCull_Range)
+    ->ArgNames({"radius", "simd"})
+    ->ArgsProduct({{16, 64}, {(int)SimdLevel::Scalar, (int)SimdLevel::SSE42, (int)SimdLevel::AVX2, (int)SimdLevel::AVX512}});
+
+// === Bounding boxes ===
+
+// One query box against `count` object-sized boxes around it
+static void BM_AABB_BatchOverlaps(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<LargePosition> centers = MakePositions(size_t(state.range(0)), Clustered);
+    LargeAABBBuffer boxes;
+    boxes.reserve(centers.size());
+    for (const LargePosition& center : centers)
+    {
+        boxes.push_back(LargeAABB::from_center(center, float3(50.0f, 50.0f, 50.0f)));
+    }
+    const LargeAABB query = LargeAABB::from_center(centers[0], float3(1500.0f, 1500.0f, 1500.0f));
+    std::vector<uint64_t> mask((boxes.size() + 63) / 64);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(batch_overlaps(query, boxes.lanes(), boxes.size(), mask.data()));
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_AABB_BatchOverlaps)
+    ->ArgNames({"count", "simd"})
+    ->ArgsProduct({{SMALL_COUNT}, {(int)SimdLevel::Scalar, (int)SimdLevel::SSE42, (int)SimdLevel::AVX2, (int)SimdLevel::AVX512}});
+
+// === BVH ===
+
+struct BVHScene
+{
+    std::vector<uint32_t> ids;
+    std::vector<LargePosition> positions;
+    std::vector<float3> half_extents;
+};
+
+// Clustered objects of 1 to 20 meters
+static BVHScene MakeBVHScene(size_t count)
+{
+    BVHScene scene;
+    scene.positions = MakePositions(count, Clustered);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> extent(0.5f, 10.0f);
+    for (size_t i = 0; i < count; i++)
+    {
+        scene.ids.push_back(uint32_t(i));
+        scene.half_extents.push_back(float3(extent(rng), extent(rng), extent(rng)));
+    }
+    return scene;
+}
+
+static void BM_BVH_Build(benchmark::State& state)
+{
+    BVHScene scene = MakeBVHScene(size_t(state.range(0)));
+    LargeBVH bvh;
+    for (auto _ : state)
+    {
+        bvh.build(scene.ids.data(), scene.positions.data(), scene.half_extents.data(), scene.ids.size());
+        benchmark::ClobberMemory();
+    }
+    state.counters["cells"] = double(bvh.cell_count());
+    FinishItems(state);
+}
+BENCHMARK(BM_BVH_Build)->ArgNames({"count"})->Arg(SMALL_COUNT)->Arg(LARGE_COUNT);
+
+// Every object moves a little each frame; items are object updates (update() + the share of refit())
+static void BM_BVH_UpdateRefit(benchmark::State& state)
+{
+    BVHScene scene = MakeBVHScene(size_t(state.range(0)));
+    LargeBVH bvh;
+    bvh.build(scene.ids.data(), scene.positions.data(), scene.half_extents.data(), scene.ids.size());
+
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+    std::vector<float3> velocity(scene.ids.size());
+    for (float3& v : velocity)
+    {
+        v = float3(step(rng), step(rng), step(rng));
+    }
+
+    size_t reinserted = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < scene.ids.size(); i++)
+        {
+            LargePosition& pos = scene.positions[i];
+            pos.from_float3(pos.global, pos.local + velocity[i]);
+            reinserted += bvh.update(uint32_t(i), pos) ? 1 : 0;
+        }
+        bvh.refit();
+    }
+    state.counters["reinserted"] = benchmark::Counter(double(reinserted), benchmark::Counter::kAvgIterations);
+    FinishItems(state);
+}
+BENCHMARK(BM_BVH_UpdateRefit)->ArgNames({"count"})->Arg(SMALL_COUNT)->Arg(LARGE_COUNT);
+
+// Items are queries: 50 m boxes around random objects
+static void BM_BVH_Overlap(benchmark::State& state)
+{
+    BVHScene scene = MakeBVHScene(size_t(state.range(0)));
+    LargeBVH bvh;
+    bvh.build(scene.ids.data(), scene.positions.data(), scene.half_extents.data(), scene.ids.size());
+
+    std::vector<uint32_t> hits;
+    size_t query = 0;
+    size_t hit_count = 0;
+    for (auto _ : state)
+    {
+        const LargePosition& center = scene.positions[(query++ * 7919) % scene.positions.size()];
+        hits.clear();
+        hit_count += bvh.overlap(LargeAABB::from_center(center, float3(50.0f, 50.0f, 50.0f)), hits);
+    }
+    state.counters["hits"] = benchmark::Counter(double(hit_count), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_BVH_Overlap)->ArgNames({"count"})->Arg(SMALL_COUNT)->Arg(LARGE_COUNT);
+
+// Items are rays: random directions from random objects, up to 2 km
+static void BM_BVH_Raycast(benchmark::State& state)
+{
+    BVHScene scene = MakeBVHScene(size_t(state.range(0)));
+    LargeBVH bvh;
+    bvh.build(scene.ids.data(), scene.positions.data(), scene.half_extents.data(), scene.ids.size());
+
+    std::mt19937 rng(9);
+    std::normal_distribution<float> axis(0.0f, 1.0f);
+    std::vector<float3> directions(1024);
+    for (float3& d : directions)
+    {
+        d = float3(axis(rng), axis(rng), axis(rng));
+        d = d / std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+    }
+
+    size_t query = 0;
+    size_t hit_count = 0;
+    LargeBVH::RayHit hit;
+    for (auto _ : state)
+    {
+        LargePosition origin = scene.positions[(query * 7919) % scene.positions.size()];
+        origin.local = origin.local + float3(15.0f, 15.0f, 15.0f);
+        hit_count += bvh.raycast(origin, directions[query++ % directions.size()], 2000.0f, hit) ? 1 : 0;
+    }
+    state.counters["hit_rate"] = benchmark::Counter(double(hit_count), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_BVH_Raycast)->ArgNames({"count"})->Arg(SMALL_COUNT)->Arg(LARGE_COUNT);
+
+// === Ray traversal ===
+
+// Items are visited cells; rays of `cells` cell lengths in random directions from random far away origins
+static void BM_RayTraversal(benchmark::State& state)
+{
+    std::vector<LargePosition> origins = MakePositions(1024, Uniform);
+    std::mt19937 rng(10);
+    std::normal_distribution<float> axis(0.0f, 1.0f);
+    std::vector<LargeRay> rays;
+    for (const LargePosition& origin : origins)
+    {
+        float3 d(axis(rng), axis(rng), axis(rng));
+        rays.push_back(LargeRay(origin, d / std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z)));
+    }
+    const float max_distance = float(state.range(0)) * LargePosition::CELL_SIZE;
+
+    size_t visited = 0;
+    size_t ray = 0;
+    for (auto _ : state)
+    {
+        LargeRayTraversal traversal(rays[ray++ % rays.size()], max_distance);
+        RayCell cell;
+        while (traversal.next(cell))
+        {
+            benchmark::DoNotOptimize(cell);
+            visited++;
+        }
+    }
+    state.SetItemsProcessed(int64_t(visited));
+}
+BENCHMARK(BM_RayTraversal)->ArgNames({"cells"})->Arg(16)->Arg(1024);
+
+// === Sweep and prune ===
+
+// One physics frame: every object moves a little, then pairs are collected. Items are objects per frame.
+static void BM_SweepAndPrune_Frame(benchmark::State& state)
+{
+    std::vector<LargePosition> centers = MakePositions(size_t(state.range(0)), Clustered);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    std::vector<float3> velocity(centers.size());
+    for (float3& v : velocity)
+    {
+        v = float3(step(rng), step(rng), step(rng));
+    }
+    const float3 half(2.0f, 2.0f, 2.0f);
+
+    LargeSweepAndPrune sap;
+    for (uint32_t i = 0; i < uint32_t(centers.size()); i++)
+    {
+        sap.insert(i, LargeAABB::from_center(centers[i], half));
+    }
+    std::vector<LargeSweepAndPrune::Pair> pairs;
+    sap.find_pairs(pairs);
+
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < uint32_t(centers.size()); i++)
+        {
+            centers[i].from_float3(centers[i].global, centers[i].local + velocity[i]);
+            sap.update(i, LargeAABB::from_center(centers[i], half));
+        }
+        pairs.clear();
+        sap.find_pairs(pairs);
+        benchmark::DoNotOptimize(pairs.data());
+    }
+    state.counters["pairs"] = double(pairs.size());
+    FinishItems(state);
+}
+BENCHMARK(BM_SweepAndPrune_Frame)->ArgNames({"count"})->Arg(SMALL_COUNT)->Arg(LARGE_COUNT);
+
+// === Parallel batch conversions ===
+
+enum ParallelConversion
+{
+    ParallelToFloat3,
+    ParallelToDouble3,
+    ParallelFromDouble3,
+    ParallelFromFloat3,
+};
+
+// Scaling of the parallel batch conversions from 1 thread to every hardware thread
+static void BM_ParallelConversion(benchmark::State& state)
+{
+    static const char* const names[] = {"to_float3", "to_double3", "from_double3", "from_float3"};
+    state.SetLabel(names[state.range(1)]);
+    const size_t count = size_t(state.range(0));
+    LargeThreadPool pool(uint32_t(state.range(2)));
+
+    std::vector<double3> values = MakeWorldPositions(count, Clustered);
+    LargePositionBuffer buffer;
+    buffer.from_double3(values.data(), count);
+    const int3 origin = buffer.get(0).global;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Keep every position within to_float3() range of the shared origin
+        LargePosition pos = buffer.get(i);
+        pos.global = origin;
+        buffer.set(i, pos);
+    }
+    std::vector<float> x(buffer.local_x(), buffer.local_x() + count), y(buffer.local_y(), buffer.local_y() + count),
+        z(buffer.local_z(), buffer.local_z() + count);
+    std::vector<uint64_t> changed_mask((count + 63) / 64);
+
+    for (auto _ : state)
+    {
+        switch (state.range(1))
+        {
+        case ParallelToFloat3:
+            parallel_batch_to_float3(origin, buffer.lanes(), Float3Lanes{x.data(), y.data(), z.data()}, count, pool);
+            break;
+        case ParallelToDouble3:
+            parallel_batch_to_double3(buffer.lanes(), values.data(), count, pool);
+            break;
+        case ParallelFromDouble3:
+            parallel_batch_from_double3(values.data(), buffer.mutable_lanes(), count, pool);
+            break;
+        default:
+            // Offsets equal to the current local positions: no element changes cell, the buffer stays the same
+            benchmark::DoNotOptimize(parallel_batch_from_float3(buffer.mutable_lanes(), ConstFloat3Lanes{x.data(), y.data(), z.data()},
+                                                                count, changed_mask.data(), pool));
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+
+static void ParallelArgs(benchmark::internal::Benchmark* b)
+{
+    const int64_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int64_t> threads;
+    for (int64_t t = 1; t < hardware_threads; t *= 2)
+    {
+        threads.push_back(t);
+    }
+    threads.push_back(hardware_threads);
+    b->ArgNames({"count", "op", "threads"})
+        ->ArgsProduct({{LARGE_COUNT}, {ParallelToFloat3, ParallelToDouble3, ParallelFromDouble3, ParallelFromFloat3}, threads})
+        ->UseRealTime();
+}
+BENCHMARK(BM_ParallelConversion)->Apply(ParallelArgs);
+
+// === Cell scheduler ===
+
+// One simulation step: bucket by cell, build islands, integrate every island in parallel and collect migrations
+static void BM_CellScheduler_Step(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+    const float3 velocity(3.0f, -1.0f, 0.5f);
+    LargeCellScheduler scheduler;
+
+    for (auto _ : state)
+    {
+        scheduler.build(positions.data(), positions.size());
+        const std::vector<LargeCellScheduler::Migration>& migrations = scheduler.run(
+            [&](const LargeCellScheduler::Island& island, std::vector<LargeCellScheduler::Migration>& out)
+            {
+                for (uint32_t e = island.first_entity; e < island.first_entity + island.entity_count; e++)
+                {
+                    uint32_t id = scheduler.entities()[e];
+                    LargePosition& pos = positions[id];
+                    int3 from = pos.global;
+                    pos.from_float3(pos.global, pos.local + velocity);
+                    if (pos.global != from)
+                    {
+                        out.push_back(LargeCellScheduler::Migration{id, from, pos.global});
+                    }
+                }
+            });
+        benchmark::DoNotOptimize(migrations.data());
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_CellScheduler_Step)
+    ->ArgNames({"count", "dist"})
+    ->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {Clustered, Uniform}})
+    ->UseRealTime();
+
+// === Migration queue ===
+
+// BM_FromFloat3_Batch with migration events pushed to a queue and drained by the consumer every step
+static void BM_FromFloat3_Tracked(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+    LargePositionBuffer initial;
+    initial.from_double3(values.data(), values.size());
+
+    std::vector<float> x(initial.size()), y(initial.size()), z(initial.size());
+    for (size_t i = 0; i < initial.size(); i++)
+    {
+        float push = (i % 64 == 0) ? LargePosition::CELL_SIZE : 1.0f;
+        x[i] = initial.local_x()[i] + push;
+        y[i] = initial.local_y()[i];
+        z[i] = initial.local_z()[i];
+    }
+    LargeMigrationQueue queue;
+    std::vector<LargeMigrationQueue::Event> events;
+    LargePositionBuffer buffer;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        buffer = initial;
+        events.clear();
+        state.ResumeTiming();
+
+        batch_from_float3(buffer.mutable_lanes(), ConstFloat3Lanes{x.data(), y.data(), z.data()}, buffer.size(), 0, queue);
+        queue.drain(events);
+        benchmark::DoNotOptimize(events.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_FromFloat3_Tracked)->Apply(SimdArgs);
+
+// === Hashing ===
+
+enum CellHashKind : int64_t
+{
+    // hash_cell(), also behind std::hash<int3>
+    CellHashMixed = 0,
+    // The usual ad-hoc hash: coordinates times large primes, xor-ed, no finalizer
+    CellHashXorPrimes = 1,
+};
+
+// Inserts the distinct cells of a distribution into a linear-probing table at load factor 1/2; the probe count
+// per key shows how well the hash spreads clustered cells over the low bits
+static void BM_CellHash_Probes(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+    std::unordered_set<int3> distinct;
+    for (const LargePosition& pos : positions)
+    {
+        distinct.insert(pos.global);
+    }
+    const std::vector<int3> cells(distinct.begin(), distinct.end());
+    size_t capacity = 1;
+    while (capacity < 2 * cells.size())
+    {
+        capacity *= 2;
+    }
+    const bool mixed = state.range(2) == CellHashMixed;
+
+    std::vector<int3> slots(capacity);
+    std::vector<uint8_t> used(capacity);
+    size_t probes = 0;
+    for (auto _ : state)
+    {
+        std::fill(used.begin(), used.end(), uint8_t(0));
+        probes = 0;
+        for (const int3& cell : cells)
+        {
+            uint64_t h = mixed ? hash_cell(cell)
+                               : uint64_t(uint32_t(cell.x) * 73856093u ^ uint32_t(cell.y) * 19349663u ^ uint32_t(cell.z) * 83492791u);
+            for (size_t i = size_t(h) & (capacity - 1);; i = (i + 1) & (capacity - 1))
+            {
+                probes++;
+                if (!used[i])
+                {
+                    used[i] = 1;
+                    slots[i] = cell;
+                    break;
+                }
+                if (slots[i] == cell)
+                {
+                    break;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(slots.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(cells.size()));
+    state.counters["cells"] = double(cells.size());
+    state.counters["probes_per_key"] = double(probes) / double(cells.size());
+}
+BENCHMARK(BM_CellHash_Probes)
+    ->ArgNames({"count", "dist", "hash"})
+    ->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {Clustered, Uniform, Boundary}, {CellHashMixed, CellHashXorPrimes}});
+
+// Positions as std::unordered_set keys: canonical-form hash cost and the longest bucket chain
+static void BM_PositionHash_Set(benchmark::State& state)
+{
+    SetupDistribution(state);
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), state.range(1));
+
+    size_t longest = 0;
+    for (auto _ : state)
+    {
+        std::unordered_set<LargePosition> set(positions.size());
+        for (const LargePosition& pos : positions)
+        {
+            set.insert(pos);
+        }
+        benchmark::DoNotOptimize(set.size());
+
+        state.PauseTiming();
+        longest = 0;
+        for (size_t b = 0; b < set.bucket_count(); b++)
+        {
+            longest = std::max(longest, set.bucket_size(b));
+        }
+        state.ResumeTiming();
+    }
+    FinishItems(state);
+    state.counters["longest_bucket"] = double(longest);
+}
+BENCHMARK(BM_PositionHash_Set)->Apply(DistributionArgs);
+
+// === Packed positions ===
+
+enum ScanLayout : int64_t
+{
+    // std::vector<LargePosition>, 24 bytes per position
+    ScanStruct = 0,
+    // std::vector<LargePackedPosition>, 16 bytes per position, unpacked one by one
+    ScanPacked = 1,
+    // std::vector<LargePackedPosition>, batch_unpack() into a small SoA block, then scanned
+    ScanPackedBatch = 2,
+};
+
+// Counts the positions within 1 km of a query point, the typical full-table scan of an entity system
+static void BM_PackedScan(benchmark::State& state)
+{
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), Clustered);
+    std::vector<LargePackedPosition> packed(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        packed[i] = LargePackedPosition::pack(positions[i]);
+    }
+    const LargePosition query(double3(1000.0, -500.0, 250.0));
+    const float radius_sq = 1000.0f * 1000.0f;
+    auto within = [&](const float3& d) { return d.x * d.x + d.y * d.y + d.z * d.z <= radius_sq; };
+
+    constexpr size_t block = 256;
+    LargePositionBuffer scratch(block);
+    size_t hits = 0;
+    for (auto _ : state)
+    {
+        hits = 0;
+        switch (state.range(1))
+        {
+        case ScanStruct:
+            for (const LargePosition& pos : positions)
+            {
+                hits += within(pos.to_float3(query.global) - query.local) ? 1 : 0;
+            }
+            break;
+        case ScanPacked:
+            for (const LargePackedPosition& pos : packed)
+            {
+                hits += within(pos.unpack().to_float3(query.global) - query.local) ? 1 : 0;
+            }
+            break;
+        default:
+            for (size_t first = 0; first < packed.size(); first += block)
+            {
+                const size_t n = std::min(block, packed.size() - first);
+                batch_unpack(int3(), packed.data() + first, scratch.mutable_lanes(), n);
+                for (size_t i = 0; i < n; i++)
+                {
+                    hits += within(scratch.get(i).to_float3(query.global) - query.local) ? 1 : 0;
+                }
+            }
+            break;
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    FinishItems(state);
+    state.counters["hits"] = double(hits);
+}
+BENCHMARK(BM_PackedScan)
+    ->ArgNames({"count", "layout"})
+    ->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {ScanStruct, ScanPacked, ScanPackedBatch}});
+
+static void BM_Pack_Batch(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+    LargePositionBuffer buffer;
+    buffer.from_double3(values.data(), values.size());
+    std::vector<LargePackedPosition> packed(buffer.size());
+
+    for (auto _ : state)
+    {
+        batch_pack(int3(), buffer.lanes(), packed.data(), buffer.size());
+        benchmark::DoNotOptimize(packed.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_Pack_Batch)->Apply(SimdArgs);
+
+static void BM_Unpack_Batch(benchmark::State& state)
+{
+    if (!SelectSimdLevel(state, state.range(1)))
+    {
+        return;
+    }
+
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+    LargePositionBuffer buffer;
+    buffer.from_double3(values.data(), values.size());
+    std::vector<LargePackedPosition> packed(buffer.size());
+    batch_pack(int3(), buffer.lanes(), packed.data(), buffer.size());
+
+    for (auto _ : state)
+    {
+        batch_unpack(int3(), packed.data(), buffer.mutable_lanes(), buffer.size());
+        benchmark::DoNotOptimize(buffer.local_x());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    simd_set_level(simd_supported_level());
+}
+BENCHMARK(BM_Unpack_Batch)->Apply(SimdArgs);
+
+// === Fixed-point positions ===
+
+// One integration step (position += velocity, re-celling past the hysteresis threshold) with float offsets
+// (from_float3) versus fixed-point offsets (LargeFixedPosition::move)
+static void BM_Integrate(benchmark::State& state)
+{
+    const bool fixed = state.range(1) != 0;
+    state.SetLabel(fixed ? "fixed" : "float");
+    std::vector<LargePosition> positions = MakePositions(size_t(state.range(0)), Clustered);
+    std::vector<LargeFixedPosition> fixed_positions(positions.size());
+    std::mt19937 rng(15);
+    std::uniform_real_distribution<float> step(-LargePosition::CELL_SIZE * 0.05f, LargePosition::CELL_SIZE * 0.05f);
+    std::vector<float3> velocity(positions.size());
+    std::vector<int3> fixed_velocity(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        fixed_positions[i].from_position(positions[i]);
+        velocity[i] = float3(step(rng), step(rng), step(rng));
+        fixed_velocity[i] = LargeFixedPosition::to_units(velocity[i]);
+    }
+
+    for (auto _ : state)
+    {
+        if (fixed)
+        {
+            for (size_t i = 0; i < fixed_positions.size(); i++)
+            {
+                fixed_positions[i].move(fixed_velocity[i]);
+            }
+            benchmark::DoNotOptimize(fixed_positions.data());
+        }
+        else
+        {
+            for (size_t i = 0; i < positions.size(); i++)
+            {
+                positions[i].from_float3(positions[i].global, positions[i].local + velocity[i]);
+            }
+            benchmark::DoNotOptimize(positions.data());
+        }
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_Integrate)->ArgNames({"count", "fixed"})->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {0, 1}});
+
+// === Snapshots ===
+
+// Saving and loading a snapshot: binary lanes (write_snapshot + LargeSnapshotReader, validated) versus the text path
+// through to_double3() / from_double3()
+static void BM_SnapshotRoundTrip(benchmark::State& state)
+{
+    const bool binary = state.range(1) != 0;
+    state.SetLabel(binary ? "binary" : "text");
+    std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Uniform);
+    LargePositionBuffer positions;
+    positions.from_double3(values.data(), values.size());
+    LargePositionBuffer loaded;
+
+    for (auto _ : state)
+    {
+        loaded.clear();
+        if (binary)
+        {
+            std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+            write_snapshot(stream, positions);
+            LargeSnapshotReader reader(stream);
+            reader.read_all(loaded);
+        }
+        else
+        {
+            std::vector<double3> world(positions.size());
+            positions.to_double3(world.data());
+            std::string text;
+            char line[96];
+            for (const double3& v : world)
+            {
+                text.append(line, size_t(std::snprintf(line, sizeof(line), "%.17g %.17g %.17g\n", v.x, v.y, v.z)));
+            }
+            const char* cursor = text.c_str();
+            for (double3& v : world)
+            {
+                char* end;
+                v.x = std::strtod(cursor, &end);
+                v.y = std::strtod(end, &end);
+                v.z = std::strtod(end, &end);
+                cursor = end;
+            }
+            loaded.from_double3(world.data(), world.size());
+        }
+        benchmark::DoNotOptimize(loaded.local_x());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+}
+BENCHMARK(BM_SnapshotRoundTrip)->ArgNames({"count", "binary"})->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {0, 1}});
+
+// === Mapped store ===
+
+// Startup: open a snapshot file and convert its first chunk for rendering, with a full load (LargeSnapshotReader)
+// versus a mapping (LargeMappedStore), whose cost doesn't depend on the snapshot size
+static void BM_SnapshotOpen(benchmark::State& state)
+{
+    const bool mapped = state.range(1) != 0;
+    state.SetLabel(mapped ? "mapped" : "load");
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_large_coordinates.lwcs").string();
+    {
+        std::vector<double3> values = MakeWorldPositions(size_t(state.range(0)), Clustered);
+        LargePositionBuffer positions;
+        positions.from_double3(values.data(), values.size());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        write_snapshot(out, positions);
+    }
+
+    const size_t first_chunk = LargeSnapshotHeader::DEFAULT_CHUNK_ELEMENTS;
+    std::vector<float> x(first_chunk), y(first_chunk), z(first_chunk);
+    for (auto _ : state)
+    {
+        if (mapped)
+        {
+            LargeMappedStore store;
+            store.open(path);
+            const LargeMappedStore::Span span = store.span(0);
+            batch_to_float3(int3(), span.lanes, Float3Lanes{x.data(), y.data(), z.data()}, span.count);
+        }
+        else
+        {
+            std::ifstream in(path, std::ios::binary);
+            LargeSnapshotReader reader(in);
+            LargePositionBuffer positions;
+            reader.read_all(positions);
+            batch_to_float3(int3(), positions.lanes(), Float3Lanes{x.data(), y.data(), z.data()}, first_chunk);
+        }
+        benchmark::DoNotOptimize(x.data());
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    std::filesystem::remove(path + ".log", error);
+}
+BENCHMARK(BM_SnapshotOpen)->ArgNames({"count", "mapped"})->ArgsProduct({{LARGE_COUNT, LARGE_COUNT * 8}, {0, 1}});
+
+// === Network encoding ===
+
+// Two replication frames of clustered positions around the observer's cell, the second one moved by up to 1 meter
+struct NetworkFrames
+{
+    LargePositionBuffer frame0;
+    LargePositionBuffer frame1;
+    std::vector<longlong3> baseline;
+};
+
+static NetworkFrames MakeNetworkFrames(size_t count, const LargePositionCodec& codec)
+{
+    NetworkFrames frames;
+    std::vector<double3> values = MakeWorldPositions(count, Clustered);
+    frames.frame0.from_double3(values.data(), values.size());
+    frames.frame1 = frames.frame0;
+    std::mt19937 rng(16);
+    std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+    std::vector<float> x(count), y(count), z(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = frames.frame0.local_x()[i] + step(rng);
+        y[i] = frames.frame0.local_y()[i] + step(rng);
+        z[i] = frames.frame0.local_z()[i] + step(rng);
+    }
+    frames.frame1.from_float3(ConstFloat3Lanes{x.data(), y.data(), z.data()});
+
+    LargeBitWriter writer;
+    frames.baseline.resize(count);
+    codec.encode(int3(), frames.frame0.lanes(), count, nullptr, writer, frames.baseline.data());
+    return frames;
+}
+
+// Encoding frame 1 as a keyframe or as deltas against frame 0, 16-bit locals (3 cm steps)
+static void BM_NetworkEncode(benchmark::State& state)
+{
+    const bool delta = state.range(1) != 0;
+    state.SetLabel(delta ? "delta" : "keyframe");
+    const size_t count = size_t(state.range(0));
+    const LargePositionCodec codec(16);
+    NetworkFrames frames = MakeNetworkFrames(count, codec);
+    std::vector<longlong3> sent(count);
+    LargeBitWriter writer;
+
+    for (auto _ : state)
+    {
+        writer.clear();
+        codec.encode(int3(), frames.frame1.lanes(), count, delta ? frames.baseline.data() : nullptr, writer, sent.data());
+        benchmark::DoNotOptimize(writer.finish().data());
+    }
+    FinishItems(state);
+    state.counters["bits_per_position"] = double(writer.bit_count()) / double(count);
+}
+BENCHMARK(BM_NetworkEncode)->ArgNames({"count", "delta"})->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {0, 1}});
+
+static void BM_NetworkDecode(benchmark::State& state)
+{
+    const bool delta = state.range(1) != 0;
+    state.SetLabel(delta ? "delta" : "keyframe");
+    const size_t count = size_t(state.range(0));
+    const LargePositionCodec codec(16);
+    NetworkFrames frames = MakeNetworkFrames(count, codec);
+    std::vector<longlong3> received(count);
+    LargeBitWriter writer;
+    codec.encode(int3(), frames.frame1.lanes(), count, delta ? frames.baseline.data() : nullptr, writer, received.data());
+    const std::vector<uint8_t> bytes = writer.finish();
+    LargePositionBuffer decoded(count);
+
+    for (auto _ : state)
+    {
+        LargeBitReader reader(bytes);
+        bool ok = codec.decode(reader, int3(), delta ? frames.baseline.data() : nullptr, count, decoded.mutable_lanes(), received.data());
+        benchmark::DoNotOptimize(ok);
+        benchmark::ClobberMemory();
+    }
+    FinishItems(state);
+    state.counters["bits_per_position"] = double(bytes.size() * 8) / double(count);
+}
+BENCHMARK(BM_NetworkDecode)->ArgNames({"count", "delta"})->ArgsProduct({{SMALL_COUNT, LARGE_COUNT}, {0, 1}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,187 @@
+#include "LargeAABB.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeAABBTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    // Boxes of up to two cells per axis scattered over a few cells around `center`
+    static void MakeBoxes(const int3& center, int spread, size_t count, uint32_t seed, LargeAABBBuffer& boxes)
+    {
+        RandomPositions random(seed, center, spread, 1024.0f);
+        std::uniform_real_distribution<float> extent(0.0f, 2000.0f);
+        for (size_t i = 0; i < count; i++)
+        {
+            LargePosition c = random.next();
+            boxes.push_back(LargeAABB::from_center(c, float3(extent(random.rng()), extent(random.rng()), extent(random.rng()))));
+        }
+    }
+
+    // Reference in double precision
+    static bool OverlapsDouble(const LargeAABB& a, const LargeAABB& b)
+    {
+        double3 a_min = a.min.to_double3(), a_max = a.max.to_double3();
+        double3 b_min = b.min.to_double3(), b_max = b.max.to_double3();
+        return b_min.x <= a_max.x && a_min.x <= b_max.x && b_min.y <= a_max.y && a_min.y <= b_max.y && b_min.z <= a_max.z &&
+               a_min.z <= b_max.z;
+    }
+};
+
+TEST_F(LargeAABBTest, OverlapAcrossCellBoundaries)
+{
+    // Same physical box expressed from two different cells
+    LargeAABB a(MakePosition(int3(4, 0, 0), float3(900.0f, -10.0f, -10.0f)), MakePosition(int3(5, 0, 0), float3(-900.0f, 10.0f, 10.0f)));
+    LargeAABB b(MakePosition(int3(5, 0, 0), float3(-1000.0f, 0.0f, 0.0f)), MakePosition(int3(5, 0, 0), float3(0.0f, 5.0f, 5.0f)));
+    LargeAABB c(MakePosition(int3(5, 0, 0), float3(-899.0f, 0.0f, 0.0f)), MakePosition(int3(6, 0, 0), float3(0.0f, 5.0f, 5.0f)));
+
+    EXPECT_TRUE(a.overlaps(b));
+    EXPECT_TRUE(b.overlaps(a));
+    EXPECT_FALSE(a.overlaps(c));
+    EXPECT_FALSE(c.overlaps(a));
+    EXPECT_NEAR(a.distance_sq(c), 1.0f, 1.0e-3f);
+
+    // Touching faces overlap
+    LargeAABB d(MakePosition(int3(5, 0, 0), float3(-900.0f, 0.0f, 0.0f)), MakePosition(int3(5, 0, 0), float3(0.0f, 1.0f, 1.0f)));
+    EXPECT_TRUE(a.overlaps(d));
+    EXPECT_EQ(a.distance_sq(d), 0.0f);
+}
+
+TEST_F(LargeAABBTest, FarApartAndOverflowingCells)
+{
+    LargeAABB near_min(MakePosition(int3(INT32_MIN, 0, 0), float3()), MakePosition(int3(INT32_MIN + 1, 1, 1), float3()));
+    LargeAABB near_max(MakePosition(int3(INT32_MAX - 1, 0, 0), float3()), MakePosition(int3(INT32_MAX, 1, 1), float3()));
+
+    // The cell delta does not fit in int32_t; it must saturate, not wrap around
+    EXPECT_FALSE(near_min.overlaps(near_max));
+    EXPECT_FALSE(near_max.overlaps(near_min));
+    EXPECT_GT(near_min.distance_sq(near_max), 1.0e24f);
+
+    const int3 lowest(INT32_MIN, INT32_MIN, INT32_MIN);
+    const int3 highest(INT32_MAX, INT32_MAX, INT32_MAX);
+    LargeAABB everything(MakePosition(lowest, float3()), MakePosition(highest, float3()));
+    EXPECT_TRUE(everything.contains(near_min));
+    EXPECT_TRUE(everything.contains(near_max));
+    EXPECT_FALSE(near_min.contains(everything));
+
+    LargeAABBBuffer boxes;
+    for (int i = 0; i < 37; i++)
+    {
+        boxes.push_back(i % 2 ? near_max : near_min);
+    }
+    for (int level = (int)SimdLevel::Scalar; level <= (int)simd_supported_level(); level++)
+    {
+        SCOPED_TRACE(level);
+        simd_set_level((SimdLevel)level);
+        uint64_t mask[1];
+        EXPECT_EQ(batch_overlaps(near_min, boxes.lanes(), boxes.size(), mask), 19u);
+        EXPECT_EQ(mask[0], 0x1555555555ull);
+        EXPECT_EQ(batch_contains(everything, boxes.lanes(), boxes.size(), mask), 37u);
+    }
+}
+
+TEST_F(LargeAABBTest, ContainsAndMerge)
+{
+    const int3 base(-100000, 7, 300000000);
+    LargeAABB box = LargeAABB::from_center(MakePosition(base, float3(1000.0f, 0.0f, -1000.0f)), float3(500.0f, 500.0f, 500.0f));
+    EXPECT_TRUE(box.contains(MakePosition(base + int3(1, 0, 0), float3(-600.0f, 0.0f, -1000.0f))));
+    EXPECT_FALSE(box.contains(MakePosition(base + int3(1, 0, 0), float3(-500.0f, 0.0f, -1000.0f))));
+
+    LargeAABB other = LargeAABB::from_center(MakePosition(base + int3(0, 2, 0), float3()), float3(10.0f, 10.0f, 10.0f));
+    LargeAABB merged = box.merged(other);
+    EXPECT_TRUE(merged.contains(box));
+    EXPECT_TRUE(merged.contains(other));
+    EXPECT_FALSE(box.contains(merged));
+
+    // Merge copies corner components, so it is exact even far from the origin
+    EXPECT_EQ(merged.min.global, box.min.global);
+    EXPECT_EQ(merged.max.global.y, other.max.global.y);
+    EXPECT_EQ(merged.max.local.y, other.max.local.y);
+    EXPECT_EQ(merged.max.local.x, box.max.local.x);
+    EXPECT_EQ(merged.min.local.x, other.min.local.x);
+
+    merged.merge(box);
+    EXPECT_EQ(merged.min.local.x, other.min.local.x);
+    EXPECT_EQ(box.distance_sq(MakePosition(base, float3(1000.0f, 0.0f, -1000.0f))), 0.0f);
+}
+
+TEST_F(LargeAABBTest, MatchesDoubleReference)
+{
+    const int3 center(123456, -98765, 40000000);
+    LargeAABBBuffer boxes;
+    MakeBoxes(center, 4, 2000, 1, boxes);
+
+    for (size_t i = 0; i < 200; i++)
+    {
+        const LargeAABB a = boxes.get(i);
+        for (size_t j = 0; j < boxes.size(); j += 7)
+        {
+            const LargeAABB b = boxes.get(j);
+            ASSERT_EQ(a.overlaps(b), OverlapsDouble(a, b)) << i << " " << j;
+        }
+    }
+}
+
+TEST_F(LargeAABBTest, BatchBitExactWithScalar)
+{
+    const int3 center(-7, 1 << 30, 12);
+    LargeAABBBuffer boxes;
+    MakeBoxes(center, 3, 1001, 2, boxes);
+    const AABBLanes lanes = boxes.lanes();
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<size_t> pick(0, boxes.size() - 1);
+    for (int query_index = 0; query_index < 8; query_index++)
+    {
+        LargeAABB query = boxes.get(pick(rng));
+        if (query_index % 2)
+        {
+            query.merge(boxes.get(pick(rng)));
+        }
+
+        std::vector<uint64_t> expected_overlap((boxes.size() + 63) / 64, 0);
+        std::vector<uint64_t> expected_contains((boxes.size() + 63) / 64, 0);
+        std::vector<float> expected_distance(boxes.size());
+        size_t overlap_count = 0;
+        size_t contains_count = 0;
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            const LargeAABB box = boxes.get(i);
+            if (query.overlaps(box))
+            {
+                expected_overlap[i / 64] |= uint64_t(1) << (i % 64);
+                overlap_count++;
+            }
+            if (query.contains(box))
+            {
+                expected_contains[i / 64] |= uint64_t(1) << (i % 64);
+                contains_count++;
+            }
+            expected_distance[i] = query.distance_sq(box);
+        }
+        EXPECT_GT(overlap_count, 0u);
+
+        for (int level = (int)SimdLevel::Scalar; level <= (int)simd_supported_level(); level++)
+        {
+            SCOPED_TRACE(level);
+            simd_set_level((SimdLevel)level);
+
+            // Start dirty: the batch functions clear the mask themselves
+            std::vector<uint64_t> mask(expected_overlap.size(), ~uint64_t(0));
+            EXPECT_EQ(batch_overlaps(query, lanes, boxes.size(), mask.data()), overlap_count);
+            EXPECT_EQ(mask, expected_overlap);
+            EXPECT_EQ(batch_contains(query, lanes, boxes.size(), mask.data()), contains_count);
+            EXPECT_EQ(mask, expected_contains);
+
+            std::vector<float> distance(boxes.size());
+            batch_distance_sq(query, lanes, boxes.size(), distance.data());
+            for (size_t i = 0; i < boxes.size(); i++)
+            {
+                ASSERT_EQ(distance[i], expected_distance[i]) << i;
+            }
+        }
+    }
+}
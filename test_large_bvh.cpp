@@ -0,0 +1,219 @@
+#include "LargeBVH.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeBVHTest : public ::testing::Test
+{
+  protected:
+    struct Object
+    {
+        LargePosition pos;
+        float3 half_extent;
+        bool alive;
+    };
+
+    static float3 ToFrame(const LargePosition& pos, const int3& cell)
+    {
+        return float3(LargeAABB::axis_offset(pos.global.x, pos.local.x, cell.x), LargeAABB::axis_offset(pos.global.y, pos.local.y, cell.y),
+                      LargeAABB::axis_offset(pos.global.z, pos.local.z, cell.z));
+    }
+
+    // Objects scattered over the cells within `spread` of `center`
+    static std::vector<Object> MakeObjects(const int3& center, size_t count, uint32_t seed, int32_t spread = 2)
+    {
+        RandomPositions random(seed, center, spread, 1000.0f);
+        std::uniform_real_distribution<float> extent(1.0f, 60.0f);
+        std::vector<Object> objects(count);
+        for (Object& o : objects)
+        {
+            o.pos = random.next();
+            o.half_extent = float3(extent(random.rng()), extent(random.rng()), extent(random.rng()));
+            o.alive = true;
+        }
+        return objects;
+    }
+
+    // Same arithmetic as the BVH leaves: the query is expressed in the object's cell frame
+    static std::vector<uint32_t> BruteOverlap(const std::vector<Object>& objects, const LargeAABB& box)
+    {
+        std::vector<uint32_t> ids;
+        for (uint32_t i = 0; i < uint32_t(objects.size()); i++)
+        {
+            const Object& o = objects[i];
+            if (!o.alive)
+            {
+                continue;
+            }
+            float3 lo = ToFrame(box.min, o.pos.global), hi = ToFrame(box.max, o.pos.global);
+            float3 mn = o.pos.local - o.half_extent, mx = o.pos.local + o.half_extent;
+            if (mn.x <= hi.x && lo.x <= mx.x && mn.y <= hi.y && lo.y <= mx.y && mn.z <= hi.z && lo.z <= mx.z)
+            {
+                ids.push_back(i);
+            }
+        }
+        return ids;
+    }
+
+    static float BruteRaycast(const std::vector<Object>& objects, const LargePosition& origin, const float3& dir, float max_distance)
+    {
+        const float3 inv(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+        float best = FLT_MAX;
+        for (const Object& o : objects)
+        {
+            if (!o.alive)
+            {
+                continue;
+            }
+            float3 p = ToFrame(origin, o.pos.global);
+            float3 mn = o.pos.local - o.half_extent, mx = o.pos.local + o.half_extent;
+            float tx0 = (mn.x - p.x) * inv.x, tx1 = (mx.x - p.x) * inv.x;
+            float ty0 = (mn.y - p.y) * inv.y, ty1 = (mx.y - p.y) * inv.y;
+            float tz0 = (mn.z - p.z) * inv.z, tz1 = (mx.z - p.z) * inv.z;
+            float t_near = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+            float t_far = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), max_distance));
+            if (t_near <= t_far)
+            {
+                best = std::min(best, t_near);
+            }
+        }
+        return best;
+    }
+
+    static void ExpectMatchesBruteForce(LargeBVH& bvh, const std::vector<Object>& objects, const int3& center, uint32_t seed,
+                                        int32_t spread = 2)
+    {
+        RandomPositions random(seed, center, spread, 1000.0f);
+        std::mt19937& rng = random.rng();
+        std::uniform_real_distribution<float> extent(10.0f, 1500.0f);
+        std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+
+        std::vector<uint32_t> ids;
+        for (int q = 0; q < 100; q++)
+        {
+            LargePosition c = random.next();
+            LargeAABB box = LargeAABB::from_center(c, float3(extent(rng), extent(rng), extent(rng)));
+
+            ids.clear();
+            bvh.overlap(box, ids);
+            std::sort(ids.begin(), ids.end());
+            ASSERT_EQ(ids, BruteOverlap(objects, box)) << q;
+
+            float3 d(dir(rng), dir(rng), dir(rng));
+            d = d / std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+            LargeBVH::RayHit hit;
+            float expected = BruteRaycast(objects, c, d, 8000.0f);
+            ASSERT_EQ(bvh.raycast(c, d, 8000.0f, hit), expected != FLT_MAX) << q;
+            if (expected != FLT_MAX)
+            {
+                ASSERT_EQ(hit.distance, expected) << q;
+                ASSERT_TRUE(objects[hit.id].alive);
+            }
+        }
+    }
+};
+
+TEST_F(LargeBVHTest, BuildMatchesBruteForce)
+{
+    const int3 center(1 << 28, -77, 123456);
+    std::vector<Object> objects = MakeObjects(center, 3000, 1);
+    std::vector<uint32_t> ids(objects.size());
+    std::vector<LargePosition> positions(objects.size());
+    std::vector<float3> extents(objects.size());
+    for (uint32_t i = 0; i < uint32_t(objects.size()); i++)
+    {
+        ids[i] = i;
+        positions[i] = objects[i].pos;
+        extents[i] = objects[i].half_extent;
+    }
+
+    LargeBVH bvh;
+    bvh.build(ids.data(), positions.data(), extents.data(), objects.size());
+    EXPECT_EQ(bvh.object_count(), 3000u);
+    EXPECT_EQ(bvh.cell_count(), 125u);
+    ExpectMatchesBruteForce(bvh, objects, center, 2);
+}
+
+TEST_F(LargeBVHTest, SparseCellsUseHashProbes)
+{
+    // Many sparsely populated cells: small queries probe the cell map instead of scanning every subtree
+    const int3 center(0, 0, -(1 << 30));
+    std::vector<Object> objects = MakeObjects(center, 3000, 6, 20);
+    LargeBVH bvh;
+    for (uint32_t i = 0; i < uint32_t(objects.size()); i++)
+    {
+        bvh.insert(i, objects[i].pos, objects[i].half_extent);
+    }
+    EXPECT_GT(bvh.cell_count(), 2500u);
+    ExpectMatchesBruteForce(bvh, objects, center, 7, 20);
+}
+
+TEST_F(LargeBVHTest, IncrementalUpdatesRefitAndReinsert)
+{
+    const int3 center(-5, 3, 40000000);
+    std::vector<Object> objects = MakeObjects(center, 2000, 3);
+    LargeBVH bvh;
+    for (uint32_t i = 0; i < uint32_t(objects.size()); i++)
+    {
+        bvh.insert(i, objects[i].pos, objects[i].half_extent);
+    }
+    ExpectMatchesBruteForce(bvh, objects, center, 4);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> step(-700.0f, 700.0f);
+    for (int frame = 0; frame < 5; frame++)
+    {
+        size_t recelled = 0;
+        for (uint32_t i = 0; i < uint32_t(objects.size()); i += 3)
+        {
+            LargePosition& pos = objects[i].pos;
+            pos.from_float3(pos.global, pos.local + float3(step(rng), step(rng), step(rng)));
+            recelled += bvh.update(i, pos) ? 1 : 0;
+        }
+        EXPECT_GT(recelled, 0u);
+        EXPECT_GT(bvh.refit(), 0u);
+        EXPECT_EQ(bvh.refit(), 0u);
+        ExpectMatchesBruteForce(bvh, objects, center, 10 + frame);
+    }
+
+    for (uint32_t i = 0; i < uint32_t(objects.size()); i += 2)
+    {
+        EXPECT_TRUE(bvh.remove(i));
+        objects[i].alive = false;
+    }
+    EXPECT_FALSE(bvh.remove(0));
+    EXPECT_EQ(bvh.object_count(), 1000u);
+    ExpectMatchesBruteForce(bvh, objects, center, 20);
+}
+
+TEST_F(LargeBVHTest, EmptyCellsAreReleased)
+{
+    LargeBVH bvh;
+    LargePosition a, b;
+    a.global = int3(INT32_MIN, 0, 0);
+    b.global = int3(INT32_MAX, 0, 0);
+    bvh.insert(0, a, float3(1.0f, 1.0f, 1.0f));
+    bvh.insert(1, b, float3(1.0f, 1.0f, 1.0f));
+    EXPECT_EQ(bvh.cell_count(), 2u);
+
+    // Cells at opposite ends of the range never see each other
+    std::vector<uint32_t> ids;
+    EXPECT_EQ(bvh.overlap(LargeAABB::from_center(a, float3(100.0f, 100.0f, 100.0f)), ids), 1u);
+    EXPECT_EQ(ids[0], 0u);
+
+    // Moving the only object out of a cell releases it; the subtree slot is reused for the next cell
+    LargePosition moved = a;
+    moved.global.x += 1;
+    EXPECT_TRUE(bvh.update(0, moved));
+    EXPECT_EQ(bvh.cell_count(), 2u);
+    EXPECT_TRUE(bvh.remove(0));
+    EXPECT_EQ(bvh.cell_count(), 1u);
+
+    ids.clear();
+    EXPECT_EQ(bvh.overlap(LargeAABB::from_center(a, float3(100.0f, 100.0f, 100.0f)), ids), 0u);
+    LargeBVH::RayHit hit;
+    EXPECT_TRUE(bvh.raycast(b, float3(0.0f, 0.0f, 1.0f), 10.0f, hit));
+    EXPECT_EQ(hit.id, 1u);
+    EXPECT_EQ(hit.distance, 0.0f);
+}
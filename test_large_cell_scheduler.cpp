@@ -0,0 +1,201 @@
+#include "LargeCellScheduler.h"
+#include "LargePositionBuffer.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeCellSchedulerTest : public ::testing::Test
+{
+  protected:
+    static bool Near(const int3& a, const int3& b, int32_t reach)
+    {
+        return std::abs(int64_t(a.x) - b.x) <= reach && std::abs(int64_t(a.y) - b.y) <= reach && std::abs(int64_t(a.z) - b.z) <= reach;
+    }
+
+    // Island index of every entity, checking the layout invariants on the way
+    static std::vector<uint32_t> IslandOfEntities(const LargeCellScheduler& scheduler, const std::vector<LargePosition>& positions)
+    {
+        std::vector<uint32_t> island_of(positions.size(), UINT32_MAX);
+        uint32_t next_cell = 0, next_entity = 0;
+        for (uint32_t i = 0; i < uint32_t(scheduler.islands().size()); i++)
+        {
+            const LargeCellScheduler::Island& island = scheduler.islands()[i];
+            EXPECT_EQ(island.first_cell, next_cell);
+            EXPECT_EQ(island.first_entity, next_entity);
+            next_cell += island.cell_count;
+            next_entity += island.entity_count;
+            for (uint32_t c = island.first_cell; c < island.first_cell + island.cell_count; c++)
+            {
+                const LargeCellScheduler::Cell& cell = scheduler.cells()[c];
+                for (uint32_t e = cell.first_entity; e < cell.first_entity + cell.entity_count; e++)
+                {
+                    uint32_t id = scheduler.entities()[e];
+                    EXPECT_EQ(positions[id].global, cell.cell);
+                    EXPECT_EQ(island_of[id], UINT32_MAX);
+                    island_of[id] = i;
+                }
+            }
+        }
+        EXPECT_EQ(next_cell, scheduler.cells().size());
+        EXPECT_EQ(next_entity, positions.size());
+        return island_of;
+    }
+};
+
+TEST_F(LargeCellSchedulerTest, CellsWithinReachShareAnIsland)
+{
+    // Cells 0 and 3 are within the default reach, cell 7 is 4 cells from cell 3
+    std::vector<LargePosition> positions = {
+        MakePosition(int3(0, 0, 0), float3()),        MakePosition(int3(7, 0, 0), float3()),  MakePosition(int3(3, -3, 3), float3()),
+        MakePosition(int3(0, 0, 0), float3(5, 5, 5)), MakePosition(int3(INT32_MAX, 0, 0), float3()),
+        MakePosition(int3(INT32_MIN, 0, 0), float3()),
+    };
+    LargeCellScheduler scheduler;
+    scheduler.build(positions.data(), positions.size());
+    std::vector<uint32_t> island_of = IslandOfEntities(scheduler, positions);
+
+    ASSERT_EQ(scheduler.islands().size(), 4u);
+    ASSERT_EQ(scheduler.cells().size(), 5u);
+    EXPECT_EQ(island_of[0], 1u);
+    EXPECT_EQ(island_of[2], 1u);
+    EXPECT_EQ(island_of[3], 1u);
+    EXPECT_EQ(island_of[1], 2u);
+    EXPECT_EQ(island_of[5], 0u);
+    EXPECT_EQ(island_of[4], 3u);
+
+    // Entities of a cell keep their input order
+    const LargeCellScheduler::Cell& origin = scheduler.cells()[scheduler.islands()[1].first_cell];
+    EXPECT_EQ(origin.cell, int3(0, 0, 0));
+    EXPECT_EQ(scheduler.entities()[origin.first_entity], 0u);
+    EXPECT_EQ(scheduler.entities()[origin.first_entity + 1], 3u);
+
+    LargeCellScheduler tight(0);
+    tight.build(positions.data(), positions.size());
+    EXPECT_EQ(tight.islands().size(), 5u);
+}
+
+TEST_F(LargeCellSchedulerTest, IslandsMatchBruteForce)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int32_t> cell(-40, 40);
+    std::vector<LargePosition> positions;
+    for (int i = 0; i < 3000; i++)
+    {
+        positions.push_back(MakePosition(int3(cell(rng), cell(rng) / 4, cell(rng) * 3), float3()));
+    }
+
+    for (int32_t reach : {0, 1, 3})
+    {
+        LargeCellScheduler scheduler(reach);
+        LargePositionBuffer buffer;
+        for (const LargePosition& pos : positions)
+        {
+            buffer.push_back(pos);
+        }
+        scheduler.build(buffer.lanes(), buffer.size());
+        std::vector<uint32_t> island_of = IslandOfEntities(scheduler, positions);
+
+        // Flood fill over entities
+        std::vector<uint32_t> expected(positions.size(), UINT32_MAX);
+        uint32_t components = 0;
+        for (size_t seed = 0; seed < positions.size(); seed++)
+        {
+            if (expected[seed] != UINT32_MAX)
+            {
+                continue;
+            }
+            std::vector<size_t> stack = {seed};
+            expected[seed] = components;
+            while (!stack.empty())
+            {
+                size_t a = stack.back();
+                stack.pop_back();
+                for (size_t b = 0; b < positions.size(); b++)
+                {
+                    if (expected[b] == UINT32_MAX && Near(positions[a].global, positions[b].global, reach))
+                    {
+                        expected[b] = components;
+                        stack.push_back(b);
+                    }
+                }
+            }
+            components++;
+        }
+
+        ASSERT_EQ(scheduler.islands().size(), components) << reach;
+        for (size_t a = 0; a < positions.size(); a += 7)
+        {
+            for (size_t b = 0; b < positions.size(); b += 5)
+            {
+                ASSERT_EQ(island_of[a] == island_of[b], expected[a] == expected[b]) << reach << " " << a << " " << b;
+            }
+        }
+    }
+}
+
+TEST_F(LargeCellSchedulerTest, RunIsDeterministic)
+{
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int32_t> cluster(-4, 4);
+    std::uniform_int_distribution<int32_t> cell(-2, 2);
+    std::uniform_real_distribution<float> local(-1000.0f, 1000.0f);
+    std::vector<LargePosition> initial;
+    for (int i = 0; i < 20000; i++)
+    {
+        int3 global(cluster(rng) * 10 + cell(rng), cluster(rng) * 10 + cell(rng), cell(rng));
+        initial.push_back(MakePosition(global, float3(local(rng), local(rng), local(rng))));
+    }
+
+    std::vector<LargeCellScheduler::Migration> reference;
+    for (uint32_t threads : {1u, 2u, 5u})
+    {
+        std::vector<LargePosition> positions = initial;
+        LargeThreadPool pool(threads);
+        LargeCellScheduler scheduler;
+        scheduler.build(positions.data(), positions.size());
+        EXPECT_EQ(scheduler.islands().size(), 81u);
+
+        std::vector<std::atomic<uint32_t>> visits(positions.size());
+        const std::vector<LargeCellScheduler::Migration>& migrations = scheduler.run(
+            [&](const LargeCellScheduler::Island& island, std::vector<LargeCellScheduler::Migration>& out)
+            {
+                // Visit entities backwards, so recording order differs from id order
+                for (uint32_t e = island.first_entity + island.entity_count; e-- > island.first_entity;)
+                {
+                    uint32_t id = scheduler.entities()[e];
+                    visits[id]++;
+                    LargePosition& pos = positions[id];
+                    int3 from = pos.global;
+                    pos.from_float3(pos.global, pos.local + float3(700.0f, 0.0f, -300.0f));
+                    if (pos.global != from)
+                    {
+                        out.push_back(LargeCellScheduler::Migration{id, from, pos.global});
+                    }
+                }
+            },
+            pool);
+
+        for (size_t i = 0; i < visits.size(); i++)
+        {
+            ASSERT_EQ(visits[i].load(), 1u) << i;
+        }
+        EXPECT_GT(migrations.size(), 1000u);
+        for (size_t i = 1; i < migrations.size(); i++)
+        {
+            ASSERT_LT(migrations[i - 1].id, migrations[i].id);
+        }
+        if (reference.empty())
+        {
+            reference = migrations;
+            continue;
+        }
+        ASSERT_EQ(migrations.size(), reference.size());
+        for (size_t i = 0; i < migrations.size(); i++)
+        {
+            ASSERT_EQ(migrations[i].id, reference[i].id);
+            ASSERT_EQ(migrations[i].from, reference[i].from);
+            ASSERT_EQ(migrations[i].to, reference[i].to);
+        }
+    }
+}
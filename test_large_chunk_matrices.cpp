@@ -0,0 +1,135 @@
+#include "LargeChunkMatrices.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeChunkMatricesTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    // Rotation about y followed by a tilt about x
+    static float4x4 MakeView()
+    {
+        float4x4 yaw = float4x4::identity();
+        yaw.m[0] = 0.8f;
+        yaw.m[2] = -0.6f;
+        yaw.m[8] = 0.6f;
+        yaw.m[10] = 0.8f;
+        float4x4 pitch = float4x4::identity();
+        pitch.m[5] = 0.96f;
+        pitch.m[6] = 0.28f;
+        pitch.m[9] = -0.28f;
+        pitch.m[10] = 0.96f;
+        return pitch * yaw;
+    }
+
+    // Reversed-Z infinite perspective projection (see README, "Depth Buffer Precision Optimization")
+    static float4x4 MakeProjection()
+    {
+        float4x4 p = {};
+        p.m[0] = 1.0f;
+        p.m[5] = 1.7f;
+        p.m[11] = -1.0f;
+        p.m[14] = 0.1f;
+        return p;
+    }
+
+    static void Transform(const float4x4& matrix, const double3& v, double out[4])
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            out[row] = matrix.m[row] * v.x + matrix.m[4 + row] * v.y + matrix.m[8 + row] * v.z + matrix.m[12 + row];
+        }
+    }
+};
+
+TEST_F(LargeChunkMatricesTest, LocalPointsLandAtTheirCameraRelativePosition)
+{
+    LargePosition camera(double3(1.0e9 + 17.25, -3.5e8, 12345.5));
+    const float4x4 view = MakeView();
+    const float4x4 projection = MakeProjection();
+    const float4x4 view_proj = projection * view;
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int32_t> step(-5, 5);
+    std::uniform_real_distribution<float> local(-1024.0f, 1024.0f);
+    for (int i = 0; i < 200; i++)
+    {
+        LargePosition object;
+        object.global = camera.global + int3(step(rng), step(rng), step(rng));
+        object.local = float3(local(rng), local(rng), local(rng));
+
+        float4x4 matrix = chunk_to_clip_matrix(camera, view_proj, object.global);
+        double actual[4];
+        Transform(matrix, double3(object.local.x, object.local.y, object.local.z), actual);
+
+        double3 a = object.to_double3();
+        double3 b = camera.to_double3();
+        double expected[4];
+        Transform(view_proj, double3(a.x - b.x, a.y - b.y, a.z - b.z), expected);
+
+        for (int row = 0; row < 4; row++)
+        {
+            // Translations reach ~11 cells, where the float ULP is 0.002
+            EXPECT_NEAR(actual[row], expected[row], 0.01) << i << " " << row;
+        }
+    }
+}
+
+TEST_F(LargeChunkMatricesTest, BatchBitExactWithScalar)
+{
+    LargePosition camera(double3(-5.0e7, 777.0, 2.0e9));
+    const float4x4 view = MakeView();
+    const float4x4 projection = MakeProjection();
+    const float4x4 view_proj = projection * view;
+
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int32_t> step(-40, 40);
+    std::vector<int3> chunks(101);
+    for (int3& chunk : chunks)
+    {
+        chunk = camera.global + int3(step(rng), step(rng), step(rng));
+    }
+
+    std::vector<float4x4> expected(chunks.size());
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        expected[i] = chunk_to_clip_matrix(camera, view_proj, chunks[i]);
+    }
+
+    for (int level = (int)SimdLevel::Scalar; level <= (int)simd_supported_level(); level++)
+    {
+        SCOPED_TRACE(level);
+        simd_set_level((SimdLevel)level);
+
+        // Odd count exercises the tail of the two-chunk loop
+        std::vector<float4x4> out(chunks.size());
+        build_chunk_matrices(camera, view, projection, chunks.data(), chunks.size(), out.data());
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(out.data()) % 16, 0u);
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            for (int j = 0; j < 16; j++)
+            {
+                ASSERT_EQ(out[i].m[j], expected[i].m[j]) << i << " " << j;
+            }
+        }
+    }
+}
+
+TEST_F(LargeChunkMatricesTest, CameraChunkTranslation)
+{
+    LargePosition camera;
+    camera.global = int3(10, 20, 30);
+    camera.local = float3(100.0f, -200.0f, 300.0f);
+
+    // Identity view and projection leave the pure translation: chunk center minus camera
+    int3 chunk(11, 20, 29);
+    float4x4 out;
+    build_chunk_matrices(camera, float4x4::identity(), float4x4::identity(), &chunk, 1, &out);
+    EXPECT_EQ(out.m[12], 2048.0f - 100.0f);
+    EXPECT_EQ(out.m[13], 200.0f);
+    EXPECT_EQ(out.m[14], -2048.0f - 300.0f);
+    EXPECT_EQ(out.m[15], 1.0f);
+    EXPECT_EQ(out.m[0], 1.0f);
+}
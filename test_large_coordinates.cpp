@@ -4,6 +4,9 @@
 #include <cmath>
 #include <gtest/gtest.h>
 #include <limits>
+#include <random>
+#include <set>
+#include <unordered_set>
 
 class LargePositionTest : public ::testing::Test
 {
@@ -917,3 +920,114 @@ TEST_F(LargePositionTest, BasicBoundsAssertion)
     EXPECT_LE(std::abs(result_far.y), LargePosition::CELL_SIZE * 3.0f);
     EXPECT_LE(std::abs(result_far.z), LargePosition::CELL_SIZE * 3.0f);
 }
+
+// === HASHING AND ORDERING ===
+
+TEST_F(LargePositionTest, Int3HashAndOrder)
+{
+    EXPECT_LT(int3(-1, 5, 5), int3(0, 0, 0));
+    EXPECT_LT(int3(0, -1, 5), int3(0, 0, 0));
+    EXPECT_LT(int3(0, 0, -1), int3(0, 0, 0));
+    EXPECT_FALSE(int3(0, 0, 0) < int3(0, 0, 0));
+    EXPECT_LT(int3(INT32_MIN, 0, 0), int3(INT32_MAX, 0, 0));
+
+    // Every distinct cell of a dense block is kept once by both container kinds
+    std::unordered_set<int3> hashed;
+    std::set<int3> sorted;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int32_t z = -8; z < 8; z++)
+        {
+            for (int32_t y = -8; y < 8; y++)
+            {
+                for (int32_t x = -8; x < 8; x++)
+                {
+                    hashed.insert(int3(x, y, z));
+                    sorted.insert(int3(x, y, z));
+                }
+            }
+        }
+    }
+    EXPECT_EQ(hashed.size(), 16u * 16u * 16u);
+    EXPECT_EQ(sorted.size(), 16u * 16u * 16u);
+    EXPECT_EQ(*sorted.begin(), int3(-8, -8, -8));
+    EXPECT_EQ(std::hash<int3>()(int3(1, 2, 3)), size_t(hash_cell(int3(1, 2, 3))));
+    EXPECT_NE(hash_cell(int3(1, 2, 3)), hash_cell(int3(3, 2, 1)));
+}
+
+TEST_F(LargePositionTest, CanonicalFormIsExact)
+{
+    const float C = LargePosition::CELL_SIZE;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int32_t> cell(-100000, 100000);
+    std::uniform_int_distribution<int32_t> sixteenths(int32_t(-1.5f * C * 16), int32_t(1.5f * C * 16));
+    std::uniform_int_distribution<int32_t> shift(-1, 1);
+    for (int i = 0; i < 10000; i++)
+    {
+        // Offsets on a 1/16 grid stay exact when moved by whole cells, so `other` is the same world position
+        LargePosition pos;
+        pos.global = int3(cell(rng), cell(rng), cell(rng));
+        pos.local = float3(sixteenths(rng) / 16.0f, sixteenths(rng) / 16.0f, sixteenths(rng) / 16.0f);
+        const int3 d(shift(rng), shift(rng), shift(rng));
+        LargePosition other;
+        other.global = pos.global + d;
+        other.local = pos.local - float3(float(d.x), float(d.y), float(d.z)) * C;
+
+        const LargePosition canonical = pos.canonical();
+        ASSERT_EQ(canonical.global, other.canonical().global);
+        ASSERT_EQ(canonical.local.x, other.canonical().local.x);
+        ASSERT_EQ(canonical.local.y, other.canonical().local.y);
+        ASSERT_EQ(canonical.local.z, other.canonical().local.z);
+        ASSERT_GE(canonical.local.x, -C / 2);
+        ASSERT_LT(canonical.local.x, C / 2);
+        ASSERT_GE(canonical.local.z, -C / 2);
+        ASSERT_LT(canonical.local.z, C / 2);
+        ASSERT_EQ(canonical.to_double3().x, pos.to_double3().x);
+        ASSERT_EQ(canonical.to_double3().y, pos.to_double3().y);
+
+        ASSERT_EQ(pos, other);
+        ASSERT_EQ(pos.hash(), other.hash());
+        ASSERT_FALSE(pos < other);
+        ASSERT_FALSE(other < pos);
+    }
+
+    // Half-cell ties go to the upper cell; -0 and +0 are the same position
+    LargePosition tie;
+    tie.local = float3(C / 2, -C / 2, -0.0f);
+    EXPECT_EQ(tie.canonical().global, int3(1, 0, 0));
+    EXPECT_EQ(tie.canonical().local.x, -C / 2);
+    EXPECT_EQ(tie.canonical().local.y, -C / 2);
+    LargePosition zero;
+    EXPECT_EQ(zero.hash(), LargePosition(int3(0, 0, 0), float3(-0.0f, 0.0f, -0.0f)).hash());
+}
+
+TEST_F(LargePositionTest, PositionsAsContainerKeys)
+{
+    const float C = LargePosition::CELL_SIZE;
+    std::vector<LargePosition> positions;
+    for (int32_t i = 0; i < 64; i++)
+    {
+        // The same 64 world positions in two representations each
+        LargePosition a;
+        a.global = int3(i % 4, i / 16, 0);
+        a.local = float3(float(i) * 10.0f - 300.0f, 1000.0f, -0.5f);
+        LargePosition b;
+        b.global = a.global + int3(-1, 0, 0);
+        b.local = a.local + float3(C, 0.0f, 0.0f);
+        positions.push_back(a);
+        positions.push_back(b);
+    }
+
+    std::unordered_set<LargePosition> hashed(positions.begin(), positions.end());
+    std::set<LargePosition> sorted(positions.begin(), positions.end());
+    EXPECT_EQ(hashed.size(), 64u);
+    EXPECT_EQ(sorted.size(), 64u);
+
+    // The order follows the canonical cell, then the local offset
+    std::vector<LargePosition> order(sorted.begin(), sorted.end());
+    for (size_t i = 1; i < order.size(); i++)
+    {
+        LargePosition prev = order[i - 1].canonical(), next = order[i].canonical();
+        ASSERT_TRUE(prev.global < next.global || (prev.global == next.global && prev.local.x < next.local.x));
+    }
+}
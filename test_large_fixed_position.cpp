@@ -0,0 +1,185 @@
+#include "LargeFixedPosition.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+class LargeFixedPositionTest : public ::testing::Test
+{
+  protected:
+    // xorshift64*: the std distributions are implementation-defined, this sequence is the same with every standard library
+    struct Rng
+    {
+        uint64_t state;
+
+        uint64_t next()
+        {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 0x2545f4914f6cdd1dull;
+        }
+
+        // Uniform enough in [-range, range] for test inputs
+        int32_t next_in(int32_t range) { return int32_t(next() % uint64_t(2 * int64_t(range) + 1)) - range; }
+    };
+
+    static uint64_t Mix(uint64_t checksum, uint64_t value) { return large_coordinates_detail::fmix64(checksum ^ value) + value; }
+
+    static uint64_t FloatBits(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+};
+
+TEST_F(LargeFixedPositionTest, IntegerCellCrossing)
+{
+    const int32_t cell = LargeFixedPosition::CELL_UNITS;
+    const int3 origin(10, -20, 30);
+
+    // Within the hysteresis threshold the origin cell is kept
+    LargeFixedPosition pos(origin, int3(LargeFixedPosition::THRESHOLD_UNITS, -LargeFixedPosition::THRESHOLD_UNITS, 5));
+    EXPECT_EQ(pos.global, origin);
+    EXPECT_EQ(pos.local, int3(LargeFixedPosition::THRESHOLD_UNITS, -LargeFixedPosition::THRESHOLD_UNITS, 5));
+
+    // Beyond it every axis moves to its nearest cell, ties go up
+    pos.from_fixed(origin, int3(LargeFixedPosition::THRESHOLD_UNITS + 1, -cell / 2, -cell * 5 / 2));
+    EXPECT_EQ(pos.global, int3(11, -20, 28));
+    EXPECT_EQ(pos.local, int3(LargeFixedPosition::THRESHOLD_UNITS + 1 - cell, -cell / 2, -cell / 2));
+
+    // Relative offsets are exact, and moving back and forth returns the same position
+    LargeFixedPosition other(int3(12, -20, 28), int3(-3, 0, 7));
+    EXPECT_EQ(other.to_fixed(pos.global), int3(cell - 3, 0, 7));
+    LargeFixedPosition moved = pos;
+    moved.move(int3(cell * 2, -cell, 17));
+    moved.move(int3(-cell * 2, cell, -17));
+    EXPECT_EQ(moved, pos);
+    EXPECT_EQ(moved.hash(), pos.hash());
+
+    // Equality is exact and independent of the cell choice
+    LargeFixedPosition a(int3(0, 0, 0), int3(cell * 2 / 3, 0, 0));
+    LargeFixedPosition b(int3(1, 0, 0), int3(cell * 2 / 3 - cell, 0, 0));
+    EXPECT_NE(a.global, b.global);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.canonical().global, b.canonical().global);
+    EXPECT_EQ(a.hash(), b.hash());
+    b.move(int3(1, 0, 0));
+    EXPECT_NE(a, b);
+}
+
+TEST_F(LargeFixedPositionTest, FloatBoundaryConversions)
+{
+    // to_position() is exact, and from_position() of it gives the same units back
+    LargeFixedPosition pos(int3(-7, 3, 1000000), int3(-12345678, 1, LargeFixedPosition::THRESHOLD_UNITS));
+    LargePosition as_float = pos.to_position();
+    EXPECT_EQ(as_float.global, pos.global);
+    EXPECT_EQ(as_float.local.x, -12345678.0f * LargeFixedPosition::UNIT_SIZE);
+    LargeFixedPosition back;
+    back.from_position(as_float);
+    EXPECT_EQ(back.global, pos.global);
+    EXPECT_EQ(back.local, pos.local);
+
+    // Input values snap to the nearest unit, half away from zero
+    EXPECT_EQ(LargeFixedPosition::to_units(LargeFixedPosition::UNIT_SIZE * 2.5f), 3);
+    EXPECT_EQ(LargeFixedPosition::to_units(-LargeFixedPosition::UNIT_SIZE * 2.5f), -3);
+    EXPECT_EQ(LargeFixedPosition::to_units(1.0f), 8192);
+
+    // World coordinates round trip within half a unit
+    const double3 world(123456.789, -987654321.25, 4.0e12);
+    LargeFixedPosition from_world(world);
+    double3 world_back = from_world.to_double3();
+    EXPECT_NEAR(world_back.x, world.x, LargeFixedPosition::UNIT_SIZE);
+    EXPECT_NEAR(world_back.y, world.y, LargeFixedPosition::UNIT_SIZE);
+    EXPECT_NEAR(world_back.z, world.z, LargeFixedPosition::UNIT_SIZE);
+    EXPECT_LE(std::abs(from_world.local.x), LargeFixedPosition::HALF_CELL_UNITS);
+
+    // The render offset agrees with the LargePosition path
+    const int3 camera = from_world.global + int3(2, -1, 0);
+    float3 fixed_offset = from_world.to_float3(camera);
+    float3 float_offset = from_world.to_position().to_float3(camera);
+    EXPECT_EQ(fixed_offset.x, float_offset.x);
+    EXPECT_EQ(fixed_offset.y, float_offset.y);
+    EXPECT_EQ(fixed_offset.z, float_offset.z);
+}
+
+TEST_F(LargeFixedPositionTest, DeterministicAcrossBuilds)
+{
+    // A small lockstep simulation: bodies integrate fixed-point velocities, cross cells, bounce, read float inputs
+    // and produce render offsets. The checksum of every result is pinned, so a compiler, standard library,
+    // optimization level or platform that changes a single bit fails this test.
+    Rng rng{0x9e3779b97f4a7c15ull};
+    const size_t body_count = 64;
+    std::vector<LargeFixedPosition> bodies(body_count);
+    std::vector<int3> velocity(body_count);
+    const int3 base(1000000, -2000000, 3);
+    for (size_t i = 0; i < body_count; i++)
+    {
+        const int3 cell = base + int3(rng.next_in(3), rng.next_in(3), rng.next_in(3));
+        const int3 offset(rng.next_in(LargeFixedPosition::THRESHOLD_UNITS), rng.next_in(LargeFixedPosition::THRESHOLD_UNITS),
+                          rng.next_in(LargeFixedPosition::THRESHOLD_UNITS));
+        bodies[i] = LargeFixedPosition(cell, offset);
+        velocity[i] = int3(rng.next_in(1 << 18), rng.next_in(1 << 18), rng.next_in(1 << 18));
+    }
+
+    // Bodies are kept within a few cells of `base` by walls that reflect their velocity
+    auto reflect = [](int32_t from_base, int32_t& v)
+    {
+        if (from_base > 3 || from_base < -3)
+        {
+            v = (from_base > 0) ? -std::abs(v) : std::abs(v);
+        }
+    };
+
+    uint64_t checksum = 0;
+    size_t bounces = 0, rendered = 0;
+    for (int step = 0; step < 1000; step++)
+    {
+        for (size_t i = 0; i < body_count; i++)
+        {
+            bodies[i].move(velocity[i]);
+            const int3 from_base = bodies[i].global - base;
+            reflect(from_base.x, velocity[i].x);
+            reflect(from_base.y, velocity[i].y);
+            reflect(from_base.z, velocity[i].z);
+
+            // Input from a float source (e.g. a player's analog stick), snapped on the fixed grid
+            if (step % 16 == int(i % 16))
+            {
+                const float input = float(rng.next_in(1 << 20)) / 7168.0f;
+                velocity[i].x = velocity[i].x / 2 + LargeFixedPosition::to_units(input);
+            }
+
+            // Bounce off the neighbor when it gets within a cell
+            LargeFixedPosition& other = bodies[(i + 1) % body_count];
+            const int3 cell_delta = other.global - bodies[i].global;
+            if (std::abs(int64_t(cell_delta.x)) <= 1 && std::abs(int64_t(cell_delta.y)) <= 1 && std::abs(int64_t(cell_delta.z)) <= 1)
+            {
+                const int3 d = other.to_fixed(bodies[i].global);
+                velocity[i] = velocity[i] - int3(d.x / 64, d.y / 64, d.z / 64);
+                bounces++;
+            }
+        }
+
+        if (step % 100 == 99)
+        {
+            const int3 camera = bodies[0].canonical().global;
+            for (const LargeFixedPosition& body : bodies)
+            {
+                checksum = Mix(checksum, body.hash());
+                const int3 cell_delta = body.global - camera;
+                if (std::abs(int64_t(cell_delta.x)) <= 2 && std::abs(int64_t(cell_delta.y)) <= 2 && std::abs(int64_t(cell_delta.z)) <= 2)
+                {
+                    const float3 offset = body.to_float3(camera);
+                    checksum = Mix(checksum, FloatBits(offset.x) ^ (FloatBits(offset.y) << 21) ^ (FloatBits(offset.z) << 42));
+                    rendered++;
+                }
+                const LargePosition as_float = body.to_position();
+                checksum = Mix(checksum, FloatBits(as_float.local.x) ^ (FloatBits(as_float.local.y) << 32));
+            }
+        }
+    }
+
+    EXPECT_GT(bounces, 0u);
+    EXPECT_GT(rendered, body_count);
+    EXPECT_EQ(checksum, 0x0e3de0b45e33cbc5ull);
+}
@@ -0,0 +1,179 @@
+#include "LargeFrustumCuller.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+class LargeFrustumCullerTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    // Camera looking down -z after a yaw, reversed-Z infinite projection with a 0..1 depth range
+    static float4x4 MakeViewProjection()
+    {
+        float4x4 view = float4x4::identity();
+        view.m[0] = 0.8f;
+        view.m[2] = -0.6f;
+        view.m[8] = 0.6f;
+        view.m[10] = 0.8f;
+        float4x4 projection = {};
+        projection.m[0] = 1.0f;
+        projection.m[5] = 1.5f;
+        projection.m[11] = -1.0f;
+        projection.m[14] = 0.1f;
+        return projection * view;
+    }
+
+    static std::vector<int3> CubeAround(const int3& center, int32_t radius)
+    {
+        std::vector<int3> cells;
+        for (int32_t z = -radius; z <= radius; z++)
+        {
+            for (int32_t y = -radius; y <= radius; y++)
+            {
+                for (int32_t x = -radius; x <= radius; x++)
+                {
+                    cells.push_back(center + int3(x, y, z));
+                }
+            }
+        }
+        return cells;
+    }
+
+    static bool SameCells(std::vector<int3> a, std::vector<int3> b)
+    {
+        auto less = [](const int3& l, const int3& r)
+        { return l.x != r.x ? l.x < r.x : (l.y != r.y ? l.y < r.y : l.z < r.z); };
+        std::sort(a.begin(), a.end(), less);
+        std::sort(b.begin(), b.end(), less);
+        return a == b;
+    }
+};
+
+TEST_F(LargeFrustumCullerTest, PlaneExtraction)
+{
+    FrustumPlane planes[6];
+    extract_frustum_planes(MakeViewProjection(), planes);
+
+    auto inside = [&](const float3& p)
+    {
+        for (const FrustumPlane& plane : planes)
+        {
+            if (plane.normal.x * p.x + plane.normal.y * p.y + plane.normal.z * p.z + plane.distance < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // View direction is the rotated -z axis; the infinite far plane accepts any distance
+    EXPECT_TRUE(inside(float3(0.6f, 0.0f, -0.8f) * 10.0f));
+    EXPECT_TRUE(inside(float3(0.6f, 0.0f, -0.8f) * 1.0e7f));
+    EXPECT_FALSE(inside(float3(-0.6f, 0.0f, 0.8f) * 10.0f));
+    EXPECT_FALSE(inside(float3(0.6f, 0.0f, -0.8f) * 0.05f));
+    EXPECT_FALSE(inside(float3(0.0f, 100.0f, 0.0f)));
+}
+
+TEST_F(LargeFrustumCullerTest, CullBitExactAcrossInstructionSets)
+{
+    LargePosition camera(double3(3.0e11, -2.0e9, 7.0e10));
+    LargeFrustumCuller culler;
+    culler.set_frustum(camera, MakeViewProjection());
+    std::vector<int3> candidates = CubeAround(camera.global, 9);
+
+    simd_set_level(SimdLevel::Scalar);
+    std::vector<int3> expected;
+    culler.cull(candidates.data(), candidates.size(), expected);
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_LT(expected.size(), candidates.size() / 2);
+
+    for (int level = (int)SimdLevel::SSE42; level <= (int)simd_supported_level(); level++)
+    {
+        SCOPED_TRACE(level);
+        simd_set_level((SimdLevel)level);
+        std::vector<int3> visible;
+        culler.cull(candidates.data(), candidates.size() - 3, visible);
+        std::vector<int3> reference;
+        simd_set_level(SimdLevel::Scalar);
+        culler.cull(candidates.data(), candidates.size() - 3, reference);
+        EXPECT_EQ(visible, reference);
+    }
+}
+
+TEST_F(LargeFrustumCullerTest, RangeWalkMatchesBruteForce)
+{
+    LargePosition camera(double3(-1.0e10, 5.0e8, 123456.0));
+    LargeFrustumCuller culler;
+    culler.set_frustum(camera, MakeViewProjection());
+
+    for (int32_t radius : {0, 3, 17})
+    {
+        SCOPED_TRACE(radius);
+        std::vector<int3> candidates = CubeAround(camera.global, radius);
+        std::vector<int3> brute_force;
+        culler.cull(candidates.data(), candidates.size(), brute_force);
+
+        std::vector<int3> walked;
+        culler.cull_range(radius, walked);
+        EXPECT_TRUE(SameCells(walked, brute_force));
+
+        // The camera's own cell is always visible, and the order is front-to-back
+        ASSERT_FALSE(walked.empty());
+        EXPECT_EQ(walked[0], camera.global);
+        float previous = 0.0f;
+        for (const int3& cell : walked)
+        {
+            int3 d = cell - camera.global;
+            float x = float(d.x) * LargePosition::CELL_SIZE - camera.local.x;
+            float y = float(d.y) * LargePosition::CELL_SIZE - camera.local.y;
+            float z = float(d.z) * LargePosition::CELL_SIZE - camera.local.z;
+            float distance_sq = large_coordinates_detail::center_distance_sq(float3(x, y, z));
+            EXPECT_GE(distance_sq, previous);
+            previous = distance_sq;
+        }
+    }
+}
+
+TEST_F(LargeFrustumCullerTest, WalkStaysInsideTheCellRange)
+{
+    LargePosition camera;
+    camera.global = int3(INT_MAX - 1, 0, INT_MIN + 1);
+    LargeFrustumCuller culler;
+    culler.set_frustum(camera, MakeViewProjection());
+
+    std::vector<int3> visible;
+    culler.cull_range(5, visible);
+    EXPECT_FALSE(visible.empty());
+    for (const int3& cell : visible)
+    {
+        EXPECT_LE(int64_t(cell.x), int64_t(INT_MAX));
+        EXPECT_GE(int64_t(cell.z), int64_t(INT_MIN));
+    }
+}
+
+TEST_F(LargeFrustumCullerTest, FarCandidatesDoNotWrap)
+{
+    // Camera at the low end of the x range, looking down +x through a single plane
+    LargePosition camera;
+    camera.global = int3(INT_MIN, 0, 0);
+    FrustumPlane plane = {float3(1.0f, 0.0f, 0.0f), 0.0f};
+    LargeFrustumCuller culler;
+    culler.set_frustum(camera, &plane, 1);
+
+    // About 2^32 cells ahead: a wrapping int32_t delta would put these just behind the camera
+    std::vector<int3> candidates;
+    for (int32_t i = 0; i < 37; i++)
+    {
+        candidates.push_back(int3(INT_MAX - i, i, -i));
+    }
+
+    for (int level = (int)SimdLevel::Scalar; level <= (int)simd_supported_level(); level++)
+    {
+        SCOPED_TRACE(level);
+        simd_set_level((SimdLevel)level);
+        std::vector<int3> visible;
+        culler.cull(candidates.data(), candidates.size(), visible);
+        EXPECT_TRUE(SameCells(visible, candidates));
+    }
+}
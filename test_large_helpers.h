@@ -0,0 +1,75 @@
+#pragma once
+
+#include "LargeCoordinates.h"
+#include "LargePositionBuffer.h"
+#include <random>
+#include <vector>
+
+/*
+
+Position helpers shared by the test fixtures.
+
+MakePosition() sets the raw global/local representation, so tests can build non-canonical positions and exact
+edge cases that the LargePosition constructors would normalize away.
+
+RandomPositions draws positions with cells uniform within +/-cell_spread of a center cell on every axis and
+locals uniform within +/-local_range. Tests that need more per-element values (extents, velocities) draw them
+from rng() in the same loop, so a seed still describes the whole data set.
+
+*/
+
+inline LargePosition MakePosition(const int3& global, const float3& local)
+{
+    LargePosition pos;
+    pos.global = global;
+    pos.local = local;
+    return pos;
+}
+
+class RandomPositions
+{
+  public:
+    RandomPositions(uint32_t seed, const int3& center, int32_t cell_spread, float local_range)
+        : m_rng(seed)
+        , m_center(center)
+        , m_cell(-cell_spread, cell_spread)
+        , m_local(-local_range, local_range)
+    {
+    }
+
+    std::mt19937& rng() { return m_rng; }
+
+    LargePosition next()
+    {
+        LargePosition pos;
+        pos.global = m_center + int3(m_cell(m_rng), m_cell(m_rng), m_cell(m_rng));
+        pos.local = float3(m_local(m_rng), m_local(m_rng), m_local(m_rng));
+        return pos;
+    }
+
+    LargePositionBuffer buffer(size_t count)
+    {
+        LargePositionBuffer buffer;
+        for (size_t i = 0; i < count; i++)
+        {
+            buffer.push_back(next());
+        }
+        return buffer;
+    }
+
+    std::vector<LargePosition> vector(size_t count)
+    {
+        std::vector<LargePosition> positions(count);
+        for (LargePosition& pos : positions)
+        {
+            pos = next();
+        }
+        return positions;
+    }
+
+  private:
+    std::mt19937 m_rng;
+    int3 m_center;
+    std::uniform_int_distribution<int32_t> m_cell;
+    std::uniform_real_distribution<float> m_local;
+};
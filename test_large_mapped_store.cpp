@@ -0,0 +1,189 @@
+#include "LargeMappedStore.h"
+#include "test_large_helpers.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <vector>
+
+class LargeMappedStoreTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        m_path = (std::filesystem::path(::testing::TempDir()) /
+                  (std::string("large_mapped_store_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".lwcs"))
+                     .string();
+        RemoveFiles();
+    }
+
+    void TearDown() override { RemoveFiles(); }
+
+    void RemoveFiles()
+    {
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+        std::filesystem::remove_all(m_path + ".log", error);
+        std::filesystem::remove(m_path + ".tmp", error);
+    }
+
+    static LargePositionBuffer MakePositions(size_t count, uint32_t seed)
+    {
+        return RandomPositions(seed, int3(0, 0, 0), 1, LargePosition::THRESHOLD).buffer(count);
+    }
+
+    void WriteSnapshot(const LargePositionBuffer& positions, uint32_t chunk_elements)
+    {
+        std::ofstream out(m_path, std::ios::binary | std::ios::trunc);
+        ASSERT_TRUE(write_snapshot(out, positions, chunk_elements));
+    }
+
+    static void ExpectContents(const LargeMappedStore& store, const LargePositionBuffer& expected)
+    {
+        ASSERT_EQ(store.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            const LargePosition a = store.get(i), b = expected.get(i);
+            ASSERT_EQ(a.global, b.global) << i;
+            ASSERT_EQ(std::memcmp(&a.local, &b.local, sizeof(float3)), 0) << i;
+        }
+    }
+
+    std::string m_path;
+};
+
+TEST_F(LargeMappedStoreTest, SpansFeedBatchConversions)
+{
+    const size_t count = 1000 + 7;
+    LargePositionBuffer positions = MakePositions(count, 1);
+    WriteSnapshot(positions, 256);
+
+    LargeMappedStore store;
+    ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+    ExpectContents(store, positions);
+
+    // Four chunk spans, 64-byte aligned in the mapping and covering the elements in order
+    ASSERT_EQ(store.span_count(), 4u);
+    size_t next = 0;
+    for (size_t i = 0; i < store.span_count(); i++)
+    {
+        const LargeMappedStore::Span span = store.span(i);
+        EXPECT_EQ(span.first, next);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(span.lanes.local_z) % 64, 0u);
+        next += span.count;
+    }
+    EXPECT_EQ(next, count);
+
+    const int3 origin(1, -1, 0);
+    std::vector<float> x(count), y(count), z(count), ex(count), ey(count), ez(count);
+    store.to_float3(origin, Float3Lanes{x.data(), y.data(), z.data()});
+    positions.to_float3(origin, Float3Lanes{ex.data(), ey.data(), ez.data()});
+    EXPECT_EQ(std::memcmp(x.data(), ex.data(), count * sizeof(float)), 0);
+    EXPECT_EQ(std::memcmp(y.data(), ey.data(), count * sizeof(float)), 0);
+    EXPECT_EQ(std::memcmp(z.data(), ez.data(), count * sizeof(float)), 0);
+
+    // Files that aren't complete snapshots are rejected
+    store.close();
+    std::filesystem::resize_file(m_path, std::filesystem::file_size(m_path) - 64);
+    EXPECT_EQ(store.open(m_path), SnapshotStatus::Truncated);
+    EXPECT_FALSE(store.is_open());
+    EXPECT_EQ(store.open(m_path + ".missing"), SnapshotStatus::IoError);
+}
+
+TEST_F(LargeMappedStoreTest, UpdatesGoToTheLog)
+{
+    const size_t count = 300;
+    LargePositionBuffer positions = MakePositions(count, 2);
+    WriteSnapshot(positions, 128);
+    const auto snapshot_size = std::filesystem::file_size(m_path);
+
+    LargePositionBuffer expected = positions;
+    LargePositionBuffer updates = MakePositions(50, 3);
+    {
+        LargeMappedStore store;
+        ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+        for (size_t i = 0; i < 40; i++)
+        {
+            store.set(i * 7, updates.get(i));
+            expected.set(i * 7, updates.get(i));
+        }
+        for (size_t i = 40; i < 50; i++)
+        {
+            store.push_back(updates.get(i));
+            expected.push_back(updates.get(i));
+        }
+        store.set(count + 2, updates.get(0));
+        expected.set(count + 2, updates.get(0));
+
+        ExpectContents(store, expected);
+        EXPECT_EQ(store.span_count(), 4u);
+        EXPECT_EQ(store.span(3).count, 10u);
+        EXPECT_TRUE(store.flush());
+    }
+
+    // The snapshot itself is unchanged: copy-on-write mapping
+    {
+        std::ifstream in(m_path, std::ios::binary);
+        LargeSnapshotReader reader(in);
+        LargePositionBuffer original;
+        ASSERT_EQ(reader.read_all(original), SnapshotStatus::Ok);
+        EXPECT_EQ(std::memcmp(original.local_x(), positions.local_x(), count * sizeof(float)), 0);
+        EXPECT_EQ(std::filesystem::file_size(m_path), snapshot_size);
+    }
+
+    // Reopening replays the log, a torn record at its end is dropped and later records still replay
+    {
+        std::ofstream log(m_path + ".log", std::ios::binary | std::ios::app);
+        log.write("torn", 4);
+    }
+    {
+        LargeMappedStore store;
+        ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+        ExpectContents(store, expected);
+        store.set(1, updates.get(49));
+        expected.set(1, updates.get(49));
+    }
+    LargeMappedStore store;
+    ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+    ExpectContents(store, expected);
+
+    // Compaction folds the log into the snapshot
+    ASSERT_EQ(store.compact(), SnapshotStatus::Ok);
+    EXPECT_FALSE(std::filesystem::exists(m_path + ".log") && std::filesystem::file_size(m_path + ".log") > 0);
+    EXPECT_EQ(store.header().count, expected.size());
+    EXPECT_EQ(store.span_count(), 3u);
+    ExpectContents(store, expected);
+    store.close();
+    ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+    ExpectContents(store, expected);
+}
+
+TEST_F(LargeMappedStoreTest, OpensWithoutAWritableLog)
+{
+    const size_t count = 200;
+    LargePositionBuffer positions = MakePositions(count, 4);
+    WriteSnapshot(positions, 64);
+
+    // A directory in place of the log cannot be opened for appending, like a log on read-only media
+    // (permissions alone would not stop tests running as root)
+    std::filesystem::create_directory(m_path + ".log");
+    LargeMappedStore store;
+    ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+    ExpectContents(store, positions);
+    EXPECT_TRUE(store.flush());
+
+    // Updates fail and leave the store unchanged
+    LargePositionBuffer updates = MakePositions(2, 5);
+    EXPECT_FALSE(store.set(3, updates.get(0)));
+    EXPECT_FALSE(store.push_back(updates.get(1)));
+    ExpectContents(store, positions);
+    EXPECT_EQ(store.span_count(), 4u);
+
+    // Once the log can be created, updates go through
+    store.close();
+    std::filesystem::remove(m_path + ".log");
+    ASSERT_EQ(store.open(m_path), SnapshotStatus::Ok);
+    EXPECT_FALSE(std::filesystem::exists(m_path + ".log"));
+    EXPECT_TRUE(store.set(3, updates.get(0)));
+    positions.set(3, updates.get(0));
+    ExpectContents(store, positions);
+}
@@ -0,0 +1,175 @@
+#include "LargeMigrationQueue.h"
+#include "LargePositionBuffer.h"
+#include "test_large_helpers.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+class LargeMigrationQueueTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    static LargeMigrationQueue::Event MakeEvent(uint32_t id)
+    {
+        return LargeMigrationQueue::Event{id, int3(int32_t(id), 0, 0), int3(0, int32_t(id), 1)};
+    }
+};
+
+TEST_F(LargeMigrationQueueTest, DrainsInPushOrderAcrossBlocks)
+{
+    LargeMigrationQueue queue;
+    std::vector<LargeMigrationQueue::Event> out;
+    EXPECT_EQ(queue.drain(out), 0u);
+
+    const uint32_t count = uint32_t(LargeMigrationQueue::BLOCK_EVENTS * 3 + 17);
+    std::vector<LargeMigrationQueue::Event> batch;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (i % 3 == 0)
+        {
+            queue.push(MakeEvent(i));
+        }
+        else
+        {
+            batch.push_back(MakeEvent(i));
+        }
+        if (i % 3 == 2)
+        {
+            queue.push(batch.data(), batch.size());
+            batch.clear();
+        }
+        if (i == 2000)
+        {
+            EXPECT_EQ(queue.size(), 2001u);
+            EXPECT_EQ(queue.drain(out), 2001u);
+        }
+    }
+    queue.push(batch.data(), batch.size());
+    EXPECT_EQ(queue.drain(out), count - 2001u);
+    EXPECT_EQ(queue.size(), 0u);
+
+    ASSERT_EQ(out.size(), count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ASSERT_EQ(out[i].id, i);
+        ASSERT_EQ(out[i].from, int3(int32_t(i), 0, 0));
+        ASSERT_EQ(out[i].to, int3(0, int32_t(i), 1));
+    }
+}
+
+TEST_F(LargeMigrationQueueTest, ConcurrentProducersAndConsumer)
+{
+    LargeMigrationQueue queue;
+    const uint32_t producers = 4, per_producer = 50000;
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back(
+            [&queue, p]
+            {
+                LargeMigrationQueue::Event events[7];
+                for (uint32_t i = 0; i < per_producer;)
+                {
+                    // Mix single pushes and small batches
+                    uint32_t n = std::min<uint32_t>(1 + i % 7, per_producer - i);
+                    for (uint32_t k = 0; k < n; k++)
+                    {
+                        events[k] = MakeEvent(p * per_producer + i + k);
+                    }
+                    queue.push(events, n);
+                    i += n;
+                }
+            });
+    }
+
+    // Drain while the producers run; every producer's events must come out in its own order
+    std::vector<uint32_t> next(producers, 0);
+    size_t received = 0;
+    while (received < size_t(producers) * per_producer)
+    {
+        received += queue.drain(
+            [&](const LargeMigrationQueue::Event& event)
+            {
+                uint32_t p = event.id / per_producer;
+                ASSERT_LT(p, producers);
+                ASSERT_EQ(event.id, p * per_producer + next[p]);
+                ASSERT_EQ(event.from.x, int32_t(event.id));
+                next[p]++;
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(queue.drain([](const LargeMigrationQueue::Event&) {}), 0u);
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        EXPECT_EQ(next[p], per_producer);
+    }
+}
+
+TEST_F(LargeMigrationQueueTest, TrackedFromFloat3ReportsCellChanges)
+{
+    const size_t count = 20000 + 5;
+    RandomPositions random(1, int3(0, 0, 0), 1000, 1024.0f);
+    std::uniform_real_distribution<float> step(-2000.0f, 2000.0f);
+
+    LargePositionBuffer initial;
+    std::vector<float> x(count), y(count), z(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        LargePosition pos = random.next();
+        initial.push_back(pos);
+        x[i] = pos.local.x + step(random.rng());
+        y[i] = pos.local.y + step(random.rng());
+        z[i] = pos.local.z + step(random.rng());
+    }
+    const ConstFloat3Lanes local_pos{x.data(), y.data(), z.data()};
+
+    // Reference: scalar tracked updates
+    LargeMigrationQueue reference_queue;
+    std::vector<LargePosition> reference(count);
+    size_t reference_changed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        reference[i] = initial.get(i);
+        const float3 local_value(x[i], y[i], z[i]);
+        if (from_float3_tracked(reference[i], reference[i].global, local_value, uint32_t(100 + i), reference_queue))
+        {
+            reference_changed++;
+        }
+    }
+    std::vector<LargeMigrationQueue::Event> expected;
+    EXPECT_EQ(reference_queue.drain(expected), reference_changed);
+    EXPECT_GT(reference_changed, count / 10);
+
+    LargeThreadPool pool(3);
+    for (int level = 0; level <= (int)simd_supported_level(); level++)
+    {
+        simd_set_level((SimdLevel)level);
+        for (bool parallel : {false, true})
+        {
+            LargePositionBuffer buffer = initial;
+            LargeMigrationQueue queue;
+            size_t changed = parallel ? parallel_batch_from_float3(buffer.mutable_lanes(), local_pos, count, 100, queue, pool)
+                                      : batch_from_float3(buffer.mutable_lanes(), local_pos, count, 100, queue);
+            EXPECT_EQ(changed, reference_changed) << level << parallel;
+
+            std::vector<LargeMigrationQueue::Event> events;
+            EXPECT_EQ(queue.drain(events), changed);
+            std::sort(events.begin(), events.end(),
+                      [](const LargeMigrationQueue::Event& a, const LargeMigrationQueue::Event& b) { return a.id < b.id; });
+            ASSERT_EQ(events.size(), expected.size());
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                ASSERT_EQ(events[i].id, expected[i].id) << level << parallel;
+                ASSERT_EQ(events[i].from, expected[i].from) << level << parallel;
+                ASSERT_EQ(events[i].to, expected[i].to) << level << parallel;
+                ASSERT_EQ(buffer.get(events[i].id - 100).global, events[i].to);
+            }
+        }
+    }
+}
@@ -0,0 +1,238 @@
+#include "LargeNetworkCodec.h"
+#include "LargePositionBuffer.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeNetworkCodecTest : public ::testing::Test
+{
+  protected:
+    // Positions within a cell or two of `reference`, including hysteresis-extended locals
+    static LargePositionBuffer MakePositions(const int3& reference, size_t count, uint32_t seed)
+    {
+        return RandomPositions(seed, reference, 1, LargePosition::THRESHOLD).buffer(count);
+    }
+
+    // Exact a - b (world doubles far from the origin are coarser than the quantization step)
+    static double3 Difference(const LargePosition& a, const LargePosition& b)
+    {
+        constexpr double cell = LargePosition::CELL_SIZE;
+        return double3((double(a.global.x) - b.global.x) * cell + (double(a.local.x) - b.local.x),
+                       (double(a.global.y) - b.global.y) * cell + (double(a.local.y) - b.local.y),
+                       (double(a.global.z) - b.global.z) * cell + (double(a.local.z) - b.local.z));
+    }
+
+    static void ExpectEqual(const LargePositionBuffer& a, const LargePositionBuffer& b)
+    {
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            const LargePosition pa = a.get(i), pb = b.get(i);
+            ASSERT_EQ(pa.global, pb.global) << i;
+            ASSERT_EQ(pa.local.x, pb.local.x) << i;
+            ASSERT_EQ(pa.local.y, pb.local.y) << i;
+            ASSERT_EQ(pa.local.z, pb.local.z) << i;
+        }
+    }
+};
+
+TEST_F(LargeNetworkCodecTest, BitPackerRoundTrip)
+{
+    std::mt19937_64 rng(1);
+    struct Entry
+    {
+        uint64_t value;
+        uint32_t bits; // 0: exponential-Golomb of order `k`
+        uint32_t k;
+    };
+    std::vector<Entry> entries;
+    LargeBitWriter writer;
+    for (int i = 0; i < 5000; i++)
+    {
+        Entry e;
+        if (i % 3 == 0)
+        {
+            e.bits = 1 + uint32_t(rng() % 64);
+            e.value = rng() & ((e.bits == 64) ? ~0ull : (1ull << e.bits) - 1);
+            e.k = 0;
+            writer.write(e.value, e.bits);
+        }
+        else
+        {
+            // Mostly small values, some up to the 2^61 limit
+            e.bits = 0;
+            e.k = uint32_t(rng() % 12);
+            e.value = (i % 17 == 0) ? rng() >> 3 : rng() % 40;
+            writer.write_exp_golomb(e.value, e.k);
+        }
+        entries.push_back(e);
+    }
+    const size_t bits = writer.bit_count();
+    const std::vector<uint8_t>& bytes = writer.finish();
+    EXPECT_EQ(bytes.size(), (bits + 7) / 8);
+
+    LargeBitReader reader(bytes);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry& e = entries[i];
+        ASSERT_EQ(e.bits ? reader.read(e.bits) : reader.read_exp_golomb(e.k), e.value) << i;
+    }
+    EXPECT_TRUE(reader.ok());
+
+    // Small values take few bits: 0 is a single bit, +/-1 (zigzag 1 and 2) three bits with order 0
+    LargeBitWriter small;
+    small.write_exp_golomb(0, 0);
+    EXPECT_EQ(small.bit_count(), 1u);
+    small.write_exp_golomb(2, 0);
+    EXPECT_EQ(small.bit_count(), 4u);
+
+    // Reading past the end is reported
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + bytes.size() / 2);
+    LargeBitReader short_reader(truncated);
+    for (const Entry& e : entries)
+    {
+        e.bits ? short_reader.read(e.bits) : short_reader.read_exp_golomb(e.k);
+    }
+    EXPECT_FALSE(short_reader.ok());
+}
+
+TEST_F(LargeNetworkCodecTest, KeyframeWithinPrecision)
+{
+    const int3 reference(-100000, 5, 2000000000);
+    const size_t count = 1000;
+    LargePositionBuffer positions = MakePositions(reference, count, 2);
+
+    for (uint32_t bits : {8u, 16u, LargePositionCodec::MAX_LOCAL_BITS})
+    {
+        SCOPED_TRACE(bits);
+        const LargePositionCodec codec(bits);
+        LargeBitWriter writer;
+        std::vector<longlong3> sent(count), received(count);
+        codec.encode(reference, positions.lanes(), count, nullptr, writer, sent.data());
+        const std::vector<uint8_t>& bytes = writer.finish();
+
+        // At most 3 bits per cell axis (0 or +/-1) and local_bits per local axis, far below 24 raw bytes at 16 bits
+        EXPECT_LE(bytes.size() * 8, 1 + count * 3 * (3 + bits) + 7);
+
+        LargeBitReader reader(bytes);
+        LargePositionBuffer decoded(count);
+        ASSERT_TRUE(codec.decode(reader, reference, nullptr, count, decoded.mutable_lanes(), received.data()));
+        for (size_t i = 0; i < count; i++)
+        {
+            ASSERT_EQ(received[i], sent[i]) << i;
+            const double3 error = Difference(decoded.get(i), positions.get(i));
+            ASSERT_LE(std::abs(error.x), codec.step() * 0.5) << i;
+            ASSERT_LE(std::abs(error.y), codec.step() * 0.5) << i;
+            ASSERT_LE(std::abs(error.z), codec.step() * 0.5) << i;
+
+            // Decoded positions are canonical and stable under requantization
+            const LargePosition p = decoded.get(i);
+            ASSERT_LT(std::abs(p.local.x), LargePosition::CELL_SIZE * 0.5f + codec.step()) << i;
+            ASSERT_EQ(codec.quantize(p), sent[i]) << i;
+        }
+    }
+
+    // Precision is the maximum rounding error, half a step
+    EXPECT_EQ(LargePositionCodec::with_precision(LargePosition::TYPICAL_PRECISION).local_bits(), 22u);
+    EXPECT_EQ(LargePositionCodec::with_precision(0.01f).local_bits(), 17u);
+    EXPECT_EQ(LargePositionCodec::with_precision(0.0f).step(), LargePosition::TYPICAL_PRECISION);
+}
+
+TEST_F(LargeNetworkCodecTest, DeltaAgainstAckedBaseline)
+{
+    const int3 reference(7, -7, 0);
+    const size_t count = 1000;
+    const LargePositionCodec codec(16);
+    LargePositionBuffer frame0 = MakePositions(reference, count, 3);
+
+    // Frame 0 is a keyframe, acknowledged by the receiver
+    std::vector<longlong3> sender_baseline(count), receiver_baseline(count);
+    LargeBitWriter writer;
+    codec.encode(reference, frame0.lanes(), count, nullptr, writer, sender_baseline.data());
+    const size_t keyframe_bytes = writer.finish().size();
+    LargePositionBuffer decoded(count);
+    {
+        LargeBitReader reader(writer.finish());
+        ASSERT_TRUE(codec.decode(reader, reference, nullptr, count, decoded.mutable_lanes(), receiver_baseline.data()));
+    }
+
+    // Frame 1: small movements, some crossing cells, and one teleport
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+    LargePositionBuffer frame1(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        LargePosition pos = frame0.get(i);
+        pos.from_float3(pos.global, pos.local + float3(step(rng), step(rng), step(rng)));
+        frame1.set(i, pos);
+    }
+    LargePosition teleport;
+    teleport.global = reference + int3(1000, 0, -1000);
+    frame1.set(17, teleport);
+
+    writer.clear();
+    std::vector<longlong3> sent(count), received(count);
+    codec.encode(reference, frame1.lanes(), count, sender_baseline.data(), writer, sent.data());
+    const std::vector<uint8_t> delta_bytes = writer.finish();
+    EXPECT_LT(delta_bytes.size() * 2, keyframe_bytes);
+
+    LargeBitReader reader(delta_bytes);
+    ASSERT_TRUE(codec.decode(reader, reference, receiver_baseline.data(), count, decoded.mutable_lanes(), received.data()));
+
+    // Same result as a keyframe of frame 1
+    writer.clear();
+    std::vector<longlong3> key_sent(count), key_received(count);
+    codec.encode(reference, frame1.lanes(), count, nullptr, writer, key_sent.data());
+    LargeBitReader key_reader(writer.finish());
+    LargePositionBuffer key_decoded(count);
+    ASSERT_TRUE(codec.decode(key_reader, reference, nullptr, count, key_decoded.mutable_lanes(), key_received.data()));
+    ExpectEqual(decoded, key_decoded);
+    EXPECT_EQ(received, key_received);
+    EXPECT_EQ(received, sent);
+    EXPECT_EQ(decoded.get(17).global, teleport.global);
+
+    // Mismatched keyframe / delta streams and truncated data fail
+    LargeBitReader wrong_mode(delta_bytes);
+    EXPECT_FALSE(codec.decode(wrong_mode, reference, nullptr, count, decoded.mutable_lanes(), received.data()));
+    std::vector<uint8_t> truncated(delta_bytes.begin(), delta_bytes.end() - 8);
+    LargeBitReader short_reader(truncated);
+    EXPECT_FALSE(codec.decode(short_reader, reference, receiver_baseline.data(), count, decoded.mutable_lanes(), received.data()));
+}
+
+TEST_F(LargeNetworkCodecTest, CorruptCellsFail)
+{
+    using large_coordinates_detail::zigzag_encode;
+    const LargePositionCodec codec(LargePositionCodec::MAX_LOCAL_BITS);
+    LargePositionBuffer decoded(1);
+    longlong3 received;
+
+    // Keyframe of one position whose x cell is `reference.x + delta`
+    auto decode_cell = [&](const int3& reference, int64_t delta)
+    {
+        LargeBitWriter writer;
+        writer.write_bit(false);
+        writer.write_exp_golomb(zigzag_encode(delta), 0);
+        writer.write_exp_golomb(0, 0);
+        writer.write_exp_golomb(0, 0);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            writer.write(0, codec.local_bits());
+        }
+        const std::vector<uint8_t> bytes = writer.finish();
+        LargeBitReader reader(bytes);
+        return codec.decode(reader, reference, nullptr, 1, decoded.mutable_lanes(), &received);
+    };
+
+    // Scaling a cell this large by 2^local_bits would overflow int64_t
+    EXPECT_FALSE(decode_cell(int3(0, 0, 0), int64_t(1) << 57));
+    EXPECT_FALSE(decode_cell(int3(0, 0, 0), -(int64_t(1) << 60)));
+
+    // Cells just outside the int32_t range fail, the extreme cells themselves decode
+    EXPECT_FALSE(decode_cell(int3(INT32_MAX, 0, 0), 1));
+    EXPECT_FALSE(decode_cell(int3(INT32_MIN, 0, 0), -1));
+    ASSERT_TRUE(decode_cell(int3(INT32_MAX - 1, 0, 0), 1));
+    EXPECT_EQ(decoded.get(0).global, int3(INT32_MAX, 0, 0));
+    ASSERT_TRUE(decode_cell(int3(INT32_MIN + 1, 0, 0), -1));
+    EXPECT_EQ(decoded.get(0).global, int3(INT32_MIN, 0, 0));
+}
@@ -0,0 +1,99 @@
+#include "LargeOriginManager.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+class LargeOriginManagerTest : public ::testing::Test
+{
+  protected:
+    // Every cached value must be bit-identical to a fresh to_float3() call
+    static void ExpectMatchesToFloat3(const LargeOriginManager& manager)
+    {
+        for (uint32_t i = 0; i < manager.size(); i++)
+        {
+            float3 expected = manager.position(i).to_float3(manager.origin());
+            float3 cached = manager.relative(i);
+            ASSERT_EQ(cached.x, expected.x) << i;
+            ASSERT_EQ(cached.y, expected.y) << i;
+            ASSERT_EQ(cached.z, expected.z) << i;
+        }
+    }
+};
+
+TEST_F(LargeOriginManagerTest, RecomputesOnlyWhatChanged)
+{
+    const int3 camera(100, -5, 42);
+    LargeOriginManager manager(camera);
+    RandomPositions random(1, camera, 1, 1024.0f);
+    for (int i = 0; i < 1000; i++)
+    {
+        manager.add(random.next());
+    }
+
+    EXPECT_EQ(manager.update(), 1000u);
+    ExpectMatchesToFloat3(manager);
+
+    // Static scene, camera still in the same cell
+    manager.set_origin(camera);
+    EXPECT_EQ(manager.update(), 0u);
+
+    // A few objects move; setting the same object twice refreshes it once
+    for (uint32_t index : {3u, 500u, 999u, 3u})
+    {
+        LargePosition pos = manager.position(index);
+        pos.from_float3(pos.global, pos.local + float3(700.0f, 0.0f, -300.0f));
+        manager.set_position(index, pos);
+    }
+    EXPECT_EQ(manager.dirty_count(), 3u);
+    EXPECT_EQ(manager.update(), 3u);
+    ExpectMatchesToFloat3(manager);
+}
+
+TEST_F(LargeOriginManagerTest, OriginShiftDoesNotDrift)
+{
+    LargeOriginManager manager;
+    manager.add(MakePosition(int3(0, 0, 0), float3(0.1f, -0.3f, 0.7f)));
+    manager.add(MakePosition(int3(1, -1, 0), float3(-1000.25f, 3.0e-5f, 512.0f)));
+    manager.update();
+    const float3 initial = manager.relative(0);
+
+    // Walk the camera away and back through many cells: the shift is exact, so nothing accumulates
+    int3 path[] = {int3(1, 0, 0), int3(2, 0, 0), int3(2, 1, 0), int3(1, 1, -1), int3(0, 0, 0)};
+    for (int loop = 0; loop < 100; loop++)
+    {
+        for (const int3& cell : path)
+        {
+            manager.set_origin(cell);
+            EXPECT_EQ(manager.update(), 2u);
+            ExpectMatchesToFloat3(manager);
+        }
+    }
+    EXPECT_EQ(manager.relative(0).x, initial.x);
+    EXPECT_EQ(manager.relative(0).y, initial.y);
+    EXPECT_EQ(manager.relative(0).z, initial.z);
+}
+
+TEST_F(LargeOriginManagerTest, MovesAndShiftInTheSameFrame)
+{
+    LargeOriginManager manager(int3(-7, 7, 0));
+    for (int i = 0; i < 64; i++)
+    {
+        manager.add(MakePosition(int3(-7 + i % 3 - 1, 7, 0), float3(float(i) * 10.0f, 1.0f, 2.0f)));
+    }
+    manager.update();
+
+    for (uint32_t i = 0; i < 64; i += 8)
+    {
+        LargePosition pos = manager.position(i);
+        pos.local.y += 100.0f;
+        manager.set_position(i, pos);
+    }
+    manager.set_origin(int3(-6, 7, 1));
+    EXPECT_EQ(manager.update(), 64u);
+    EXPECT_EQ(manager.dirty_count(), 0u);
+    ExpectMatchesToFloat3(manager);
+
+    // Lanes expose the same values for upload
+    ConstFloat3Lanes lanes = manager.relative_lanes();
+    EXPECT_EQ(lanes.y[8], manager.relative(8).y);
+}
@@ -0,0 +1,124 @@
+#include "LargePackedPosition.h"
+#include "LargePositionBuffer.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargePackedPositionTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    // Positions within the packed cell range around `origin`, including hysteresis-extended locals and edge values
+    static LargePositionBuffer MakePositions(const int3& origin, size_t count, uint32_t seed)
+    {
+        constexpr float cell = LargePosition::CELL_SIZE;
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int32_t> cell_dist(LargePackedPosition::MIN_CELL + 2, LargePackedPosition::MAX_CELL - 2);
+        std::uniform_real_distribution<float> local(-cell * 0.75f, cell * 0.75f);
+        const float special[] = {cell * 0.5f,
+                                 -cell * 0.5f,
+                                 std::nextafter(cell * 0.5f, 0.0f),
+                                 LargePackedPosition::LOCAL_STEP * 0.5f,
+                                 -LargePackedPosition::LOCAL_STEP * 1.5f,
+                                 -0.0f,
+                                 1e-30f,
+                                 cell * 0.75f};
+
+        LargePositionBuffer buffer;
+        for (size_t i = 0; i < count; i++)
+        {
+            LargePosition pos;
+            pos.global = origin + int3(cell_dist(rng), cell_dist(rng), cell_dist(rng));
+            pos.local = float3(local(rng), local(rng), (i % 7 == 0) ? special[(i / 7) % 8] : local(rng));
+            buffer.push_back(pos);
+        }
+        return buffer;
+    }
+
+    static void ExpectWithinPrecision(const LargePosition& actual, const LargePosition& expected, size_t i)
+    {
+        double3 a = actual.to_double3(), e = expected.to_double3();
+        ASSERT_LE(std::abs(a.x - e.x), LargePosition::TYPICAL_PRECISION) << i;
+        ASSERT_LE(std::abs(a.y - e.y), LargePosition::TYPICAL_PRECISION) << i;
+        ASSERT_LE(std::abs(a.z - e.z), LargePosition::TYPICAL_PRECISION) << i;
+    }
+};
+
+TEST_F(LargePackedPositionTest, RoundTripWithinTypicalPrecision)
+{
+    const int3 origin(-3000000, 17, 2000000000);
+    LargePositionBuffer positions = MakePositions(origin, 5000, 1);
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        const LargePosition pos = positions.get(i);
+        const LargePackedPosition packed = LargePackedPosition::pack(pos, origin);
+        const LargePosition unpacked = packed.unpack(origin);
+        ExpectWithinPrecision(unpacked, pos, i);
+
+        // Unpacked values are canonical and pack back to the same bits
+        ASSERT_GE(unpacked.local.x, -LargePosition::CELL_SIZE * 0.5f) << i;
+        ASSERT_LT(unpacked.local.z, LargePosition::CELL_SIZE * 0.5f) << i;
+        ASSERT_EQ(LargePackedPosition::pack(unpacked, origin), packed) << i;
+    }
+
+    // Values on the step grid survive exactly, whatever the origin
+    LargePosition exact;
+    exact.global = int3(LargePackedPosition::MAX_CELL, LargePackedPosition::MIN_CELL, 0);
+    exact.local = float3(-1024.0f, 1023.99951171875f, 0.00048828125f);
+    LargePosition back = LargePackedPosition::pack(exact).unpack();
+    EXPECT_EQ(back.global, exact.global);
+    EXPECT_EQ(back.local.x, exact.local.x);
+    EXPECT_EQ(back.local.y, exact.local.y);
+    EXPECT_EQ(back.local.z, exact.local.z);
+    back = LargePackedPosition::pack(exact, int3(5, -5, 0)).unpack(int3(5, -5, 0));
+    EXPECT_EQ(back.global, exact.global);
+
+    // Extended locals move to the neighboring cell
+    LargePosition extended;
+    extended.local = float3(1500.0f, -1500.0f, 1024.0f);
+    back = LargePackedPosition::pack(extended).unpack();
+    EXPECT_EQ(back.global, int3(1, -1, 1));
+    EXPECT_EQ(back.local.x, 1500.0f - LargePosition::CELL_SIZE);
+    EXPECT_EQ(back.local.z, -1024.0f);
+}
+
+TEST_F(LargePackedPositionTest, BatchBitExactWithScalar)
+{
+    const int3 origin(100, -200, 300);
+    const size_t count = 1000 + 13;
+    LargePositionBuffer positions = MakePositions(origin, count, 2);
+
+    std::vector<LargePackedPosition> expected(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        expected[i] = LargePackedPosition::pack(positions.get(i), origin);
+    }
+
+    for (int level = 0; level <= (int)simd_supported_level(); level++)
+    {
+        SCOPED_TRACE(level);
+        simd_set_level((SimdLevel)level);
+
+        // Odd counts exercise the scalar tails
+        for (size_t n : {count, size_t(16), size_t(7)})
+        {
+            std::vector<LargePackedPosition> packed(n);
+            batch_pack(origin, positions.lanes(), packed.data(), n);
+            ASSERT_EQ(std::memcmp(packed.data(), expected.data(), n * sizeof(LargePackedPosition)), 0) << n;
+
+            LargePositionBuffer unpacked(n);
+            batch_unpack(origin, packed.data(), unpacked.mutable_lanes(), n);
+            for (size_t i = 0; i < n; i++)
+            {
+                const LargePosition scalar = packed[i].unpack(origin);
+                const LargePosition batch = unpacked.get(i);
+                ASSERT_EQ(batch.global, scalar.global) << i;
+                ASSERT_EQ(batch.local.x, scalar.local.x) << i;
+                ASSERT_EQ(batch.local.y, scalar.local.y) << i;
+                ASSERT_EQ(batch.local.z, scalar.local.z) << i;
+            }
+        }
+    }
+}
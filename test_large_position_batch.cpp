@@ -0,0 +1,318 @@
+#include "LargePositionBuffer.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargePositionBatchTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    // Every instruction set available on this machine, including the scalar fallback
+    static std::vector<SimdLevel> SupportedLevels()
+    {
+        std::vector<SimdLevel> levels;
+        for (int level = (int)SimdLevel::Scalar; level <= (int)simd_supported_level(); level++)
+        {
+            levels.push_back((SimdLevel)level);
+        }
+        return levels;
+    }
+};
+
+TEST_F(LargePositionBatchTest, LevelSelection)
+{
+    EXPECT_EQ(simd_active_level(), simd_supported_level());
+    EXPECT_EQ(simd_set_level(SimdLevel::Scalar), SimdLevel::Scalar);
+    EXPECT_EQ(simd_active_level(), SimdLevel::Scalar);
+
+    // Requests above the supported level are clamped
+    EXPECT_EQ(simd_set_level(SimdLevel::AVX512), simd_supported_level());
+}
+
+TEST_F(LargePositionBatchTest, ToFloat3BitExactWithScalar)
+{
+    const int3 origins[] = {int3(0, 0, 0), int3(-7, 12, 100000), int3(INT_MAX - 1, INT_MIN + 1, 0)};
+
+    for (const int3& origin : origins)
+    {
+        LargePositionBuffer buffer = RandomPositions(42, origin, 1, LargePosition::THRESHOLD).buffer(1000);
+        std::vector<float3> expected(buffer.size());
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            expected[i] = buffer.get(i).to_float3(origin);
+        }
+
+        for (SimdLevel level : SupportedLevels())
+        {
+            SCOPED_TRACE((int)level);
+            simd_set_level(level);
+
+            // Odd counts exercise the scalar tail of every vector width
+            for (size_t count : {size_t(0), size_t(1), size_t(15), size_t(17), size_t(33), buffer.size()})
+            {
+                std::vector<float> x(count), y(count), z(count);
+                batch_to_float3(origin, buffer.lanes(), Float3Lanes{x.data(), y.data(), z.data()}, count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    ASSERT_EQ(x[i], expected[i].x);
+                    ASSERT_EQ(y[i], expected[i].y);
+                    ASSERT_EQ(z[i], expected[i].z);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(LargePositionBatchTest, BufferToFloat3Lanes)
+{
+    int3 origin(3, -4, 5);
+    LargePositionBuffer buffer = RandomPositions(7, origin, 1, LargePosition::THRESHOLD).buffer(123);
+
+    std::vector<float> x(buffer.size()), y(buffer.size()), z(buffer.size());
+    buffer.to_float3(origin, Float3Lanes{x.data(), y.data(), z.data()});
+
+    std::vector<float3> aos(buffer.size());
+    buffer.to_float3(origin, aos.data());
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        EXPECT_EQ(x[i], aos[i].x);
+        EXPECT_EQ(y[i], aos[i].y);
+        EXPECT_EQ(z[i], aos[i].z);
+    }
+}
+
+TEST_F(LargePositionBatchTest, FromFloat3BitExactWithScalar)
+{
+    constexpr float cell = LargePosition::CELL_SIZE;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int32_t> cell_dist(-1000000, 1000000);
+    std::uniform_real_distribution<float> small_move(-cell * 0.75f, cell * 0.75f);
+    std::uniform_real_distribution<float> large_move(-cell * 3.0f, cell * 3.0f);
+
+    // Ties of world / CELL_SIZE (x.5) must round away from zero exactly like std::round
+    const float special[] = {cell * 1.5f,  -cell * 1.5f,  cell * 2.5f, -cell * 2.5f,
+                             cell * 0.75f, -cell * 0.75f, std::nextafter(cell * 0.75f, cell)};
+
+    const size_t count = 1003;
+    LargePositionBuffer initial;
+    std::vector<float> x(count), y(count), z(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        LargePosition pos;
+        pos.global = int3(cell_dist(rng), cell_dist(rng), (i % 97 == 0) ? INT_MAX - 3 : cell_dist(rng));
+        initial.push_back(pos);
+
+        // Roughly one position in eight leaves the hysteresis zone
+        bool crossing = (i % 8) == 3;
+        x[i] = crossing ? large_move(rng) : small_move(rng);
+        y[i] = small_move(rng);
+        z[i] = (i % 13 == 0) ? special[(i / 13) % 7] : small_move(rng);
+    }
+
+    for (SimdLevel level : SupportedLevels())
+    {
+        SCOPED_TRACE((int)level);
+        simd_set_level(level);
+
+        LargePositionBuffer buffer(initial);
+        std::vector<uint64_t> mask((count + 63) / 64, ~uint64_t(0));
+        size_t changed = buffer.from_float3(ConstFloat3Lanes{x.data(), y.data(), z.data()}, mask.data());
+
+        size_t expected_changed = 0;
+        std::vector<uint32_t> expected_indices;
+        for (size_t i = 0; i < count; i++)
+        {
+            LargePosition expected;
+            expected.from_float3(initial.get(i).global, float3(x[i], y[i], z[i]));
+
+            LargePosition actual = buffer.get(i);
+            ASSERT_EQ(actual.global, expected.global) << i;
+            ASSERT_EQ(actual.local.x, expected.local.x) << i;
+            ASSERT_EQ(actual.local.y, expected.local.y) << i;
+            ASSERT_EQ(actual.local.z, expected.local.z) << i;
+
+            bool moved = expected.global != initial.get(i).global;
+            EXPECT_EQ(((mask[i / 64] >> (i % 64)) & 1) != 0, moved) << i;
+            if (moved)
+            {
+                expected_changed++;
+                expected_indices.push_back(uint32_t(i));
+            }
+        }
+        EXPECT_EQ(changed, expected_changed);
+        EXPECT_GT(changed, 0u);
+
+        std::vector<uint32_t> indices(count);
+        indices.resize(changed_mask_to_indices(mask.data(), count, indices.data()));
+        EXPECT_EQ(indices, expected_indices);
+    }
+}
+
+TEST_F(LargePositionBatchTest, FromFloat3InPlaceIntegration)
+{
+    int3 origin(-20, 5, 1000);
+    LargePositionBuffer buffer = RandomPositions(5, origin, 1, LargePosition::THRESHOLD).buffer(256);
+    LargePositionBuffer reference(buffer);
+
+    // Integrate directly into the local lanes, as a simulation step would
+    const float step = 100.0f;
+    for (int frame = 0; frame < 40; frame++)
+    {
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            buffer.local_x()[i] += step;
+            buffer.local_z()[i] -= step * 0.5f;
+        }
+        buffer.from_float3(ConstFloat3Lanes{buffer.local_x(), buffer.local_y(), buffer.local_z()});
+
+        for (size_t i = 0; i < reference.size(); i++)
+        {
+            LargePosition pos = reference.get(i);
+            pos.from_float3(pos.global, pos.local + float3(step, 0.0f, -step * 0.5f));
+            reference.set(i, pos);
+        }
+    }
+
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        EXPECT_EQ(buffer.get(i).global, reference.get(i).global);
+        EXPECT_EQ(buffer.get(i).local.x, reference.get(i).local.x);
+        EXPECT_EQ(buffer.get(i).local.z, reference.get(i).local.z);
+    }
+}
+
+TEST_F(LargePositionBatchTest, FromDouble3BitExactWithScalar)
+{
+    constexpr double cell = double(LargePosition::CELL_SIZE);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> wide(-29.0 * LargePosition::AU_DISTANCE, 29.0 * LargePosition::AU_DISTANCE);
+    std::uniform_real_distribution<double> near(-10.0 * cell, 10.0 * cell);
+    std::uniform_int_distribution<int32_t> tie(-100000, 100000);
+
+    std::vector<double3> values;
+    for (int i = 0; i < 1000; i++)
+    {
+        values.push_back(double3(wide(rng), near(rng), wide(rng)));
+        // Exact half-cell ties must round away from zero
+        values.push_back(double3((tie(rng) + 0.5) * cell, (tie(rng) - 0.5) * cell, near(rng)));
+    }
+    values.push_back(double3(LargePosition::MIN_COORDINATE, LargePosition::MAX_COORDINATE, -0.0));
+    values.push_back(double3(LargePosition::MAX_COORDINATE - cell * 0.5, LargePosition::MIN_COORDINATE + cell * 0.5, 1e-300));
+    values.push_back(double3(cell * 0.5, -cell * 0.5, std::nextafter(cell * 0.5, 0.0)));
+
+    for (SimdLevel level : SupportedLevels())
+    {
+        SCOPED_TRACE((int)level);
+        simd_set_level(level);
+
+        // Odd sizes exercise the scalar tail
+        for (size_t count : {values.size(), values.size() - 1, size_t(3)})
+        {
+            LargePositionBuffer buffer;
+            buffer.from_double3(values.data(), count);
+            for (size_t i = 0; i < count; i++)
+            {
+                LargePosition expected(values[i]);
+                LargePosition actual = buffer.get(i);
+                ASSERT_EQ(actual.global, expected.global) << i;
+                ASSERT_EQ(actual.local.x, expected.local.x) << i;
+                ASSERT_EQ(actual.local.y, expected.local.y) << i;
+                ASSERT_EQ(actual.local.z, expected.local.z) << i;
+            }
+        }
+    }
+}
+
+TEST_F(LargePositionBatchTest, CanonicalizeBitExactWithScalar)
+{
+    constexpr float cell = LargePosition::CELL_SIZE;
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int32_t> cell_dist(-1000000, 1000000);
+    std::uniform_real_distribution<float> extended(-cell, cell);
+    std::uniform_real_distribution<float> inside(-cell * 0.5f, cell * 0.5f);
+
+    // Half-cell ties go to the upper cell, -CELL_SIZE/2 is already canonical
+    const float special[] = {cell * 0.5f, -cell * 0.5f, std::nextafter(cell * 0.5f, 0.0f), std::nextafter(-cell * 0.5f, -cell),
+                             cell * 1.5f, -cell * 2.5f, -0.0f,                             1e-30f};
+
+    const size_t count = 1003;
+    LargePositionBuffer initial;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Most positions are canonical already, like after a few frames of slow movement
+        LargePosition pos;
+        pos.global = int3(cell_dist(rng), cell_dist(rng), cell_dist(rng));
+        pos.local = float3((i % 5 == 0) ? extended(rng) : inside(rng), inside(rng), (i % 11 == 0) ? special[(i / 11) % 8] : inside(rng));
+        initial.push_back(pos);
+    }
+
+    for (SimdLevel level : SupportedLevels())
+    {
+        SCOPED_TRACE((int)level);
+        simd_set_level(level);
+
+        LargePositionBuffer buffer(initial);
+        std::vector<uint64_t> mask((count + 63) / 64, ~uint64_t(0));
+        size_t changed = buffer.canonicalize(mask.data());
+
+        size_t expected_changed = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const LargePosition expected = initial.get(i).canonical();
+            const LargePosition actual = buffer.get(i);
+            ASSERT_EQ(actual.global, expected.global) << i;
+            ASSERT_EQ(actual.local.x, expected.local.x) << i;
+            ASSERT_EQ(actual.local.y, expected.local.y) << i;
+            ASSERT_EQ(actual.local.z, expected.local.z) << i;
+            ASSERT_EQ(actual.to_double3().x, initial.get(i).to_double3().x) << i;
+
+            bool moved = expected.global != initial.get(i).global;
+            EXPECT_EQ(((mask[i / 64] >> (i % 64)) & 1) != 0, moved) << i;
+            expected_changed += moved ? 1 : 0;
+        }
+        EXPECT_EQ(changed, expected_changed);
+        EXPECT_GT(changed, count / 10);
+
+        // A second pass has nothing left to do
+        EXPECT_EQ(buffer.canonicalize(), 0u);
+    }
+}
+
+TEST_F(LargePositionBatchTest, CanonicalizeIncrementally)
+{
+    LargePositionBuffer initial = RandomPositions(9, int3(5, -5, 0), 1, LargePosition::THRESHOLD).buffer(1000);
+    LargePositionBuffer full(initial);
+    const size_t total = full.canonicalize();
+    ASSERT_GT(total, 0u);
+
+    // Sweep with a budget that doesn't divide the size, the cursor wraps around at the end
+    LargePositionBuffer buffer(initial);
+    size_t cursor = 0, changed = 0;
+    std::vector<uint64_t> mask((96 + 63) / 64);
+    for (int step = 0; step < 11; step++)
+    {
+        const size_t first = cursor;
+        size_t step_changed = buffer.canonicalize(cursor, 96, mask.data());
+        EXPECT_EQ(cursor, (step == 10) ? 0u : first + 96);
+
+        size_t flagged = 0;
+        for (size_t i = 0; i < 96 && first + i < buffer.size(); i++)
+        {
+            bool moved = buffer.get(first + i).global != initial.get(first + i).global;
+            EXPECT_EQ(((mask[i / 64] >> (i % 64)) & 1) != 0, moved) << first + i;
+            flagged += moved ? 1 : 0;
+        }
+        EXPECT_EQ(step_changed, flagged);
+        changed += step_changed;
+    }
+    EXPECT_EQ(changed, total);
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        ASSERT_EQ(buffer.get(i).global, full.get(i).global) << i;
+        ASSERT_EQ(buffer.get(i).local.x, full.get(i).local.x) << i;
+    }
+    EXPECT_EQ(buffer.canonicalize(cursor, 5000), 0u);
+    EXPECT_EQ(cursor, 0u);
+}
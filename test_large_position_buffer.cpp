@@ -0,0 +1,145 @@
+#include "LargePositionBuffer.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargePositionBufferTest : public ::testing::Test
+{
+  protected:
+    static std::vector<double3> MakeWorldPositions(size_t count, double range, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> dist(-range, range);
+        std::vector<double3> values(count);
+        for (auto& v : values)
+        {
+            v = double3(dist(rng), dist(rng), dist(rng));
+        }
+        return values;
+    }
+
+    static void ExpectSameRepresentation(const LargePosition& a, const LargePosition& b)
+    {
+        EXPECT_EQ(a.global, b.global);
+        EXPECT_EQ(a.local.x, b.local.x);
+        EXPECT_EQ(a.local.y, b.local.y);
+        EXPECT_EQ(a.local.z, b.local.z);
+    }
+};
+
+TEST_F(LargePositionBufferTest, LanesAreAligned)
+{
+    LargePositionBuffer buffer(37);
+    EXPECT_EQ(buffer.size(), 37u);
+    EXPECT_EQ(buffer.capacity() % LargePositionBuffer::LANE_PADDING, 0u);
+
+    const void* lanes[] = {buffer.global_x(), buffer.global_y(), buffer.global_z(),
+                           buffer.local_x(),  buffer.local_y(),  buffer.local_z()};
+    for (const void* lane : lanes)
+    {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(lane) % LargePositionBuffer::ALIGNMENT, 0u);
+    }
+
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        ExpectSameRepresentation(buffer.get(i), LargePosition());
+    }
+}
+
+TEST_F(LargePositionBufferTest, GrowthPreservesContents)
+{
+    LargePositionBuffer buffer;
+    EXPECT_TRUE(buffer.empty());
+
+    for (int i = 0; i < 1000; i++)
+    {
+        buffer.push_back(LargePosition(int3(i, -i, i * 2), float3(float(i) * 0.5f, -1.0f, 3.0f)));
+    }
+    ASSERT_EQ(buffer.size(), 1000u);
+    EXPECT_GE(buffer.capacity(), 1000u);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ExpectSameRepresentation(buffer.get(i), LargePosition(int3(i, -i, i * 2), float3(float(i) * 0.5f, -1.0f, 3.0f)));
+    }
+
+    LargePositionBuffer copy(buffer);
+    LargePositionBuffer moved(std::move(buffer));
+    EXPECT_TRUE(buffer.empty());
+    ASSERT_EQ(copy.size(), moved.size());
+    for (size_t i = 0; i < copy.size(); i++)
+    {
+        ExpectSameRepresentation(copy.get(i), moved.get(i));
+    }
+
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+    EXPECT_GE(copy.capacity(), 1000u);
+}
+
+TEST_F(LargePositionBufferTest, BulkFromDouble3MatchesScalar)
+{
+    std::vector<double3> values = MakeWorldPositions(4096, 29.0 * LargePosition::AU_DISTANCE, 1);
+    values.push_back(double3(LargePosition::MIN_COORDINATE, LargePosition::MAX_COORDINATE, 0.0));
+    values.push_back(double3(1024.0, -1024.0, 3072.0));
+
+    LargePositionBuffer buffer;
+    buffer.from_double3(values.data(), values.size());
+    ASSERT_EQ(buffer.size(), values.size());
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        ExpectSameRepresentation(buffer.get(i), LargePosition(values[i]));
+    }
+}
+
+TEST_F(LargePositionBufferTest, BulkToDouble3MatchesScalar)
+{
+    std::vector<double3> values = MakeWorldPositions(1000, 1e9, 2);
+
+    LargePositionBuffer buffer;
+    buffer.from_double3(values.data(), values.size());
+
+    std::vector<double3> out(buffer.size());
+    buffer.to_double3(out.data());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        double3 expected = buffer.get(i).to_double3();
+        EXPECT_EQ(out[i].x, expected.x);
+        EXPECT_EQ(out[i].y, expected.y);
+        EXPECT_EQ(out[i].z, expected.z);
+    }
+}
+
+TEST_F(LargePositionBufferTest, BulkFloat3RoundTripMatchesScalar)
+{
+    int3 origin(100, -50, 7);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-LargePosition::CELL_SIZE * 1.5f, LargePosition::CELL_SIZE * 1.5f);
+
+    std::vector<float3> locals(2000);
+    for (auto& l : locals)
+    {
+        l = float3(dist(rng), dist(rng), dist(rng));
+    }
+
+    LargePositionBuffer buffer;
+    buffer.from_float3(origin, locals.data(), locals.size());
+    ASSERT_EQ(buffer.size(), locals.size());
+
+    std::vector<float3> relative(buffer.size());
+    buffer.to_float3(origin, relative.data());
+
+    for (size_t i = 0; i < locals.size(); i++)
+    {
+        LargePosition expected;
+        expected.from_float3(origin, locals[i]);
+        ExpectSameRepresentation(buffer.get(i), expected);
+
+        float3 expected_relative = expected.to_float3(origin);
+        EXPECT_EQ(relative[i].x, expected_relative.x);
+        EXPECT_EQ(relative[i].y, expected_relative.y);
+        EXPECT_EQ(relative[i].z, expected_relative.z);
+    }
+}
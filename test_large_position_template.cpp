@@ -0,0 +1,147 @@
+#include "LargeCoordinates.h"
+#include <gtest/gtest.h>
+#include <unordered_set>
+
+// Planetary surface layer: small cells for tighter precision
+using SurfacePosition = LargePositionT<512, int32_t, float>;
+
+// Solar system layer: 64-bit cells for range beyond +/-29.3 AU
+using SolarSystemPosition = LargePositionT<2048, int64_t, float>;
+
+// Double precision local offsets
+using PrecisePosition = LargePositionT<1024, int32_t, double>;
+
+TEST(LargePositionTemplateTest, DefaultAliasConstants)
+{
+    static_assert(std::is_same<LargePosition::global_type, int3>::value, "LargePosition uses int3 cells");
+    static_assert(std::is_same<LargePosition::local_type, float3>::value, "LargePosition uses float3 offsets");
+    static_assert(LargePosition::CELL_SIZE == 2048.0f, "Default cell size changed");
+    static_assert(LargePosition::THRESHOLD == 1536.0f, "Default hysteresis threshold changed");
+    static_assert(LargePosition::MAX_COORDINATE == 4398046509056.0, "Default range changed");
+
+    // Exact ULPs since the template rewrite, formerly the rounded literals 0.000244f and 0.000488f
+    static_assert(LargePosition::TYPICAL_PRECISION == 1.0f / 4096.0f, "Typical precision is the FP32 ULP at 2048");
+    static_assert(LargePosition::MIN_PRECISION == 1.0f / 2048.0f, "Minimum precision is the FP32 ULP at 6144");
+    EXPECT_NEAR(LargePosition::TYPICAL_PRECISION, 0.000244f, 1e-6f);
+    EXPECT_NEAR(LargePosition::MIN_PRECISION, 0.000488f, 1e-6f);
+}
+
+TEST(LargePositionTemplateTest, DerivedConstants)
+{
+    static_assert(SurfacePosition::CELL_SIZE == 512.0f, "");
+    static_assert(SurfacePosition::THRESHOLD == 384.0f, "");
+    static_assert(SurfacePosition::TYPICAL_PRECISION == LargePosition::TYPICAL_PRECISION / 4.0f, "Precision scales with cell size");
+    static_assert(SurfacePosition::MAX_COORDINATE == LargePosition::MAX_COORDINATE / 4.0, "Range scales with cell size");
+
+    static_assert(std::is_same<SolarSystemPosition::global_type, longlong3>::value, "");
+    static_assert(SolarSystemPosition::MAX_COORDINATE > 1e6 * LargePosition::AU_DISTANCE, "");
+
+    static_assert(std::is_same<PrecisePosition::local_type, double3>::value, "");
+    static_assert(PrecisePosition::TYPICAL_PRECISION < 1e-12, "");
+}
+
+TEST(LargePositionTemplateTest, SmallCellsHysteresis)
+{
+    SurfacePosition pos;
+    pos.from_float3(int3(3, -2, 1), float3(SurfacePosition::THRESHOLD, -100.0f, 0.0f));
+    EXPECT_EQ(pos.global, int3(3, -2, 1));
+
+    pos.from_float3(int3(3, -2, 1), float3(SurfacePosition::THRESHOLD + 1.0f, -100.0f, 0.0f));
+    EXPECT_EQ(pos.global, int3(4, -2, 1));
+    EXPECT_FLOAT_EQ(pos.local.x, SurfacePosition::THRESHOLD + 1.0f - 512.0f);
+
+    double3 world(123456.789, -987654.321, 5e11);
+    SurfacePosition from_world(world);
+    double3 back = from_world.to_double3();
+    EXPECT_NEAR(back.x, world.x, SurfacePosition::TYPICAL_PRECISION);
+    EXPECT_NEAR(back.y, world.y, SurfacePosition::TYPICAL_PRECISION);
+    EXPECT_NEAR(back.z, world.z, SurfacePosition::TYPICAL_PRECISION);
+    EXPECT_LE(std::abs(from_world.local.x), SurfacePosition::CELL_SIZE * 0.5f);
+}
+
+TEST(LargePositionTemplateTest, SixtyFourBitCellsBeyond29AU)
+{
+    // Pluto's aphelion is ~49 AU, well beyond the int32_t cell range
+    const double distance = 49.0 * LargePosition::AU_DISTANCE;
+    SolarSystemPosition pluto(double3(distance, -distance, 0.0));
+    EXPECT_GT(pluto.global.x, int64_t(INT_MAX));
+
+    SolarSystemPosition probe(double3(distance + 1000.0, -distance, 0.0));
+    float3 relative = probe.to_float3(pluto.global);
+    float3 expected = pluto.to_float3(pluto.global) + float3(1000.0f, 0.0f, 0.0f);
+    EXPECT_NEAR(relative.x, expected.x, SolarSystemPosition::MIN_PRECISION);
+    EXPECT_NEAR(relative.y, expected.y, SolarSystemPosition::MIN_PRECISION);
+
+    SolarSystemPosition moved;
+    moved.from_float3(pluto.global, relative);
+    EXPECT_EQ(moved, probe);
+    EXPECT_NE(moved, pluto);
+}
+
+TEST(LargePositionTemplateTest, SixtyFourBitRangeLimits)
+{
+    // MAX_COORDINATE / CELL_SIZE is 2^63, one past INT64_MAX
+    SolarSystemPosition max(double3(SolarSystemPosition::MAX_COORDINATE, 0.0, 0.0));
+    EXPECT_EQ(max.global.x, INT64_MAX);
+    EXPECT_EQ(max.to_double3().x, SolarSystemPosition::MAX_COORDINATE);
+
+    SolarSystemPosition min(double3(SolarSystemPosition::MIN_COORDINATE, 0.0, 0.0));
+    EXPECT_EQ(min.global.x, INT64_MIN);
+    EXPECT_EQ(min.local.x, 0.0f);
+
+    LargePosition max32(double3(LargePosition::MAX_COORDINATE, LargePosition::MIN_COORDINATE, 0.0));
+    EXPECT_EQ(max32.global, int3(INT_MAX, INT_MIN, 0));
+    EXPECT_EQ(max32.local, float3(0.0f, 0.0f, 0.0f));
+}
+
+TEST(LargePositionTemplateTest, SixtyFourBitEqualityEarlyExitDoesNotOverflow)
+{
+    SolarSystemPosition a;
+    a.global = longlong3(INT64_MAX, 0, 0);
+    SolarSystemPosition b;
+    b.global = longlong3(INT64_MIN, 0, 0);
+
+    EXPECT_NE(a, b);
+    EXPECT_NE(b, a);
+    EXPECT_EQ(a, a);
+}
+
+TEST(LargePositionTemplateTest, DoubleLocalOffsets)
+{
+    PrecisePosition pos(double3(1e12 + 0.125, -3.0, 7.5));
+    double3 back = pos.to_double3();
+    EXPECT_EQ(back.x, 1e12 + 0.125);
+    EXPECT_EQ(back.y, -3.0);
+    EXPECT_EQ(back.z, 7.5);
+
+    PrecisePosition neighbor;
+    neighbor.from_float3(pos.global, pos.local + double3(PrecisePosition::CELL_SIZE, 0.0, 0.0));
+    EXPECT_EQ(neighbor.global.x, pos.global.x + 1);
+}
+
+TEST(LargePositionTemplateTest, CanonicalFormAndHash)
+{
+    // 64-bit cells far beyond the int3 range
+    SolarSystemPosition far;
+    far.global = longlong3(int64_t(1) << 40, -(int64_t(1) << 40), 7);
+    far.local = float3(1600.0f, -1024.0f, 0.25f);
+    SolarSystemPosition canonical = far.canonical();
+    EXPECT_EQ(canonical.global, longlong3((int64_t(1) << 40) + 1, -(int64_t(1) << 40), 7));
+    EXPECT_EQ(canonical.local.x, 1600.0f - 2048.0f);
+    EXPECT_EQ(canonical.local.y, -1024.0f);
+    EXPECT_EQ(far.hash(), canonical.hash());
+    EXPECT_NE(hash_cell(longlong3(int64_t(1) << 40, 0, 0)), hash_cell(longlong3(int64_t(1) << 41, 0, 0)));
+
+    // Double offsets: representations in neighbouring cells hash and order the same
+    PrecisePosition a(int3(3, 0, 0), double3(0.125, 0.0, 0.0));
+    PrecisePosition b;
+    b.global = int3(2, 0, 0);
+    b.local = double3(1024.125, 0.0, 0.0);
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_FALSE(a < b);
+    EXPECT_FALSE(b < a);
+    EXPECT_TRUE(a < PrecisePosition(int3(3, 0, 0), double3(0.25, 0.0, 0.0)));
+
+    std::unordered_set<PrecisePosition> set = {a, b};
+    EXPECT_EQ(set.size(), 1u);
+}
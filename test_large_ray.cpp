@@ -0,0 +1,159 @@
+#include "LargeRay.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeRayTest : public ::testing::Test
+{
+  protected:
+    static float3 RandomDirection(std::mt19937& rng)
+    {
+        std::normal_distribution<float> axis(0.0f, 1.0f);
+        float3 d(axis(rng), axis(rng), axis(rng));
+        return d / std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+    }
+
+    // Natural cell of a point given relative to the center of `base`, in double precision
+    static int64_t CellOf(int32_t base, double offset)
+    {
+        return int64_t(base) + int64_t(std::floor(offset / LargePosition::CELL_SIZE + 0.5));
+    }
+
+    static std::vector<RayCell> Walk(const LargeRay& ray, float max_distance)
+    {
+        std::vector<RayCell> cells;
+        LargeRayTraversal traversal(ray, max_distance);
+        RayCell cell;
+        while (traversal.next(cell))
+        {
+            cells.push_back(cell);
+        }
+        return cells;
+    }
+};
+
+TEST_F(LargeRayTest, VisitsEveryCrossedCellInOrder)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> local(-1500.0f, 1500.0f);
+    std::uniform_real_distribution<float> length(0.0f, 40000.0f);
+    for (int r = 0; r < 300; r++)
+    {
+        LargePosition origin;
+        origin.global = int3(1000000000 + r, -7, r * 3);
+        origin.local = float3(local(rng), local(rng), local(rng));
+        const LargeRay ray(origin, RandomDirection(rng));
+        const float max_distance = length(rng);
+        std::vector<RayCell> cells = Walk(ray, max_distance);
+        ASSERT_FALSE(cells.empty());
+
+        // One cell per boundary crossed along each axis, plus the start cell
+        const int32_t global[3] = {origin.global.x, origin.global.y, origin.global.z};
+        const double start[3] = {origin.local.x, origin.local.y, origin.local.z};
+        const double dir[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+        int64_t crossings = 0;
+        int64_t first[3], last[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            first[axis] = CellOf(global[axis], start[axis]);
+            last[axis] = CellOf(global[axis], start[axis] + dir[axis] * max_distance);
+            crossings += std::abs(last[axis] - first[axis]);
+        }
+        ASSERT_EQ(int64_t(cells.size()), crossings + 1) << r;
+        EXPECT_EQ(cells.front().cell, int3(int32_t(first[0]), int32_t(first[1]), int32_t(first[2])));
+        EXPECT_EQ(cells.back().cell, int3(int32_t(last[0]), int32_t(last[1]), int32_t(last[2])));
+        EXPECT_EQ(cells.front().t_enter, 0.0f);
+        EXPECT_EQ(cells.back().t_exit, max_distance);
+
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            const RayCell& c = cells[i];
+            ASSERT_LE(c.t_enter, c.t_exit);
+            if (i > 0)
+            {
+                // Integer steps of exactly one cell along one axis, continuous ray parameters
+                int3 d = c.cell - cells[i - 1].cell;
+                ASSERT_EQ(std::abs(d.x) + std::abs(d.y) + std::abs(d.z), 1) << r << " " << i;
+                ASSERT_EQ(c.t_enter, cells[i - 1].t_exit);
+            }
+
+            // The middle of the cell's ray segment lies inside the cell
+            float t = 0.5f * (c.t_enter + c.t_exit);
+            float3 p = c.origin + ray.direction * t;
+            EXPECT_LE(std::abs(p.x), 1024.01f);
+            EXPECT_LE(std::abs(p.y), 1024.01f);
+            EXPECT_LE(std::abs(p.z), 1024.01f);
+        }
+    }
+}
+
+TEST_F(LargeRayTest, LongRayDoesNotDrift)
+{
+    // 100 000 cells along a diagonal: boundaries are computed per step, not accumulated
+    LargePosition origin;
+    origin.global = int3(-2000000000, 5, 1999000000);
+    origin.local = float3(0.25f, -0.5f, 100.0f);
+    const float3 dir = float3(3.0f, 1.0f, -2.0f) / std::sqrt(14.0f);
+    const LargeRay ray(origin, dir);
+    const float max_distance = 100000.0f * LargePosition::CELL_SIZE;
+
+    std::vector<RayCell> cells = Walk(ray, max_distance);
+    const RayCell& end = cells.back();
+    LargePosition p = end.point_at(ray, max_distance);
+    double3 expected = origin.to_double3() + double3(dir.x, dir.y, dir.z) * double(max_distance);
+    double3 actual = p.to_double3();
+    EXPECT_NEAR(actual.x, expected.x, 20.0);
+    EXPECT_NEAR(actual.y, expected.y, 20.0);
+    EXPECT_NEAR(actual.z, expected.z, 20.0);
+    EXPECT_EQ(int64_t(end.cell.x), CellOf(origin.global.x, origin.local.x + double(dir.x) * max_distance));
+}
+
+TEST_F(LargeRayTest, AxisAlignedAndRangeLimits)
+{
+    LargePosition origin;
+    origin.global = int3(INT32_MAX - 2, 0, 0);
+    origin.local = float3(1500.0f, 0.0f, 0.0f); // already in the next cell
+
+    // Stops at the end of the int32_t cell range
+    std::vector<RayCell> cells = Walk(LargeRay(origin, float3(1.0f, 0.0f, 0.0f)), 1.0e9f);
+    ASSERT_EQ(cells.size(), 2u);
+    EXPECT_EQ(cells[0].cell, int3(INT32_MAX - 1, 0, 0));
+    EXPECT_EQ(cells[1].cell, int3(INT32_MAX, 0, 0));
+    EXPECT_EQ(cells[0].t_exit, 1024.0f + 2048.0f - 1500.0f);
+    EXPECT_EQ(cells[1].origin.x, 1500.0f - 2.0f * 2048.0f);
+
+    // Zero length visits the start cell only
+    cells = Walk(LargeRay(origin, float3(0.0f, -1.0f, 0.0f)), 0.0f);
+    ASSERT_EQ(cells.size(), 1u);
+    EXPECT_EQ(cells[0].t_exit, 0.0f);
+}
+
+TEST_F(LargeRayTest, EarlyOutAtFirstHitInCellFrame)
+{
+    // A box in a distant cell, intersected with the per-cell origin only
+    LargePosition origin(double3(3.0e12, -1.0e11, 5.0e10));
+    const int3 target = origin.global + int3(40, 0, 0);
+    const float3 box_min(-10.0f, -10.0f, -10.0f), box_max(10.0f, 10.0f, 10.0f);
+    LargePosition aim;
+    aim.global = target;
+    double3 to = aim.to_double3() - origin.to_double3();
+    double length = std::sqrt(to.x * to.x + to.y * to.y + to.z * to.z);
+    const LargeRay ray(origin, float3(float(to.x / length), float(to.y / length), float(to.z / length)));
+
+    LargeRayTraversal traversal(ray, 1.0e6f);
+    RayCell cell;
+    size_t visited = 0;
+    float t_hit = -1.0f;
+    while (traversal.next(cell))
+    {
+        visited++;
+        float t;
+        if (cell.cell == target && ray_intersect_box(cell.origin, ray.inv_direction(), box_min, box_max, cell.t_exit, &t))
+        {
+            t_hit = t;
+            break;
+        }
+    }
+    EXPECT_NEAR(t_hit, length - 10.0, 0.1);
+    EXPECT_LE(visited, 42u);
+}
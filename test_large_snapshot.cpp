@@ -0,0 +1,203 @@
+#include "LargeSnapshot.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+
+class LargeSnapshotTest : public ::testing::Test
+{
+  protected:
+    static LargePositionBuffer MakePositions(size_t count)
+    {
+        return RandomPositions(1, int3(0, 0, 0), 5000, LargePosition::THRESHOLD).buffer(count);
+    }
+
+    static std::string Write(const LargePositionBuffer& positions, uint32_t chunk_elements)
+    {
+        std::ostringstream out(std::ios::binary);
+        EXPECT_TRUE(write_snapshot(out, positions, chunk_elements));
+        return out.str();
+    }
+
+    static SnapshotStatus ReadAll(const std::string& bytes, LargePositionBuffer& out)
+    {
+        std::istringstream in(bytes, std::ios::binary);
+        LargeSnapshotReader reader(in);
+        return reader.read_all(out);
+    }
+
+    // Offset of lane `lane` (0..5) of element `index` in a snapshot with a single chunk of `count` elements
+    static size_t ElementOffset(size_t count, int lane, size_t index)
+    {
+        return sizeof(LargeSnapshotHeader) + size_t(LargeSnapshotHeader::lane_bytes(count)) * lane + index * sizeof(float);
+    }
+
+    template <typename T> static void Poke(std::string& bytes, size_t offset, T value)
+    {
+        std::memcpy(&bytes[offset], &value, sizeof(value));
+    }
+};
+
+TEST_F(LargeSnapshotTest, RoundTripInChunks)
+{
+    const size_t count = 1000 + 5;
+    LargePositionBuffer positions = MakePositions(count);
+    const std::string bytes = Write(positions, 64);
+
+    // 16 chunks: 15 full ones, the last one with 45 elements padded to 48 per lane
+    EXPECT_EQ(bytes.size(), sizeof(LargeSnapshotHeader) + 15 * 6 * 64 * 4 + 6 * 48 * 4);
+
+    // Fixed little-endian layout
+    EXPECT_EQ(std::memcmp(bytes.data(), "LWCS", 4), 0);
+    EXPECT_EQ(uint8_t(bytes[4]), LargeSnapshotHeader::VERSION);
+    EXPECT_EQ(uint8_t(bytes[16]), count & 0xff);
+    EXPECT_EQ(uint8_t(bytes[17]), count >> 8);
+
+    std::istringstream in(bytes, std::ios::binary);
+    LargeSnapshotReader reader(in);
+    ASSERT_EQ(reader.status(), SnapshotStatus::Ok);
+    EXPECT_EQ(reader.header().count, count);
+    EXPECT_EQ(reader.header().cell_size, LargePosition::CELL_SIZE);
+
+    // The header bounds are the tight bounds of all cells
+    int3 lo(INT32_MAX, INT32_MAX, INT32_MAX), hi(INT32_MIN, INT32_MIN, INT32_MIN);
+    for (size_t i = 0; i < count; i++)
+    {
+        const int3 g = positions.get(i).global;
+        lo = int3(std::min(lo.x, g.x), std::min(lo.y, g.y), std::min(lo.z, g.z));
+        hi = int3(std::max(hi.x, g.x), std::max(hi.y, g.y), std::max(hi.z, g.z));
+    }
+    EXPECT_EQ(reader.header().min_cell, lo);
+    EXPECT_EQ(reader.header().max_cell, hi);
+
+    // Streaming one chunk at a time, after existing elements
+    LargePositionBuffer loaded = MakePositions(3);
+    size_t chunks = 0;
+    while (reader.remaining() > 0)
+    {
+        ASSERT_EQ(reader.read_chunk(loaded), SnapshotStatus::Ok);
+        chunks++;
+    }
+    EXPECT_EQ(chunks, 16u);
+    ASSERT_EQ(loaded.size(), count + 3);
+    for (size_t i = 0; i < count; i++)
+    {
+        const LargePosition a = positions.get(i), b = loaded.get(i + 3);
+        ASSERT_EQ(a.global, b.global) << i;
+        ASSERT_EQ(std::memcmp(&a.local, &b.local, sizeof(float3)), 0) << i;
+    }
+
+    // Empty snapshots are valid
+    LargePositionBuffer empty;
+    EXPECT_EQ(ReadAll(Write(LargePositionBuffer(), 64), empty), SnapshotStatus::Ok);
+    EXPECT_TRUE(empty.empty());
+}
+
+TEST_F(LargeSnapshotTest, RejectsInvalidInput)
+{
+    const size_t count = 100;
+    LargePositionBuffer positions = MakePositions(count);
+    const std::string bytes = Write(positions, 128);
+    LargePositionBuffer out;
+
+    std::string bad = bytes;
+    bad[0] = 'X';
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::BadMagic);
+
+    bad = bytes;
+    Poke<uint16_t>(bad, 4, LargeSnapshotHeader::VERSION + 1);
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::UnsupportedVersion);
+
+    bad = bytes;
+    Poke<uint16_t>(bad, 4, 0);
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::BadHeader);
+
+    bad = bytes;
+    Poke<uint32_t>(bad, 12, 100); // chunk_elements
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::BadHeader);
+
+    bad = bytes;
+    Poke<float>(bad, 8, 512.0f);
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::CellSizeMismatch);
+
+    EXPECT_EQ(ReadAll(bytes.substr(0, 10), out), SnapshotStatus::Truncated);
+    EXPECT_EQ(ReadAll(bytes.substr(0, bytes.size() - 6 * 112 * 4 + 1), out), SnapshotStatus::Truncated);
+    EXPECT_TRUE(out.empty());
+
+    // Element validation, without converting to double
+    const float bad_locals[] = {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+                                std::nextafter(LargePosition::THRESHOLD, 2048.0f), -1e30f};
+    for (float local : bad_locals)
+    {
+        bad = bytes;
+        Poke<float>(bad, ElementOffset(count, 4, 57), local);
+        EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::OutOfRange) << local;
+    }
+
+    bad = bytes;
+    Poke<int32_t>(bad, ElementOffset(count, 1, 3), positions.get(0).global.y > 0 ? 6000 : -6000); // outside the bounds
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::OutOfRange);
+    EXPECT_TRUE(out.empty());
+
+    // The extreme cells are only valid up to MAX_COORDINATE / down to MIN_COORDINATE
+    LargePositionBuffer edge;
+    LargePosition pos;
+    pos.global = int3(INT32_MAX, INT32_MIN, 0);
+    pos.local = float3(-1.0f, 1.0f, 0.0f);
+    edge.push_back(pos);
+    std::string edge_bytes = Write(edge, 16);
+    EXPECT_EQ(ReadAll(edge_bytes, out), SnapshotStatus::Ok);
+    Poke<float>(edge_bytes, ElementOffset(1, 3, 0), 1.0f);
+    out.clear();
+    EXPECT_EQ(ReadAll(edge_bytes, out), SnapshotStatus::OutOfRange);
+    EXPECT_TRUE(out.empty());
+}
+
+TEST_F(LargeSnapshotTest, ForgedHeaderFailsBeforeAllocating)
+{
+    // Stream without seeking support, like a socket or a pipe
+    struct ForwardOnlyBuffer : std::streambuf
+    {
+        explicit ForwardOnlyBuffer(std::string& bytes) { setg(&bytes[0], &bytes[0], &bytes[0] + bytes.size()); }
+    };
+
+    const std::string bytes = Write(MakePositions(100), 128);
+    LargePositionBuffer out;
+
+    std::string bad = bytes;
+    Poke<uint32_t>(bad, 12, 0xfffffff0u); // chunk_elements, a multiple of 16
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::BadHeader);
+    Poke<uint32_t>(bad, 12, LargeSnapshotHeader::MAX_CHUNK_ELEMENTS + 16);
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::BadHeader);
+
+    bad = bytes;
+    Poke<uint64_t>(bad, 16, LargeSnapshotHeader::MAX_COUNT + 1); // count
+    EXPECT_EQ(ReadAll(bad, out), SnapshotStatus::BadHeader);
+
+    // A count far beyond the data fails from the stream length when it is known, after the first chunk otherwise
+    Poke<uint64_t>(bad, 16, uint64_t(1) << 40);
+    Poke<uint32_t>(bad, 12, LargeSnapshotHeader::MAX_CHUNK_ELEMENTS);
+    {
+        std::istringstream in(bad, std::ios::binary);
+        LargeSnapshotReader reader(in);
+        EXPECT_EQ(reader.status(), SnapshotStatus::Truncated);
+        EXPECT_EQ(reader.read_all(out), SnapshotStatus::Truncated);
+    }
+    {
+        ForwardOnlyBuffer buffer(bad);
+        std::istream in(&buffer);
+        LargeSnapshotReader reader(in);
+        EXPECT_EQ(reader.status(), SnapshotStatus::Ok);
+        EXPECT_EQ(reader.read_all(out), SnapshotStatus::Truncated);
+        EXPECT_LE(out.capacity(), size_t(LargeSnapshotHeader::MAX_CHUNK_ELEMENTS) * 2); // one chunk, no reserve
+    }
+    EXPECT_TRUE(out.empty());
+
+    // The same stream without the forged fields reads normally
+    std::string good = bytes;
+    ForwardOnlyBuffer buffer(good);
+    std::istream in(&buffer);
+    LargeSnapshotReader reader(in);
+    EXPECT_EQ(reader.read_all(out), SnapshotStatus::Ok);
+    EXPECT_EQ(out.size(), 100u);
+}
@@ -0,0 +1,168 @@
+#include "LargeSpatialHash.h"
+#include "test_large_helpers.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeSpatialHashTest : public ::testing::Test
+{
+  protected:
+    static std::vector<LargePosition> MakePositions(size_t count, int32_t cell_range, uint32_t seed)
+    {
+        return RandomPositions(seed, int3(1000000, -500, 7), cell_range, LargePosition::THRESHOLD).vector(count);
+    }
+
+    static std::vector<LargeSpatialHash::Hit> BruteForce(const std::vector<LargePosition>& positions, const std::vector<bool>& alive,
+                                                         const LargePosition& center, int32_t radius)
+    {
+        std::vector<LargeSpatialHash::Hit> hits;
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            int3 d = positions[i].global - center.global;
+            if (alive[i] && std::abs(d.x) <= radius && std::abs(d.y) <= radius && std::abs(d.z) <= radius)
+            {
+                // Same arithmetic as to_float3, without its +/-3 cell assert so larger radii can be checked
+                constexpr float cell = LargePosition::CELL_SIZE;
+                hits.push_back(LargeSpatialHash::Hit{uint32_t(i), positions[i].local + float3(d.x * cell, d.y * cell, d.z * cell)});
+            }
+        }
+        return hits;
+    }
+
+    static void ExpectSameHits(std::vector<LargeSpatialHash::Hit> a, std::vector<LargeSpatialHash::Hit> b)
+    {
+        auto by_id = [](const LargeSpatialHash::Hit& l, const LargeSpatialHash::Hit& r) { return l.id < r.id; };
+        std::sort(a.begin(), a.end(), by_id);
+        std::sort(b.begin(), b.end(), by_id);
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            EXPECT_EQ(a[i].id, b[i].id);
+            EXPECT_EQ(a[i].local.x, b[i].local.x);
+            EXPECT_EQ(a[i].local.y, b[i].local.y);
+            EXPECT_EQ(a[i].local.z, b[i].local.z);
+        }
+    }
+};
+
+TEST_F(LargeSpatialHashTest, HashSpreadsClusteredCells)
+{
+    // A dense 32^3 block of cells must not pile up in a small power-of-two table
+    const size_t buckets = 1024;
+    std::vector<int> counts(buckets, 0);
+    for (int z = 0; z < 32; z++)
+    {
+        for (int y = 0; y < 32; y++)
+        {
+            for (int x = 0; x < 32; x++)
+            {
+                counts[hash_cell(int3(x, y, z)) & (buckets - 1)]++;
+            }
+        }
+    }
+    // 32 per bucket on average
+    EXPECT_LT(*std::max_element(counts.begin(), counts.end()), 64);
+    EXPECT_GT(*std::min_element(counts.begin(), counts.end()), 8);
+}
+
+TEST_F(LargeSpatialHashTest, GatherMatchesBruteForce)
+{
+    std::vector<LargePosition> positions = MakePositions(5000, 6, 1);
+    std::vector<uint32_t> ids(positions.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        ids[i] = uint32_t(i);
+    }
+
+    LargeSpatialHash grid;
+    grid.insert(ids.data(), positions.data(), positions.size());
+    EXPECT_EQ(grid.object_count(), positions.size());
+    EXPECT_LE(grid.cell_count(), 13u * 13u * 13u);
+
+    std::vector<bool> alive(positions.size(), true);
+    for (int32_t radius : {0, 1, 2})
+    {
+        for (size_t q = 0; q < 20; q++)
+        {
+            const LargePosition& center = positions[q * 97];
+            std::vector<LargeSpatialHash::Hit> hits;
+            size_t appended = grid.gather(center, radius, hits);
+            EXPECT_EQ(appended, hits.size());
+            ExpectSameHits(hits, BruteForce(positions, alive, center, radius));
+        }
+    }
+}
+
+TEST_F(LargeSpatialHashTest, RemoveAndUpdate)
+{
+    std::vector<LargePosition> positions = MakePositions(2000, 3, 2);
+    LargeSpatialHash grid;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        grid.insert(uint32_t(i), positions[i]);
+    }
+
+    // Remove every third object in bulk
+    std::vector<uint32_t> removed;
+    std::vector<bool> alive(positions.size(), true);
+    for (size_t i = 0; i < positions.size(); i += 3)
+    {
+        removed.push_back(uint32_t(i));
+        alive[i] = false;
+    }
+    EXPECT_EQ(grid.remove(removed.data(), removed.size()), removed.size());
+    EXPECT_EQ(grid.remove(removed.data(), removed.size()), 0u);
+    EXPECT_EQ(grid.object_count(), positions.size() - removed.size());
+    EXPECT_FALSE(grid.contains(0));
+    EXPECT_TRUE(grid.contains(1));
+
+    // Move the survivors, half of them into other cells
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> step(-LargePosition::CELL_SIZE, LargePosition::CELL_SIZE);
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (alive[i])
+        {
+            LargePosition moved;
+            moved.from_float3(positions[i].global, positions[i].local + float3(step(rng), 0.0f, step(rng)));
+            positions[i] = moved;
+            grid.update(uint32_t(i), moved);
+        }
+    }
+
+    LargePosition center = positions[1];
+    std::vector<LargeSpatialHash::Hit> hits;
+    grid.gather(center, 2, hits);
+    ExpectSameHits(hits, BruteForce(positions, alive, center, 2));
+
+    // Emptying cells must release their table slots without breaking other probe chains
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (alive[i] && positions[i].global.x % 2 == 0)
+        {
+            grid.remove(uint32_t(i));
+            alive[i] = false;
+        }
+    }
+    hits.clear();
+    grid.gather(center, 3, hits);
+    ExpectSameHits(hits, BruteForce(positions, alive, center, 3));
+
+    grid.clear();
+    EXPECT_EQ(grid.object_count(), 0u);
+    EXPECT_EQ(grid.cell_count(), 0u);
+    EXPECT_EQ(grid.find_cell(center.global), nullptr);
+}
+
+TEST_F(LargeSpatialHashTest, GatherNearCellIndexLimits)
+{
+    LargeSpatialHash grid;
+    LargePosition edge;
+    edge.global = int3(INT_MAX, INT_MIN, 0);
+    grid.insert(7, edge);
+
+    std::vector<LargeSpatialHash::Hit> hits;
+    EXPECT_EQ(grid.gather(edge, 1, hits), 1u);
+    EXPECT_EQ(hits[0].id, 7u);
+}
@@ -0,0 +1,202 @@
+#include "LargeSpatialSort.h"
+#include "test_large_helpers.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeSpatialSortTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+
+    // Bit-by-bit reference for the interleaving
+    static uint64_t ReferenceMorton(uint32_t x, uint32_t y, uint32_t z)
+    {
+        uint64_t key = 0;
+        for (int bit = 0; bit < 21; bit++)
+        {
+            key |= uint64_t((x >> bit) & 1) << (3 * bit);
+            key |= uint64_t((y >> bit) & 1) << (3 * bit + 1);
+            key |= uint64_t((z >> bit) & 1) << (3 * bit + 2);
+        }
+        return key;
+    }
+};
+
+TEST_F(LargeSpatialSortTest, InterleaveMatchesReference)
+{
+    using namespace large_coordinates_detail;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 10000; i++)
+    {
+        uint32_t x = rng() & 0x1fffff, y = rng() & 0x1fffff, z = rng() & 0x1fffff;
+        uint64_t expected = ReferenceMorton(x, y, z);
+        ASSERT_EQ(interleave3(x, y, z, false), expected);
+        ASSERT_EQ(interleave3(x, y, z, true), expected);
+
+        uint32_t hx = rng(), hy = rng(), hz = rng();
+        SpatialKey96 wide = interleave3_96(hx, hy, hz, false);
+        ASSERT_EQ(wide, interleave3_96(hx, hy, hz, true));
+        // The low 63 bits interleave the low 21 bits of every axis
+        uint64_t low = (wide.hi << 32) | wide.lo;
+        ASSERT_EQ(low & ~(uint64_t(1) << 63), ReferenceMorton(hx & 0x1fffff, hy & 0x1fffff, hz & 0x1fffff));
+        ASSERT_EQ(wide.hi >> 31, ReferenceMorton(hx >> 21, hy >> 21, hz >> 21));
+    }
+}
+
+TEST_F(LargeSpatialSortTest, KeysFollowSignedCellOrder)
+{
+    // Moving along one axis never decreases the key, across zero and across sub-cells
+    uint64_t previous_morton = 0;
+    SpatialKey96 previous_wide{0, 0};
+    for (int32_t cell = -40; cell <= 40; cell++)
+    {
+        for (float local : {-1024.0f, -512.0f, 0.0f, 512.0f, 1000.0f})
+        {
+            LargePosition pos = MakePosition(int3(3, cell, -2), float3(0.0f, local, 0.0f));
+            uint64_t morton = morton_key64(pos);
+            SpatialKey96 wide = morton_key96(pos);
+            EXPECT_GE(morton, previous_morton);
+            EXPECT_FALSE(wide < previous_wide);
+            previous_morton = morton;
+            previous_wide = wide;
+        }
+    }
+
+    // Two representations of the same point quantize identically
+    LargePosition a = MakePosition(int3(5, 0, 0), float3(1200.0f, 0.0f, 0.0f));
+    LargePosition b = MakePosition(int3(6, 0, 0), float3(1200.0f - LargePosition::CELL_SIZE, 0.0f, 0.0f));
+    EXPECT_EQ(morton_key64(a), morton_key64(b));
+    EXPECT_EQ(hilbert_key64(a), hilbert_key64(b));
+
+    // The full cell range fits in 96-bit keys without clamping
+    EXPECT_LT(morton_key96(MakePosition(int3(INT_MIN, 0, 0), float3())), morton_key96(MakePosition(int3(INT_MIN + 1, 0, 0), float3())));
+    EXPECT_LT(morton_key96(MakePosition(int3(0, INT_MAX - 1, 0), float3())), morton_key96(MakePosition(int3(0, INT_MAX, 0), float3())));
+
+    // 64-bit keys clamp far away positions onto the border instead of wrapping
+    int3 origin(1000, 1000, 1000);
+    EXPECT_EQ(morton_key64(MakePosition(int3(INT_MAX, 1000, 1000), float3()), origin),
+              morton_key64(MakePosition(int3(INT_MAX - 100000, 1000, 1000), float3()), origin));
+}
+
+TEST_F(LargeSpatialSortTest, HilbertStepsBetweenFaceNeighbors)
+{
+    // An aligned block of 8x8x8 sub-cells is a contiguous run of the Hilbert curve,
+    // and consecutive points along the curve are face neighbors
+    struct Point
+    {
+        uint64_t key;
+        int3 p;
+    };
+    std::vector<Point> points;
+    for (int z = 0; z < 8; z++)
+    {
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                // 4 x 4 x 4 cells split in two along every axis (1 sub-cell bit): axis value = 2 * cell + (local > 0) + bias
+                int3 cell(x >> 1, y >> 1, z >> 1);
+                float3 local((x & 1) ? 512.0f : -512.0f, (y & 1) ? 512.0f : -512.0f, (z & 1) ? 512.0f : -512.0f);
+                points.push_back(Point{hilbert_key64<1>(MakePosition(cell, local)), int3(x, y, z)});
+            }
+        }
+    }
+    std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) { return a.key < b.key; });
+
+    EXPECT_EQ(points.back().key - points.front().key, 511u);
+    for (size_t i = 1; i < points.size(); i++)
+    {
+        int3 d = points[i].p - points[i - 1].p;
+        EXPECT_EQ(std::abs(d.x) + std::abs(d.y) + std::abs(d.z), 1) << i;
+    }
+}
+
+TEST_F(LargeSpatialSortTest, RadixSortMatchesStableSort)
+{
+    std::mt19937_64 rng(2);
+    const size_t count = 300000;
+    std::vector<uint64_t> keys(count);
+    std::vector<SpatialKey96> wide_keys(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        // Few distinct values in the high bytes, plenty of duplicates to check stability
+        keys[i] = (rng() % 5000) << 20 | (rng() & 0xff);
+        wide_keys[i] = SpatialKey96{rng() % 1000, uint32_t(rng() % 7)};
+    }
+
+    std::vector<uint32_t> expected(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        expected[i] = uint32_t(i);
+    }
+    std::vector<uint32_t> expected_wide(expected);
+    std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    std::stable_sort(expected_wide.begin(), expected_wide.end(), [&](uint32_t a, uint32_t b) { return wide_keys[a] < wide_keys[b]; });
+
+    LargeThreadPool pool(4);
+    for (uint32_t threads : {1u, 4u, 0u}) // 0: on the pool
+    {
+        SCOPED_TRACE(threads);
+        std::vector<uint64_t> sorted_keys(keys);
+        std::vector<uint32_t> values(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            values[i] = uint32_t(i);
+        }
+        std::vector<uint32_t> wide_values(values);
+        std::vector<SpatialKey96> sorted_wide(wide_keys);
+
+        if (threads > 0)
+        {
+            radix_sort(sorted_keys.data(), values.data(), count, threads);
+            radix_sort(sorted_wide.data(), wide_values.data(), count, threads);
+        }
+        else
+        {
+            radix_sort(sorted_keys.data(), values.data(), count, pool);
+            radix_sort(sorted_wide.data(), wide_values.data(), count, pool);
+        }
+        EXPECT_EQ(values, expected);
+        EXPECT_EQ(wide_values, expected_wide);
+        EXPECT_TRUE(std::is_sorted(sorted_keys.begin(), sorted_keys.end()));
+    }
+}
+
+TEST_F(LargeSpatialSortTest, SpatialSortReordersBuffer)
+{
+    const int3 origin(-7000, 0, 7000);
+    LargePositionBuffer buffer = RandomPositions(3, origin, 50, 1024.0f).buffer(5000);
+    const LargePositionBuffer original(buffer);
+
+    for (SpatialCurve curve : {SpatialCurve::Morton, SpatialCurve::Hilbert})
+    {
+        buffer = original;
+        std::vector<uint32_t> order(buffer.size());
+        spatial_sort(buffer, origin, curve, order.data());
+
+        uint64_t previous = 0;
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            LargePosition pos = buffer.get(i);
+            EXPECT_EQ(pos, original.get(order[i]));
+            uint64_t key = curve == SpatialCurve::Morton ? morton_key64(pos, origin) : hilbert_key64(pos, origin);
+            EXPECT_GE(key, previous);
+            previous = key;
+        }
+
+        std::sort(order.begin(), order.end());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            ASSERT_EQ(order[i], i);
+        }
+    }
+
+    // The portable path produces the same keys as pdep
+    std::vector<uint64_t> fast(original.size()), portable(original.size());
+    spatial_keys64(SpatialCurve::Hilbert, origin, original.lanes(), fast.data(), original.size());
+    simd_set_level(SimdLevel::Scalar);
+    spatial_keys64(SpatialCurve::Hilbert, origin, original.lanes(), portable.data(), original.size());
+    EXPECT_EQ(fast, portable);
+}
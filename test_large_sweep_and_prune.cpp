@@ -0,0 +1,172 @@
+#include "LargeSweepAndPrune.h"
+#include "test_large_helpers.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+class LargeSweepAndPruneTest : public ::testing::Test
+{
+  protected:
+    using PairSet = std::set<std::pair<uint32_t, uint32_t>>;
+
+    // Boxes anchored to a few cells, with local offsets anywhere in the hysteresis range (+/-THRESHOLD)
+    static std::vector<LargeAABB> MakeBoxes(const int3& center, size_t count, uint32_t seed)
+    {
+        RandomPositions random(seed, center, 3, LargePosition::THRESHOLD);
+        std::uniform_real_distribution<float> extent(20.0f, 400.0f);
+        std::vector<LargeAABB> boxes(count);
+        for (LargeAABB& box : boxes)
+        {
+            LargePosition c = random.next();
+            float3 h(extent(random.rng()), extent(random.rng()), extent(random.rng()));
+            box.min.global = box.max.global = c.global;
+            box.min.local = c.local - h;
+            box.max.local = c.local + h;
+        }
+        return boxes;
+    }
+
+    static PairSet BruteForce(const std::vector<LargeAABB>& boxes, const std::vector<bool>& alive)
+    {
+        PairSet pairs;
+        for (uint32_t a = 0; a < uint32_t(boxes.size()); a++)
+        {
+            for (uint32_t b = a + 1; alive[a] && b < uint32_t(boxes.size()); b++)
+            {
+                if (alive[b] && boxes[a].overlaps(boxes[b]))
+                {
+                    pairs.insert(std::make_pair(a, b));
+                }
+            }
+        }
+        return pairs;
+    }
+
+    // Every pair is reported exactly once, with a < b
+    static PairSet Collect(LargeSweepAndPrune& sap)
+    {
+        std::vector<LargeSweepAndPrune::Pair> pairs;
+        sap.find_pairs(pairs);
+        PairSet set;
+        for (const LargeSweepAndPrune::Pair& p : pairs)
+        {
+            EXPECT_LT(p.a, p.b);
+            EXPECT_TRUE(set.insert(std::make_pair(p.a, p.b)).second) << p.a << " " << p.b;
+        }
+        return set;
+    }
+};
+
+TEST_F(LargeSweepAndPruneTest, FindsPairsAcrossCellsAndRegions)
+{
+    // Region boundaries fall between cells 3 and 4 (and -1 and 0), inside the populated block
+    const int3 center(2, -1, 1 << 29);
+    std::vector<LargeAABB> boxes = MakeBoxes(center, 1500, 1);
+    std::vector<bool> alive(boxes.size(), true);
+    LargeSweepAndPrune sap;
+    for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+    {
+        sap.insert(i, boxes[i]);
+    }
+    EXPECT_GT(sap.region_count(), 1u);
+
+    PairSet expected = BruteForce(boxes, alive);
+    EXPECT_GT(expected.size(), 100u);
+    EXPECT_EQ(Collect(sap), expected);
+
+    // Anchored to neighboring cells, overlapping only because local reaches past the natural boundary
+    LargeSweepAndPrune small;
+    LargeAABB a, b;
+    a.min.global = a.max.global = int3(0, 0, 0);
+    a.min.local = float3(1400.0f, -1.0f, -1.0f);
+    a.max.local = float3(1500.0f, 1.0f, 1.0f);
+    b.min.global = b.max.global = int3(1, 0, 0);
+    b.min.local = float3(-600.0f, -1.0f, -1.0f);
+    b.max.local = float3(-500.0f, 1.0f, 1.0f);
+    small.insert(7, a);
+    small.insert(9, b);
+    PairSet found = Collect(small);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(*found.begin(), std::make_pair(7u, 9u));
+}
+
+TEST_F(LargeSweepAndPruneTest, IncrementalFramesMatchBruteForce)
+{
+    const int3 center(-4, 0, 3);
+    std::vector<LargeAABB> boxes = MakeBoxes(center, 800, 2);
+    std::vector<bool> alive(boxes.size(), true);
+    LargeSweepAndPrune sap;
+    for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+    {
+        sap.insert(i, boxes[i]);
+    }
+    EXPECT_EQ(Collect(sap), BruteForce(boxes, alive));
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> step(-200.0f, 200.0f);
+    for (int frame = 0; frame < 10; frame++)
+    {
+        for (uint32_t i = uint32_t(frame % 2); i < uint32_t(boxes.size()); i += 2)
+        {
+            // Move the box and re-cell its anchor like from_float3() would
+            LargeAABB& box = boxes[i];
+            float3 delta(step(rng), step(rng), step(rng));
+            float3 half = (box.max.local - box.min.local) * 0.5f;
+            LargePosition c;
+            c.from_float3(box.min.global, box.min.local + half + delta);
+            box.min.global = box.max.global = c.global;
+            box.min.local = c.local - half;
+            box.max.local = c.local + half;
+            sap.update(i, box);
+        }
+
+        // Remove and re-add a few objects between frames
+        for (uint32_t i = uint32_t(frame); i < uint32_t(boxes.size()); i += 53)
+        {
+            EXPECT_TRUE(sap.remove(i));
+            if (frame % 3 == 0)
+            {
+                sap.insert(i, boxes[i]);
+            }
+            else
+            {
+                alive[i] = false;
+            }
+        }
+        ASSERT_EQ(Collect(sap), BruteForce(boxes, alive)) << frame;
+
+        for (uint32_t i = 0; i < uint32_t(boxes.size()); i++)
+        {
+            if (!alive[i])
+            {
+                sap.insert(i, boxes[i]);
+                alive[i] = true;
+            }
+        }
+    }
+}
+
+TEST_F(LargeSweepAndPruneTest, EmptyRegionsAreReleased)
+{
+    LargeSweepAndPrune sap;
+    LargeAABB box;
+    box.min.global = box.max.global = int3(INT32_MAX, INT32_MIN, 0);
+    box.min.local = float3(-1.0f, -1.0f, -1.0f);
+    box.max.local = float3(1.0f, 1.0f, 1.0f);
+    sap.insert(0, box);
+    sap.insert(1, box);
+    EXPECT_EQ(sap.region_count(), 1u);
+    EXPECT_EQ(Collect(sap).size(), 1u);
+
+    // Moving out and removing leaves the old region empty; it is released by the next find_pairs()
+    LargeAABB moved = box;
+    moved.min.global.z = moved.max.global.z = 100;
+    sap.update(0, moved);
+    sap.remove(1);
+    EXPECT_EQ(sap.region_count(), 2u);
+    EXPECT_TRUE(Collect(sap).empty());
+    EXPECT_EQ(sap.region_count(), 1u);
+    EXPECT_EQ(sap.object_count(), 1u);
+}
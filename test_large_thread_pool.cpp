@@ -0,0 +1,134 @@
+#include "LargePositionBuffer.h"
+#include "LargeThreadPool.h"
+#include "test_large_helpers.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+class LargeThreadPoolTest : public ::testing::Test
+{
+  protected:
+    void TearDown() override { simd_set_level(simd_supported_level()); }
+};
+
+TEST_F(LargeThreadPoolTest, ParallelForCoversEveryIndexOnce)
+{
+    for (uint32_t threads : {1u, 2u, 4u, 7u})
+    {
+        LargeThreadPool pool(threads);
+        EXPECT_EQ(pool.thread_count(), threads);
+        for (size_t count : {size_t(0), size_t(1), size_t(63), size_t(1000), size_t(100003)})
+        {
+            for (size_t align : {size_t(1), size_t(64)})
+            {
+                std::vector<std::atomic<uint32_t>> hits(count);
+                std::atomic<bool> ranges_ok{true};
+                pool.parallel_for(
+                    count, 100,
+                    [&](size_t begin, size_t end)
+                    {
+                        size_t grain = (100 + align - 1) / align * align;
+                        if (begin % align != 0 || end <= begin || (threads > 1 && end - begin > grain) ||
+                            pool.thread_index() >= threads)
+                        {
+                            ranges_ok = false;
+                        }
+                        for (size_t i = begin; i < end; i++)
+                        {
+                            hits[i]++;
+                        }
+                    },
+                    align);
+                EXPECT_TRUE(ranges_ok) << threads << " " << count;
+                for (size_t i = 0; i < count; i++)
+                {
+                    ASSERT_EQ(hits[i].load(), 1u) << threads << " " << count << " " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(LargeThreadPoolTest, NestedParallelFor)
+{
+    LargeThreadPool pool(4);
+    std::vector<std::atomic<uint32_t>> hits(64 * 1000);
+    pool.parallel_for(64, 1,
+                      [&](size_t begin, size_t end)
+                      {
+                          for (size_t outer = begin; outer < end; outer++)
+                          {
+                              pool.parallel_for(1000, 10,
+                                                [&](size_t b, size_t e)
+                                                {
+                                                    for (size_t i = b; i < e; i++)
+                                                    {
+                                                        hits[outer * 1000 + i]++;
+                                                    }
+                                                });
+                          }
+                      });
+    for (size_t i = 0; i < hits.size(); i++)
+    {
+        ASSERT_EQ(hits[i].load(), 1u) << i;
+    }
+}
+
+TEST_F(LargeThreadPoolTest, ParallelConversionsMatchBatch)
+{
+    const size_t count = 100000 + 13;
+    LargeThreadPool pool(4);
+    for (int level = 0; level <= (int)simd_supported_level(); level++)
+    {
+        simd_set_level((SimdLevel)level);
+        LargePositionBuffer buffer = RandomPositions(1 + level, int3(100, -7, 0), 2, 1500.0f).buffer(count);
+        const int3 origin(100, -7, 0);
+
+        std::vector<float> expected(3 * count), actual(3 * count);
+        batch_to_float3(origin, buffer.lanes(), Float3Lanes{&expected[0], &expected[count], &expected[2 * count]}, count);
+        parallel_batch_to_float3(origin, buffer.lanes(), Float3Lanes{&actual[0], &actual[count], &actual[2 * count]}, count, pool);
+        ASSERT_EQ(std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(float)), 0) << level;
+
+        std::vector<double3> world(count), world_parallel(count);
+        buffer.to_double3(world.data());
+        parallel_batch_to_double3(buffer.lanes(), world_parallel.data(), count, pool);
+        ASSERT_EQ(std::memcmp(world.data(), world_parallel.data(), count * sizeof(double3)), 0) << level;
+        EXPECT_EQ(world[17].x, buffer.get(17).to_double3().x);
+
+        LargePositionBuffer serial, parallel;
+        serial.resize(count);
+        parallel.resize(count);
+        batch_from_double3(world.data(), serial.mutable_lanes(), count);
+        parallel_batch_from_double3(world.data(), parallel.mutable_lanes(), count, pool);
+        for (size_t i = 0; i < count; i += 97)
+        {
+            ASSERT_EQ(serial.get(i).global, parallel.get(i).global) << level << " " << i;
+            ASSERT_EQ(serial.get(i).local, parallel.get(i).local) << level << " " << i;
+        }
+
+        // Move everything by up to half a cell, so many elements change cell
+        std::mt19937 rng(10 + level);
+        std::uniform_real_distribution<float> step(-1024.0f, 1024.0f);
+        std::vector<float> moved(3 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            LargePosition pos = serial.get(i);
+            moved[i] = pos.local.x + step(rng);
+            moved[count + i] = pos.local.y + step(rng);
+            moved[2 * count + i] = pos.local.z + step(rng);
+        }
+        const ConstFloat3Lanes local_pos{&moved[0], &moved[count], &moved[2 * count]};
+        std::vector<uint64_t> serial_mask((count + 63) / 64), parallel_mask((count + 63) / 64, ~uint64_t(0));
+        size_t serial_changed = batch_from_float3(serial.mutable_lanes(), local_pos, count, serial_mask.data());
+        size_t parallel_changed = parallel_batch_from_float3(parallel.mutable_lanes(), local_pos, count, parallel_mask.data(), pool);
+        EXPECT_GT(serial_changed, count / 10);
+        EXPECT_EQ(parallel_changed, serial_changed) << level;
+        EXPECT_EQ(parallel_mask, serial_mask) << level;
+        for (size_t i = 0; i < count; i += 89)
+        {
+            ASSERT_EQ(serial.get(i).global, parallel.get(i).global) << level << " " << i;
+            ASSERT_EQ(serial.get(i).local, parallel.get(i).local) << level << " " << i;
+        }
+    }
+}